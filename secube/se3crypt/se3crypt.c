@@ -0,0 +1,215 @@
+/**
+ *  \file se3crypt.c
+ *  \brief Encrypt or decrypt a file or a pipe with a key stored in the SEcube, and report the throughput
+ *
+ *  \details Usage: se3crypt -e|-d -k key_id [-m ctr|cbc|ecb|ofb|cfb] [-v iv_hex] [-p pin]
+ *  [-n device_index] [input [output]]
+ *  The input and the output default to stdin and stdout; the statistics go to stderr.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include "L1_stream.h"
+
+#ifdef _WIN32
+#include <io.h>
+#define open _open
+#define close _close
+#define O_FLAGS_IN (_O_RDONLY | _O_BINARY)
+#define O_FLAGS_OUT (_O_WRONLY | _O_CREAT | _O_TRUNC | _O_BINARY)
+#else
+#define O_FLAGS_IN (O_RDONLY)
+#define O_FLAGS_OUT (O_WRONLY | O_CREAT | O_TRUNC)
+#endif
+
+static double wall_time(void)
+{
+#ifdef _WIN32
+	LARGE_INTEGER f, t;
+	QueryPerformanceFrequency(&f);
+	QueryPerformanceCounter(&t);
+	return (double)t.QuadPart / (double)f.QuadPart;
+#else
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+#endif
+}
+
+static void usage(void)
+{
+	fprintf(stderr,
+		"usage: se3crypt -e|-d -k key_id [-m ctr|cbc|ecb|ofb|cfb] [-v iv_hex] [-p pin]\n"
+		"                [-n device_index] [input [output]]\n");
+}
+
+static bool parse_hex(const char* s, uint8_t* out, size_t len)
+{
+	size_t i;
+	unsigned int b;
+
+	if (strlen(s) != 2 * len)
+		return false;
+	for (i = 0; i < len; i++) {
+		if (1 != sscanf(s + 2 * i, "%2x", &b))
+			return false;
+		out[i] = (uint8_t)b;
+	}
+	return true;
+}
+
+int main(int argc, char* argv[])
+{
+	static const struct {
+		const char* name;
+		uint16_t feedback;
+	} modes[] = {
+		{ "ctr", SE3_FEEDBACK_CTR }, { "cbc", SE3_FEEDBACK_CBC }, { "ecb", SE3_FEEDBACK_ECB },
+		{ "ofb", SE3_FEEDBACK_OFB }, { "cfb", SE3_FEEDBACK_CFB }
+	};
+	uint16_t direction = 0;
+	uint16_t feedback = SE3_FEEDBACK_CTR;
+	uint32_t key_id = SE3_KEY_INVALID;
+	uint8_t iv[16];
+	bool iv_set = false;
+	uint8_t pin[SE3_L1_PIN_SIZE];
+	long dev_index = 0;
+	const char* path_in = NULL, *path_out = NULL;
+	int fd_in = 0, fd_out = 1;
+	se3_disco_it it;
+	se3_device dev;
+	se3_session session;
+	L1_stream_stats stats;
+	bool found = false, opened = false, logged_in = false;
+	uint16_t r = SE3_OK;
+	double t0, t1;
+	size_t i;
+	int a, ret = 1;
+
+	memset(pin, 0, sizeof(pin));
+	for (a = 1; a < argc; a++) {
+		if (!strcmp(argv[a], "-e")) {
+			direction = SE3_DIR_ENCRYPT;
+		}
+		else if (!strcmp(argv[a], "-d")) {
+			direction = SE3_DIR_DECRYPT;
+		}
+		else if (!strcmp(argv[a], "-k") && a + 1 < argc) {
+			key_id = (uint32_t)strtoul(argv[++a], NULL, 0);
+		}
+		else if (!strcmp(argv[a], "-m") && a + 1 < argc) {
+			a++;
+			for (i = 0; i < sizeof(modes) / sizeof(modes[0]); i++) {
+				if (!strcmp(argv[a], modes[i].name))
+					break;
+			}
+			if (i == sizeof(modes) / sizeof(modes[0])) {
+				usage();
+				return 1;
+			}
+			feedback = modes[i].feedback;
+		}
+		else if (!strcmp(argv[a], "-v") && a + 1 < argc) {
+			if (!parse_hex(argv[++a], iv, sizeof(iv))) {
+				fprintf(stderr, "se3crypt: the IV must be 32 hex digits\n");
+				return 1;
+			}
+			iv_set = true;
+		}
+		else if (!strcmp(argv[a], "-p") && a + 1 < argc) {
+			a++;
+			memcpy(pin, argv[a], (strlen(argv[a]) < sizeof(pin)) ? strlen(argv[a]) : sizeof(pin));
+		}
+		else if (!strcmp(argv[a], "-n") && a + 1 < argc) {
+			dev_index = strtol(argv[++a], NULL, 0);
+		}
+		else if (argv[a][0] != '-' && path_in == NULL) {
+			path_in = argv[a];
+		}
+		else if (argv[a][0] != '-' && path_out == NULL) {
+			path_out = argv[a];
+		}
+		else {
+			usage();
+			return 1;
+		}
+	}
+	if (direction == 0 || key_id == SE3_KEY_INVALID) {
+		usage();
+		return 1;
+	}
+
+	if (path_in != NULL && (fd_in = open(path_in, O_FLAGS_IN)) < 0) {
+		perror(path_in);
+		return 1;
+	}
+	if (path_out != NULL && (fd_out = open(path_out, O_FLAGS_OUT, 0600)) < 0) {
+		perror(path_out);
+		goto cleanup;
+	}
+#ifdef _WIN32
+	_setmode(fd_in, _O_BINARY);
+	_setmode(fd_out, _O_BINARY);
+#endif
+
+	L0_discover_init(&it);
+	while (L0_discover_next(&it)) {
+		if (dev_index-- == 0) {
+			found = true;
+			break;
+		}
+	}
+	if (!found) {
+		fprintf(stderr, "se3crypt: device not found\n");
+		goto cleanup;
+	}
+	r = L0_open(&dev, &it.device_info, 1000);
+	if (SE3_OK != r) {
+		fprintf(stderr, "se3crypt: cannot open device (%04x)\n", r);
+		goto cleanup;
+	}
+	opened = true;
+	r = L1_login(&session, &dev, pin, SE3_ACCESS_USER);
+	if (SE3_OK != r) {
+		fprintf(stderr, "se3crypt: login failed (%04x)\n", r);
+		goto cleanup;
+	}
+	logged_in = true;
+	r = L1_crypto_set_time(&session, (uint32_t)time(0));
+	if (SE3_OK != r) {
+		fprintf(stderr, "se3crypt: cannot set the device time (%04x)\n", r);
+		goto cleanup;
+	}
+
+	t0 = wall_time();
+	r = L1_stream_crypt_fd(&session, SE3_ALGO_AES, feedback | direction, key_id, iv_set ? iv : NULL, fd_in, fd_out, &stats);
+	t1 = wall_time();
+	if (SE3_OK != r) {
+		fprintf(stderr, "se3crypt: %s failed (%04x)\n", (direction == SE3_DIR_ENCRYPT) ? "encryption" : "decryption", r);
+		goto cleanup;
+	}
+
+	fprintf(stderr, "%llu bytes in %.3f s, %.2f MB/s (%u requests, device waited for input %u times)\n",
+		(unsigned long long)stats.bytes_out, t1 - t0,
+		(t1 > t0) ? (double)stats.bytes_out / (t1 - t0) / 1e6 : 0.0,
+		stats.requests, stats.input_stalls);
+	ret = 0;
+
+cleanup:
+	memset(pin, 0, sizeof(pin));
+	if (logged_in) {
+		L1_logout(&session);
+	}
+	if (opened) {
+		L0_close(&dev);
+	}
+	if (path_in != NULL && fd_in >= 0) {
+		close(fd_in);
+	}
+	if (path_out != NULL && fd_out >= 0) {
+		close(fd_out);
+	}
+	return ret;
+}
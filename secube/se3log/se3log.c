@@ -0,0 +1,239 @@
+/**
+ *  \file se3log.c
+ *  \brief Decode the binary event log written by the SEcube to its SD card
+ *
+ *  \details Usage: se3log [-f first_block] [-c blocks] device_or_image
+ *  The log range, by default the one of se3_log.h, is read from a block device or from an
+ *  image of the card. The blocks of each boot are printed in order with their events; times
+ *  are microseconds from the first event of the boot, assuming no two consecutive events are
+ *  more than one wrap of the cycle counter apart. Blocks overwritten by the circular log and
+ *  events dropped by the device are reported.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "se3_log.h"
+
+typedef struct {
+	uint32_t boot;
+	uint32_t seq;
+	uint32_t index;  ///< position in the range, then first position of its boot
+	uint8_t data[SE3_LOG_BLOCK_SIZE];
+} log_block;
+
+static const char* event_names[] = {
+	NULL, "BOOT", "CMD0", "CMD1", "FLASH_COLLECT", "FLASH_ERASE", "MEM_DEFRAG", "SD_ERROR"
+};
+
+static void usage(void)
+{
+	fprintf(stderr, "usage: se3log [-f first_block] [-c blocks] device_or_image\n");
+}
+
+static int block_cmp_boot(const void* a, const void* b)
+{
+	const log_block* x = (const log_block*)a;
+	const log_block* y = (const log_block*)b;
+
+	if (x->boot != y->boot) {
+		return (x->boot < y->boot) ? (-1) : (1);
+	}
+	return 0;
+}
+
+static int block_cmp(const void* a, const void* b)
+{
+	const log_block* x = (const log_block*)a;
+	const log_block* y = (const log_block*)b;
+
+	if (x->index != y->index) {
+		return (x->index > y->index) ? (-1) : (1);
+	}
+	if (x->boot != y->boot) {
+		return (x->boot < y->boot) ? (-1) : (1);
+	}
+	if (x->seq != y->seq) {
+		return (x->seq < y->seq) ? (-1) : (1);
+	}
+	return 0;
+}
+
+static void print_event(uint16_t id, uint16_t seq, double us, uint32_t arg0, uint32_t arg1)
+{
+	if (id < sizeof(event_names) / sizeof(event_names[0]) && event_names[id] != NULL) {
+		printf("%14.1f %5u %-14s", us, (unsigned)seq, event_names[id]);
+	}
+	else if (id >= SE3_LOG_USER) {
+		printf("%14.1f %5u USER+%-9u", us, (unsigned)seq, (unsigned)(id - SE3_LOG_USER));
+	}
+	else {
+		printf("%14.1f %5u ID%-12u", us, (unsigned)seq, (unsigned)id);
+	}
+
+	switch (id) {
+	case SE3_LOG_CMD0:
+	case SE3_LOG_CMD1:
+		printf(" cmd=%u status=0x%04x cycles=%u\n", (unsigned)(arg0 & 0xFFFF), (unsigned)(arg0 >> 16), (unsigned)arg1);
+		break;
+	case SE3_LOG_SD_ERROR:
+		printf(" %s block=%u blocks=%u\n", (arg1 & 0x80000000) ? "write" : "read",
+			(unsigned)arg0, (unsigned)(arg1 & 0x7FFFFFFF));
+		break;
+	default:
+		printf(" 0x%08x 0x%08x\n", (unsigned)arg0, (unsigned)arg1);
+		break;
+	}
+}
+
+/** \brief Print the blocks of one boot, sorted by seq */
+static void print_boot(const log_block* blocks, size_t n)
+{
+	uint64_t time = 0;
+	uint32_t last = 0, t, arg0, arg1, hz, dropped_total = 0;
+	uint16_t count, dropped, id, seq, next_seq = 0;
+	bool first = true;
+	size_t i, j;
+	const uint8_t* p;
+
+	SE3_GET32(blocks[0].data, SE3_LOG_BLOCK_OFF_HZ, hz);
+	printf("boot %08x: %u blocks, %u Hz\n", (unsigned)blocks[0].boot, (unsigned)n, (unsigned)hz);
+	if (hz == 0) {
+		hz = 1;
+	}
+	if (blocks[0].seq != 0) {
+		printf("  %u earlier blocks overwritten\n", (unsigned)blocks[0].seq);
+	}
+
+	for (i = 0; i < n; i++) {
+		if (i > 0 && blocks[i].seq != blocks[i - 1].seq + 1) {
+			printf("  %u blocks missing\n", (unsigned)(blocks[i].seq - blocks[i - 1].seq - 1));
+			first = true;
+		}
+		SE3_GET16(blocks[i].data, SE3_LOG_BLOCK_OFF_COUNT, count);
+		SE3_GET16(blocks[i].data, SE3_LOG_BLOCK_OFF_DROPPED, dropped);
+		if (count > SE3_LOG_BLOCK_RECORDS) {
+			printf("  block %u: bad record count %u\n", (unsigned)blocks[i].seq, (unsigned)count);
+			continue;
+		}
+		if (dropped > 0) {
+			printf("  %u events dropped\n", (unsigned)dropped);
+			dropped_total += dropped;
+		}
+
+		p = blocks[i].data + SE3_LOG_BLOCK_OFF_RECORDS;
+		for (j = 0; j < count; j++, p += SE3_LOG_RECORD_SIZE) {
+			SE3_GET32(p, SE3_LOG_RECORD_OFF_TIME, t);
+			SE3_GET16(p, SE3_LOG_RECORD_OFF_ID, id);
+			SE3_GET16(p, SE3_LOG_RECORD_OFF_SEQ, seq);
+			SE3_GET32(p, SE3_LOG_RECORD_OFF_ARG0, arg0);
+			SE3_GET32(p, SE3_LOG_RECORD_OFF_ARG1, arg1);
+			if (!first) {
+				time += (uint32_t)(t - last);
+				if (seq != next_seq) {
+					printf("  %u events missing\n", (unsigned)(uint16_t)(seq - next_seq));
+				}
+			}
+			first = false;
+			last = t;
+			next_seq = (uint16_t)(seq + 1);
+			print_event(id, seq, (double)time * 1e6 / hz, arg0, arg1);
+		}
+	}
+	if (dropped_total > 0) {
+		printf("  %u events dropped in total\n", (unsigned)dropped_total);
+	}
+	printf("\n");
+}
+
+int main(int argc, char* argv[])
+{
+	unsigned long first = SE3_LOG_SD_FIRST, count = SE3_LOG_SD_BLOCKS;
+	const char* path = NULL;
+	log_block* blocks = NULL;
+	uint8_t buf[SE3_LOG_BLOCK_SIZE];
+	uint32_t magic, min_index;
+	size_t n = 0, i, j, k;
+	FILE* fp;
+	int a;
+
+	for (a = 1; a < argc; a++) {
+		if (!strcmp(argv[a], "-f") && a + 1 < argc) {
+			first = strtoul(argv[++a], NULL, 0);
+		}
+		else if (!strcmp(argv[a], "-c") && a + 1 < argc) {
+			count = strtoul(argv[++a], NULL, 0);
+		}
+		else if (argv[a][0] != '-' && path == NULL) {
+			path = argv[a];
+		}
+		else {
+			usage();
+			return 1;
+		}
+	}
+	if (path == NULL || count == 0) {
+		usage();
+		return 1;
+	}
+
+	fp = fopen(path, "rb");
+	if (fp == NULL) {
+		perror(path);
+		return 1;
+	}
+	if (fseeko(fp, (off_t)first * SE3_LOG_BLOCK_SIZE, SEEK_SET)) {
+		perror(path);
+		fclose(fp);
+		return 1;
+	}
+	blocks = (log_block*)malloc(count * sizeof(log_block));
+	if (blocks == NULL) {
+		fprintf(stderr, "out of memory\n");
+		fclose(fp);
+		return 1;
+	}
+	for (i = 0; i < count; i++) {
+		if (fread(buf, 1, sizeof(buf), fp) != sizeof(buf)) {
+			break;
+		}
+		SE3_GET32(buf, SE3_LOG_BLOCK_OFF_MAGIC, magic);
+		if (magic != SE3_LOG_MAGIC) {
+			continue;
+		}
+		SE3_GET32(buf, SE3_LOG_BLOCK_OFF_BOOT, blocks[n].boot);
+		SE3_GET32(buf, SE3_LOG_BLOCK_OFF_SEQ, blocks[n].seq);
+		blocks[n].index = (uint32_t)i;
+		memcpy(blocks[n].data, buf, sizeof(buf));
+		n++;
+	}
+	fclose(fp);
+	if (n == 0) {
+		fprintf(stderr, "no log blocks in %lu blocks from %lu\n", (unsigned long)i, first);
+		free(blocks);
+		return 1;
+	}
+
+	// each boot restarts from the first block of the range, so the boots that start further
+	// from it are older: print them first
+	qsort(blocks, n, sizeof(log_block), block_cmp_boot);
+	for (i = 0; i < n; i = j) {
+		min_index = blocks[i].index;
+		for (j = i + 1; j < n && blocks[j].boot == blocks[i].boot; j++) {
+			if (blocks[j].index < min_index) {
+				min_index = blocks[j].index;
+			}
+		}
+		for (k = i; k < j; k++) {
+			blocks[k].index = min_index;
+		}
+	}
+	qsort(blocks, n, sizeof(log_block), block_cmp);
+	for (i = 0; i < n; i = j) {
+		for (j = i + 1; j < n && blocks[j].boot == blocks[i].boot; j++);
+		print_boot(blocks + i, j - i);
+	}
+
+	free(blocks);
+	return 0;
+}
@@ -0,0 +1,307 @@
+/**
+ *  \file se3trace.c
+ *  \brief Time a burst of requests on the host and on the SEcube, and write a Chrome trace
+ *
+ *  \details Usage: se3trace [-p pin [-k key_id]] [-r requests] [-s size] [-n device_index] [output]
+ *  Without a key the requests are L0 echoes of size bytes; with a key, which needs the PIN,
+ *  they are AES-CTR encryptions of size bytes. The output, stdout by default, is in the
+ *  trace_event JSON format read by chrome://tracing and Perfetto: the host and the device are
+ *  two processes, the events of a request are matched by its command token.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "L1.h"
+
+/** Host events kept, enough for the L1 requests of a few megabytes */
+#define HOST_EVENTS (16384)
+
+enum {
+	SRC_HOST = 1,
+	SRC_DEVICE = 2
+};
+
+enum {
+	TID_HOST = 1,
+	TID_DEVICE_MAIN = 1,
+	TID_DEVICE_USB = 2
+};
+
+typedef struct {
+	se3_timeline_event ev;
+	int src;
+} trace_event;
+
+/** Pairs of events written as complete events */
+static const struct {
+	uint8_t begin;
+	uint8_t end;
+	int src;
+	int tid;
+	const char* name;
+} spans[] = {
+	{ SE3_TIMELINE_HOST_SEAL_BEGIN, SE3_TIMELINE_HOST_SEAL_END, SRC_HOST, TID_HOST, "seal" },
+	{ SE3_TIMELINE_HOST_TX_BEGIN, SE3_TIMELINE_HOST_TX_END, SRC_HOST, TID_HOST, "write" },
+	{ SE3_TIMELINE_HOST_RX_BEGIN, SE3_TIMELINE_HOST_RX_END, SRC_HOST, TID_HOST, "read" },
+	{ SE3_TIMELINE_HOST_RX_BEGIN, SE3_TIMELINE_HOST_RX_READY, SRC_HOST, TID_HOST, "poll" },
+	{ SE3_TIMELINE_HOST_OPEN_BEGIN, SE3_TIMELINE_HOST_OPEN_END, SRC_HOST, TID_HOST, "open" },
+	{ SE3_TIMELINE_READY, SE3_TIMELINE_EXEC_BEGIN, SRC_DEVICE, TID_DEVICE_MAIN, "queued" },
+	{ SE3_TIMELINE_EXEC_BEGIN, SE3_TIMELINE_EXEC_END, SRC_DEVICE, TID_DEVICE_MAIN, "exec" },
+	{ SE3_TIMELINE_DECRYPT_BEGIN, SE3_TIMELINE_DECRYPT_END, SRC_DEVICE, TID_DEVICE_MAIN, "decrypt" },
+	{ SE3_TIMELINE_HANDLER_BEGIN, SE3_TIMELINE_HANDLER_END, SRC_DEVICE, TID_DEVICE_MAIN, "handler" },
+	{ SE3_TIMELINE_ENCRYPT_BEGIN, SE3_TIMELINE_ENCRYPT_END, SRC_DEVICE, TID_DEVICE_MAIN, "encrypt" }
+};
+
+static void usage(void)
+{
+	fprintf(stderr,
+		"usage: se3trace [-p pin [-k key_id]] [-r requests] [-s size] [-n device_index] [output]\n");
+}
+
+static int by_time(const void* a, const void* b)
+{
+	uint64_t ta = ((const trace_event*)a)->ev.time, tb = ((const trace_event*)b)->ev.time;
+	return (ta < tb) ? (-1) : ((ta > tb) ? (1) : (0));
+}
+
+/** \brief Latest event of a type of the request before index end, or -1 */
+static long find_begin(const trace_event* events, size_t end, int src, uint8_t type)
+{
+	size_t i;
+	for (i = end; i > 0; i--) {
+		const trace_event* e = events + i - 1;
+		if (e->src == src && e->ev.type == type && e->ev.token == events[end].ev.token)
+			return (long)(i - 1);
+	}
+	return -1;
+}
+
+static void write_event(FILE* fp, bool* first, const char* name, const char* ph, int pid, int tid,
+	uint64_t ts, uint64_t dur, const trace_event* e)
+{
+	fprintf(fp, "%s\n{\"name\":\"%s\",\"ph\":\"%s\",\"pid\":%d,\"tid\":%d,\"ts\":%llu",
+		(*first) ? "" : ",", name, ph, pid, tid, (unsigned long long)ts);
+	if (!strcmp(ph, "X")) {
+		fprintf(fp, ",\"dur\":%llu", (unsigned long long)dur);
+	}
+	else if (!strcmp(ph, "i")) {
+		fprintf(fp, ",\"s\":\"t\"");
+	}
+	else if (!strcmp(ph, "s") || !strcmp(ph, "f")) {
+		fprintf(fp, ",\"cat\":\"request\",\"id\":%lu%s", (unsigned long)e->ev.token, (ph[0] == 'f') ? ",\"bp\":\"e\"" : "");
+	}
+	fprintf(fp, ",\"args\":{\"token\":\"%08lx\",\"arg\":%u}}", (unsigned long)e->ev.token, (unsigned)e->ev.arg);
+	*first = false;
+}
+
+static void write_trace(FILE* fp, trace_event* events, size_t n)
+{
+	bool first = false;
+	size_t i, k;
+	long b;
+
+	qsort(events, n, sizeof(trace_event), by_time);
+	fprintf(fp, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[");
+	fprintf(fp, "\n{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%d,\"args\":{\"name\":\"host\"}},", SRC_HOST);
+	fprintf(fp, "\n{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%d,\"args\":{\"name\":\"SEcube\"}},", SRC_DEVICE);
+	fprintf(fp, "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":%d,\"args\":{\"name\":\"main loop\"}},", SRC_DEVICE, TID_DEVICE_MAIN);
+	fprintf(fp, "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":%d,\"args\":{\"name\":\"USB\"}}", SRC_DEVICE, TID_DEVICE_USB);
+
+	for (i = 0; i < n; i++) {
+		const trace_event* e = events + i;
+		if (e->src == SRC_DEVICE && e->ev.type == SE3_TIMELINE_RECV) {
+			write_event(fp, &first, "recv", "i", SRC_DEVICE, TID_DEVICE_USB, e->ev.time, 0, e);
+		}
+		else if (e->src == SRC_DEVICE && e->ev.type == SE3_TIMELINE_SEND) {
+			write_event(fp, &first, "send", "i", SRC_DEVICE, TID_DEVICE_USB, e->ev.time, 0, e);
+		}
+		else if (e->src == SRC_HOST && e->ev.type == SE3_TIMELINE_HOST_TX_BEGIN) {
+			write_event(fp, &first, "request", "s", SRC_HOST, TID_HOST, e->ev.time, 0, e);
+		}
+		else if (e->src == SRC_DEVICE && e->ev.type == SE3_TIMELINE_EXEC_BEGIN) {
+			write_event(fp, &first, "request", "f", SRC_DEVICE, TID_DEVICE_MAIN, e->ev.time, 0, e);
+		}
+		for (k = 0; k < sizeof(spans) / sizeof(spans[0]); k++) {
+			if (e->src != spans[k].src || e->ev.type != spans[k].end)
+				continue;
+			b = find_begin(events, i, spans[k].src, spans[k].begin);
+			if (b < 0)
+				continue;
+			write_event(fp, &first, spans[k].name, "X", spans[k].src, spans[k].tid,
+				events[b].ev.time, e->ev.time - events[b].ev.time, events + b);
+		}
+	}
+	fprintf(fp, "\n]}\n");
+}
+
+int main(int argc, char* argv[])
+{
+	uint8_t pin[SE3_L1_PIN_SIZE];
+	bool pin_set = false;
+	uint32_t key_id = SE3_KEY_INVALID;
+	long requests = 16, size = 1024, dev_index = 0;
+	const char* path_out = NULL;
+	FILE* fp = stdout;
+	se3_disco_it it;
+	se3_device dev;
+	se3_session session;
+	se3_timeline host;
+	se3_timeline_event* host_events = NULL;
+	se3_timeline_event device_events[SE3_TIMELINE_DEVICE_EVENTS];
+	trace_event* events = NULL;
+	size_t n = 0, i;
+	uint8_t* data = NULL, *out = NULL;
+	size_t out_len;
+	uint16_t count;
+	uint32_t dropped, host_dropped, device_dropped = 0;
+	bool found = false, opened = false, logged_in = false;
+	uint16_t r = SE3_OK;
+	long req;
+	int a, ret = 1;
+
+	memset(pin, 0, sizeof(pin));
+	for (a = 1; a < argc; a++) {
+		if (!strcmp(argv[a], "-p") && a + 1 < argc) {
+			a++;
+			memcpy(pin, argv[a], (strlen(argv[a]) < sizeof(pin)) ? strlen(argv[a]) : sizeof(pin));
+			pin_set = true;
+		}
+		else if (!strcmp(argv[a], "-k") && a + 1 < argc) {
+			key_id = (uint32_t)strtoul(argv[++a], NULL, 0);
+		}
+		else if (!strcmp(argv[a], "-r") && a + 1 < argc) {
+			requests = strtol(argv[++a], NULL, 0);
+		}
+		else if (!strcmp(argv[a], "-s") && a + 1 < argc) {
+			size = strtol(argv[++a], NULL, 0);
+		}
+		else if (!strcmp(argv[a], "-n") && a + 1 < argc) {
+			dev_index = strtol(argv[++a], NULL, 0);
+		}
+		else if (argv[a][0] != '-' && path_out == NULL) {
+			path_out = argv[a];
+		}
+		else {
+			usage();
+			return 1;
+		}
+	}
+	if (requests <= 0 || size <= 0 || (key_id != SE3_KEY_INVALID && !pin_set) ||
+		(key_id == SE3_KEY_INVALID && size > SE3_REQ_MAX_DATA))
+	{
+		usage();
+		return 1;
+	}
+
+	host_events = (se3_timeline_event*)malloc(HOST_EVENTS * sizeof(se3_timeline_event));
+	events = (trace_event*)malloc((HOST_EVENTS + SE3_TIMELINE_DEVICE_EVENTS) * sizeof(trace_event));
+	data = (uint8_t*)calloc((size_t)size, 1);
+	out = (uint8_t*)malloc((size_t)size + 16);
+	if (host_events == NULL || events == NULL || data == NULL || out == NULL) {
+		fprintf(stderr, "se3trace: out of memory\n");
+		goto cleanup;
+	}
+	se3_timeline_init(&host, host_events, HOST_EVENTS);
+
+	L0_discover_init(&it);
+	while (L0_discover_next(&it)) {
+		if (dev_index-- == 0) {
+			found = true;
+			break;
+		}
+	}
+	if (!found) {
+		fprintf(stderr, "se3trace: device not found\n");
+		goto cleanup;
+	}
+	r = L0_open(&dev, &it.device_info, 1000);
+	if (SE3_OK != r) {
+		fprintf(stderr, "se3trace: cannot open device (%04x)\n", r);
+		goto cleanup;
+	}
+	opened = true;
+
+	L0_timeline_attach(&dev, &host);
+	if (pin_set) {
+		r = L1_login(&session, &dev, pin, SE3_ACCESS_USER);
+		if (SE3_OK != r) {
+			fprintf(stderr, "se3trace: login failed (%04x)\n", r);
+			goto cleanup;
+		}
+		logged_in = true;
+	}
+
+	// forget the login and the requests of other programs
+	se3_timeline_take(&host, NULL, HOST_EVENTS, NULL);
+	do {
+		r = L0_timeline_read(&dev, device_events, SE3_TIMELINE_DEVICE_EVENTS, &count, &dropped);
+	} while (SE3_OK == r && count == SE3_TIMELINE_DEVICE_EVENTS);
+	if (SE3_OK != r) {
+		fprintf(stderr, "se3trace: the device does not record its requests (%04x)\n", r);
+		goto cleanup;
+	}
+	se3_timeline_take(&host, NULL, HOST_EVENTS, NULL);
+
+	for (req = 0; req < requests; req++) {
+		if (key_id != SE3_KEY_INVALID) {
+			r = L1_encrypt(&session, SE3_ALGO_AES, SE3_FEEDBACK_CTR | SE3_DIR_ENCRYPT, key_id,
+				(size_t)size, data, &out_len, out);
+		}
+		else {
+			r = L0_echo(&dev, data, (uint16_t)size, out);
+		}
+		if (SE3_OK != r) {
+			fprintf(stderr, "se3trace: request %ld failed (%04x)\n", req, r);
+			goto cleanup;
+		}
+	}
+	L0_timeline_attach(&dev, NULL);
+	if (logged_in) {
+		L0_timeline_attach(&(session.device), NULL);
+	}
+
+	n = se3_timeline_take(&host, host_events, HOST_EVENTS, &host_dropped);
+	for (i = 0; i < n; i++) {
+		events[i].ev = host_events[i];
+		events[i].src = SRC_HOST;
+	}
+	// one read returns the whole ring of the device
+	r = L0_timeline_read(&dev, device_events, SE3_TIMELINE_DEVICE_EVENTS, &count, &device_dropped);
+	if (SE3_OK != r) {
+		fprintf(stderr, "se3trace: cannot read the device events (%04x)\n", r);
+		goto cleanup;
+	}
+	for (i = 0; i < count; i++) {
+		events[n].ev = device_events[i];
+		events[n].src = SRC_DEVICE;
+		n++;
+	}
+
+	if (path_out != NULL && (fp = fopen(path_out, "w")) == NULL) {
+		perror(path_out);
+		fp = stdout;
+		goto cleanup;
+	}
+	write_trace(fp, events, n);
+	fprintf(stderr, "%ld requests, %u host and %u device events, %lu and %lu lost\n",
+		requests, (unsigned)(n - count), (unsigned)count, (unsigned long)host_dropped, (unsigned long)device_dropped);
+	ret = 0;
+
+cleanup:
+	memset(pin, 0, sizeof(pin));
+	if (fp != stdout) {
+		fclose(fp);
+	}
+	if (logged_in) {
+		L1_logout(&session);
+	}
+	if (opened) {
+		L0_close(&dev);
+	}
+	free(host_events);
+	free(events);
+	free(data);
+	free(out);
+	return ret;
+}
@@ -0,0 +1,135 @@
+/**
+ *  \file bench.cpp
+ *  \brief Compare the C++ interface with the C API it wraps
+ *
+ *  \details Usage: bench [pin [size_kb [runs]]]
+ *  The same operations are timed through L1 and through secube.hpp on the first device
+ *  found, alternating the two so that both see the same device conditions; key 550 is
+ *  overwritten.
+ */
+
+#include "secube.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <functional>
+
+using namespace secube;
+
+enum {
+	KEY_ID = 550
+};
+
+static double seconds(const std::function<void()>& f)
+{
+	auto t0 = std::chrono::steady_clock::now();
+	f();
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+}
+
+static void report(const char* name, double c_time, double cpp_time, size_t bytes)
+{
+	std::printf("%-16s C %8.2f MB/s   C++ %8.2f MB/s   overhead %+.2f%%\n", name,
+		bytes / c_time / 1e6, bytes / cpp_time / 1e6, 100.0 * (cpp_time - c_time) / c_time);
+}
+
+int main(int argc, char* argv[])
+{
+	const char* pin = (argc > 1) ? argv[1] : "test";
+	size_t size = ((argc > 2) ? std::strtoul(argv[2], nullptr, 0) : 1024) * 1024;
+	int runs = (argc > 3) ? std::atoi(argv[3]) : 10;
+	uint16_t mode = SE3_FEEDBACK_CTR | SE3_DIR_ENCRYPT;
+
+	try {
+		Device dev;
+		Session session(dev, pin);
+		session.set_time((uint32_t)time(0));
+
+		uint8_t key_data[32];
+		se3c_rand(sizeof(key_data), key_data);
+		se3_key key = { KEY_ID, (uint32_t)time(0) + 3600, sizeof(key_data), 6, { 0 }, key_data, "tbench" };
+		session.key_edit(SE3_KEY_OP_UPSERT, key);
+
+		std::vector<uint8_t> in(size), out_c(size), out_cpp(size);
+		se3c_rand(size, in.data());
+		se3_session* s = session.get();
+		double c_time = 0, cpp_time = 0;
+		size_t len = 0;
+
+		// whole messages
+		for (int i = 0; i < runs; i++) {
+			c_time += seconds([&] {
+				check(L1_encrypt(s, SE3_ALGO_AES, mode, KEY_ID, size, in.data(), &len, out_c.data()));
+			});
+			cpp_time += seconds([&] {
+				session.encrypt(SE3_ALGO_AES, mode, KEY_ID, in, out_cpp);
+			});
+		}
+		if (out_c != out_cpp)
+			throw std::runtime_error("encrypt: outputs differ");
+		report("encrypt", c_time, cpp_time, size * runs);
+		double encrypt_time = c_time;
+
+		// one request at a time
+		c_time = cpp_time = 0;
+		for (int i = 0; i < runs; i++) {
+			c_time += seconds([&] {
+				uint32_t id = 0;
+				uint16_t curr = 0;
+				check(L1_crypto_init(s, SE3_ALGO_AES, mode, KEY_ID, &id));
+				for (size_t off = 0; off < size; off += SE3_CRYPTO_MAX_DATAIN) {
+					size_t n = (size - off < SE3_CRYPTO_MAX_DATAIN) ? size - off : SE3_CRYPTO_MAX_DATAIN;
+					uint16_t flags = (off + n == size) ? SE3_CRYPTO_FLAG_FINIT : 0;
+					check(L1_crypto_update(s, id, flags, 0, NULL, (uint16_t)n, in.data() + off, &curr, out_c.data() + off));
+				}
+			});
+			cpp_time += seconds([&] {
+				CryptoSession cs = session.crypto(SE3_ALGO_AES, mode, KEY_ID);
+				bytes_in src(in);
+				bytes_out dst(out_cpp);
+				for (size_t off = 0; off < size; off += SE3_CRYPTO_MAX_DATAIN) {
+					size_t n = (size - off < SE3_CRYPTO_MAX_DATAIN) ? size - off : SE3_CRYPTO_MAX_DATAIN;
+					uint16_t flags = (off + n == size) ? SE3_CRYPTO_FLAG_FINIT : 0;
+					cs.update(flags, {}, src.subspan(off, n), dst.subspan(off));
+				}
+			});
+		}
+		if (out_c != out_cpp)
+			throw std::runtime_error("crypto_update: outputs differ");
+		report("crypto_update", c_time, cpp_time, size * runs);
+
+		// digests
+		c_time = cpp_time = 0;
+		Digest d_c, d_cpp;
+		for (int i = 0; i < runs; i++) {
+			c_time += seconds([&] {
+				check(L1_digest(s, SE3_ALGO_SHA256, size, in.data(), &len, d_c.data()));
+			});
+			cpp_time += seconds([&] {
+				d_cpp = session.digest(SE3_ALGO_SHA256, in);
+			});
+		}
+		if (d_c != d_cpp)
+			throw std::runtime_error("digest: outputs differ");
+		report("digest", c_time, cpp_time, size * runs);
+
+		// the asynchronous call adds the start of a thread to the same L1_encrypt
+		cpp_time = 0;
+		for (int i = 0; i < runs; i++) {
+			cpp_time += seconds([&] {
+				session.encrypt_async(SE3_ALGO_AES, mode, KEY_ID, in, out_cpp).get();
+			});
+		}
+		if (out_c != out_cpp)
+			throw std::runtime_error("encrypt_async: outputs differ");
+		report("encrypt_async", encrypt_time, cpp_time, size * runs);
+	}
+	catch (const std::exception& e) {
+		std::fprintf(stderr, "bench: %s\n", e.what());
+		return 1;
+	}
+	return 0;
+}
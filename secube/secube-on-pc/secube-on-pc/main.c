@@ -3,6 +3,10 @@
 #include "stubs.h"
 #include "device_main.h"
 #include "L1.h"
+#include "se3_bench.h"
+#include "se3_flash.h"
+#include "se3_log.h"
+#include "replay.h"
 
 #include <assert.h>
 
@@ -330,6 +334,412 @@ uint16_t test_keys(se3_device *dev)
 	return return_value;
 }
 
+/* Key store operations at 5k keys, spanning several flash sectors. The keys are deleted at the end */
+uint16_t test_keystore(se3_device *dev)
+{
+	enum {
+		NKEYS = 5000,
+		KEY_ID_BASE = 0x10000
+	};
+	uint16_t return_value = SE3_OK;
+	se3_session s;
+	se3_key k, info;
+	uint8_t data[32];
+	uint64_t t;
+	int i;
+
+	return_value = L1_login(&s, dev, USER_PIN, SE3_ACCESS_USER);
+	assert(!return_value);
+	memcpy(data, test_key, 32);
+	k.data = data;
+	k.data_size = 32;
+	k.validity = (uint32_t)time(0) + 365 * 24 * 60;
+
+	t = se3c_clock();
+	for (i = 0; i < NKEYS; i++) {
+		k.id = KEY_ID_BASE + i;
+		k.name_size = sprintf(k.name, "key%d", i);
+		(*((uint32_t*)k.data))++;
+		return_value = L1_key_edit(&s, SE3_KEY_OP_INSERT, &k);
+		assert(!return_value);
+	}
+	t = se3c_clock() - t;
+	printf("KEY INSERT %.3f ms\n", (double)t / NKEYS);
+
+	t = se3c_clock();
+	for (i = 0; i < NKEYS; i++) {
+		return_value = L1_key_get_info(&s, KEY_ID_BASE + (i * 7919) % NKEYS, NULL, &info);
+		assert(!return_value);
+	}
+	t = se3c_clock() - t;
+	printf("KEY LOOKUP %.3f ms\n", (double)t / NKEYS);
+
+	t = se3c_clock();
+	for (i = 0; i < NKEYS; i++) {
+		k.id = KEY_ID_BASE + i;
+		return_value = L1_key_edit(&s, SE3_KEY_OP_DELETE, &k);
+		assert(!return_value);
+	}
+	t = se3c_clock() - t;
+	printf("KEY DELETE %.3f ms\n", (double)t / NKEYS);
+
+	return_value = L1_logout(&s);
+	assert(!return_value);
+	return return_value;
+}
+
+enum {
+	FLASH_TEST_TYPE = 0x80,
+	FLASH_TEST_NODE_MAX = 100
+};
+
+/* Nodes of the flash tests: one block, or two every third node */
+static uint16_t flash_test_size(uint32_t i)
+{
+	return (i % 3 == 2) ? (FLASH_TEST_NODE_MAX) : (40);
+}
+
+static void flash_test_data(uint32_t i, uint8_t* data)
+{
+	uint16_t j;
+	SE3_SET32(data, 0, i);
+	for (j = 4; j < FLASH_TEST_NODE_MAX; j++) {
+		data[j] = (uint8_t)(i + j);
+	}
+}
+
+static bool flash_test_new(uint32_t i, size_t* pos)
+{
+	se3_flash_it it;
+	uint8_t data[FLASH_TEST_NODE_MAX];
+
+	flash_test_data(i, data);
+	if (!se3_flash_it_new(&it, FLASH_TEST_TYPE, flash_test_size(i))) {
+		return false;
+	}
+	*pos = it.pos;
+	return se3_flash_it_write(&it, 0, data, flash_test_size(i));
+}
+
+/* Fill the log, deleting every other node, until only the sector reserved to the collection is
+   free; returns the number of nodes written */
+static uint32_t flash_test_fill()
+{
+	uint32_t n = 0;
+	size_t pos;
+	bool success;
+
+	sim_clear_flash();
+	success = se3_flash_init();
+	assert(success);
+	while (se3_flash_compact_step());
+	while (se3_flash_allocated() < 4 * (SE3_FLASH_INDEX_SIZE - 1) * SE3_FLASH_BLOCK_SIZE) {
+		success = flash_test_new(n, &pos);
+		assert(success);
+		if (n % 2) {
+			success = se3_flash_pos_delete(pos);
+			assert(success);
+		}
+		n++;
+	}
+	return n;
+}
+
+/* Every even node below n, and every node from n to n + extra, is found once and intact */
+static bool flash_test_check(uint32_t n, uint32_t extra)
+{
+	se3_flash_it it;
+	uint8_t data[FLASH_TEST_NODE_MAX];
+	uint8_t* count = (uint8_t*)calloc(n + extra, 1);
+	uint32_t i;
+	bool success = true;
+
+	se3_flash_it_init(&it);
+	while (success && se3_flash_it_next(&it)) {
+		if (it.type != FLASH_TEST_TYPE) continue;
+		SE3_GET32(it.addr, 0, i);
+		flash_test_data(i, data);
+		success = (i < n + extra && it.size == flash_test_size(i) && !memcmp(it.addr, data, it.size));
+		if (success) {
+			count[i]++;
+		}
+	}
+	for (i = 0; success && i < n + extra; i++) {
+		success = (count[i] == ((i >= n || i % 2 == 0) ? 1 : 0));
+	}
+	free(count);
+	return success;
+}
+
+/* Garbage collection interrupted by a reset before each flash programming operation of its first
+   moves: after se3_flash_init each live node must be found once, and new nodes must be written to
+   erased flash. Runs on the flash alone, before the device is started. */
+uint16_t test_flash_reset()
+{
+	enum {
+		STEPS = 5,  // start of the collection, then moves of nodes of one and two blocks
+		EXTRA = 3,
+		FLASH_SIZE = SE3_FLASH_SECTORS * SE3_FLASH_SECTOR_SIZE
+	};
+	uint8_t* snapshot = (uint8_t*)malloc(FLASH_SIZE);
+	uint32_t n, i;
+	size_t pos, programs, budget;
+	bool success;
+
+	n = flash_test_fill();
+	memcpy(snapshot, stub_flash, FLASH_SIZE);
+
+	success = se3_flash_init();
+	assert(success);
+	programs = sim_flash_programs;
+	for (i = 0; i < STEPS; i++) {
+		success = se3_flash_compact_step();
+		assert(success);
+	}
+	programs = sim_flash_programs - programs;
+
+	for (budget = 0; budget <= programs; budget++) {
+		memcpy(stub_flash, snapshot, FLASH_SIZE);
+		success = se3_flash_init();
+		assert(success);
+		sim_flash_budget = budget;
+		for (i = 0; i < STEPS; i++) {
+			se3_flash_compact_step();
+		}
+		sim_flash_budget = SIM_FLASH_UNLIMITED;
+		hwerror = false;
+
+		// reset
+		success = se3_flash_init() && flash_test_check(n, 0);
+		for (i = 0; success && i < EXTRA; i++) {
+			success = flash_test_new(n + i, &pos);
+		}
+		if (!success || !flash_test_check(n, EXTRA)) {
+			printf("FLASH RESET after %u of %u operations: FAIL\n", (unsigned)budget, (unsigned)programs);
+			free(snapshot);
+			return SE3_ERR_HW;
+		}
+	}
+	printf("FLASH RESET %u resets\n", (unsigned)programs + 1);
+	free(snapshot);
+	return SE3_OK;
+}
+
+/* Garbage collection interrupted by a reset before each flash programming operation after its
+   last move, while the collected sector is erased and formatted: after se3_flash_init each live
+   node must be found once, and new nodes must be written to erased flash. Runs on the flash
+   alone, before the device is started. */
+uint16_t test_flash_reset_erase()
+{
+	enum {
+		EXTRA = 3,
+		FLASH_SIZE = SE3_FLASH_SECTORS * SE3_FLASH_SECTOR_SIZE
+	};
+	uint8_t* snapshot = (uint8_t*)malloc(FLASH_SIZE);
+	uint32_t n, i, erases;
+	size_t pos, programs, budget;
+	bool success;
+
+	n = flash_test_fill();
+	success = se3_flash_init();
+	assert(success);
+	// the collection is complete, its sector is erased by the next step
+	while (flash.swaps == 0) {
+		success = se3_flash_compact_step();
+		assert(success);
+	}
+	memcpy(snapshot, stub_flash, FLASH_SIZE);
+
+	success = se3_flash_init();
+	assert(success);
+	programs = sim_flash_programs;
+	while (se3_flash_compact_step());
+	programs = sim_flash_programs - programs;
+	erases = flash.erases;
+	assert(erases > 0);
+
+	for (budget = 0; budget <= programs; budget++) {
+		memcpy(stub_flash, snapshot, FLASH_SIZE);
+		success = se3_flash_init();
+		assert(success);
+		sim_flash_budget = budget;
+		while (se3_flash_compact_step());
+		sim_flash_budget = SIM_FLASH_UNLIMITED;
+		hwerror = false;
+
+		// reset, then complete the compaction
+		success = se3_flash_init() && flash_test_check(n, 0);
+		while (success && se3_flash_compact_step());
+		for (i = 0; success && i < EXTRA; i++) {
+			success = flash_test_new(n + i, &pos);
+		}
+		if (!success || !flash_test_check(n, EXTRA)) {
+			printf("FLASH RESET ERASE after %u of %u operations: FAIL\n", (unsigned)budget, (unsigned)programs);
+			free(snapshot);
+			return SE3_ERR_HW;
+		}
+	}
+	printf("FLASH RESET ERASE %u resets, %u sectors erased\n", (unsigned)programs + 1, (unsigned)erases);
+	free(snapshot);
+	return SE3_OK;
+}
+
+#ifdef SE3_LOG_SD
+/* Event k of test_log_ring, after the boot event: arg0 is its number within the phase */
+static bool log_test_record(const uint8_t* p, uint16_t seq, uint32_t phase_start, uint32_t phase)
+{
+	uint16_t id, u16tmp;
+	uint32_t arg0, arg1;
+
+	SE3_GET16(p, SE3_LOG_RECORD_OFF_ID, id);
+	SE3_GET16(p, SE3_LOG_RECORD_OFF_SEQ, u16tmp);
+	SE3_GET32(p, SE3_LOG_RECORD_OFF_ARG0, arg0);
+	SE3_GET32(p, SE3_LOG_RECORD_OFF_ARG1, arg1);
+	if (u16tmp != seq) {
+		return false;
+	}
+	if (seq == 0) {
+		return (id == SE3_LOG_BOOT);
+	}
+	return (id == SE3_LOG_USER && arg0 == seq - phase_start && arg1 == phase);
+}
+
+/* Events recorded past a full ring are dropped and counted, and the ring wraps around without
+   losing or reordering the accepted ones; with a failed RNG the boot ID still changes. Runs on
+   the log alone, before the device is started. */
+uint16_t test_log_ring()
+{
+	enum {
+		RING = 256,  // SE3_LOG_RING in se3_log.c
+		BATCH_EVENTS = 4 * SE3_LOG_BLOCK_RECORDS,
+		PHASE1 = RING + 44,  // after the boot event: RING - 1 accepted
+		PHASE2 = 2 * BATCH_EVENTS + 1,  // after two batches: 2 * BATCH_EVENTS accepted
+		EVENTS = RING + 2 * BATCH_EVENTS,
+		DROPPED = (PHASE1 - (RING - 1)) + 1
+	};
+	const uint8_t* block;
+	const uint8_t* p;
+	uint32_t magic, boot = 0, seq, dropped = 0, events = 0, i, phase_start;
+	uint16_t count, u16tmp, j;
+	bool success = true;
+
+	memset(sim_sd_log, 0, SE3_LOG_SD_BLOCKS * SE3_LOG_BLOCK_SIZE);
+	se3_log_init();
+	for (i = 0; i < PHASE1; i++) {
+		se3_log_event(SE3_LOG_USER, i, 1);
+	}
+	// full batches are written at once, the remaining events wait
+	se3_log_idle();
+	se3_log_idle();
+	for (i = 0; i < PHASE2; i++) {
+		se3_log_event(SE3_LOG_USER, i, 2);
+	}
+	se3_log_idle();
+	se3_log_idle();
+	// the oldest event has waited for a second
+	Sleep(1100);
+	se3_log_idle();
+
+	for (seq = 0; success; seq++) {
+		block = sim_sd_log + seq * SE3_LOG_BLOCK_SIZE;
+		SE3_GET32(block, SE3_LOG_BLOCK_OFF_MAGIC, magic);
+		if (magic != SE3_LOG_MAGIC) {
+			break;
+		}
+		SE3_GET32(block, SE3_LOG_BLOCK_OFF_BOOT, i);
+		if (seq == 0) {
+			boot = i;
+		}
+		success = (i == boot);
+		SE3_GET32(block, SE3_LOG_BLOCK_OFF_SEQ, i);
+		success = success && (i == seq);
+		SE3_GET16(block, SE3_LOG_BLOCK_OFF_DROPPED, u16tmp);
+		dropped += u16tmp;
+		SE3_GET16(block, SE3_LOG_BLOCK_OFF_COUNT, count);
+		p = block + SE3_LOG_BLOCK_OFF_RECORDS;
+		for (j = 0; success && j < count; j++, events++, p += SE3_LOG_RECORD_SIZE) {
+			phase_start = (events < RING) ? (1) : (RING);
+			success = log_test_record(p, (uint16_t)events, phase_start, (events < RING) ? (1) : (2));
+		}
+	}
+	if (!success || events != EVENTS || dropped != DROPPED) {
+		printf("LOG RING %u events, %u dropped: FAIL\n", (unsigned)events, (unsigned)dropped);
+		return SE3_ERR_HW;
+	}
+
+	// the next boot overwrites the first block with another ID
+	sim_rand_fail = true;
+	se3_log_init();
+	sim_rand_fail = false;
+	Sleep(1100);
+	se3_log_idle();
+	SE3_GET32(sim_sd_log, SE3_LOG_BLOCK_OFF_BOOT, i);
+	if (i == boot) {
+		printf("LOG RING boot ID without RNG: FAIL\n");
+		return SE3_ERR_HW;
+	}
+	printf("LOG RING %u events in %u blocks, %u dropped\n", (unsigned)events, (unsigned)seq, (unsigned)dropped);
+	return SE3_OK;
+}
+#endif
+
+/* Cycles per byte of the crypto kernels, each checked against the reference implementation */
+uint16_t test_bench()
+{
+	se3_bench_result results[SE3_BENCH_AES_COUNT];
+	se3_bench_result results_aead[SE3_BENCH_AEAD_COUNT];
+	se3_bench_result results_mac[SE3_BENCH_MAC_COUNT];
+	se3_bench_result results_rand[SE3_BENCH_RAND_COUNT];
+	bool ok;
+	size_t i;
+
+	ok = se3_bench_aes(results);
+	for (i = 0; i < SE3_BENCH_AES_COUNT; i++) {
+		printf("%s %.2f cycles/byte%s\n", results[i].name, (double)results[i].cycles / results[i].bytes,
+			results[i].ok ? "" : " MISMATCH");
+	}
+	ok = se3_bench_aead(results_aead) && ok;
+	for (i = 0; i < SE3_BENCH_AEAD_COUNT; i++) {
+		printf("%s %.2f cycles/byte%s\n", results_aead[i].name, (double)results_aead[i].cycles / results_aead[i].bytes,
+			results_aead[i].ok ? "" : " MISMATCH");
+	}
+	ok = se3_bench_mac(results_mac) && ok;
+	for (i = 0; i < SE3_BENCH_MAC_COUNT; i++) {
+		printf("%s %.2f cycles/byte%s\n", results_mac[i].name, (double)results_mac[i].cycles / results_mac[i].bytes,
+			results_mac[i].ok ? "" : " MISMATCH");
+	}
+	ok = se3_bench_rand(results_rand) && ok;
+	for (i = 0; i < SE3_BENCH_RAND_COUNT; i++) {
+		printf("%s %u cycles%s\n", results_rand[i].name, (unsigned)results_rand[i].cycles,
+			results_rand[i].ok ? "" : " FAILED");
+	}
+	return ok ? SE3_OK : SE3_ERR_HW;
+}
+
+/* Login latency with the key store filled by test_keys: the PIN records are read from RAM */
+uint16_t test_login_latency(se3_device *dev)
+{
+	enum {
+		NLOGIN = 100
+	};
+	uint16_t return_value = SE3_OK;
+	se3_session s;
+	uint64_t t;
+	int i;
+
+	t = se3c_clock();
+	for (i = 0; i < NLOGIN; i++) {
+		return_value = L1_login(&s, dev, USER_PIN, SE3_ACCESS_USER);
+		assert(!return_value);
+		return_value = L1_logout(&s);
+		assert(!return_value);
+	}
+	t = se3c_clock() - t;
+	printf("LOGIN %.3f ms\n", (double)t / NLOGIN);
+
+	return return_value;
+}
+
 uint16_t test_crypt(se3_device *dev)
 {
 	int32_t return_value = SE3_OK;
@@ -404,6 +814,29 @@ uint16_t test_crypt(se3_device *dev)
 	return return_value;
 }
 
+/* Traffic of test_crypt captured and replayed on the simulator: the responses must match the
+   capture, and the times the baseline written by the first replay */
+uint16_t test_replay(se3_device *dev)
+{
+	char* write_baseline[] = { "replay", "-s", "-w", "replay.txt", "replay.se3r" };
+	char* compare[] = { "replay", "-s", "-b", "replay.txt", "-t", "1000", "-m", "1", "replay.se3r" };
+	uint16_t return_value;
+	bool success;
+	int r;
+
+	success = se3_capture_open("replay.se3r");
+	assert(success);
+	return_value = test_crypt(dev);
+	se3_capture_close();
+	assert(!return_value);
+
+	r = replay_main(sizeof(write_baseline) / sizeof(write_baseline[0]), write_baseline);
+	assert(r == 0);
+	r = replay_main(sizeof(compare) / sizeof(compare[0]), compare);
+	assert(r == 0);
+	return (r == 0) ? (SE3_OK) : (SE3_ERR_COMM);
+}
+
 #define BUFFER_SIZE 16
 
 uint16_t test_session(se3_device *dev)
@@ -651,13 +1084,25 @@ void main_tests()
 
 	return_value = test_login(&dev);
 	assert(!return_value);
+
+	return_value = test_bench();
+	assert(!return_value);
 	
+	return_value = test_keystore(&dev);
+	assert(!return_value);
+
 	return_value = test_keys(&dev);
 	assert(!return_value);
 
+	return_value = test_login_latency(&dev);
+	assert(!return_value);
+
 	return_value = test_crypt(&dev);
 	assert(!return_value);
 
+	return_value = test_replay(&dev);
+	assert(!return_value);
+
 	return_value = test_session(&dev);
 	assert(!return_value);
 	
@@ -671,9 +1116,25 @@ void main_tests()
 	assert(!return_value);
 }
 
-int main()
+int main(int argc, char* argv[])
 {
+	uint16_t return_value;
+
     sim_init();
+	// replay against the key store left in flash.bin by earlier runs
+	if (argc > 1 && !strcmp(argv[1], "replay")) {
+		sim_start();
+		return replay_main(argc - 1, argv + 1);
+	}
+	// flash tests, before the device uses the flash
+	return_value = test_flash_reset();
+	assert(!return_value);
+	return_value = test_flash_reset_erase();
+	assert(!return_value);
+#ifdef SE3_LOG_SD
+	return_value = test_log_ring();
+	assert(!return_value);
+#endif
     sim_clear_flash();
 	sim_start();
 
@@ -0,0 +1,540 @@
+#include <Windows.h>
+#include "stubs.h"
+#include "replay.h"
+#include "L0.h"
+#include "se3_capture.h"
+#include "se3_communication_core.h"
+#include "se3_dispatcher_core.h"
+
+#pragma warning(disable:4996)
+
+enum {
+	REPLAY_LABEL_SIZE = 32,
+	REPLAY_BASE_BLOCK = 101,  ///< first block of the simulated device, as in L0_open_sim
+	REPLAY_TIMEOUT_US = 10000000,
+	REPLAY_MIN_COUNT = 10
+};
+
+/** \brief A request of the capture */
+typedef struct {
+	const uint8_t* rec;  ///< write record
+	const uint8_t* resp;  ///< read record of the ready response, NULL if none
+	const uint8_t* session;  ///< session record to install before it, NULL if none
+	uint16_t cmd;  ///< L0 command
+	uint16_t flags;  ///< L0 command flags
+	const uint8_t* key;  ///< L1 payload key
+	const uint8_t* next_key;  ///< key of the session recorded after the request, NULL if none
+	bool login;  ///< L1 login, which fails on replay: the challenge of the device is random
+	uint32_t captured_us;  ///< request written to response read, in the capture
+	uint16_t captured_status;  ///< L1 status for L1 requests, else L0 status
+	char label[REPLAY_LABEL_SIZE];
+} replay_request;
+
+/** \brief Times of one command */
+typedef struct {
+	char label[REPLAY_LABEL_SIZE];
+	uint32_t* times;
+	size_t count;
+	size_t mismatches;  ///< responses with a status different from the capture, logins excluded
+	double captured_total;
+	bool in_baseline;
+	double baseline_p50;
+} replay_command;
+
+static const char* cmd0_names[] = {
+	NULL, "factory_init", "echo", "l1", "boot_mode_reset", "stats", "timeline"
+};
+
+static const char* cmd1_names[] = {
+	NULL, "challenge", "login", "logout", "config", "key_edit", "key_list", "crypto_init",
+	"crypto_update", "crypto_list", "crypto_set_time", "key_import_batch", "key_get_info"
+};
+
+static void usage(void)
+{
+	fprintf(stderr, "usage: replay [-p] [-s] [-b baseline] [-w baseline_out] [-t percent] [-m min_count] capture\n");
+}
+
+static uint32_t rec_len(const uint8_t* rec)
+{
+	uint32_t len;
+	SE3_GET32(rec, SE3_CAPTURE_REC_OFF_LEN, len);
+	return len;
+}
+
+/** \brief Payload of a request or of a response spread over blocks
+ *  \return payload size, 0 if the blocks do not hold all of it
+ */
+static uint16_t replay_payload(const uint8_t* blocks, size_t nblocks, bool request, uint8_t* payload)
+{
+	uint16_t hdr0 = (request) ? (SE3_REQ_SIZE_HEADER) : (SE3_RESP_SIZE_HEADER);
+	uint16_t hdr = (request) ? (SE3_REQDATA_SIZE_HEADER) : (SE3_RESPDATA_SIZE_HEADER);
+	uint16_t off_len = (request) ? (SE3_REQ_OFFSET_LEN) : (SE3_RESP_OFFSET_LEN);
+	uint16_t len_data_and_headers, len, n, off = 0;
+	size_t i;
+
+	SE3_GET16(blocks, off_len, len_data_and_headers);
+	len = (request) ? (se3_req_len_data(len_data_and_headers)) : (se3_resp_len_data(len_data_and_headers));
+	if (se3_nblocks(len_data_and_headers) > nblocks) {
+		return 0;
+	}
+	for (i = 0; off < len; i++) {
+		n = SE3_COMM_BLOCK - ((i == 0) ? (hdr0) : (hdr));
+		if (n > len - off) {
+			n = len - off;
+		}
+		memcpy(payload + off, blocks + i * SE3_COMM_BLOCK + ((i == 0) ? (hdr0) : (hdr)), n);
+		off += n;
+	}
+	return len;
+}
+
+/** \brief Decrypt an L1 payload in place, as L1_TXRX does */
+static bool replay_open(uint8_t* payload, uint16_t len, uint16_t flags, const uint8_t* key)
+{
+	se3_payload_cryptoctx ctx;
+
+	if (len < SE3_REQ1_OFFSET_DATA) {
+		return false;
+	}
+	se3_payload_cryptoinit(&ctx, key);
+	return se3_payload_open(&ctx, payload + SE3_REQ1_OFFSET_AUTH, payload + SE3_REQ1_OFFSET_IV,
+		payload + SE3_L1_AUTH_SIZE + SE3_L1_IV_SIZE, (len - SE3_L1_AUTH_SIZE - SE3_L1_IV_SIZE) / SE3_L1_CRYPTOBLOCK_SIZE, flags);
+}
+
+/** \brief Status of a response: the L1 one if it can be decrypted, else the L0 one */
+static uint16_t replay_status(const uint8_t* blocks, size_t nblocks, const replay_request* r, uint8_t* payload)
+{
+	uint16_t status, len;
+
+	SE3_GET16(blocks, SE3_RESP_OFFSET_STATUS, status);
+	if (status != SE3_OK || r->key == NULL) {
+		return status;
+	}
+	len = replay_payload(blocks, nblocks, false, payload);
+	if (!replay_open(payload, len, r->flags, r->key)) {
+		return SE3_ERR_COMM;
+	}
+	SE3_GET16(payload, SE3_RESP1_OFFSET_STATUS, status);
+	return status;
+}
+
+static void replay_name(char* label, unsigned level, uint16_t cmd)
+{
+	const char* name = NULL;
+
+	if (level == 0 && cmd < sizeof(cmd0_names) / sizeof(cmd0_names[0])) {
+		name = cmd0_names[cmd];
+	}
+	else if (level == 1 && cmd < sizeof(cmd1_names) / sizeof(cmd1_names[0])) {
+		name = cmd1_names[cmd];
+	}
+	if (name != NULL) {
+		sprintf(label, "l%u.%s", level, name);
+	}
+	else {
+		sprintf(label, "l%u.%u", level, (unsigned)cmd);
+	}
+}
+
+/** \brief Name an L1 request, with the key of the session in force, of the one that it opens (login) or the magic one */
+static void replay_name_l1(replay_request* r, uint8_t* payload)
+{
+	const uint8_t* keys[3];
+	uint16_t nblocks, len, cmd;
+	size_t i;
+
+	// the challenge of a new login is sent with the magic key
+	keys[0] = r->key;
+	keys[1] = r->next_key;
+	keys[2] = se3_magic;
+	r->key = NULL;
+	SE3_GET16(r->rec, SE3_CAPTURE_REC_OFF_NBLOCKS, nblocks);
+	for (i = 0; i < 3 && r->key == NULL; i++) {
+		len = replay_payload(r->rec + SE3_CAPTURE_REC_SIZE, nblocks, true, payload);
+		if (keys[i] != NULL && replay_open(payload, len, r->flags, keys[i])) {
+			r->key = keys[i];
+		}
+	}
+	if (r->key == NULL) {
+		strcpy(r->label, "l1.unknown");
+		return;
+	}
+	SE3_GET16(payload, SE3_REQ1_OFFSET_CMD, cmd);
+	replay_name(r->label, 1, cmd);
+	r->login = (cmd == SE3_CMD1_LOGIN);
+}
+
+/** \brief Split the capture in requests, naming each one and timing it as captured
+ *
+ *  The requests are collected in one pass; the key of a login is known only at the session record
+ *  that follows it, so the requests are named and their statuses decoded at the end.
+ *  \return number of requests, or -1 if the capture is not valid
+ */
+static long replay_parse(const uint8_t* cap, size_t size, replay_request* requests, uint8_t* payload)
+{
+	const uint8_t* p = cap + SE3_CAPTURE_HEADER_SIZE;
+	const uint8_t* key = se3_magic;  // key of the session in force, the magic one before a login
+	const uint8_t* pending = NULL;  // session record not yet installed
+	replay_request* r = NULL;
+	long n = 0, unresolved = 0, k;
+	uint64_t time, t;
+	uint32_t duration;
+	uint16_t nblocks, u16tmp;
+
+	while (p + SE3_CAPTURE_REC_SIZE <= cap + size) {
+		if (p + SE3_CAPTURE_REC_SIZE + rec_len(p) > cap + size) {
+			return -1;
+		}
+		SE3_GET64(p, SE3_CAPTURE_REC_OFF_TIME, time);
+		SE3_GET32(p, SE3_CAPTURE_REC_OFF_DURATION, duration);
+		SE3_GET16(p, SE3_CAPTURE_REC_OFF_NBLOCKS, nblocks);
+
+		switch (p[SE3_CAPTURE_REC_OFF_TYPE]) {
+		case SE3_CAPTURE_SESSION:
+			if (rec_len(p) == SE3_CAPTURE_SESSION_SIZE) {
+				pending = p + SE3_CAPTURE_REC_SIZE;
+				key = pending + SE3_CAPTURE_SESSION_OFF_KEY;
+				// the requests since the previous session may have opened this one
+				for (k = unresolved; k < n; k++) {
+					requests[k].next_key = key;
+				}
+				unresolved = n;
+			}
+			r = NULL;
+			break;
+		case SE3_CAPTURE_WRITE:
+			r = NULL;
+			// magic blocks written by the discovery are not requests
+			if (nblocks == 0 || !memcmp(p + SE3_CAPTURE_REC_SIZE, se3_magic, SE3_MAGIC_SIZE)) {
+				break;
+			}
+			r = requests + n;
+			n++;
+			memset(r, 0, sizeof(replay_request));
+			r->rec = p;
+			r->session = pending;
+			pending = NULL;
+			r->key = key;
+			r->captured_us = duration;
+			r->captured_status = SE3_ERR_COMM;
+			SE3_GET16(p + SE3_CAPTURE_REC_SIZE, SE3_REQ_OFFSET_CMD, r->cmd);
+			SE3_GET16(p + SE3_CAPTURE_REC_SIZE, SE3_REQ_OFFSET_CMDFLAGS, r->flags);
+			break;
+		case SE3_CAPTURE_READ:
+			// the response of the last request: the ready first block, then the others
+			if (r == NULL || !p[SE3_CAPTURE_REC_OFF_OK] || rec_len(p) < SE3_COMM_BLOCK) {
+				break;
+			}
+			SE3_GET64(r->rec, SE3_CAPTURE_REC_OFF_TIME, t);
+			r->captured_us = (uint32_t)(time + duration - t);
+			SE3_GET16(p + SE3_CAPTURE_REC_SIZE, SE3_RESP_OFFSET_READY, u16tmp);
+			if (u16tmp == 1) {
+				r->resp = p;
+			}
+			break;
+		default:
+			return -1;
+		}
+		p += SE3_CAPTURE_REC_SIZE + rec_len(p);
+	}
+
+	for (k = 0; k < n; k++) {
+		r = requests + k;
+		if (r->cmd == SE3_CMD0_L1) {
+			replay_name_l1(r, payload);
+		}
+		else {
+			r->key = NULL;
+			replay_name(r->label, 0, r->cmd);
+		}
+		if (r->resp != NULL) {
+			SE3_GET16(r->resp, SE3_CAPTURE_REC_OFF_NBLOCKS, nblocks);
+			r->captured_status = replay_status(r->resp + SE3_CAPTURE_REC_SIZE, nblocks, r, payload);
+		}
+	}
+	return n;
+}
+
+/** \brief Log in the simulated device with a captured session, as the login command does */
+static void replay_session(const uint8_t* session)
+{
+	sim_mutex_acquire();
+	login_struct.y = true;
+	SE3_GET16(session, SE3_CAPTURE_SESSION_OFF_ACCESS, login_struct.access);
+	login_struct.challenge_access = SE3_ACCESS_MAX;
+	memcpy(login_struct.token, session + SE3_CAPTURE_SESSION_OFF_TOKEN, SE3_TOKEN_SIZE);
+	memcpy(login_struct.key, session + SE3_CAPTURE_SESSION_OFF_KEY, SE3_KEY_SIZE);
+	login_struct.cryptoctx_initialized = false;
+	SE3_GET16(session, SE3_CAPTURE_SESSION_OFF_CMDFLAGS, login_struct.cmd_flags);
+	sim_mutex_release();
+}
+
+/** \brief Send a request to the simulated device and wait for the response
+ *  \return false on timeout
+ */
+static bool replay_send(const replay_request* r, uint8_t* resp, uint16_t* nblocks_resp)
+{
+	uint16_t nblocks, ready = 0, len_data_and_headers;
+	uint64_t deadline;
+
+	SE3_GET16(r->rec, SE3_CAPTURE_REC_OFF_NBLOCKS, nblocks);
+	se3_proto_recv(1, r->rec + SE3_CAPTURE_REC_SIZE, REPLAY_BASE_BLOCK, nblocks);
+	deadline = se3c_clock_us() + REPLAY_TIMEOUT_US;
+	while (ready != 1) {
+		if (se3c_clock_us() > deadline) {
+			return false;
+		}
+		Sleep(0);
+		se3_proto_send(1, resp, REPLAY_BASE_BLOCK, 1);
+		SE3_GET16(resp, SE3_RESP_OFFSET_READY, ready);
+	}
+	SE3_GET16(resp, SE3_RESP_OFFSET_LEN, len_data_and_headers);
+	*nblocks_resp = se3_nblocks(len_data_and_headers);
+	if (*nblocks_resp > 1) {
+		se3_proto_send(1, resp + SE3_COMM_BLOCK, REPLAY_BASE_BLOCK + 1, *nblocks_resp - 1);
+	}
+	return true;
+}
+
+static int time_cmp(const void* a, const void* b)
+{
+	uint32_t x = *(const uint32_t*)a, y = *(const uint32_t*)b;
+	return (x < y) ? (-1) : ((x > y) ? (1) : (0));
+}
+
+static replay_command* replay_command_get(replay_command* cmds, size_t* ncmds, const char* label, size_t max_times)
+{
+	size_t i;
+
+	for (i = 0; i < *ncmds; i++) {
+		if (!strcmp(cmds[i].label, label)) {
+			return cmds + i;
+		}
+	}
+	memset(cmds + i, 0, sizeof(replay_command));
+	strcpy(cmds[i].label, label);
+	cmds[i].times = (uint32_t*)malloc(max_times * sizeof(uint32_t));
+	(*ncmds)++;
+	return cmds + i;
+}
+
+static double percentile(const replay_command* c, double q)
+{
+	return (double)c->times[(size_t)(q * (c->count - 1) + 0.5)];
+}
+
+static uint8_t* read_file(const char* path, size_t* size)
+{
+	FILE* fp = fopen(path, "rb");
+	uint8_t* buf = NULL;
+	long n;
+
+	if (fp == NULL) {
+		return NULL;
+	}
+	if (fseek(fp, 0, SEEK_END) == 0 && (n = ftell(fp)) > 0 && fseek(fp, 0, SEEK_SET) == 0) {
+		buf = (uint8_t*)malloc((size_t)n);
+		if (buf != NULL && fread(buf, 1, (size_t)n, fp) != (size_t)n) {
+			free(buf);
+			buf = NULL;
+		}
+		*size = (size_t)n;
+	}
+	fclose(fp);
+	return buf;
+}
+
+int replay_main(int argc, char* argv[])
+{
+	const char* path = NULL, *path_baseline = NULL, *path_out = NULL;
+	double threshold = -1, p50, delta;
+	unsigned min_count = REPLAY_MIN_COUNT;
+	bool paced = false, strict = false, regression = false;
+	size_t mismatches = 0;
+	uint8_t* cap = NULL, *resp = NULL, *payload = NULL;
+	replay_request* requests = NULL;
+	replay_command* cmds = NULL, *c;
+	size_t size = 0, ncmds = 0, i;
+	long n, k;
+	uint64_t t0, t1, first = 0, start, time;
+	uint32_t magic;
+	uint16_t version, nblocks_resp, status;
+	se3_device dev;
+	char label[REPLAY_LABEL_SIZE], line[128];
+	double count_b, p50_b;
+	FILE* fp;
+	int a, ret = 2;
+
+	for (a = 1; a < argc; a++) {
+		if (!strcmp(argv[a], "-p")) {
+			paced = true;
+		}
+		else if (!strcmp(argv[a], "-s")) {
+			strict = true;
+		}
+		else if (!strcmp(argv[a], "-b") && a + 1 < argc) {
+			path_baseline = argv[++a];
+		}
+		else if (!strcmp(argv[a], "-w") && a + 1 < argc) {
+			path_out = argv[++a];
+		}
+		else if (!strcmp(argv[a], "-t") && a + 1 < argc) {
+			threshold = atof(argv[++a]);
+		}
+		else if (!strcmp(argv[a], "-m") && a + 1 < argc) {
+			min_count = (unsigned)strtoul(argv[++a], NULL, 0);
+		}
+		else if (argv[a][0] != '-' && path == NULL) {
+			path = argv[a];
+		}
+		else {
+			usage();
+			return 2;
+		}
+	}
+	if (path == NULL || (threshold >= 0 && path_baseline == NULL)) {
+		usage();
+		return 2;
+	}
+
+	cap = read_file(path, &size);
+	if (cap == NULL || size < SE3_CAPTURE_HEADER_SIZE) {
+		fprintf(stderr, "cannot read %s\n", path);
+		goto cleanup;
+	}
+	SE3_GET32(cap, SE3_CAPTURE_OFF_MAGIC, magic);
+	SE3_GET16(cap, SE3_CAPTURE_OFF_VERSION, version);
+	if (magic != SE3_CAPTURE_MAGIC || version != SE3_CAPTURE_VERSION) {
+		fprintf(stderr, "%s is not a capture\n", path);
+		goto cleanup;
+	}
+	// at most one request per record
+	requests = (replay_request*)malloc((size / SE3_CAPTURE_REC_SIZE) * sizeof(replay_request));
+	resp = (uint8_t*)malloc(SE3_COMM_N * SE3_COMM_BLOCK);
+	payload = (uint8_t*)malloc(SE3_COMM_N * SE3_COMM_BLOCK);
+	if (requests == NULL || resp == NULL || payload == NULL) {
+		goto cleanup;
+	}
+	n = replay_parse(cap, size, requests, payload);
+	if (n < 0) {
+		fprintf(stderr, "%s is truncated or corrupted\n", path);
+		goto cleanup;
+	}
+	cmds = (replay_command*)calloc((size_t)n + 1, sizeof(replay_command));
+	if (cmds == NULL) {
+		goto cleanup;
+	}
+
+	L0_open_sim(&dev);
+	start = se3c_clock_us();
+	for (k = 0; k < n; k++) {
+		const replay_request* r = requests + k;
+		if (r->session != NULL) {
+			replay_session(r->session);
+		}
+		if (paced) {
+			SE3_GET64(r->rec, SE3_CAPTURE_REC_OFF_TIME, time);
+			if (k == 0) {
+				first = time;
+			}
+			while (se3c_clock_us() - start < time - first) {
+				Sleep((time - first - (se3c_clock_us() - start) > 2000) ? (1) : (0));
+			}
+		}
+		t0 = se3c_clock_us();
+		if (!replay_send(r, resp, &nblocks_resp)) {
+			fprintf(stderr, "request %ld (%s) timed out\n", k, r->label);
+			goto cleanup;
+		}
+		t1 = se3c_clock_us();
+		status = replay_status(resp, nblocks_resp, r, payload);
+
+		c = replay_command_get(cmds, &ncmds, r->label, (size_t)n);
+		if (c->times == NULL) {
+			goto cleanup;
+		}
+		c->times[c->count] = (uint32_t)(t1 - t0);
+		(c->count)++;
+		c->captured_total += r->captured_us;
+		if (status != r->captured_status && !r->login) {
+			(c->mismatches)++;
+			mismatches++;
+		}
+	}
+	for (i = 0; i < ncmds; i++) {
+		qsort(cmds[i].times, cmds[i].count, sizeof(uint32_t), time_cmp);
+	}
+
+	if (path_baseline != NULL) {
+		fp = fopen(path_baseline, "r");
+		if (fp == NULL) {
+			fprintf(stderr, "cannot read %s\n", path_baseline);
+			goto cleanup;
+		}
+		while (fgets(line, sizeof(line), fp) != NULL) {
+			if (line[0] == '#' || sscanf(line, "%31s %lf %lf", label, &count_b, &p50_b) != 3) {
+				continue;
+			}
+			for (i = 0; i < ncmds; i++) {
+				if (!strcmp(cmds[i].label, label)) {
+					cmds[i].in_baseline = true;
+					cmds[i].baseline_p50 = p50_b;
+				}
+			}
+		}
+		fclose(fp);
+	}
+
+	printf("%-20s %7s %10s %10s %10s %10s %8s %10s\n", "command", "count", "captured", "p50", "p95", "baseline", "delta", "mismatch");
+	for (i = 0; i < ncmds; i++) {
+		c = cmds + i;
+		p50 = percentile(c, 0.5);
+		printf("%-20s %7u %10.1f %10.1f %10.1f", c->label, (unsigned)c->count, c->captured_total / c->count, p50, percentile(c, 0.95));
+		if (c->in_baseline && c->baseline_p50 > 0) {
+			delta = (p50 - c->baseline_p50) * 100.0 / c->baseline_p50;
+			printf(" %10.1f %+7.1f%%", c->baseline_p50, delta);
+			if (threshold >= 0 && c->count >= min_count && delta > threshold) {
+				printf(" %10u REGRESSION\n", (unsigned)c->mismatches);
+				regression = true;
+				continue;
+			}
+		}
+		else {
+			printf(" %10s %8s", "-", "-");
+		}
+		printf(" %10u\n", (unsigned)c->mismatches);
+	}
+	printf("times in us; captured is the mean on the captured device, p50 and p95 on the simulator\n");
+
+	if (path_out != NULL) {
+		fp = fopen(path_out, "w");
+		if (fp == NULL) {
+			fprintf(stderr, "cannot write %s\n", path_out);
+			goto cleanup;
+		}
+		fprintf(fp, "# command count p50_us p95_us\n");
+		for (i = 0; i < ncmds; i++) {
+			fprintf(fp, "%s %u %.1f %.1f\n", cmds[i].label, (unsigned)cmds[i].count, percentile(cmds + i, 0.5), percentile(cmds + i, 0.95));
+		}
+		fclose(fp);
+	}
+	if (strict && mismatches > 0) {
+		printf("%u responses differ from the capture\n", (unsigned)mismatches);
+		regression = true;
+	}
+	ret = (regression) ? (1) : (0);
+
+cleanup:
+	if (cmds != NULL) {
+		for (i = 0; i < ncmds; i++) {
+			free(cmds[i].times);
+		}
+		free(cmds);
+	}
+	free(requests);
+	free(resp);
+	free(payload);
+	free(cap);
+	return ret;
+}
@@ -0,0 +1,16 @@
+#pragma once
+
+/** \brief Replay a capture on the simulated device, see se3_capture.h
+ *
+ *  usage: replay [-p] [-s] [-b baseline] [-w baseline_out] [-t percent] [-m min_count] capture
+ *  -p paces the requests like the capture instead of sending them back to back; -b compares the
+ *  median time of each command with a baseline written by -w, and with -t returns 1 if any
+ *  command sent at least min_count times (10 by default) got slower by more than percent.
+ *  The key store of the simulator (flash.bin) should match the one of the captured device, or
+ *  the commands using keys fail; such status mismatches are counted in the report, and with -s
+ *  return 1 as well. Logins always fail, as the challenge of the device is random: the captured
+ *  session is installed in the device instead, and their status is not compared.
+ *
+ *  \return 0, 1 on a regression, 2 on errors
+ */
+int replay_main(int argc, char* argv[]);
@@ -1,14 +1,32 @@
 
 #include "stubs.h"
 #include "se3_flash.h"
+#include "se3_log.h"
+
+uint8_t sim_sd_log[SE3_LOG_SD_BLOCKS * SE3_LOG_BLOCK_SIZE];
+bool sim_rand_fail = false;
+
+/* Only the log range of the card is simulated */
+static bool sim_sd_in_log(uint32_t blk_addr, uint16_t blk_len)
+{
+	return (blk_addr >= SE3_LOG_SD_FIRST && blk_addr + blk_len <= SE3_LOG_SD_FIRST + SE3_LOG_SD_BLOCKS);
+}
 
 int32_t secube_sdio_write(uint8_t lun, const uint8_t* buf, uint32_t blk_addr, uint16_t blk_len)
 {
-	return 0;
+	if (!sim_sd_in_log(blk_addr, blk_len)) {
+		return 0;
+	}
+	memcpy(sim_sd_log + (blk_addr - SE3_LOG_SD_FIRST) * SE3_LOG_BLOCK_SIZE, buf, blk_len * SE3_LOG_BLOCK_SIZE);
+	return 1;
 }
 int32_t secube_sdio_read(uint8_t lun, uint8_t* buf, uint32_t blk_addr, uint16_t blk_len)
 {
-	return 0;
+	if (!sim_sd_in_log(blk_addr, blk_len)) {
+		return 0;
+	}
+	memcpy(buf, sim_sd_log + (blk_addr - SE3_LOG_SD_FIRST) * SE3_LOG_BLOCK_SIZE, blk_len * SE3_LOG_BLOCK_SIZE);
+	return 1;
 }
 
 
@@ -35,6 +53,9 @@ void sim_mutex_release()
 int32_t se3_rand(uint16_t size, uint8_t* data)
 {
 	size_t i;
+	if (sim_rand_fail) {
+		return 0;
+	}
 	srand((unsigned)time(0));
 	for (i = 0; i < size; i++)
 	{
@@ -46,13 +67,15 @@ int32_t se3_rand(uint16_t size, uint8_t* data)
 
 
 uint8_t* stub_flash = NULL;
+size_t sim_flash_budget = SIM_FLASH_UNLIMITED;
+size_t sim_flash_programs = 0;
 
 static void flash_init()
 {
 	HANDLE hFile, hMap;
 	hFile = CreateFileW(L"flash.bin", GENERIC_READ | GENERIC_WRITE, FILE_SHARE_DELETE | FILE_SHARE_READ | FILE_SHARE_WRITE, NULL, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
-	hMap = CreateFileMappingW(hFile, NULL, PAGE_READWRITE, 0, 2 * SE3_FLASH_SECTOR_SIZE, NULL);
-	stub_flash = (uint8_t*)MapViewOfFile(hMap, FILE_MAP_ALL_ACCESS, 0, 0, 2 * SE3_FLASH_SECTOR_SIZE);
+	hMap = CreateFileMappingW(hFile, NULL, PAGE_READWRITE, 0, SE3_FLASH_SECTORS * SE3_FLASH_SECTOR_SIZE, NULL);
+	stub_flash = (uint8_t*)MapViewOfFile(hMap, FILE_MAP_ALL_ACCESS, 0, 0, SE3_FLASH_SECTORS * SE3_FLASH_SECTOR_SIZE);
 }
 
 HAL_StatusTypeDef HAL_FLASH_Unlock()
@@ -68,6 +91,13 @@ HAL_StatusTypeDef HAL_FLASH_Lock()
 HAL_StatusTypeDef HAL_FLASH_Program(uint32_t TypeProgram, uint32_t Address, uint64_t Data)
 {
 	size_t i;
+	if (sim_flash_budget == 0) {
+		return HAL_ERROR;
+	}
+	if (sim_flash_budget != SIM_FLASH_UNLIMITED) {
+		sim_flash_budget--;
+	}
+	sim_flash_programs++;
 	for (i = 0; i < (size_t)(1 << TypeProgram); i++)
 	{
 		*((uint8_t*)(Address + i)) &= *(((uint8_t*)&Data) + i);
@@ -77,13 +107,12 @@ HAL_StatusTypeDef HAL_FLASH_Program(uint32_t TypeProgram, uint32_t Address, uint
 
 void sim_clear_flash()
 {
-	se3_flash_info_setup((uint32_t)SE3_FLASH_S0, (uint8_t*)SE3_FLASH_S0_ADDR);
-	memset(stub_flash, 0xFF, 2*SE3_FLASH_SECTOR_SIZE);
-	memcpy(stub_flash, se3_magic, SE3_FLASH_MAGIC_SIZE);
+	// se3_flash_init formats the erased sectors
+	memset(stub_flash, 0xFF, SE3_FLASH_SECTORS*SE3_FLASH_SECTOR_SIZE);
 
 }
 
 size_t sim_get_allocated_mem()
 {
-	return se3c0.flash.allocated;
+	return flash.used*SE3_FLASH_BLOCK_SIZE;
 }
\ No newline at end of file
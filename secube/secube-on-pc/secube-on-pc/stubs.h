@@ -2,6 +2,7 @@
 
 #include <Windows.h>
 #include <stdint.h>
+#include <stdbool.h>
 #include <stdio.h>
 #include <string.h>
 #include <time.h>
@@ -21,6 +22,11 @@ typedef struct {
 
 int32_t se3_rand(uint16_t size, uint8_t* data);
 
+/** Log range of the SD card, the only part written and read by the secube_sdio stubs */
+extern uint8_t sim_sd_log[];
+/** Makes se3_rand fail, as on a device with a stuck RNG */
+extern bool sim_rand_fail;
+
 
 typedef enum
 {
@@ -37,16 +43,22 @@ typedef enum
 
 extern uint8_t* stub_flash;
 #define SE3_FLASH_SECTOR_SIZE (128*1024)
-#define SE3_FLASH_S0  (10)
-#define SE3_FLASH_S1  (11)
-#define SE3_FLASH_S0_ADDR ((uint32_t)(stub_flash+0*SE3_FLASH_SECTOR_SIZE))
-#define SE3_FLASH_S1_ADDR ((uint32_t)(stub_flash+1*SE3_FLASH_SECTOR_SIZE))
+#define SE3_FLASH_SECTORS (6)
+#define SE3_FLASH_SECTOR_NUMBER(n) (10 + (n))
+#define SE3_FLASH_SECTOR_ADDR(n) ((uint32_t)(stub_flash+(n)*SE3_FLASH_SECTOR_SIZE))
+#define SE3_FLASH_SECTOR_ASYNC(n) ((n) >= 2)
 
 
 HAL_StatusTypeDef HAL_FLASH_Unlock();
 HAL_StatusTypeDef HAL_FLASH_Lock();
 HAL_StatusTypeDef HAL_FLASH_Program(uint32_t TypeProgram, uint32_t Address, uint64_t Data);
 
+/** Programming operations allowed before the flash fails as on a power loss, SIM_FLASH_UNLIMITED by default */
+extern size_t sim_flash_budget;
+/** Programming operations performed since the start */
+extern size_t sim_flash_programs;
+#define SIM_FLASH_UNLIMITED ((size_t)-1)
+
 
 
 
@@ -23,15 +23,45 @@ bool L1_tests(se3_session* session)
 	if (!test_Sha256(session)) {
 		return false;
 	}
+	if (!test_Sha256Ni(session)) {
+		return false;
+	}
 	if (!test_HmacSha256(session)) {
 		return false;
 	}
 	if (!test_Aes(session)) {
 		return false;
 	}
+	if (!test_AesNi(session)) {
+		return false;
+	}
 	if (!test_AesHmacSha256s(session)) {
 		return false;
 	}
+	if (!test_AesGcm(session)) {
+		return false;
+	}
+	if (!test_ChaCha20Poly1305(session)) {
+		return false;
+	}
+	if (!test_AesCmac(session)) {
+		return false;
+	}
+	if (!test_AesXts(session)) {
+		return false;
+	}
+	if (!test_Envelope(session)) {
+		return false;
+	}
+	if (!test_Container(session)) {
+		return false;
+	}
+	if (!test_Stream(session)) {
+		return false;
+	}
+	if (!test_Keys(session)) {
+		return false;
+	}
 	return true;
 }
 
@@ -40,6 +70,18 @@ bool L0_tests(se3_device* dev)
 	if (!test_echo(dev)) {
 		return false;
 	}
+	if (!test_L0_overhead(dev)) {
+		return false;
+	}
+	if (!test_Stats(dev)) {
+		return false;
+	}
+	if (!test_Timeline(dev)) {
+		return false;
+	}
+	if (!test_Metrics(dev)) {
+		return false;
+	}
 
 	return true;
 }
@@ -58,6 +100,9 @@ bool run_tests(se3_device_info* devinfo)
 	if (!L0_tests(&dev)) {
 		goto cleanup;
 	}
+	if (!test_Records(&dev)) {
+		goto cleanup;
+	}
 
 	r = L1_login(&session, &dev, pin, SE3_ACCESS_USER);
 	if (SE3_OK != r) {
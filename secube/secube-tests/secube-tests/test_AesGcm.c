@@ -0,0 +1,209 @@
+#include "tests.h"
+
+enum {
+	TEST_AAD_SIZE = 32
+};
+
+typedef struct {
+	size_t size;
+	uint8_t* buf;
+	uint8_t* buf_enc;
+	uint8_t* buf_hw;
+	uint8_t iv[B5_GCM_AES_IV_SIZE];
+	uint8_t aad[TEST_AAD_SIZE];
+} test_buffers;
+
+typedef struct {
+	uint8_t direction;
+	uint16_t se3mode;
+	uint16_t key_id;
+	uint16_t key_size;
+	uint8_t* key_data;
+	char name[32];
+} test_spec;
+
+static bool test_mode(se3_session* s, test_buffers* tb, test_spec* mode);
+static bool test_forgery(se3_session* s, test_buffers* tb, test_spec* mode);
+
+
+bool test_AesGcm(se3_session* s)
+{
+	enum {
+		TEST_SIZE = 1 * 1024 * 1024,
+		KEY_ID_128 = 500,
+		KEY_ID_192 = 501,
+		KEY_ID_256 = 502,
+		N_KEYS = 3,
+		N_MODES = 6
+	};
+	uint16_t r;
+	bool b;
+	size_t i;
+	test_buffers tb;
+	bool success = false;
+	size_t rep;
+	uint8_t key_data[32];
+	test_spec modes[N_MODES] = {
+		{ 0, SE3_DIR_ENCRYPT, KEY_ID_128, 16, key_data, "AES128 GCM encrypt" },
+		{ 0, SE3_DIR_ENCRYPT, KEY_ID_192, 24, key_data, "AES192 GCM encrypt" },
+		{ 0, SE3_DIR_ENCRYPT, KEY_ID_256, 32, key_data, "AES256 GCM encrypt" },
+
+		{ 1, SE3_DIR_DECRYPT, KEY_ID_128, 16, key_data, "AES128 GCM decrypt" },
+		{ 1, SE3_DIR_DECRYPT, KEY_ID_192, 24, key_data, "AES192 GCM decrypt" },
+		{ 1, SE3_DIR_DECRYPT, KEY_ID_256, 32, key_data, "AES256 GCM decrypt" }
+	};
+
+	se3_key keys[N_KEYS] = {
+		{ KEY_ID_128, (uint32_t)time(0) + 365 * 24 * 3600, B5_AES_128, 5, {0}, key_data, "tk128" },
+		{ KEY_ID_192, (uint32_t)time(0) + 365 * 24 * 3600, B5_AES_192, 5, {0}, key_data, "tk192" },
+		{ KEY_ID_256, (uint32_t)time(0) + 365 * 24 * 3600, B5_AES_256, 5, {0}, key_data, "tk256" }
+	};
+
+	test_randbuf(TEST_SIZE, &tb.buf);
+	tb.buf_enc = (uint8_t*)malloc(TEST_SIZE + B5_GCM_AES_TAG_SIZE);
+	tb.buf_hw = (uint8_t*)malloc(TEST_SIZE + B5_GCM_AES_TAG_SIZE);
+	tb.size = TEST_SIZE;
+
+	se3c_rand(32, key_data);
+	for (i = 0; i < N_KEYS; i++) {
+		r = L1_key_edit(s, SE3_KEY_OP_UPSERT, &keys[i]);
+		if (r != SE3_OK) {
+			printf("Error inserting keys\n");
+			goto cleanup;
+		}
+	}
+
+	se3c_rand(B5_GCM_AES_IV_SIZE, tb.iv);
+	se3c_rand(TEST_AAD_SIZE, tb.aad);
+	for (i = 0; i < N_MODES; i++) {
+		printf("%s ", modes[i].name);
+		for (rep = 0; rep < NRUN; rep++) {
+			b = test_mode(s, &tb, &modes[i]);
+			printf(" ");
+			if (!b) {
+				goto cleanup;
+			}
+		}
+		printf("\n");
+	}
+
+	printf("AES256 GCM forged tag ");
+	if (!test_forgery(s, &tb, &modes[N_MODES - 1])) {
+		goto cleanup;
+	}
+	printf("rejected\n");
+
+	success = true;
+cleanup:
+	free(tb.buf);
+	free(tb.buf_enc);
+	free(tb.buf_hw);
+	return success;
+}
+
+
+/** Compute the reference cipher text and tag of tb->buf on the host */
+static void test_reference(test_buffers* tb, test_spec* mode)
+{
+	B5_tGcmAesCtx gcm;
+
+	B5_GcmAes256_Init(&gcm, mode->key_data, mode->key_size, B5_GCM_AES256_ENC);
+	B5_GcmAes256_SetIV(&gcm, tb->iv, B5_GCM_AES_IV_SIZE);
+	B5_GcmAes256_UpdateAad(&gcm, tb->aad, TEST_AAD_SIZE);
+	B5_GcmAes256_Update(&gcm, tb->buf_enc, tb->buf, (int32_t)tb->size);
+	B5_GcmAes256_Finit(&gcm, tb->buf_enc + tb->size);
+}
+
+/** Send the additional data and sp to the device; the last chunk carries the tag when decrypting */
+static uint16_t test_stream(se3_session* s, uint32_t session_id, test_buffers* tb, bool decrypt, uint8_t* sp, uint8_t* rp)
+{
+	uint16_t chunk = ((SE3_CRYPTO_MAX_DATAIN - TEST_AAD_SIZE - B5_GCM_AES_TAG_SIZE) / B5_AES_BLK_SIZE) * B5_AES_BLK_SIZE;
+	uint16_t r;
+	uint16_t dataout_len = 0;
+	uint16_t n, nin, nout;
+	size_t size = tb->size;
+	bool first = true;
+	bool last;
+
+	r = L1_crypto_update(s, session_id, SE3_CRYPTO_FLAG_SETNONCE, B5_GCM_AES_IV_SIZE, tb->iv, 0, NULL, &dataout_len, NULL);
+	if ((SE3_OK != r) || (0 != dataout_len)) {
+		return (SE3_OK != r) ? r : SE3_ERR_PARAMS;
+	}
+
+	while (size > 0) {
+		n = (size > chunk) ? chunk : (uint16_t)size;
+		last = (size == n);
+		nin = n + ((last && decrypt) ? B5_GCM_AES_TAG_SIZE : 0);
+		nout = n + ((last && !decrypt) ? B5_GCM_AES_TAG_SIZE : 0);
+		r = L1_crypto_update(s, session_id, last ? SE3_CRYPTO_FLAG_FINIT : 0,
+			first ? TEST_AAD_SIZE : 0, first ? tb->aad : NULL, nin, sp, &dataout_len, rp);
+		if (SE3_OK != r) {
+			return r;
+		}
+		if (nout != dataout_len) {
+			return SE3_ERR_PARAMS;
+		}
+		first = false;
+		size -= n;
+		sp += n;
+		rp += n;
+	}
+	return SE3_OK;
+}
+
+static bool test_mode(se3_session* s, test_buffers* tb, test_spec* mode)
+{
+	uint32_t session_id;
+	uint16_t r = SE3_OK;
+	stopwatch sw;
+	bool decrypt = (mode->direction == 1);
+
+	test_reference(tb, mode);
+
+	stopwatch_start(&sw);
+	r = L1_crypto_init(s, SE3_ALGO_AES_GCM, mode->se3mode, mode->key_id, &session_id);
+	if (SE3_OK != r) {
+		return false;
+	}
+	r = test_stream(s, session_id, tb, decrypt, decrypt ? tb->buf_enc : tb->buf, tb->buf_hw);
+	if (SE3_OK != r) {
+		return false;
+	}
+	stopwatch_stop(&sw);
+
+	if (decrypt) {
+		if (memcmp(tb->buf, tb->buf_hw, tb->size)) {
+			return false;
+		}
+	}
+	else {
+		if (memcmp(tb->buf_enc, tb->buf_hw, tb->size + B5_GCM_AES_TAG_SIZE)) {
+			return false;
+		}
+	}
+
+	test_printspeed(&sw, tb->size);
+
+	return true;
+}
+
+static bool test_forgery(se3_session* s, test_buffers* tb, test_spec* mode)
+{
+	uint32_t session_id;
+	uint16_t r = SE3_OK;
+
+	test_reference(tb, mode);
+	tb->buf_enc[tb->size] ^= 0x01;
+
+	r = L1_crypto_init(s, SE3_ALGO_AES_GCM, mode->se3mode, mode->key_id, &session_id);
+	if (SE3_OK != r) {
+		return false;
+	}
+	r = test_stream(s, session_id, tb, true, tb->buf_enc, tb->buf_hw);
+	if (SE3_ERR_AUTH != r) {
+		return false;
+	}
+	// the session is still open after a failed verification
+	r = L1_crypto_update(s, session_id, SE3_CRYPTO_FLAG_FINIT, 0, NULL, 0, NULL, NULL, NULL);
+	return (SE3_OK == r);
+}
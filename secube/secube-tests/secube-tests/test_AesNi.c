@@ -0,0 +1,123 @@
+#include "tests.h"
+
+typedef struct {
+	uint8_t b5mode;
+	bool decrypt;
+	char name[16];
+} test_aesni_mode;
+
+static bool test_aesni_run(uint8_t backend, const test_aesni_mode* mode, const uint8_t* key, uint16_t key_size,
+	const uint8_t* iv, const uint8_t* in, uint8_t* out, size_t size);
+
+/* AES-NI against the table based implementation, then the throughput of both */
+bool test_AesNi(se3_session* s)
+{
+	enum {
+		TEST_SIZE = 1 * 1024 * 1024,
+		CHECK_SIZE = 4 * 1024,
+		N_MODES = 8,
+		N_KEYS = 3
+	};
+	test_aesni_mode modes[N_MODES] = {
+		{ B5_AES256_ECB_ENC, false, "ECB encrypt" },
+		{ B5_AES256_ECB_DEC, true, "ECB decrypt" },
+		{ B5_AES256_CBC_ENC, false, "CBC encrypt" },
+		{ B5_AES256_CBC_DEC, true, "CBC decrypt" },
+		{ B5_AES256_CFB_ENC, false, "CFB encrypt" },
+		{ B5_AES256_CFB_DEC, true, "CFB decrypt" },
+		{ B5_AES256_CTR, false, "CTR" },
+		{ B5_AES256_OFB, false, "OFB" }
+	};
+	uint16_t key_sizes[N_KEYS] = { B5_AES_128, B5_AES_192, B5_AES_256 };
+	uint8_t key[32];
+	uint8_t iv[B5_AES_IV_SIZE];
+	uint8_t* buf = NULL;
+	uint8_t* buf_sw = NULL;
+	uint8_t* buf_ni = NULL;
+	size_t i, j, size;
+	stopwatch sw;
+	bool success = false;
+
+	if (B5_AES256_RES_OK != B5_Aes256_SetBackend(B5_AES256_BACKEND_NI)) {
+		printf("AES-NI not supported\n");
+		B5_Aes256_SetBackend(B5_AES256_BACKEND_AUTO);
+		return true;
+	}
+
+	test_randbuf(TEST_SIZE, &buf);
+	buf_sw = (uint8_t*)malloc(TEST_SIZE);
+	buf_ni = (uint8_t*)malloc(TEST_SIZE);
+
+	for (i = 0; i < N_MODES; i++) {
+		for (j = 0; j < N_KEYS; j++) {
+			se3c_rand(sizeof(key), key);
+			// counter close to wrapping, to check the carry
+			se3c_rand(B5_AES_IV_SIZE, iv);
+			iv[B5_AES_IV_SIZE - 1] = 0xFE;
+			for (size = B5_AES_BLK_SIZE; size <= CHECK_SIZE; size += 3 * B5_AES_BLK_SIZE) {
+				test_aesni_run(B5_AES256_BACKEND_SW, &modes[i], key, key_sizes[j], iv, buf, buf_sw, size);
+				test_aesni_run(B5_AES256_BACKEND_NI, &modes[i], key, key_sizes[j], iv, buf, buf_ni, size);
+				if (memcmp(buf_sw, buf_ni, size)) {
+					printf("AES%u %s mismatch\n", (unsigned)key_sizes[j] * 8, modes[i].name);
+					goto cleanup;
+				}
+			}
+		}
+	}
+
+	for (i = 0; i < N_MODES; i++) {
+		printf("AES256 %s ", modes[i].name);
+		stopwatch_start(&sw);
+		test_aesni_run(B5_AES256_BACKEND_SW, &modes[i], key, B5_AES_256, iv, buf, buf_sw, TEST_SIZE);
+		stopwatch_stop(&sw);
+		printf("SW ");
+		test_printspeed(&sw, TEST_SIZE);
+		stopwatch_start(&sw);
+		test_aesni_run(B5_AES256_BACKEND_NI, &modes[i], key, B5_AES_256, iv, buf, buf_ni, TEST_SIZE);
+		stopwatch_stop(&sw);
+		printf(" NI ");
+		test_printspeed(&sw, TEST_SIZE);
+		printf("\n");
+	}
+
+	success = true;
+cleanup:
+	B5_Aes256_SetBackend(B5_AES256_BACKEND_AUTO);
+	free(buf);
+	free(buf_sw);
+	free(buf_ni);
+	return success;
+}
+
+/* Process size bytes in chunks, so that the IV is carried between updates */
+static bool test_aesni_run(uint8_t backend, const test_aesni_mode* mode, const uint8_t* key, uint16_t key_size,
+	const uint8_t* iv, const uint8_t* in, uint8_t* out, size_t size)
+{
+	enum {
+		CHUNK_BLOCKS = 1000
+	};
+	B5_tAesCtx aes;
+	size_t off, nblk;
+
+	B5_Aes256_SetBackend(backend);
+	if (B5_AES256_RES_OK != B5_Aes256_Init(&aes, key, key_size, mode->b5mode)) {
+		return false;
+	}
+	if (mode->b5mode != B5_AES256_ECB_ENC && mode->b5mode != B5_AES256_ECB_DEC) {
+		B5_Aes256_SetIV(&aes, iv);
+	}
+	for (off = 0; off < size; off += nblk * B5_AES_BLK_SIZE) {
+		nblk = (size - off) / B5_AES_BLK_SIZE;
+		if (nblk > CHUNK_BLOCKS) {
+			nblk = CHUNK_BLOCKS;
+		}
+		if (mode->decrypt) {
+			B5_Aes256_Update(&aes, (uint8_t*)in + off, out + off, (int16_t)nblk);
+		}
+		else {
+			B5_Aes256_Update(&aes, out + off, (uint8_t*)in + off, (int16_t)nblk);
+		}
+	}
+	B5_Aes256_Finit(&aes);
+	return true;
+}
@@ -0,0 +1,156 @@
+#include "tests.h"
+
+typedef struct {
+	size_t size;
+	uint8_t* buf;
+	uint8_t* buf_hw;
+	uint8_t* buf_sw;
+} test_buffers;
+
+typedef struct {
+	uint16_t key_id;
+	uint16_t key_size;
+	uint8_t* key_data;
+	char name[32];
+} test_spec;
+
+static bool test_mode(se3_session* s, test_buffers* tb, test_spec* mode, bool encrypt);
+
+
+bool test_AesXts(se3_session* s)
+{
+	enum {
+		TEST_SIZE = 1 * 1024 * 1024,
+		KEY_ID_128 = 510,
+		KEY_ID_256 = 511,
+		N_KEYS = 2,
+		N_MODES = 2
+	};
+	uint16_t r;
+	uint32_t session_id;
+	size_t i;
+	bool b;
+	test_buffers tb;
+	bool success = false;
+	size_t rep;
+	uint8_t key_data[B5_XTS_AES_256];
+	test_spec modes[N_MODES] = {
+		{ KEY_ID_128, B5_XTS_AES_128, key_data, "AES-XTS 128-bit key" },
+		{ KEY_ID_256, B5_XTS_AES_256, key_data, "AES-XTS 256-bit key" }
+	};
+
+	se3_key keys[N_KEYS] = {
+		{ KEY_ID_128, (uint32_t)time(0) + 365 * 24 * 3600, B5_XTS_AES_128, 5, {0}, key_data, "tx128" },
+		{ KEY_ID_256, (uint32_t)time(0) + 365 * 24 * 3600, B5_XTS_AES_256, 5, {0}, key_data, "tx256" }
+	};
+
+	test_randbuf(TEST_SIZE, &tb.buf);
+	tb.size = TEST_SIZE;
+	tb.buf_hw = (uint8_t*)malloc(TEST_SIZE);
+	tb.buf_sw = (uint8_t*)malloc(TEST_SIZE);
+	if (tb.buf_hw == NULL || tb.buf_sw == NULL) {
+		printf("Cannot allocate test buffers\n");
+		goto cleanup;
+	}
+
+	se3c_rand(B5_XTS_AES_256, key_data);
+	for (i = 0; i < N_KEYS; i++) {
+		r = L1_key_edit(s, SE3_KEY_OP_UPSERT, &keys[i]);
+		if (r != SE3_OK) {
+			printf("Error inserting keys\n");
+			goto cleanup;
+		}
+	}
+
+	// the direction must be given
+	if (SE3_ERR_PARAMS != L1_crypto_init(s, SE3_ALGO_AES_XTS, 0, KEY_ID_128, &session_id) ||
+		SE3_ERR_PARAMS != L1_crypto_init(s, SE3_ALGO_AES_XTS, SE3_DIR_ENCRYPT | SE3_DIR_DECRYPT, KEY_ID_128, &session_id))
+	{
+		printf("AES-XTS session without a direction accepted\n");
+		goto cleanup;
+	}
+
+	for (i = 0; i < N_MODES; i++) {
+		printf("%s ", modes[i].name);
+		for (rep = 0; rep < NRUN; rep++) {
+			b = test_mode(s, &tb, &modes[i], true);
+			if (!b) {
+				goto cleanup;
+			}
+			printf(" ");
+			b = test_mode(s, &tb, &modes[i], false);
+			if (!b) {
+				goto cleanup;
+			}
+			printf(" ");
+		}
+		printf("\n");
+	}
+
+	success = true;
+cleanup:
+	free(tb.buf);
+	free(tb.buf_hw);
+	free(tb.buf_sw);
+	return success;
+}
+
+
+
+static bool test_mode(se3_session* s, test_buffers* tb, test_spec* mode, bool encrypt)
+{
+	uint32_t session_id;
+	uint16_t r = SE3_OK;
+	uint8_t* sp, *rp;
+	uint16_t dataout_len = 0;
+	uint8_t sector_data[8];
+	B5_tXtsAesCtx ctx;
+	// start away from zero so that the upper bytes of the sector number are exercised
+	uint64_t sector = 0x0123456789ull;
+	size_t i = 0, n = 0, nrem = 0;
+	uint16_t chunk = SE3_CRYPTO_XTS_MAX_SECTORS * SE3_CRYPTO_XTS_SECTOR_SIZE;
+	stopwatch sw;
+
+	// expected output; decryption is checked against the plaintext in tb->buf
+	B5_XtsAes256_Init(&ctx, mode->key_data, mode->key_size, B5_XTS_AES256_ENC);
+	B5_XtsAes256_Update(&ctx, tb->buf_sw, tb->buf, sector, (int32_t)(tb->size / SE3_CRYPTO_XTS_SECTOR_SIZE));
+
+	sp = (encrypt) ? tb->buf : tb->buf_sw;
+	rp = tb->buf_hw;
+	stopwatch_start(&sw);
+	r = L1_crypto_init(s, SE3_ALGO_AES_XTS, (encrypt) ? SE3_DIR_ENCRYPT : SE3_DIR_DECRYPT, mode->key_id, &session_id);
+	if (SE3_OK != r) {
+		return false;
+	}
+
+	n = (tb->size) / chunk;
+	nrem = (tb->size) % chunk;
+	for (i = 0; i < n; i++) {
+		SE3_SET64(sector_data, 0, sector);
+		r = L1_crypto_update(s, session_id,
+			(nrem == 0 && i == n - 1) ? SE3_CRYPTO_FLAG_FINIT : 0,
+			sizeof(sector_data), sector_data, chunk, sp, &dataout_len, rp);
+		if ((SE3_OK != r) || (chunk != dataout_len)) {
+			return false;
+		}
+		sp += chunk;
+		rp += chunk;
+		sector += SE3_CRYPTO_XTS_MAX_SECTORS;
+	}
+	if (nrem > 0) {
+		SE3_SET64(sector_data, 0, sector);
+		r = L1_crypto_update(s, session_id, SE3_CRYPTO_FLAG_FINIT,
+			sizeof(sector_data), sector_data, (uint16_t)nrem, sp, &dataout_len, rp);
+		if ((SE3_OK != r) || (nrem != dataout_len)) {
+			return false;
+		}
+	}
+	stopwatch_stop(&sw);
+
+	if (memcmp((encrypt) ? tb->buf_sw : tb->buf, tb->buf_hw, tb->size)) {
+		return false;
+	}
+	test_printspeed(&sw, tb->size);
+
+	return true;
+}
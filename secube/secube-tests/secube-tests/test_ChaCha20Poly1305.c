@@ -0,0 +1,164 @@
+#include "tests.h"
+#include "chacha20poly1305.h"
+
+enum {
+	TEST_AAD_SIZE = 32
+};
+
+typedef struct {
+	size_t size;
+	uint8_t* buf;
+	uint8_t* buf_enc;
+	uint8_t* buf_hw;
+	uint8_t nonce[B5_CHACHA20_NONCE_SIZE];
+	uint8_t aad[TEST_AAD_SIZE];
+} test_buffers;
+
+typedef struct {
+	uint8_t direction;
+	uint16_t key_id;
+	uint8_t* key_data;
+	char name[32];
+} test_spec;
+
+static bool test_mode(se3_session* s, test_buffers* tb, test_spec* mode);
+static bool test_forgery(se3_session* s, test_buffers* tb, test_spec* mode);
+
+
+bool test_ChaCha20Poly1305(se3_session* s)
+{
+	enum {
+		TEST_SIZE = 1 * 1024 * 1024,
+		KEY_ID = 510,
+		N_MODES = 2
+	};
+	uint16_t r;
+	bool b;
+	size_t i;
+	test_buffers tb;
+	bool success = false;
+	size_t rep;
+	uint8_t key_data[B5_CHACHA20_KEY_SIZE];
+	test_spec modes[N_MODES] = {
+		{ 0, KEY_ID, key_data, "ChaCha20-Poly1305 encrypt" },
+		{ 1, KEY_ID, key_data, "ChaCha20-Poly1305 decrypt" }
+	};
+
+	se3_key key = { KEY_ID, (uint32_t)time(0) + 365 * 24 * 3600, B5_CHACHA20_KEY_SIZE, 4, {0}, key_data, "tkcp" };
+
+	test_randbuf(TEST_SIZE, &tb.buf);
+	tb.buf_enc = (uint8_t*)malloc(TEST_SIZE + B5_POLY1305_TAG_SIZE);
+	tb.buf_hw = (uint8_t*)malloc(TEST_SIZE + B5_POLY1305_TAG_SIZE);
+	tb.size = TEST_SIZE;
+
+	se3c_rand(B5_CHACHA20_KEY_SIZE, key_data);
+	r = L1_key_edit(s, SE3_KEY_OP_UPSERT, &key);
+	if (r != SE3_OK) {
+		printf("Error inserting keys\n");
+		goto cleanup;
+	}
+
+	se3c_rand(B5_CHACHA20_NONCE_SIZE, tb.nonce);
+	se3c_rand(TEST_AAD_SIZE, tb.aad);
+	for (i = 0; i < N_MODES; i++) {
+		printf("%s ", modes[i].name);
+		for (rep = 0; rep < NRUN; rep++) {
+			b = test_mode(s, &tb, &modes[i]);
+			printf(" ");
+			if (!b) {
+				goto cleanup;
+			}
+		}
+		printf("\n");
+	}
+
+	printf("ChaCha20-Poly1305 forged tag ");
+	if (!test_forgery(s, &tb, &modes[1])) {
+		goto cleanup;
+	}
+	printf("rejected\n");
+
+	success = true;
+cleanup:
+	free(tb.buf);
+	free(tb.buf_enc);
+	free(tb.buf_hw);
+	return success;
+}
+
+
+/** Compute the reference cipher text and tag of tb->buf on the host */
+static void test_reference(test_buffers* tb, test_spec* mode)
+{
+	B5_tChaCha20Poly1305Ctx cp;
+
+	B5_ChaCha20Poly1305_Init(&cp, mode->key_data, B5_CHACHA20_KEY_SIZE, B5_CHACHA20_POLY1305_ENC);
+	B5_ChaCha20Poly1305_SetNonce(&cp, tb->nonce);
+	B5_ChaCha20Poly1305_UpdateAad(&cp, tb->aad, TEST_AAD_SIZE);
+	B5_ChaCha20Poly1305_Update(&cp, tb->buf_enc, tb->buf, (int32_t)tb->size);
+	B5_ChaCha20Poly1305_Finit(&cp, tb->buf_enc + tb->size);
+}
+
+static bool test_mode(se3_session* s, test_buffers* tb, test_spec* mode)
+{
+	uint16_t r = SE3_OK;
+	size_t dataout_len = 0;
+	stopwatch sw;
+	bool decrypt = (mode->direction == 1);
+
+	test_reference(tb, mode);
+
+	stopwatch_start(&sw);
+	if (decrypt) {
+		r = L1_aead_decrypt(s, SE3_ALGO_CHACHA20_POLY1305, mode->key_id, B5_CHACHA20_NONCE_SIZE, tb->nonce,
+			TEST_AAD_SIZE, tb->aad, tb->size + B5_POLY1305_TAG_SIZE, tb->buf_enc, &dataout_len, tb->buf_hw);
+	}
+	else {
+		r = L1_aead_encrypt(s, SE3_ALGO_CHACHA20_POLY1305, mode->key_id, B5_CHACHA20_NONCE_SIZE, tb->nonce,
+			TEST_AAD_SIZE, tb->aad, tb->size, tb->buf, &dataout_len, tb->buf_hw);
+	}
+	if (SE3_OK != r) {
+		return false;
+	}
+	stopwatch_stop(&sw);
+
+	if (decrypt) {
+		if ((dataout_len != tb->size) || memcmp(tb->buf, tb->buf_hw, tb->size)) {
+			return false;
+		}
+	}
+	else {
+		if ((dataout_len != tb->size + B5_POLY1305_TAG_SIZE) || memcmp(tb->buf_enc, tb->buf_hw, tb->size + B5_POLY1305_TAG_SIZE)) {
+			return false;
+		}
+	}
+
+	test_printspeed(&sw, tb->size);
+
+	return true;
+}
+
+static bool test_forgery(se3_session* s, test_buffers* tb, test_spec* mode)
+{
+	uint16_t r = SE3_OK;
+	size_t dataout_len = 0;
+	size_t i;
+
+	test_reference(tb, mode);
+	tb->aad[0] ^= 0x01;
+
+	memset(tb->buf_hw, 0xFF, tb->size);
+	r = L1_aead_decrypt(s, SE3_ALGO_CHACHA20_POLY1305, mode->key_id, B5_CHACHA20_NONCE_SIZE, tb->nonce,
+		TEST_AAD_SIZE, tb->aad, tb->size + B5_POLY1305_TAG_SIZE, tb->buf_enc, &dataout_len, tb->buf_hw);
+	tb->aad[0] ^= 0x01;
+	if (SE3_ERR_AUTH != r || dataout_len != 0) {
+		return false;
+	}
+	// no unauthenticated plaintext is left in the output
+	for (i = 0; i < tb->size; i++) {
+		if (tb->buf_hw[i] != 0 && tb->buf_hw[i] != 0xFF) {
+			return false;
+		}
+	}
+	return true;
+}
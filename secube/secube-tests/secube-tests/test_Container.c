@@ -0,0 +1,161 @@
+#include "tests.h"
+#include "L1_container.h"
+
+typedef struct {
+	uint8_t* data;
+	size_t len;
+	size_t size;
+} mem_file;
+
+static bool mem_write(void* ctx, const uint8_t* buf, size_t len);
+static bool mem_read(void* ctx, uint64_t offset, uint8_t* buf, size_t len);
+static bool test_container(se3_session* s, uint16_t algorithm, uint32_t key_id, uint8_t* buf, size_t size);
+
+
+bool test_Container(se3_session* s)
+{
+	enum {
+		TEST_SIZE = 1 * 1024 * 1024,
+		KEY_ID = 530
+	};
+	uint16_t r;
+	uint8_t* buf = NULL;
+	uint8_t key_data[B5_AES_256];
+	bool success = false;
+	size_t rep;
+
+	se3_key key = { KEY_ID, (uint32_t)time(0) + 365 * 24 * 3600, B5_AES_256, 5, {0}, key_data, "tcnt0" };
+
+	test_randbuf(TEST_SIZE, &buf);
+
+	se3c_rand(B5_AES_256, key_data);
+	r = L1_key_edit(s, SE3_KEY_OP_UPSERT, &key);
+	if (r != SE3_OK) {
+		printf("Error inserting keys\n");
+		goto cleanup;
+	}
+
+	printf("Container AES-256-GCM ");
+	for (rep = 0; rep < NRUN; rep++) {
+		if (!test_container(s, SE3_ALGO_AES_GCM, KEY_ID, buf, TEST_SIZE)) {
+			goto cleanup;
+		}
+		printf(" ");
+	}
+	printf("\n");
+
+	success = true;
+cleanup:
+	free(buf);
+	return success;
+}
+
+
+
+static bool mem_write(void* ctx, const uint8_t* buf, size_t len)
+{
+	mem_file* f = (mem_file*)ctx;
+	if (f->len + len > f->size) {
+		return false;
+	}
+	memcpy(f->data + f->len, buf, len);
+	f->len += len;
+	return true;
+}
+
+static bool mem_read(void* ctx, uint64_t offset, uint8_t* buf, size_t len)
+{
+	mem_file* f = (mem_file*)ctx;
+	if (offset > f->len || len > f->len - offset) {
+		return false;
+	}
+	memcpy(buf, f->data + offset, len);
+	return true;
+}
+
+static bool test_container(se3_session* s, uint16_t algorithm, uint32_t key_id, uint8_t* buf, size_t size)
+{
+	enum {
+		CHUNK_SIZE = 16 * 1024,
+		N_READS = 16
+	};
+	L1_container c;
+	mem_file f = { NULL, 0, 0 };
+	uint8_t* out = (uint8_t*)malloc(size);
+	size_t off, len, read_len;
+	bool success = false;
+	int i;
+	stopwatch sw;
+
+	// a tag and an index entry for each chunk
+	f.size = L1_CONTAINER_HEADER_SIZE + size + (size / CHUNK_SIZE + 1) * (SE3_CRYPTO_AEAD_TAG_SIZE + 8) + L1_CONTAINER_FOOTER_SIZE;
+	f.data = (uint8_t*)malloc(f.size);
+	if (f.data == NULL || out == NULL) {
+		goto cleanup;
+	}
+
+	// written in pieces that do not match the chunks
+	stopwatch_start(&sw);
+	if (SE3_OK != L1_container_create(&c, &s, 1, algorithm, key_id, CHUNK_SIZE, mem_write, &f)) {
+		goto cleanup;
+	}
+	for (off = 0; off < size; off += len) {
+		len = (size - off < 3000) ? size - off : 3000;
+		if (SE3_OK != L1_container_write(&c, len, buf + off)) {
+			L1_container_close(&c);
+			goto cleanup;
+		}
+	}
+	if (SE3_OK != L1_container_close(&c)) {
+		goto cleanup;
+	}
+	stopwatch_stop(&sw);
+
+	if (SE3_OK != L1_container_open(&c, &s, 1, mem_read, &f, f.len)) {
+		goto cleanup;
+	}
+	if (L1_container_size(&c) != size) {
+		L1_container_close(&c);
+		goto cleanup;
+	}
+	if ((SE3_OK != L1_container_read(&c, 0, size, out, &read_len)) || read_len != size || memcmp(out, buf, size)) {
+		L1_container_close(&c);
+		goto cleanup;
+	}
+
+	// random access, ranges across the chunk boundaries
+	for (i = 0; i < N_READS; i++) {
+		off = (size_t)rand() % size;
+		len = (size_t)rand() % (3 * CHUNK_SIZE);
+		if ((SE3_OK != L1_container_read(&c, off, len, out, &read_len)) ||
+			read_len != ((len < size - off) ? len : size - off) || memcmp(out, buf + off, read_len))
+		{
+			L1_container_close(&c);
+			goto cleanup;
+		}
+	}
+	L1_container_close(&c);
+
+	// a modified chunk fails when read
+	f.data[L1_CONTAINER_HEADER_SIZE + 1] ^= 1;
+	if (SE3_OK != L1_container_open(&c, &s, 1, mem_read, &f, f.len)) {
+		goto cleanup;
+	}
+	if (SE3_ERR_AUTH != L1_container_read(&c, 0, 16, out, &read_len)) {
+		L1_container_close(&c);
+		goto cleanup;
+	}
+	L1_container_close(&c);
+
+	// the last chunk cannot be dropped
+	if (SE3_ERR_PARAMS != L1_container_open(&c, &s, 1, mem_read, &f, f.len - CHUNK_SIZE)) {
+		goto cleanup;
+	}
+
+	test_printspeed(&sw, size);
+	success = true;
+cleanup:
+	free(f.data);
+	free(out);
+	return success;
+}
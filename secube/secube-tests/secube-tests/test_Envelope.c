@@ -0,0 +1,165 @@
+#include "tests.h"
+
+static bool test_keys(se3_envelope* env, const uint8_t* kek_data);
+static bool test_objects(se3_envelope* env, uint8_t* buf, size_t size);
+
+
+bool test_Envelope(se3_session* s)
+{
+	enum {
+		TEST_SIZE = 1 * 1024 * 1024,
+		KEY_ID_KEK = 520
+	};
+	uint16_t r;
+	uint8_t* buf = NULL;
+	uint8_t kek_data[B5_AES_256];
+	se3_envelope env;
+	bool success = false;
+	size_t rep;
+
+	se3_key kek = { KEY_ID_KEK, (uint32_t)time(0) + 365 * 24 * 3600, B5_AES_256, 5, {0}, kek_data, "tkek0" };
+
+	test_randbuf(TEST_SIZE, &buf);
+
+	se3c_rand(B5_AES_256, kek_data);
+	r = L1_key_edit(s, SE3_KEY_OP_UPSERT, &kek);
+	if (r != SE3_OK) {
+		printf("Error inserting keys\n");
+		goto cleanup;
+	}
+
+	r = L1_envelope_init(s, KEY_ID_KEK, &env);
+	if (r != SE3_OK) {
+		goto cleanup;
+	}
+
+	printf("Envelope AES-KW + AES-256-GCM ");
+	if (!test_keys(&env, kek_data)) {
+		L1_envelope_close(&env);
+		goto cleanup;
+	}
+	for (rep = 0; rep < NRUN; rep++) {
+		if (!test_objects(&env, buf, TEST_SIZE)) {
+			L1_envelope_close(&env);
+			goto cleanup;
+		}
+		printf(" ");
+	}
+	printf("\n");
+
+	success = (SE3_OK == L1_envelope_close(&env));
+cleanup:
+	free(buf);
+	return success;
+}
+
+
+
+static bool test_keys(se3_envelope* env, const uint8_t* kek_data)
+{
+	uint8_t key[SE3_CRYPTO_KW_MAX_KEY];
+	uint8_t unwrapped[SE3_CRYPTO_KW_MAX_KEY];
+	uint8_t wrapped[SE3_CRYPTO_KW_MAX_KEY + SE3_CRYPTO_KW_OVERHEAD];
+	uint8_t wrapped_sw[SE3_CRYPTO_KW_MAX_KEY + SE3_CRYPTO_KW_OVERHEAD];
+	B5_tKwAesCtx ctx;
+	uint8_t size_req[2];
+	uint16_t size;
+
+	B5_KwAes256_Init(&ctx, kek_data, B5_AES_256);
+	for (size = SE3_CRYPTO_KW_MIN_KEY; size <= SE3_CRYPTO_KW_MAX_KEY; size += 8 * SE3_CRYPTO_KW_ALIGN) {
+		// generated on the device, wrapped under the KEK
+		if (SE3_OK != L1_envelope_new_key(env, size, key, wrapped)) {
+			return false;
+		}
+		B5_KwAes256_Wrap(&ctx, wrapped_sw, key, size);
+		if (memcmp(wrapped, wrapped_sw, size + SE3_CRYPTO_KW_OVERHEAD)) {
+			return false;
+		}
+
+		// wrapped on the device, unwrapped on the host, and the other way round
+		se3c_rand(size, key);
+		if (SE3_OK != L1_envelope_wrap_key(env, size, key, wrapped)) {
+			return false;
+		}
+		if ((B5_KW_AES256_RES_OK != B5_KwAes256_Unwrap(&ctx, unwrapped, wrapped, size + SE3_CRYPTO_KW_OVERHEAD)) ||
+			memcmp(unwrapped, key, size))
+		{
+			return false;
+		}
+		if ((SE3_OK != L1_envelope_unwrap_key(env, size + SE3_CRYPTO_KW_OVERHEAD, wrapped, unwrapped)) ||
+			memcmp(unwrapped, key, size))
+		{
+			return false;
+		}
+
+		// clear keys are refused to requests that are not encrypted and signed
+		if (SE3_ERR_ACCESS != L1_crypto_update(env->s, env->sess_id, 0, 0, NULL, size + SE3_CRYPTO_KW_OVERHEAD, wrapped, NULL, NULL)) {
+			return false;
+		}
+		SE3_SET16(size_req, 0, size);
+		if (SE3_ERR_ACCESS != L1_crypto_update(env->s, env->sess_id, SE3_CRYPTO_FLAG_GENKEY, sizeof(size_req), size_req, 0, NULL, NULL, NULL)) {
+			return false;
+		}
+
+		wrapped[size / 2] ^= 1;
+		if (SE3_ERR_AUTH != L1_envelope_unwrap_key(env, size + SE3_CRYPTO_KW_OVERHEAD, wrapped, unwrapped)) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+
+
+static bool test_objects(se3_envelope* env, uint8_t* buf, size_t size)
+{
+	uint8_t aad[16];
+	uint8_t* sealed = (uint8_t*)malloc(size + SE3_ENVELOPE_OVERHEAD);
+	uint8_t* opened = (uint8_t*)malloc(size);
+	size_t sealed_len = 0, opened_len = 0;
+	bool success = false;
+	stopwatch sw;
+
+	if (sealed == NULL || opened == NULL) {
+		goto cleanup;
+	}
+	se3c_rand(sizeof(aad), aad);
+
+	stopwatch_start(&sw);
+	if (SE3_OK != L1_envelope_seal(env, sizeof(aad), aad, size, buf, &sealed_len, sealed)) {
+		goto cleanup;
+	}
+	stopwatch_stop(&sw);
+	if (sealed_len != size + SE3_ENVELOPE_OVERHEAD) {
+		goto cleanup;
+	}
+
+	if ((SE3_OK != L1_envelope_open(env, sizeof(aad), aad, sealed_len, sealed, &opened_len, opened)) ||
+		(opened_len != size) || memcmp(opened, buf, size))
+	{
+		goto cleanup;
+	}
+
+	// the cipher text, the wrapped key and the additional data are all authenticated
+	sealed[sealed_len / 2] ^= 1;
+	if (SE3_ERR_AUTH != L1_envelope_open(env, sizeof(aad), aad, sealed_len, sealed, &opened_len, opened)) {
+		goto cleanup;
+	}
+	sealed[sealed_len / 2] ^= 1;
+	sealed[0] ^= 1;
+	if (SE3_ERR_AUTH != L1_envelope_open(env, sizeof(aad), aad, sealed_len, sealed, &opened_len, opened)) {
+		goto cleanup;
+	}
+	sealed[0] ^= 1;
+	if (SE3_ERR_AUTH != L1_envelope_open(env, sizeof(aad) - 1, aad, sealed_len, sealed, &opened_len, opened)) {
+		goto cleanup;
+	}
+
+	test_printspeed(&sw, size);
+	success = true;
+cleanup:
+	free(sealed);
+	free(opened);
+	return success;
+}
@@ -0,0 +1,589 @@
+#include "tests.h"
+
+enum {
+	KEYS_FIRST_ID = 1000,  ///< first ID used by these tests, the keys are deleted at the end
+	KEYS_DATA_SIZE = 32
+};
+
+static void key_fill(se3_key* key, uint32_t id, uint8_t* data, uint16_t data_size, uint8_t version);
+static uint16_t key_import(se3_session* s, uint16_t op, const se3_key* keys, size_t n, size_t* count);
+static bool key_check(se3_session* s, const se3_key* key);
+static bool keys_delete(se3_session* s, uint32_t first, size_t n);
+static bool test_import(se3_session* s);
+static bool test_compaction(se3_session* s);
+static bool test_cursor(se3_session* s);
+static bool test_fingerprints(se3_session* s);
+static bool test_capacity(se3_session* s);
+
+
+bool test_Keys(se3_session* s)
+{
+	if (!test_import(s)) {
+		return false;
+	}
+	if (!test_compaction(s)) {
+		return false;
+	}
+	if (!test_cursor(s)) {
+		return false;
+	}
+	if (!test_fingerprints(s)) {
+		return false;
+	}
+	if (!test_capacity(s)) {
+		return false;
+	}
+	return true;
+}
+
+
+
+/* Key with data depending on its ID and version */
+static void key_fill(se3_key* key, uint32_t id, uint8_t* data, uint16_t data_size, uint8_t version)
+{
+	size_t i;
+
+	for (i = 0; i < data_size; i++) {
+		data[i] = (uint8_t)(id * 7 + i + version * 31);
+	}
+	memset(key, 0, sizeof(se3_key));
+	key->id = id;
+	key->validity = (uint32_t)time(0) + 365 * 24 * 3600;
+	key->data_size = data_size;
+	key->data = data;
+	key->name_size = (uint16_t)sprintf((char*)key->name, "tkey%u", (unsigned)id);
+}
+
+/* Import keys through a key file */
+static uint16_t key_import(se3_session* s, uint16_t op, const se3_key* keys, size_t n, size_t* count)
+{
+	uint8_t header[SE3_CMD1_KEY_IMPORT_KEY_OFF_DATA_AND_NAME];
+	FILE* fp = tmpfile();
+	uint16_t r;
+	size_t i;
+
+	if (fp == NULL) {
+		return SE3_ERR_RESOURCE;
+	}
+	for (i = 0; i < n; i++) {
+		SE3_SET32(header, SE3_CMD1_KEY_IMPORT_KEY_OFF_ID, keys[i].id);
+		SE3_SET32(header, SE3_CMD1_KEY_IMPORT_KEY_OFF_VALIDITY, keys[i].validity);
+		SE3_SET16(header, SE3_CMD1_KEY_IMPORT_KEY_OFF_DATA_LEN, keys[i].data_size);
+		SE3_SET16(header, SE3_CMD1_KEY_IMPORT_KEY_OFF_NAME_LEN, keys[i].name_size);
+		fwrite(header, 1, sizeof(header), fp);
+		fwrite(keys[i].data, 1, keys[i].data_size, fp);
+		fwrite(keys[i].name, 1, keys[i].name_size, fp);
+	}
+	rewind(fp);
+	r = L1_key_import(s, op, fp, count);
+	fclose(fp);
+	return r;
+}
+
+/* The device stores the key with the same name, validity and value */
+static bool key_check(se3_session* s, const se3_key* key)
+{
+	uint8_t salt[SE3_KEY_SALT_SIZE];
+	se3_key info;
+
+	se3c_rand(SE3_KEY_SALT_SIZE, salt);
+	if (SE3_OK != L1_key_get_info(s, key->id, salt, &info)) {
+		return false;
+	}
+	if (info.id != key->id || info.validity != key->validity || info.data_size != key->data_size ||
+		info.name_size != key->name_size || memcmp(info.name, key->name, key->name_size))
+	{
+		return false;
+	}
+	info.data = key->data;
+	return L1_key_verify(&info, 1, salt, NULL);
+}
+
+/* Delete the keys with n consecutive IDs, if they exist */
+static bool keys_delete(se3_session* s, uint32_t first, size_t n)
+{
+	se3_key key;
+	uint16_t r;
+	size_t i;
+
+	memset(&key, 0, sizeof(se3_key));
+	for (i = 0; i < n; i++) {
+		key.id = first + (uint32_t)i;
+		r = L1_key_edit(s, SE3_KEY_OP_DELETE, &key);
+		if (r != SE3_OK && r != SE3_ERR_RESOURCE) {
+			return false;
+		}
+	}
+	return true;
+}
+
+/* Keys imported over several requests: an INSERT request is rejected as a whole if one of its
+   keys exists, UPSERT skips the keys stored with the same value and replaces the others */
+static bool test_import(se3_session* s)
+{
+	enum {
+		N_KEYS = 2 * SE3_CMD1_KEY_IMPORT_MAX + 44
+	};
+	se3_key* keys = (se3_key*)malloc((N_KEYS + 1) * sizeof(se3_key));
+	uint8_t* data = (uint8_t*)malloc((N_KEYS + 1) * KEYS_DATA_SIZE);
+	size_t i, count = 0;
+	bool success = false;
+
+	if (keys == NULL || data == NULL || !keys_delete(s, KEYS_FIRST_ID, N_KEYS + 1)) {
+		goto cleanup;
+	}
+	for (i = 0; i <= N_KEYS; i++) {
+		key_fill(&keys[i], KEYS_FIRST_ID + (uint32_t)i, data + i * KEYS_DATA_SIZE, KEYS_DATA_SIZE, 0);
+	}
+
+	printf("Keys import ");
+	if (SE3_OK != key_import(s, SE3_KEY_OP_INSERT, keys, N_KEYS, &count) || count != N_KEYS) {
+		printf("insert FAIL\n");
+		goto cleanup;
+	}
+	for (i = 0; i < N_KEYS; i++) {
+		if (!key_check(s, &keys[i])) {
+			printf("key %u FAIL\n", (unsigned)keys[i].id);
+			goto cleanup;
+		}
+	}
+
+	// the new key is in the same request as an existing one
+	if (SE3_ERR_RESOURCE != key_import(s, SE3_KEY_OP_INSERT, keys + N_KEYS - 1, 2, &count) ||
+		SE3_ERR_RESOURCE != L1_key_get_info(s, keys[N_KEYS].id, NULL, NULL))
+	{
+		printf("insert conflict FAIL\n");
+		goto cleanup;
+	}
+
+	if (SE3_OK != key_import(s, SE3_KEY_OP_UPSERT, keys, N_KEYS, &count) || count != 0) {
+		printf("upsert equal FAIL\n");
+		goto cleanup;
+	}
+	for (i = 0; i < N_KEYS; i += 2) {
+		key_fill(&keys[i], keys[i].id, data + i * KEYS_DATA_SIZE, KEYS_DATA_SIZE, 1);
+	}
+	if (SE3_OK != key_import(s, SE3_KEY_OP_UPSERT, keys, N_KEYS, &count) || count != N_KEYS / 2) {
+		printf("upsert FAIL\n");
+		goto cleanup;
+	}
+	for (i = 0; i < N_KEYS; i++) {
+		if (!key_check(s, &keys[i])) {
+			printf("key %u FAIL\n", (unsigned)keys[i].id);
+			goto cleanup;
+		}
+	}
+	printf("%u keys\n", (unsigned)N_KEYS);
+
+	success = true;
+cleanup:
+	success = keys_delete(s, KEYS_FIRST_ID, N_KEYS + 1) && success;
+	free(keys);
+	free(data);
+	return success;
+}
+
+/* Keys rewritten until their old values have filled the flash twice: the sectors are collected,
+   in the background while the device is idle, and no key is lost or damaged */
+static bool test_compaction(se3_session* s)
+{
+	enum {
+		N_KEYS = 16,
+		DATA_SIZE = 1024
+	};
+	se3_key keys[N_KEYS];
+	uint8_t* data = (uint8_t*)malloc(N_KEYS * DATA_SIZE);
+	se3_stats before, after;
+	size_t i, k, n_writes;
+	bool success = false;
+
+	if (data == NULL || !keys_delete(s, KEYS_FIRST_ID, N_KEYS)) {
+		goto cleanup;
+	}
+	if (SE3_OK != L0_stats(&(s->device), false, &before)) {
+		goto cleanup;
+	}
+
+	printf("Keys compaction ");
+	n_writes = 2 * (size_t)before.flash_capacity / DATA_SIZE;
+	for (i = 0; i < n_writes; i++) {
+		k = i % N_KEYS;
+		key_fill(&keys[k], KEYS_FIRST_ID + (uint32_t)k, data + k * DATA_SIZE, DATA_SIZE, (uint8_t)(i / N_KEYS));
+		if (SE3_OK != L1_key_edit(s, SE3_KEY_OP_UPSERT, &keys[k])) {
+			printf("write %u FAIL\n", (unsigned)i);
+			goto cleanup;
+		}
+	}
+	for (k = 0; k < N_KEYS; k++) {
+		if (!key_check(s, &keys[k])) {
+			printf("key %u FAIL\n", (unsigned)keys[k].id);
+			goto cleanup;
+		}
+	}
+	if (SE3_OK != L0_stats(&(s->device), false, &after) || after.flash_swaps <= before.flash_swaps) {
+		printf("no sector collected FAIL\n");
+		goto cleanup;
+	}
+	printf("%u writes, %u sectors collected\n", (unsigned)n_writes, (unsigned)(after.flash_swaps - before.flash_swaps));
+
+	success = true;
+cleanup:
+	success = keys_delete(s, KEYS_FIRST_ID, N_KEYS) && success;
+	free(data);
+	return success;
+}
+
+/* Keys listed in pages while other keys are rewritten between the pages, until the rewrites have
+   filled the flash twice: each listing that is not expired returns every stable key once, and a
+   listing expires only because a write had to collect and erase a sector */
+static bool test_cursor(se3_session* s)
+{
+	enum {
+		N_STABLE = 100,
+		N_CHURN = 8,
+		CHURN_ID = KEYS_FIRST_ID + N_STABLE,
+		CHURN_SIZE = 1024,
+		PAGE_KEYS = 7,
+		PAGE_WRITES = 4
+	};
+	se3_key* keys = (se3_key*)malloc(N_STABLE * sizeof(se3_key));
+	uint8_t* data = (uint8_t*)malloc(N_STABLE * KEYS_DATA_SIZE + N_CHURN * CHURN_SIZE);
+	uint8_t* churn_data;
+	uint8_t seen[N_STABLE];
+	se3_key page[PAGE_KEYS];
+	se3_key churn;
+	se3_stats before, after;
+	uint64_t cursor = SE3_KEY_LIST_CURSOR_START;
+	uint32_t erases;
+	uint16_t r, count, j;
+	size_t i, k, writes = 0, n_writes, listings = 0, expired = 0;
+	bool success = false;
+
+	if (keys == NULL || data == NULL || !keys_delete(s, KEYS_FIRST_ID, N_STABLE + N_CHURN)) {
+		goto cleanup;
+	}
+	churn_data = data + N_STABLE * KEYS_DATA_SIZE;
+	for (i = 0; i < N_STABLE; i++) {
+		key_fill(&keys[i], KEYS_FIRST_ID + (uint32_t)i, data + i * KEYS_DATA_SIZE, KEYS_DATA_SIZE, 0);
+	}
+	if (SE3_OK != key_import(s, SE3_KEY_OP_INSERT, keys, N_STABLE, NULL)) {
+		goto cleanup;
+	}
+	if (SE3_OK != L0_stats(&(s->device), false, &before)) {
+		goto cleanup;
+	}
+
+	printf("Keys cursor ");
+	n_writes = 2 * (size_t)before.flash_capacity / CHURN_SIZE;
+	memset(seen, 0, sizeof(seen));
+	erases = before.flash_erases;
+	// the listings that follow the last write are not expired
+	while (writes < n_writes || cursor != SE3_KEY_LIST_CURSOR_START || listings == 0) {
+		r = L1_key_list_next(s, &cursor, PAGE_KEYS, NULL, page, &count);
+		if (r == SE3_ERR_EXPIRED) {
+			// only a write that ran out of space can move the keys during a listing
+			if (SE3_OK != L0_stats(&(s->device), false, &after) || after.flash_erases == erases) {
+				printf("expired without a collection FAIL\n");
+				goto cleanup;
+			}
+			expired++;
+			cursor = SE3_KEY_LIST_CURSOR_START;
+			memset(seen, 0, sizeof(seen));
+			continue;
+		}
+		if (r != SE3_OK) {
+			printf("list FAIL\n");
+			goto cleanup;
+		}
+		for (j = 0; j < count; j++) {
+			if (page[j].id >= KEYS_FIRST_ID && page[j].id < KEYS_FIRST_ID + N_STABLE) {
+				seen[page[j].id - KEYS_FIRST_ID]++;
+			}
+		}
+		if (count == 0) {
+			for (i = 0; i < N_STABLE; i++) {
+				if (seen[i] != 1) {
+					printf("key %u listed %u times FAIL\n", (unsigned)keys[i].id, (unsigned)seen[i]);
+					goto cleanup;
+				}
+			}
+			listings++;
+			cursor = SE3_KEY_LIST_CURSOR_START;
+			memset(seen, 0, sizeof(seen));
+			continue;
+		}
+
+		if (SE3_OK != L0_stats(&(s->device), false, &after)) {
+			goto cleanup;
+		}
+		erases = after.flash_erases;
+		for (i = 0; i < PAGE_WRITES && writes < n_writes; i++, writes++) {
+			k = writes % N_CHURN;
+			key_fill(&churn, CHURN_ID + (uint32_t)k, churn_data + k * CHURN_SIZE, CHURN_SIZE, (uint8_t)(writes / N_CHURN));
+			if (SE3_OK != L1_key_edit(s, SE3_KEY_OP_UPSERT, &churn)) {
+				printf("write FAIL\n");
+				goto cleanup;
+			}
+		}
+	}
+	if (SE3_OK != L0_stats(&(s->device), false, &after) || after.flash_swaps <= before.flash_swaps || listings == 0) {
+		printf("no sector collected FAIL\n");
+		goto cleanup;
+	}
+	printf("%u listings, %u expired, %u sectors collected\n", (unsigned)listings, (unsigned)expired,
+		(unsigned)(after.flash_swaps - before.flash_swaps));
+
+	success = true;
+cleanup:
+	success = keys_delete(s, KEYS_FIRST_ID, N_STABLE + N_CHURN) && success;
+	free(keys);
+	free(data);
+	return success;
+}
+
+/* The fingerprints cached by the device for a salt follow the key edits and deletions, and a
+   KEY_GET_INFO without a salt returns no fingerprint */
+static bool test_fingerprints(se3_session* s)
+{
+	enum {
+		N_KEYS = 20,
+		EDITED = 3,
+		DELETED = 11
+	};
+	se3_key keys[N_KEYS];
+	se3_key list[N_KEYS];
+	se3_key info;
+	uint8_t data[N_KEYS * KEYS_DATA_SIZE];
+	uint8_t salt[SE3_KEY_SALT_SIZE];
+	uint8_t zero[SE3_KEY_FINGERPRINT_SIZE];
+	uint64_t cursor;
+	uint16_t count, found, j;
+	size_t i, pass;
+	bool success = false;
+
+	if (!keys_delete(s, KEYS_FIRST_ID, N_KEYS)) {
+		goto cleanup;
+	}
+	for (i = 0; i < N_KEYS; i++) {
+		key_fill(&keys[i], KEYS_FIRST_ID + (uint32_t)i, data + i * KEYS_DATA_SIZE, KEYS_DATA_SIZE, 0);
+	}
+	if (SE3_OK != key_import(s, SE3_KEY_OP_INSERT, keys, N_KEYS, NULL)) {
+		goto cleanup;
+	}
+	se3c_rand(SE3_KEY_SALT_SIZE, salt);
+	memset(zero, 0, sizeof(zero));
+
+	printf("Keys fingerprints ");
+	// listed once to fill the cache, then after an edit and a deletion
+	for (pass = 0; pass < 3; pass++) {
+		if (pass == 1) {
+			key_fill(&keys[EDITED], keys[EDITED].id, data + EDITED * KEYS_DATA_SIZE, KEYS_DATA_SIZE, 1);
+			if (SE3_OK != L1_key_edit(s, SE3_KEY_OP_UPSERT, &keys[EDITED])) {
+				goto cleanup;
+			}
+		}
+		if (pass == 2 && SE3_OK != L1_key_edit(s, SE3_KEY_OP_DELETE, &keys[DELETED])) {
+			goto cleanup;
+		}
+		found = 0;
+		cursor = SE3_KEY_LIST_CURSOR_START;
+		do {
+			if (SE3_OK != L1_key_list_next(s, &cursor, N_KEYS, salt, list, &count)) {
+				printf("list FAIL\n");
+				goto cleanup;
+			}
+			for (j = 0; j < count; j++) {
+				if (list[j].id < KEYS_FIRST_ID || list[j].id >= KEYS_FIRST_ID + N_KEYS) {
+					continue;
+				}
+				i = list[j].id - KEYS_FIRST_ID;
+				list[j].data = keys[i].data;
+				if ((pass == 2 && i == DELETED) || !L1_key_verify(&list[j], 1, salt, NULL)) {
+					printf("key %u pass %u FAIL\n", (unsigned)list[j].id, (unsigned)pass);
+					goto cleanup;
+				}
+				found++;
+			}
+		} while (count > 0);
+		if (found != ((pass == 2) ? (N_KEYS - 1) : (N_KEYS))) {
+			printf("pass %u FAIL\n", (unsigned)pass);
+			goto cleanup;
+		}
+	}
+
+	if (SE3_ERR_RESOURCE != L1_key_get_info(s, keys[DELETED].id, salt, NULL) ||
+		SE3_OK != L1_key_get_info(s, keys[EDITED].id, NULL, &info) ||
+		memcmp(info.fingerprint, zero, sizeof(zero)) || !key_check(s, &keys[EDITED]))
+	{
+		printf("get info FAIL\n");
+		goto cleanup;
+	}
+	printf("OK\n");
+
+	success = true;
+cleanup:
+	success = keys_delete(s, KEYS_FIRST_ID, N_KEYS) && success;
+	return success;
+}
+
+/* More keys than the 2016 blocks of the two-sector layout: all of them are stored and listed, and
+   the space is given back when they are deleted */
+static bool test_capacity(se3_session* s)
+{
+	enum {
+		N_KEYS = 3000,
+		N_CHECKS = 50
+	};
+	se3_key* keys = (se3_key*)malloc(N_KEYS * sizeof(se3_key));
+	uint8_t* data = (uint8_t*)malloc(N_KEYS * KEYS_DATA_SIZE);
+	uint8_t* seen = (uint8_t*)calloc(N_KEYS, 1);
+	se3_key page[SE3_CMD1_KEY_IMPORT_MAX];
+	se3_stats before, after;
+	uint64_t cursor = SE3_KEY_LIST_CURSOR_START;
+	uint16_t count, j;
+	size_t i, imported = 0;
+	bool success = false;
+
+	if (keys == NULL || data == NULL || seen == NULL || !keys_delete(s, KEYS_FIRST_ID, N_KEYS)) {
+		goto cleanup;
+	}
+	if (SE3_OK != L0_stats(&(s->device), false, &before)) {
+		goto cleanup;
+	}
+	for (i = 0; i < N_KEYS; i++) {
+		key_fill(&keys[i], KEYS_FIRST_ID + (uint32_t)i, data + i * KEYS_DATA_SIZE, KEYS_DATA_SIZE, 0);
+	}
+
+	printf("Keys capacity ");
+	if (SE3_OK != key_import(s, SE3_KEY_OP_INSERT, keys, N_KEYS, &imported) || imported != N_KEYS) {
+		printf("import FAIL\n");
+		goto cleanup;
+	}
+	do {
+		if (SE3_OK != L1_key_list_next(s, &cursor, SE3_CMD1_KEY_IMPORT_MAX, NULL, page, &count)) {
+			printf("list FAIL\n");
+			goto cleanup;
+		}
+		for (j = 0; j < count; j++) {
+			if (page[j].id >= KEYS_FIRST_ID && page[j].id < KEYS_FIRST_ID + N_KEYS) {
+				seen[page[j].id - KEYS_FIRST_ID]++;
+			}
+		}
+	} while (count > 0);
+	for (i = 0; i < N_KEYS; i++) {
+		if (seen[i] != 1) {
+			printf("key %u listed %u times FAIL\n", (unsigned)keys[i].id, (unsigned)seen[i]);
+			goto cleanup;
+		}
+	}
+	for (i = 0; i < N_KEYS; i += N_KEYS / N_CHECKS) {
+		if (!key_check(s, &keys[i])) {
+			printf("key %u FAIL\n", (unsigned)keys[i].id);
+			goto cleanup;
+		}
+	}
+	if (!keys_delete(s, KEYS_FIRST_ID, N_KEYS) || SE3_OK != L0_stats(&(s->device), false, &after) ||
+		after.flash_used != before.flash_used)
+	{
+		printf("delete FAIL\n");
+		goto cleanup;
+	}
+	printf("%u keys, %u KB available\n", (unsigned)N_KEYS, (unsigned)(before.flash_capacity / 1024));
+
+	success = true;
+cleanup:
+	success = keys_delete(s, KEYS_FIRST_ID, N_KEYS) && success;
+	free(keys);
+	free(data);
+	free(seen);
+	return success;
+}
+
+/* A new user PIN is used by the next login, and replacing a PIN record that the garbage collector
+   has moved deletes the moved copy; runs logged out, with the PIN of the test device */
+bool test_Records(se3_device* dev)
+{
+	enum {
+		N_KEYS = 16,
+		DATA_SIZE = 1024
+	};
+	uint8_t pin[SE3_PIN_SIZE] = { 'c','i','a','o' };
+	uint8_t pin2[SE3_PIN_SIZE] = { 'r','e','c','o','r','d' };
+	se3_session s;
+	se3_key key;
+	se3_stats before, after;
+	uint8_t* data = (uint8_t*)malloc(DATA_SIZE);
+	bool logged_in = false, pin_changed = false;
+	bool success = false;
+	size_t i, n_writes;
+
+	if (data == NULL || SE3_OK != L1_login(&s, dev, pin, SE3_ACCESS_ADMIN)) {
+		goto cleanup;
+	}
+	logged_in = true;
+
+	printf("Records ");
+	if (SE3_OK != L1_set_user_PIN(&s, pin2)) {
+		goto cleanup;
+	}
+	pin_changed = true;
+	L1_logout(&s);
+	logged_in = false;
+	if (SE3_ERR_PIN != L1_login(&s, dev, pin, SE3_ACCESS_USER)) {
+		printf("old PIN FAIL\n");
+		goto cleanup;
+	}
+	if (SE3_OK != L1_login(&s, dev, pin2, SE3_ACCESS_USER)) {
+		printf("new PIN FAIL\n");
+		goto cleanup;
+	}
+	L1_logout(&s);
+
+	if (SE3_OK != L1_login(&s, dev, pin, SE3_ACCESS_ADMIN)) {
+		goto cleanup;
+	}
+	logged_in = true;
+	if (!keys_delete(&s, KEYS_FIRST_ID, N_KEYS) || SE3_OK != L0_stats(dev, false, &before)) {
+		goto cleanup;
+	}
+	// the record nodes are moved when their sectors are collected
+	n_writes = (size_t)before.flash_capacity / DATA_SIZE;
+	for (i = 0; i < n_writes; i++) {
+		key_fill(&key, KEYS_FIRST_ID + (uint32_t)(i % N_KEYS), data, DATA_SIZE, (uint8_t)(i / N_KEYS));
+		if (SE3_OK != L1_key_edit(&s, SE3_KEY_OP_UPSERT, &key)) {
+			goto cleanup;
+		}
+	}
+	if (!keys_delete(&s, KEYS_FIRST_ID, N_KEYS) || SE3_OK != L1_set_user_PIN(&s, pin)) {
+		goto cleanup;
+	}
+	pin_changed = false;
+	if (SE3_OK != L0_stats(dev, false, &after) || after.flash_swaps == before.flash_swaps ||
+		after.flash_used != before.flash_used)
+	{
+		printf("record replaced after a collection FAIL\n");
+		goto cleanup;
+	}
+	L1_logout(&s);
+	logged_in = false;
+	if (SE3_OK != L1_login(&s, dev, pin, SE3_ACCESS_USER)) {
+		printf("restored PIN FAIL\n");
+		goto cleanup;
+	}
+	logged_in = true;
+	printf("OK\n");
+
+	success = true;
+cleanup:
+	if (!logged_in && pin_changed && SE3_OK == L1_login(&s, dev, pin, SE3_ACCESS_ADMIN)) {
+		logged_in = true;
+	}
+	if (logged_in && pin_changed) {
+		L1_set_user_PIN(&s, pin);
+	}
+	if (logged_in) {
+		L1_logout(&s);
+	}
+	free(data);
+	return success;
+}
@@ -0,0 +1,41 @@
+#include "tests.h"
+
+/* Host cost of a request next to the round trip of the smallest one: the command token and
+   the IV drawn by L0_TX and L1_TXRX, then a one byte echo. */
+bool test_L0_overhead(se3_device* dev)
+{
+	enum {
+		N_RAND = 100000,
+		N_ECHO = 1000
+	};
+	uint8_t token[4];
+	uint8_t iv[SE3_IV_SIZE];
+	uint8_t sendbuf[1] = { 0x5A };
+	uint8_t recvbuf[1] = { 0 };
+	uint16_t r = SE3_OK;
+	size_t i;
+	stopwatch sw;
+	double t_rand, t_echo;
+
+	stopwatch_start(&sw);
+	for (i = 0; i < N_RAND; i++) {
+		se3c_rand(sizeof(token), token);
+		se3c_rand(sizeof(iv), iv);
+	}
+	stopwatch_stop(&sw);
+	t_rand = stopwatch_gettime(&sw) / N_RAND;
+
+	stopwatch_start(&sw);
+	for (i = 0; i < N_ECHO; i++) {
+		r = L0_echo(dev, sendbuf, sizeof(sendbuf), recvbuf);
+		if (SE3_OK != r || recvbuf[0] != sendbuf[0]) {
+			return false;
+		}
+	}
+	stopwatch_stop(&sw);
+	t_echo = stopwatch_gettime(&sw) / N_ECHO;
+
+	printf("L0 OVERHEAD token+IV %.3f us, echo %.3f us\n", t_rand * 1e6, t_echo * 1e6);
+
+	return true;
+}
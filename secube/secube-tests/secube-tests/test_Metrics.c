@@ -0,0 +1,71 @@
+#include "tests.h"
+
+/* Host metrics: echo requests fill the L0 histograms and show up in the Prometheus text */
+bool test_Metrics(se3_device* dev)
+{
+	enum {
+		N_ECHO = 100
+	};
+	static se3_metrics_data data;
+	uint8_t sendbuf[16] = { 0 };
+	uint8_t recvbuf[16];
+	char expected[128];
+	char* text = NULL;
+	se3_metrics* m;
+	const se3_metrics_cmd* echo;
+	stopwatch sw;
+	double t_off, t_on;
+	uint16_t r = SE3_OK;
+	size_t len, i;
+	bool ok;
+
+	m = se3_metrics_create();
+	if (m == NULL) return false;
+
+	stopwatch_start(&sw);
+	for (i = 0; i < N_ECHO && SE3_OK == r; i++) {
+		r = L0_echo(dev, sendbuf, sizeof(sendbuf), recvbuf);
+	}
+	stopwatch_stop(&sw);
+	t_off = stopwatch_gettime(&sw);
+
+	L0_metrics_attach(dev, m);
+	stopwatch_start(&sw);
+	for (i = 0; i < N_ECHO && SE3_OK == r; i++) {
+		r = L0_echo(dev, sendbuf, sizeof(sendbuf), recvbuf);
+	}
+	stopwatch_stop(&sw);
+	t_on = stopwatch_gettime(&sw);
+	L0_metrics_attach(dev, NULL);
+	if (SE3_OK != r) {
+		se3_metrics_destroy(m);
+		return false;
+	}
+
+	se3_metrics_snapshot(m, &data);
+	echo = &(data.cmd0[SE3_CMD0_ECHO]);
+	ok = (echo->h[SE3_METRICS_ROUNDTRIP_US].count == N_ECHO &&
+		echo->h[SE3_METRICS_POLLS].count == N_ECHO &&
+		echo->h[SE3_METRICS_POLLS].sum >= N_ECHO &&
+		echo->h[SE3_METRICS_REQ_BYTES].sum == N_ECHO * sizeof(sendbuf) &&
+		echo->h[SE3_METRICS_RESP_BYTES].sum == N_ECHO * sizeof(recvbuf) &&
+		echo->h[SE3_METRICS_SEAL_US].count == 0 &&
+		echo->errors[0] == 0 && echo->errors_other == 0 &&
+		echo->h[SE3_METRICS_ROUNDTRIP_US].buckets[SE3_METRICS_BUCKETS - 1] == 0);
+
+	if (ok) {
+		len = se3_metrics_prometheus(m, NULL, 0);
+		text = (char*)malloc(len + 1);
+		ok = (text != NULL && se3_metrics_prometheus(m, text, len + 1) == len);
+	}
+	if (ok) {
+		sprintf(expected, "se3_roundtrip_microseconds_count{level=\"l0\",cmd=\"echo\"} %u\n", (unsigned)N_ECHO);
+		ok = (strstr(text, expected) != NULL && strstr(text, "le=\"+Inf\"") != NULL);
+	}
+	free(text);
+	se3_metrics_destroy(m);
+	if (!ok) return false;
+
+	printf("METRICS echo %.1f us, %.1f us with metrics\n", t_off * 1e6 / N_ECHO, t_on * 1e6 / N_ECHO);
+	return true;
+}
\ No newline at end of file
@@ -0,0 +1,124 @@
+#include "tests.h"
+#include "pbkdf2.h"
+
+typedef struct {
+	uint8_t backend;
+	char name[8];
+} test_sha256ni_backend;
+
+/* SHA extensions and AVX2 against the portable implementation, then the throughput of each */
+bool test_Sha256Ni(se3_session* s)
+{
+	enum {
+		TEST_SIZE = 1 * 1024 * 1024,
+		CHECK_SIZE = 300,
+		N_BACKENDS = 3,
+		N_MSG = B5_SHA256_MULTI_LANES,
+		PBKDF2_ITERATIONS = 10000
+	};
+	test_sha256ni_backend backends[N_BACKENDS] = {
+		{ B5_SHA256_BACKEND_SW, "SW" },
+		{ B5_SHA256_BACKEND_NI, "NI" },
+		{ B5_SHA256_BACKEND_AVX2, "AVX2" }
+	};
+	uint8_t* buf = NULL;
+	const uint8_t* msg[N_MSG];
+	uint8_t digest[N_MSG][B5_SHA256_DIGEST_SIZE];
+	uint8_t* pdigest[N_MSG];
+	uint8_t ref[B5_SHA256_DIGEST_SIZE];
+	B5_tHmacSha256Ctx hmac[N_MSG];
+	const B5_tHmacSha256Ctx* phmac[N_MSG];
+	size_t npw[N_MSG];
+	B5_tSha256Ctx sha;
+	B5_tHmacSha256Ctx hmac_ref;
+	size_t i, j, size;
+	stopwatch sw;
+	bool success = false;
+
+	test_randbuf(TEST_SIZE * N_MSG, &buf);
+	for (j = 0; j < N_MSG; j++) {
+		msg[j] = buf + j * TEST_SIZE;
+		pdigest[j] = digest[j];
+		npw[j] = SE3_L1_PIN_SIZE;
+		B5_HmacSha256_Init(&hmac[j], msg[j], (int16_t)(1 + j * 11));
+		phmac[j] = &hmac[j];
+	}
+
+	for (i = 0; i < N_BACKENDS; i++) {
+		if (B5_SHA256_RES_OK != B5_Sha256_SetBackend(backends[i].backend)) {
+			printf("SHA256 %s not supported\n", backends[i].name);
+			continue;
+		}
+		for (size = 0; size <= CHECK_SIZE; size++) {
+			B5_Sha256_Multi(msg, (int32_t)size, pdigest, N_MSG);
+			for (j = 0; j < N_MSG; j++) {
+				B5_Sha256_SetBackend(B5_SHA256_BACKEND_SW);
+				B5_Sha256_Init(&sha);
+				B5_Sha256_Update(&sha, msg[j], (int32_t)size);
+				B5_Sha256_Finit(&sha, ref);
+				B5_Sha256_SetBackend(backends[i].backend);
+				if (memcmp(ref, digest[j], B5_SHA256_DIGEST_SIZE)) {
+					printf("SHA256 %s mismatch\n", backends[i].name);
+					goto cleanup;
+				}
+				B5_Sha256_Init(&sha);
+				B5_Sha256_Update(&sha, msg[j], (int32_t)size);
+				B5_Sha256_Finit(&sha, digest[j]);
+				if (memcmp(ref, digest[j], B5_SHA256_DIGEST_SIZE)) {
+					printf("SHA256 %s mismatch\n", backends[i].name);
+					goto cleanup;
+				}
+			}
+			B5_HmacSha256_Multi(phmac, msg, (int32_t)size, pdigest, N_MSG);
+			for (j = 0; j < N_MSG; j++) {
+				hmac_ref = hmac[j];
+				B5_HmacSha256_Update(&hmac_ref, msg[j], (int32_t)size);
+				B5_HmacSha256_Finit(&hmac_ref, ref);
+				if (memcmp(ref, digest[j], B5_SHA256_DIGEST_SIZE)) {
+					printf("HMAC-SHA256 %s mismatch\n", backends[i].name);
+					goto cleanup;
+				}
+			}
+		}
+		// the messages double as passwords and salts
+		PBKDF2HmacSha256_Multi(msg, npw, msg, B5_SHA256_DIGEST_SIZE, 3, pdigest, B5_SHA256_DIGEST_SIZE, N_MSG);
+		for (j = 0; j < N_MSG; j++) {
+			PBKDF2HmacSha256(msg[j], npw[j], msg[j], B5_SHA256_DIGEST_SIZE, 3, ref, B5_SHA256_DIGEST_SIZE);
+			if (memcmp(ref, digest[j], B5_SHA256_DIGEST_SIZE)) {
+				printf("PBKDF2 %s mismatch\n", backends[i].name);
+				goto cleanup;
+			}
+		}
+	}
+
+	for (i = 0; i < N_BACKENDS; i++) {
+		if (B5_SHA256_RES_OK != B5_Sha256_SetBackend(backends[i].backend)) {
+			continue;
+		}
+		printf("SHA256 %s single ", backends[i].name);
+		stopwatch_start(&sw);
+		for (j = 0; j < N_MSG; j++) {
+			B5_Sha256_Init(&sha);
+			B5_Sha256_Update(&sha, msg[j], TEST_SIZE);
+			B5_Sha256_Finit(&sha, digest[j]);
+		}
+		stopwatch_stop(&sw);
+		test_printspeed(&sw, TEST_SIZE * N_MSG);
+		printf(" %u-way ", (unsigned)N_MSG);
+		stopwatch_start(&sw);
+		B5_Sha256_Multi(msg, TEST_SIZE, pdigest, N_MSG);
+		stopwatch_stop(&sw);
+		test_printspeed(&sw, TEST_SIZE * N_MSG);
+		printf(" PBKDF2 x%u ", (unsigned)N_MSG);
+		stopwatch_start(&sw);
+		PBKDF2HmacSha256_Multi(msg, npw, msg, B5_SHA256_DIGEST_SIZE, PBKDF2_ITERATIONS, pdigest, B5_SHA256_DIGEST_SIZE, N_MSG);
+		stopwatch_stop(&sw);
+		printf("%.3f ms\n", stopwatch_gettime(&sw) * 1000);
+	}
+
+	success = true;
+cleanup:
+	B5_Sha256_SetBackend(B5_SHA256_BACKEND_AUTO);
+	free(buf);
+	return success;
+}
@@ -0,0 +1,44 @@
+#include "tests.h"
+
+/* Device counters: echo requests are counted with their cycles and cleared by a reset read */
+bool test_Stats(se3_device* dev)
+{
+	enum {
+		N_ECHO = 100
+	};
+	uint8_t sendbuf[16] = { 0 };
+	uint8_t recvbuf[16];
+	se3_stats stats;
+	const se3_stats_cmd* echo;
+	uint16_t r = SE3_OK;
+	size_t i;
+
+	r = L0_stats(dev, true, &stats);
+	if (SE3_OK != r) return false;
+
+	for (i = 0; i < N_ECHO; i++) {
+		r = L0_echo(dev, sendbuf, sizeof(sendbuf), recvbuf);
+		if (SE3_OK != r) return false;
+	}
+
+	r = L0_stats(dev, true, &stats);
+	if (SE3_OK != r) return false;
+	echo = &(stats.cmd0[SE3_CMD0_ECHO]);
+	if (echo->count != N_ECHO || echo->max_cycles == 0 || echo->total_cycles < echo->max_cycles) {
+		return false;
+	}
+	if (stats.mem_size == 0 || stats.mem_used > stats.mem_size) return false;
+	if (stats.flash_capacity == 0 || stats.flash_used > stats.flash_allocated) return false;
+
+	printf("STATS echo %u cycles avg %u max, session memory %u/%u, flash %u/%u/%u\n",
+		(unsigned)(echo->total_cycles / echo->count), (unsigned)echo->max_cycles,
+		(unsigned)stats.mem_used, (unsigned)stats.mem_size,
+		(unsigned)stats.flash_used, (unsigned)stats.flash_allocated, (unsigned)stats.flash_capacity);
+
+	// the previous read has cleared the counters
+	r = L0_stats(dev, false, &stats);
+	if (SE3_OK != r) return false;
+	if (stats.cmd0[SE3_CMD0_ECHO].count != 0 || stats.cmd0[SE3_CMD0_STATS].count != 1) return false;
+
+	return true;
+}
\ No newline at end of file
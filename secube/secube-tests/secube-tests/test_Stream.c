@@ -0,0 +1,154 @@
+#include "tests.h"
+#include "L1_stream.h"
+
+typedef struct {
+	const uint8_t* data;
+	size_t len;
+	size_t pos;
+	size_t max_read;  ///< bytes returned by one call at most
+	size_t fail_at;  ///< the read at this position fails
+} mem_source;
+
+typedef struct {
+	uint8_t* data;
+	size_t len;
+	size_t size;  ///< a write past it fails
+} mem_sink;
+
+static long long mem_read(void* ctx, uint8_t* buf, size_t len);
+static bool mem_write(void* ctx, const uint8_t* buf, size_t len);
+static uint16_t test_stream(se3_session* s, uint16_t mode, uint32_t key_id, const uint8_t* iv, const uint8_t* in, size_t len,
+	size_t max_read, size_t fail_at, uint8_t* out, size_t out_size, L1_stream_stats* stats);
+
+
+bool test_Stream(se3_session* s)
+{
+	enum {
+		SLOT_SIZE = L1_STREAM_CHUNK * L1_STREAM_SLOT_CHUNKS,
+		TEST_SIZE = 2 * SLOT_SIZE + 37,
+		KEY_ID = 540,
+		N_SIZES = 5,
+		N_MODES = 2
+	};
+	// empty, a short last block in the first slot, a full slot followed by an empty one, whole
+	// blocks, and short reads over three slots with a short last block
+	const size_t sizes[N_SIZES] = { 0, 1000, SLOT_SIZE, 3 * L1_STREAM_CHUNK + 16, TEST_SIZE };
+	const size_t max_reads[N_SIZES] = { SIZE_MAX, SIZE_MAX, SIZE_MAX, SIZE_MAX, 5000 };
+	const uint16_t modes[N_MODES][2] = {
+		{ SE3_DIR_ENCRYPT | SE3_FEEDBACK_CTR, SE3_DIR_ENCRYPT | SE3_FEEDBACK_CTR },
+		{ SE3_DIR_ENCRYPT | SE3_FEEDBACK_CFB, SE3_DIR_DECRYPT | SE3_FEEDBACK_CFB }
+	};
+	uint16_t r;
+	uint8_t* buf = NULL;
+	uint8_t* enc = (uint8_t*)malloc(TEST_SIZE);
+	uint8_t* dec = (uint8_t*)malloc(TEST_SIZE);
+	uint8_t key_data[B5_AES_256];
+	uint8_t iv[B5_AES_IV_SIZE];
+	L1_stream_stats stats;
+	bool success = false;
+	size_t i, j;
+
+	se3_key key = { KEY_ID, (uint32_t)time(0) + 365 * 24 * 3600, B5_AES_256, 5, {0}, key_data, "tstr0" };
+
+	test_randbuf(TEST_SIZE, &buf);
+	if (enc == NULL || dec == NULL) {
+		goto cleanup;
+	}
+
+	se3c_rand(B5_AES_256, key_data);
+	se3c_rand(B5_AES_IV_SIZE, iv);
+	r = L1_key_edit(s, SE3_KEY_OP_UPSERT, &key);
+	if (r != SE3_OK) {
+		printf("Error inserting keys\n");
+		goto cleanup;
+	}
+
+	printf("Stream ");
+	// aborted streams release the device session, so that the next ones succeed
+	r = test_stream(s, modes[0][0], KEY_ID, iv, buf, TEST_SIZE, SIZE_MAX, SLOT_SIZE, enc, TEST_SIZE, &stats);
+	if (r != SE3_ERR_RESOURCE) {
+		printf("read abort FAIL\n");
+		goto cleanup;
+	}
+	r = test_stream(s, modes[0][0], KEY_ID, iv, buf, TEST_SIZE, SIZE_MAX, SIZE_MAX, enc, SLOT_SIZE, &stats);
+	if (r != SE3_ERR_RESOURCE || stats.bytes_out > SLOT_SIZE) {
+		printf("write abort FAIL\n");
+		goto cleanup;
+	}
+	r = test_stream(s, SE3_DIR_ENCRYPT | SE3_FEEDBACK_CBC, KEY_ID, iv, buf, 1000, SIZE_MAX, SIZE_MAX, enc, TEST_SIZE, &stats);
+	if (r != SE3_ERR_PARAMS) {
+		printf("CBC tail FAIL\n");
+		goto cleanup;
+	}
+
+	for (i = 0; i < N_MODES; i++) {
+		for (j = 0; j < N_SIZES; j++) {
+			r = test_stream(s, modes[i][0], KEY_ID, iv, buf, sizes[j], max_reads[j], SIZE_MAX, enc, TEST_SIZE, &stats);
+			if (r != SE3_OK || stats.bytes_in != sizes[j] || stats.bytes_out != sizes[j] ||
+				stats.requests != ((sizes[j] == 0) ? (1) : ((sizes[j] + L1_STREAM_CHUNK - 1) / L1_STREAM_CHUNK)) ||
+				(sizes[j] > 0 && !memcmp(enc, buf, sizes[j])))
+			{
+				printf("encrypt %u bytes FAIL\n", (unsigned)sizes[j]);
+				goto cleanup;
+			}
+			r = test_stream(s, modes[i][1], KEY_ID, iv, enc, sizes[j], max_reads[j], SIZE_MAX, dec, TEST_SIZE, &stats);
+			if (r != SE3_OK || stats.bytes_out != sizes[j] || memcmp(dec, buf, sizes[j])) {
+				printf("decrypt %u bytes FAIL\n", (unsigned)sizes[j]);
+				goto cleanup;
+			}
+			printf(".");
+		}
+	}
+	printf("\n");
+
+	success = true;
+cleanup:
+	free(buf);
+	free(enc);
+	free(dec);
+	return success;
+}
+
+
+
+static long long mem_read(void* ctx, uint8_t* buf, size_t len)
+{
+	mem_source* f = (mem_source*)ctx;
+	if (f->pos >= f->fail_at) {
+		return -1;
+	}
+	if (len > f->len - f->pos) {
+		len = f->len - f->pos;
+	}
+	if (len > f->max_read) {
+		len = f->max_read;
+	}
+	memcpy(buf, f->data + f->pos, len);
+	f->pos += len;
+	return (long long)len;
+}
+
+static bool mem_write(void* ctx, const uint8_t* buf, size_t len)
+{
+	mem_sink* f = (mem_sink*)ctx;
+	if (f->len + len > f->size) {
+		return false;
+	}
+	memcpy(f->data + f->len, buf, len);
+	f->len += len;
+	return true;
+}
+
+static uint16_t test_stream(se3_session* s, uint16_t mode, uint32_t key_id, const uint8_t* iv, const uint8_t* in, size_t len,
+	size_t max_read, size_t fail_at, uint8_t* out, size_t out_size, L1_stream_stats* stats)
+{
+	mem_source src = { in, len, 0, max_read, fail_at };
+	mem_sink dst = { out, 0, out_size };
+	uint16_t r;
+
+	r = L1_stream_crypt(s, SE3_ALGO_AES, mode, key_id, iv, mem_read, &src, mem_write, &dst, stats);
+	if (r == SE3_OK && dst.len != len) {
+		return SE3_ERR_COMM;
+	}
+	return r;
+}
@@ -0,0 +1,69 @@
+#include "tests.h"
+
+/* Request timeline: every echo shows up on both sides with the same token, in order */
+bool test_Timeline(se3_device* dev)
+{
+	enum {
+		N_ECHO = 8
+	};
+	static const uint8_t device_order[] = {
+		SE3_TIMELINE_RECV, SE3_TIMELINE_READY, SE3_TIMELINE_EXEC_BEGIN, SE3_TIMELINE_EXEC_END, SE3_TIMELINE_SEND
+	};
+	static const uint8_t host_order[] = {
+		SE3_TIMELINE_HOST_TX_BEGIN, SE3_TIMELINE_HOST_TX_END, SE3_TIMELINE_HOST_RX_BEGIN,
+		SE3_TIMELINE_HOST_RX_READY, SE3_TIMELINE_HOST_RX_END
+	};
+	uint8_t sendbuf[16] = { 0 };
+	uint8_t recvbuf[16];
+	se3_timeline_event host_events[8 * N_ECHO];
+	se3_timeline_event device_events[SE3_TIMELINE_DEVICE_EVENTS];
+	se3_timeline host;
+	uint64_t queued = 0, exec = 0;
+	uint32_t dropped;
+	uint16_t count;
+	uint16_t r = SE3_OK;
+	size_t n, i, j, k;
+
+	// empty the device ring
+	do {
+		r = L0_timeline_read(dev, device_events, SE3_TIMELINE_DEVICE_EVENTS, &count, &dropped);
+		if (SE3_OK != r) return false;
+	} while (count == SE3_TIMELINE_DEVICE_EVENTS);
+
+	se3_timeline_init(&host, host_events, sizeof(host_events) / sizeof(host_events[0]));
+	L0_timeline_attach(dev, &host);
+	for (i = 0; i < N_ECHO; i++) {
+		r = L0_echo(dev, sendbuf, sizeof(sendbuf), recvbuf);
+		if (SE3_OK != r) break;
+	}
+	L0_timeline_attach(dev, NULL);
+	if (SE3_OK != r) return false;
+
+	n = se3_timeline_take(&host, host_events, sizeof(host_events) / sizeof(host_events[0]), &dropped);
+	if (n != N_ECHO * sizeof(host_order) || dropped != 0) return false;
+	r = L0_timeline_read(dev, device_events, SE3_TIMELINE_DEVICE_EVENTS, &count, &dropped);
+	if (SE3_OK != r || dropped != 0) return false;
+
+	for (i = 0; i < N_ECHO; i++) {
+		const se3_timeline_event* h = host_events + i * sizeof(host_order);
+		for (j = 0; j < sizeof(host_order); j++) {
+			if (h[j].type != host_order[j] || h[j].token != h[0].token || h[j].time < h[0].time) return false;
+		}
+		// events of the device for the same request
+		for (j = 0, k = 0; k < count && j < sizeof(device_order); k++) {
+			if (device_events[k].token != h[0].token) continue;
+			if (device_events[k].type != device_order[j]) return false;
+			if (device_order[j] == SE3_TIMELINE_EXEC_BEGIN) {
+				queued += device_events[k].time - device_events[k - 1].time;
+			}
+			else if (device_order[j] == SE3_TIMELINE_EXEC_END) {
+				exec += device_events[k].time - device_events[k - 1].time;
+			}
+			j++;
+		}
+		if (j != sizeof(device_order)) return false;
+	}
+
+	printf("TIMELINE echo %u us queued, %u us executed\n", (unsigned)(queued / N_ECHO), (unsigned)(exec / N_ECHO));
+	return true;
+}
\ No newline at end of file
@@ -29,9 +29,24 @@ void test_printv(size_t len, uint8_t* v);
 void test_printspeed(stopwatch* sw, size_t size);
 
 bool test_echo(se3_device* dev);
+bool test_L0_overhead(se3_device* dev);
+bool test_Stats(se3_device* dev);
+bool test_Timeline(se3_device* dev);
+bool test_Metrics(se3_device* dev);
+bool test_Records(se3_device* dev);
 bool test_Aes(se3_session* s);
+bool test_AesNi(se3_session* s);
 bool test_AesHmacSha256s(se3_session* s);
+bool test_AesGcm(se3_session* s);
+bool test_AesCmac(se3_session* s);
+bool test_AesXts(se3_session* s);
+bool test_Envelope(se3_session* s);
+bool test_Container(se3_session* s);
+bool test_Stream(se3_session* s);
+bool test_Keys(se3_session* s);
+bool test_ChaCha20Poly1305(se3_session* s);
 bool test_HmacSha256(se3_session* s);
 bool test_Sha256(se3_session* s);
+bool test_Sha256Ni(se3_session* s);
 
 #define NRUN (10)
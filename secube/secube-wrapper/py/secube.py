@@ -1,4 +1,5 @@
 from ctypes import *
+from contextlib import ExitStack
 import time, sys, os
 
 # L0 constants
@@ -21,6 +22,9 @@ SE3_ERR_PARAMS = 0xF006
 SE3_CMD0_FACTORY_INIT = 1
 SE3_CMD0_ECHO = 2
 SE3_CMD0_L1 = 3
+SE3_CMD0_BOOT_MODE_RESET = 4
+SE3_CMD0_STATS = 5
+SE3_CMD0_TIMELINE = 6
 
 SE3_CMDFLAG_ENCRYPT = (1 << 15)
 SE3_CMDFLAG_SIGN = (1 << 14) 
@@ -139,7 +143,13 @@ SE3_ALGO_AES = 0
 SE3_ALGO_SHA256 = 1
 SE3_ALGO_HMACSHA256 = 2
 SE3_ALGO_AES_HMACSHA256 = 3
-SE3_ALGO_MAX = 8
+SE3_ALGO_AES_HMAC = 4
+SE3_ALGO_AES_GCM = 5
+SE3_ALGO_CHACHA20_POLY1305 = 6
+SE3_ALGO_AES_CMAC = 7
+SE3_ALGO_AES_XTS = 8
+SE3_ALGO_AES_KW = 9
+SE3_ALGO_MAX = 10
 
 SE3_CRYPTO_FLAG_FINIT = (1 << 15)
 SE3_CRYPTO_FLAG_RESET = (1 << 14)
@@ -152,6 +162,8 @@ SE3_CMD1_CRYPTO_UPDATE_RESP_OFF_DATA = 16
 SE3_CRYPTO_MAX_DATAIN = (SE3_REQ1_MAX_DATA - SE3_CMD1_CRYPTO_UPDATE_REQ_OFF_DATA)
 SE3_CRYPTO_MAX_DATAOUT = (SE3_RESP1_MAX_DATA - SE3_CMD1_CRYPTO_UPDATE_RESP_OFF_DATA)
 
+SE3_DIGEST_MAX_SIZE = 32
+
 SE3_CMD1_CRYPTO_ALGOINFO_NAME_SIZE = 16
 
 SE3_CRYPTO_TYPE_BLOCKCIPHER = 0
@@ -255,6 +267,16 @@ dll.se3_algo_get_type.restype=c_uint
 dll.L0_TXRX.restype=c_ushort
 dll.L0_echo.restype=c_ushort
 dll.L0_factoryinit.restype=c_ushort
+dll.L0_stats.restype=c_ushort
+dll.L0_timeline_read.restype=c_ushort
+dll.se3_metrics_create.restype=c_void_p
+dll.se3_metrics_destroy.argtypes=[c_void_p]
+dll.se3_metrics_reset.argtypes=[c_void_p]
+dll.se3_metrics_prometheus.restype=c_size_t
+dll.se3_metrics_prometheus.argtypes=[c_void_p, c_char_p, c_size_t]
+dll.L0_metrics_attach.argtypes=[c_void_p, c_void_p]
+dll.se3_capture_open.restype=c_bool
+dll.se3_capture_open.argtypes=[c_char_p]
 dll.L0_open.restype=c_ushort
 dll.L0_discover_serialno.restype=c_bool
 dll.L0_discover_next.restype=c_bool
@@ -265,10 +287,120 @@ dll.L1_set_user_PIN.restype=c_ushort
 dll.L1_logout.restype=c_ushort
 dll.L1_key_list.restype=c_ushort
 dll.L1_key_edit.restype=c_ushort
+dll.L1_key_get_info.restype=c_ushort
 dll.L1_crypto_init.restype=c_ushort
 dll.L1_crypto_update.restype=c_ushort
 dll.L1_crypto_set_time.restype=c_ushort
 dll.L1_get_algorithms.restype=c_ushort
+dll.L1_encrypt.restype=c_ushort
+dll.L1_decrypt.restype=c_ushort
+dll.L1_digest.restype=c_ushort
+dll.L1_stream_crypt.restype=c_ushort
+dll.se3_crypt_batch.restype=c_ushort
+dll.se3_digest_batch.restype=c_ushort
+
+class L1_stream_stats(Structure):
+    _fields_=[
+        ("bytes_in", c_uint64),
+        ("bytes_out", c_uint64),
+        ("requests", c_uint32),
+        ("input_stalls", c_uint32)]
+
+SE3_STATS_CMD0_COUNT = 8
+SE3_STATS_CMD1_COUNT = 16
+SE3_STATS_ALGO_COUNT = 16
+
+class se3_stats_cmd(Structure):
+    _fields_=[
+        ("count", c_uint32),
+        ("max_cycles", c_uint32),
+        ("total_cycles", c_uint64)]
+
+# device performance counters, see se3_stats.h
+class se3_stats(Structure):
+    _fields_=[
+        ("cmd0", se3_stats_cmd * SE3_STATS_CMD0_COUNT),
+        ("cmd1", se3_stats_cmd * SE3_STATS_CMD1_COUNT),
+        ("algo_bytes", c_uint64 * SE3_STATS_ALGO_COUNT),
+        ("mem_used", c_uint32),
+        ("mem_size", c_uint32),
+        ("mem_peak", c_uint32),
+        ("mem_defrags", c_uint32),
+        ("flash_used", c_uint32),
+        ("flash_allocated", c_uint32),
+        ("flash_capacity", c_uint32),
+        ("flash_swaps", c_uint32),
+        ("flash_erases", c_uint32),
+        ("sd_read_blocks", c_uint32),
+        ("sd_write_blocks", c_uint32),
+        ("sd_errors", c_uint32),
+        ("sd_read_cycles", c_uint64),
+        ("sd_write_cycles", c_uint64)]
+
+SE3_TIMELINE_DEVICE_EVENTS = 256
+
+# event of a request, see se3_timeline.h
+class se3_timeline_event(Structure):
+    _fields_=[
+        ("time", c_uint64),
+        ("token", c_uint32),
+        ("arg", c_uint16),
+        ("type", c_uint8)]
+
+L1_stream_read_cb=CFUNCTYPE(c_longlong, c_void_p, POINTER(c_ubyte), c_size_t)
+L1_stream_write_cb=CFUNCTYPE(c_bool, c_void_p, POINTER(c_ubyte), c_size_t)
+
+# Buffers are passed to the library without copies: any object supporting the buffer
+# protocol (bytes, bytearray, memoryview, array, numpy arrays) is locked with
+# PyObject_GetBuffer for the duration of the call. The library is loaded with CDLL,
+# so the GIL is released while a call, and the device I/O in it, is running.
+
+class _Py_buffer(Structure):
+    _fields_=[
+        ("buf", c_void_p),
+        ("obj", c_void_p),
+        ("len", c_ssize_t),
+        ("itemsize", c_ssize_t),
+        ("readonly", c_int),
+        ("ndim", c_int),
+        ("format", c_char_p),
+        ("shape", POINTER(c_ssize_t)),
+        ("strides", POINTER(c_ssize_t)),
+        ("suboffsets", POINTER(c_ssize_t)),
+        ("internal", c_void_p)]
+
+_PyBUF_SIMPLE = 0
+_PyBUF_WRITABLE = 1
+
+pythonapi.PyObject_GetBuffer.argtypes=[py_object, POINTER(_Py_buffer), c_int]
+pythonapi.PyObject_GetBuffer.restype=c_int
+pythonapi.PyBuffer_Release.argtypes=[POINTER(_Py_buffer)]
+pythonapi.PyBuffer_Release.restype=None
+
+class _Buffer:
+    """Contiguous memory of a buffer-protocol object, as a context manager (None is an empty buffer)"""
+    def __init__(self, obj, writable=False):
+        self.obj=obj
+        self.writable=writable
+        self.view=None
+        self.ptr=POINTER(c_ubyte)()
+        self.len=0
+    
+    def __enter__(self):
+        if self.obj is not None:
+            view=_Py_buffer()
+            pythonapi.PyObject_GetBuffer(self.obj, byref(view),
+                _PyBUF_WRITABLE if self.writable else _PyBUF_SIMPLE)
+            self.view=view
+            self.ptr=cast(c_void_p(view.buf), POINTER(c_ubyte))
+            self.len=view.len
+        return self
+    
+    def __exit__(self, *exc):
+        if self.view is not None:
+            pythonapi.PyBuffer_Release(byref(self.view))
+            self.view=None
+        return False
     
     
 class SEcubeError(Exception):
@@ -383,6 +515,47 @@ def _read_algo(calgos, index):
     key_size=dll.se3_algo_get_key_size(calgos, c_uint(index))
     return SEcubeAlgorithm(type=type, name=name, block_size=block_size, key_size=key_size)
     
+def _readfull(src, buf):
+    view=memoryview(buf)
+    count=0
+    while count<len(buf):
+        n=src.readinto(view[count:])
+        if not n:
+            break
+        count+=n
+    return count
+    
+class SEcubeMetrics:
+    # histograms of the requests of any number of devices, see se3_metrics.h
+    def __init__(self):
+        self.m=dll.se3_metrics_create()
+        if not self.m:
+            raise MemoryError()
+    
+    def destroy(self):
+        # detach it from every device first
+        if self.m:
+            dll.se3_metrics_destroy(self.m)
+            self.m=None
+    
+    def reset(self):
+        dll.se3_metrics_reset(self.m)
+    
+    def prometheus(self):
+        # text exposition format, e.g. to serve on /metrics
+        n=dll.se3_metrics_prometheus(self.m, None, 0)
+        buf=create_string_buffer(n+1)
+        dll.se3_metrics_prometheus(self.m, buf, n+1)
+        return buf.value.decode("ascii")
+
+def capture_open(path):
+    # record the block traffic of the process for the replay driver, see se3_capture.h;
+    # the file holds the session keys of the logins that follow
+    return dll.se3_capture_open(path.encode("utf-8"))
+
+def capture_close():
+    dll.se3_capture_close()
+
 class SEcube:
     @staticmethod
     def discover():
@@ -459,6 +632,29 @@ class SEcube:
         r=dll.L0_factoryinit(self.dev, cast(cserial, POINTER(c_ubyte)))
         if SE3_OK != r:
             raise SEcubeError(r)
+    
+    def stats(self, reset=False):
+        # performance counters of the device, no login needed; reset clears them after reading
+        st=se3_stats()
+        r=dll.L0_stats(self.dev, c_bool(reset), byref(st))
+        if SE3_OK != r:
+            raise SEcubeError(r)
+        return st
+    
+    def timeline(self):
+        # events recorded by the device since the last call, with times in microseconds of
+        # the host monotonic clock; returns (events, number of events lost)
+        ev=(se3_timeline_event * SE3_TIMELINE_DEVICE_EVENTS)()
+        count=c_ushort(0)
+        dropped=c_uint32(0)
+        r=dll.L0_timeline_read(self.dev, ev, c_ushort(SE3_TIMELINE_DEVICE_EVENTS), byref(count), byref(dropped))
+        if SE3_OK != r:
+            raise SEcubeError(r)
+        return list(ev[:count.value]), dropped.value
+     
+    def attach_metrics(self, metrics):
+        # record the requests in an SEcubeMetrics, None to stop; before login, which copies the device
+        dll.L0_metrics_attach(self.dev, metrics.m if metrics is not None else None)
      
     def login(self, pin, access=SE3_ACCESS_USER):
         if isinstance(pin, str):
@@ -519,36 +715,179 @@ class SEcube:
         return csid[0]
     
     def crypto_update(self, sess_id, flags, data1, data2):
-        if data1 is None:
-            cdata1=POINTER(c_ubyte)()
-            data1_len=0
-        else:
-            cdata1=(len(data1)*c_ubyte)(*data1)
-            data1_len=len(data1)
-        if data2 is None:
-            cdata2=POINTER(c_ubyte)()
-            data2_len=0
-        else:
-            cdata2=(len(data2)*c_ubyte)(*data2)
-            data2_len=len(data2)
-        cdataout_len=(1*c_ushort)()
-        cdataout=(SE3_CRYPTO_MAX_DATAOUT*c_ubyte)()
-        r=dll.L1_crypto_update(
-            self.session,
-            c_uint(sess_id),
-            c_ushort(flags),
-            c_ushort(data1_len),
-            cast(cdata1, POINTER(c_ubyte)),
-            c_ushort(data2_len),
-            cast(cdata2, POINTER(c_ubyte)),
-            cast(cdataout_len, POINTER(c_ushort)),
-            cast(cdataout, POINTER(c_ubyte)))
+        out=bytearray(SE3_CRYPTO_MAX_DATAOUT)
+        n=self.crypto_update_into(sess_id, flags, data1, data2, out)
+        return bytes(out[:n])
+    
+    def crypto_update_into(self, sess_id, flags, data1, data2, out):
+        """crypto_update with the response written to out, a writable buffer of
+        SE3_CRYPTO_MAX_DATAOUT bytes; returns the response length"""
+        with _Buffer(data1) as b1, _Buffer(data2) as b2, _Buffer(out, True) as bout:
+            if b1.len>SE3_CRYPTO_MAX_DATAIN or b2.len>SE3_CRYPTO_MAX_DATAIN:
+                raise SEcubeError(SE3_ERR_PARAMS)
+            if bout.len<SE3_CRYPTO_MAX_DATAOUT:
+                raise SEcubeError(SE3_ERR_PARAMS)
+            cdataout_len=c_ushort(0)
+            r=dll.L1_crypto_update(
+                self.session,
+                c_uint(sess_id),
+                c_ushort(flags),
+                c_ushort(b1.len),
+                b1.ptr,
+                c_ushort(b2.len),
+                b2.ptr,
+                byref(cdataout_len),
+                bout.ptr)
         
         if SE3_OK != r:
             raise SEcubeError(r)
-        if cdataout_len[0]>SE3_CRYPTO_MAX_DATAOUT:
+        if cdataout_len.value>SE3_CRYPTO_MAX_DATAOUT:
             raise SEcubeError(SE3_ERR_COMM)
-        return bytes(cdataout[:cdataout_len[0]])
+        return cdataout_len.value
+    
+    def encrypt(self, algorithm, mode, key_id, data, out=None):
+        """Encrypt a whole message in one call; the output is as long as the input and is
+        written to out, if given, or returned as a bytearray"""
+        return self._crypt(dll.L1_encrypt, algorithm, mode | SE3_DIR_ENCRYPT, key_id, data, out)
+    
+    def decrypt(self, algorithm, mode, key_id, data, out=None):
+        return self._crypt(dll.L1_decrypt, algorithm, mode | SE3_DIR_DECRYPT, key_id, data, out)
+    
+    def _crypt(self, func, algorithm, mode, key_id, data, out):
+        with _Buffer(data) as bin:
+            if out is None:
+                out=bytearray(bin.len)
+            with _Buffer(out, True) as bout:
+                if bout.len<bin.len:
+                    raise SEcubeError(SE3_ERR_PARAMS)
+                cdataout_len=c_size_t(0)
+                r=func(self.session, c_ushort(algorithm), c_ushort(mode), c_uint(key_id),
+                    c_size_t(bin.len), bin.ptr, byref(cdataout_len), bout.ptr)
+        if SE3_OK != r:
+            raise SEcubeError(r)
+        return out
+    
+    def digest(self, algorithm, data):
+        out=bytearray(SE3_DIGEST_MAX_SIZE)
+        with _Buffer(data) as bin, _Buffer(out, True) as bout:
+            cdataout_len=c_size_t(0)
+            r=dll.L1_digest(self.session, c_ushort(algorithm),
+                c_size_t(bin.len), bin.ptr, byref(cdataout_len), bout.ptr)
+        if SE3_OK != r:
+            raise SEcubeError(r)
+        return bytes(out[:min(cdataout_len.value, SE3_DIGEST_MAX_SIZE)])
+    
+    def encrypt_batch(self, algorithm, mode, key_id, messages, outs=None):
+        """Encrypt each message with its own session, all in one call; returns the outputs"""
+        return self._crypt_batch(algorithm, mode | SE3_DIR_ENCRYPT, key_id, messages, outs)
+    
+    def decrypt_batch(self, algorithm, mode, key_id, messages, outs=None):
+        return self._crypt_batch(algorithm, mode | SE3_DIR_DECRYPT, key_id, messages, outs)
+    
+    def _crypt_batch(self, algorithm, mode, key_id, messages, outs):
+        messages=list(messages)
+        if outs is None:
+            outs=[bytearray(memoryview(m).nbytes) for m in messages]
+        if len(outs)!=len(messages):
+            raise SEcubeError(SE3_ERR_PARAMS)
+        n=len(messages)
+        with ExitStack() as stack:
+            bins=[stack.enter_context(_Buffer(m)) for m in messages]
+            bouts=[stack.enter_context(_Buffer(o, True)) for o in outs]
+            for bin, bout in zip(bins, bouts):
+                if bout.len<bin.len:
+                    raise SEcubeError(SE3_ERR_PARAMS)
+            r=dll.se3_crypt_batch(self.session, c_ushort(algorithm), c_ushort(mode), c_uint(key_id), c_uint(n),
+                (n*POINTER(c_ubyte))(*[b.ptr for b in bins]),
+                (n*c_size_t)(*[b.len for b in bins]),
+                (n*POINTER(c_ubyte))(*[b.ptr for b in bouts]),
+                (n*c_size_t)())
+        if SE3_OK != r:
+            raise SEcubeError(r)
+        return outs
+    
+    def digest_batch(self, algorithm, messages):
+        """Digest of each message, all in one call"""
+        messages=list(messages)
+        n=len(messages)
+        outs=[bytearray(SE3_DIGEST_MAX_SIZE) for i in range(n)]
+        cdataout_len=(n*c_size_t)()
+        with ExitStack() as stack:
+            bins=[stack.enter_context(_Buffer(m)) for m in messages]
+            bouts=[stack.enter_context(_Buffer(o, True)) for o in outs]
+            r=dll.se3_digest_batch(self.session, c_ushort(algorithm), c_uint(n),
+                (n*POINTER(c_ubyte))(*[b.ptr for b in bins]),
+                (n*c_size_t)(*[b.len for b in bins]),
+                (n*POINTER(c_ubyte))(*[b.ptr for b in bouts]),
+                cdataout_len)
+        if SE3_OK != r:
+            raise SEcubeError(r)
+        return [bytes(o[:min(l, SE3_DIGEST_MAX_SIZE)]) for o, l in zip(outs, cdataout_len)]
+    
+    def encrypt_stream(self, algorithm, mode, key_id, src, dst, iv=None):
+        """Encrypt from the binary file object src (readinto) to dst (write) with L1_stream_crypt,
+        which reads ahead and writes from its own threads; returns a L1_stream_stats"""
+        return self._crypt_stream(algorithm, mode | SE3_DIR_ENCRYPT, key_id, src, dst, iv)
+    
+    def decrypt_stream(self, algorithm, mode, key_id, src, dst, iv=None):
+        return self._crypt_stream(algorithm, mode | SE3_DIR_DECRYPT, key_id, src, dst, iv)
+    
+    def _crypt_stream(self, algorithm, mode, key_id, src, dst, iv):
+        errors=[]
+        # the callbacks run in the library threads, and take the GIL only to copy a slot
+        def read(ctx, buf, length):
+            try:
+                n=src.readinto(memoryview(cast(buf, POINTER(length*c_ubyte)).contents).cast('B'))
+                return 0 if n is None else n
+            except Exception as e:
+                errors.append(e)
+                return -1
+        def write(ctx, buf, length):
+            try:
+                dst.write(memoryview(cast(buf, POINTER(length*c_ubyte)).contents).cast('B'))
+                return True
+            except Exception as e:
+                errors.append(e)
+                return False
+        cread=L1_stream_read_cb(read)
+        cwrite=L1_stream_write_cb(write)
+        stats=L1_stream_stats()
+        with _Buffer(iv) as biv:
+            if iv is not None and biv.len!=SE3_L1_IV_SIZE:
+                raise SEcubeError(SE3_ERR_PARAMS)
+            r=dll.L1_stream_crypt(self.session, c_ushort(algorithm), c_ushort(mode), c_uint(key_id),
+                biv.ptr if iv is not None else POINTER(c_ubyte)(), cread, None, cwrite, None, byref(stats))
+        if errors:
+            raise errors[0]
+        if SE3_OK != r:
+            raise SEcubeError(r)
+        return stats
+    
+    def digest_stream(self, algorithm, src):
+        """Digest of everything read from the binary file object src"""
+        sess_id=self.crypto_init(algorithm, 0, 0)
+        bufs=[bytearray(SE3_CRYPTO_MAX_DATAIN), bytearray(SE3_CRYPTO_MAX_DATAIN)]
+        out=bytearray(SE3_CRYPTO_MAX_DATAOUT)
+        try:
+            # one chunk ahead, to know which one is the last
+            n=_readfull(src, bufs[0])
+            i=0
+            while True:
+                nxt=_readfull(src, bufs[1-i]) if n==len(bufs[i]) else 0
+                last=(nxt==0)
+                m=self.crypto_update_into(sess_id, SE3_CRYPTO_FLAG_FINIT if last else 0,
+                    memoryview(bufs[i])[:n], None, out)
+                if last:
+                    return bytes(out[:min(m, SE3_DIGEST_MAX_SIZE)])
+                n=nxt
+                i=1-i
+        except:
+            # release the device session
+            try:
+                self.crypto_update(sess_id, SE3_CRYPTO_FLAG_FINIT, None, None)
+            except SEcubeError:
+                pass
+            raise
     
     def crypto_set_time(self, devtime):
         
@@ -621,6 +960,24 @@ class SEcube:
                 raise SEcubeError(SE3_ERR_COMM)
         return ret
     
+    def key_get_info(self, key_id, salt=None):
+        ckey=dll.se3_key_alloc(c_uint(1))
+        if salt is None:
+            csalt=POINTER(c_ubyte)()
+        else:
+            csalt=(SE3_KEY_SALT_SIZE*c_ubyte)(*salt)
+        r = dll.L1_key_get_info(self.session, c_uint(key_id), cast(csalt, POINTER(c_ubyte)), ckey)
+        key=None
+        if SE3_OK == r:
+            key=_read_key(ckey, 0)
+        dll.se3_free(ckey)
+        
+        if SE3_ERR_RESOURCE == r:
+            return None
+        if SE3_OK != r:
+            raise SEcubeError(r)
+        return key
+    
     def key_edit(self, op, key):
         ckey=dll.se3_key_alloc(c_uint(1))
         cdata=None
@@ -0,0 +1,41 @@
+#!/usr/bin/env python3
+
+import secube, sys
+
+CMD0_NAMES={1:"FACTORY_INIT", 2:"ECHO", 3:"L1", 4:"BOOT_MODE_RESET", 5:"STATS", 6:"TIMELINE"}
+CMD1_NAMES={1:"CHALLENGE", 2:"LOGIN", 3:"LOGOUT", 4:"CONFIG", 5:"KEY_EDIT", 6:"KEY_LIST",
+    7:"CRYPTO_INIT", 8:"CRYPTO_UPDATE", 9:"CRYPTO_LIST", 10:"CRYPTO_SET_TIME",
+    11:"KEY_IMPORT_BATCH", 12:"KEY_GET_INFO"}
+
+def show_cmds(title, cmds, names):
+    print(title)
+    for i,cmd in enumerate(cmds):
+        if cmd.count:
+            print("\t%-16s %8d requests %12d cycles avg %12d max"%(names.get(i, str(i)), cmd.count,
+                cmd.total_cycles//cmd.count, cmd.max_cycles))
+
+def main():
+    # with --reset the counters start again from zero
+    cube=secube.SEcube()
+    st=cube.stats("--reset" in sys.argv)
+    
+    show_cmds("L0 COMMANDS", st.cmd0, CMD0_NAMES)
+    show_cmds("L1 COMMANDS", st.cmd1, CMD1_NAMES)
+    print("ALGORITHMS")
+    for i,n in enumerate(st.algo_bytes):
+        if n:
+            print("\t%-16d %12d bytes"%(i, n))
+    print("SESSION MEMORY")
+    print("\tUSED %d / %d bytes, PEAK %d, DEFRAGS %d"%(st.mem_used, st.mem_size, st.mem_peak, st.mem_defrags))
+    print("FLASH")
+    print("\tUSED %d, ALLOCATED %d / %d bytes, SWAPS %d, ERASES %d"%(st.flash_used, st.flash_allocated,
+        st.flash_capacity, st.flash_swaps, st.flash_erases))
+    print("SD")
+    print("\tREAD %d blocks in %d cycles, WRITTEN %d blocks in %d cycles, ERRORS %d"%(st.sd_read_blocks,
+        st.sd_read_cycles, st.sd_write_blocks, st.sd_write_cycles, st.sd_errors))
+    
+    cube.close()
+    return 0
+    
+if __name__=="__main__":
+    exit(main())
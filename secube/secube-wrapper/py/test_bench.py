@@ -0,0 +1,132 @@
+#!/usr/bin/env python3
+
+# Throughput of the bindings against the copy-based crypto_update of the previous
+# wrapper, on the first device found. Run with: pytest -s test_bench.py
+# The PIN is taken from SECUBE_PIN, "test" by default; key 540 is overwritten.
+
+import io, os, time
+import pytest
+
+try:
+    import secube
+    from secube import *
+except OSError:
+    pytest.skip("SEcube library not found", allow_module_level=True)
+
+KEY_ID = 540
+SIZE = 4 * 1024 * 1024
+CHUNK = SE3_CRYPTO_MAX_DATAIN
+MODE = SE3_FEEDBACK_CTR
+
+results = {}
+
+
+@pytest.fixture(scope="module")
+def cube():
+    if len(SEcube.discover()) == 0:
+        pytest.skip("no SEcube device found")
+    cube = SEcube()
+    cube.login(os.environ.get("SECUBE_PIN", "test"))
+    cube.crypto_set_time(int(time.time()))
+    cube.key_edit(SE3_KEY_OP_UPSERT, SEcubeKey(id=KEY_ID, name="tbench", data=os.urandom(32)))
+    yield cube
+    cube.logout()
+    cube.close()
+    base = results.get("legacy crypto_update")
+    for name, speed in sorted(results.items(), key=lambda x: x[1]):
+        print("%-24s %8.2f MB/s" % (name, speed) + ("  x%.2f" % (speed / base) if base else ""))
+
+
+@pytest.fixture(scope="module")
+def data():
+    return os.urandom(SIZE)
+
+
+@pytest.fixture(scope="module")
+def expected(cube, data):
+    return bytes(cube.encrypt(SE3_ALGO_AES, MODE, KEY_ID, data))
+
+
+def measure(name, func):
+    t0 = time.perf_counter()
+    ret = func()
+    results[name] = SIZE / (time.perf_counter() - t0) / 1e6
+    return ret
+
+
+def legacy_crypto_update(cube, sess_id, flags, data1, data2):
+    # crypto_update as implemented by the previous wrapper: c_ubyte arrays in and out
+    if data1 is None:
+        cdata1 = POINTER(c_ubyte)()
+        data1_len = 0
+    else:
+        cdata1 = (len(data1) * c_ubyte)(*data1)
+        data1_len = len(data1)
+    if data2 is None:
+        cdata2 = POINTER(c_ubyte)()
+        data2_len = 0
+    else:
+        cdata2 = (len(data2) * c_ubyte)(*data2)
+        data2_len = len(data2)
+    cdataout_len = (1 * c_ushort)()
+    cdataout = (SE3_CRYPTO_MAX_DATAOUT * c_ubyte)()
+    r = dll.L1_crypto_update(cube.session, c_uint(sess_id), c_ushort(flags),
+        c_ushort(data1_len), cast(cdata1, POINTER(c_ubyte)),
+        c_ushort(data2_len), cast(cdata2, POINTER(c_ubyte)),
+        cast(cdataout_len, POINTER(c_ushort)), cast(cdataout, POINTER(c_ubyte)))
+    if SE3_OK != r:
+        raise SEcubeError(r)
+    return bytes(cdataout[:cdataout_len[0]])
+
+
+def chunked(cube, data, update):
+    sess_id = cube.crypto_init(SE3_ALGO_AES, MODE | SE3_DIR_ENCRYPT, KEY_ID)
+    out = []
+    for off in range(0, len(data), CHUNK):
+        last = off + CHUNK >= len(data)
+        out.append(update(sess_id, SE3_CRYPTO_FLAG_FINIT if last else 0, data[off:off + CHUNK]))
+    return b"".join(out)
+
+
+def test_legacy_crypto_update(cube, data, expected):
+    out = measure("legacy crypto_update",
+        lambda: chunked(cube, data, lambda s, f, d: legacy_crypto_update(cube, s, f, None, d)))
+    assert out == expected
+
+
+def test_crypto_update_into(cube, data, expected):
+    view = memoryview(data)
+    buf = bytearray(SE3_CRYPTO_MAX_DATAOUT)
+    def update(s, f, d):
+        n = cube.crypto_update_into(s, f, None, d, buf)
+        return bytes(buf[:n])
+    out = measure("crypto_update_into", lambda: chunked(cube, view, update))
+    assert out == expected
+
+
+def test_encrypt(cube, data, expected):
+    out = bytearray(SIZE)
+    measure("encrypt", lambda: cube.encrypt(SE3_ALGO_AES, MODE, KEY_ID, data, out))
+    assert out == expected
+
+
+def test_encrypt_batch(cube, data):
+    n = 64
+    size = SIZE // n
+    view = memoryview(data)
+    messages = [view[i * size:(i + 1) * size] for i in range(n)]
+    outs = measure("encrypt_batch", lambda: cube.encrypt_batch(SE3_ALGO_AES, MODE, KEY_ID, messages))
+    # each message starts from the initial counter
+    assert outs[1] == cube.encrypt(SE3_ALGO_AES, MODE, KEY_ID, messages[1])
+    assert cube.decrypt_batch(SE3_ALGO_AES, MODE, KEY_ID, outs) == [bytearray(m) for m in messages]
+
+
+def test_encrypt_stream(cube, data, expected):
+    dst = io.BytesIO()
+    measure("encrypt_stream", lambda: cube.encrypt_stream(SE3_ALGO_AES, MODE, KEY_ID, io.BytesIO(data), dst))
+    assert dst.getvalue() == expected
+
+
+def test_digest(cube, data):
+    digest = measure("digest", lambda: cube.digest(SE3_ALGO_SHA256, data))
+    assert digest == cube.digest_stream(SE3_ALGO_SHA256, io.BytesIO(data))
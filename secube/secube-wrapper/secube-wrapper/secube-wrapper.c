@@ -102,6 +102,33 @@ unsigned int se3_algo_get_type(se3_algo* algo, unsigned int index) {
 	return algo->type;
 }
 
+/* batches: one call for many messages, so that bindings cross into the library once */
+unsigned short se3_crypt_batch(se3_session* s, unsigned short algorithm, unsigned short mode, unsigned int key_id,
+	unsigned int count, unsigned char** data_in, size_t* datain_len, unsigned char** data_out, size_t* dataout_len)
+{
+	uint16_t r = SE3_OK;
+	unsigned int i;
+	for (i = 0; i < count && r == SE3_OK; i++) {
+		if (mode & SE3_DIR_DECRYPT) {
+			r = L1_decrypt(s, algorithm, mode, key_id, datain_len[i], data_in[i], &dataout_len[i], data_out[i]);
+		}
+		else {
+			r = L1_encrypt(s, algorithm, mode, key_id, datain_len[i], data_in[i], &dataout_len[i], data_out[i]);
+		}
+	}
+	return r;
+}
+unsigned short se3_digest_batch(se3_session* s, unsigned short algorithm,
+	unsigned int count, unsigned char** data_in, size_t* datain_len, unsigned char** data_out, size_t* dataout_len)
+{
+	uint16_t r = SE3_OK;
+	unsigned int i;
+	for (i = 0; i < count && r == SE3_OK; i++) {
+		r = L1_digest(s, algorithm, datain_len[i], data_in[i], &dataout_len[i], data_out[i]);
+	}
+	return r;
+}
+
 void se3_free(void* p) {
 	free(p);
 }
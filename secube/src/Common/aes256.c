@@ -8,6 +8,26 @@
  */
 
 #include "aes256.h"
+#include "aes256_ni.h"
+
+
+static uint8_t B5_Aes256_Backend = B5_AES256_BACKEND_AUTO;
+
+
+/*
+ * On the Cortex-M4 the tables are read through the flash wait states; B5_Aes256_Init copies
+ * them once to the core coupled memory, which is zero wait state and only reachable by the CPU.
+ * The linker script must provide the .ccmram section; define B5_AES256_NO_CCM to keep the
+ * tables in flash.
+ */
+#if defined(__ARM_ARCH_7EM__) && defined(__GNUC__) && !defined(B5_AES256_NO_CCM)
+#define B5_AES256_CCM
+#endif
+
+#ifdef B5_AES256_CCM
+static uint32_t B5_AesTables_CCM[10][256] __attribute__((section(".ccmram")));
+static uint8_t B5_AesTables_Ready = 0;
+#endif
 
 
 
@@ -1190,6 +1210,193 @@ void B5_rijndaelDecrypt (B5_tAesCtx *ctx, uint32_t *rk, int16_t Nr, const uint8_
 
 
 
+/*
+ * Two independent blocks at a time. The states are big endian words, already loaded by the
+ * caller. On ARM, Te1..Te3 (Td1..Td3) are read as Te0 (Td0) rotated by 8, 16 and 24 bits: the
+ * rotation is free on the data processing instructions, and a single table base is live in
+ * the round, leaving registers for the eight words of state.
+ */
+#define B5_AES_ROR(x,n) (((x) >> (n)) | ((x) << (32 - (n))))
+
+#if defined(__arm__)
+#define B5_AES_T1(x) B5_AES_ROR(T[x],  8)
+#define B5_AES_T2(x) B5_AES_ROR(T[x], 16)
+#define B5_AES_T3(x) B5_AES_ROR(T[x], 24)
+#else
+#define B5_AES_T1(x) T1[x]
+#define B5_AES_T2(x) T2[x]
+#define B5_AES_T3(x) T3[x]
+#endif
+
+#define B5_AES_ENC_ROUND(d, s, k)                                                                                   \
+{                                                                                                                   \
+    d##0 = T[s##0 >> 24] ^ B5_AES_T1((s##1 >> 16) & 0xff) ^ B5_AES_T2((s##2 >> 8) & 0xff) ^ B5_AES_T3(s##3 & 0xff) ^ (k)[0]; \
+    d##1 = T[s##1 >> 24] ^ B5_AES_T1((s##2 >> 16) & 0xff) ^ B5_AES_T2((s##3 >> 8) & 0xff) ^ B5_AES_T3(s##0 & 0xff) ^ (k)[1]; \
+    d##2 = T[s##2 >> 24] ^ B5_AES_T1((s##3 >> 16) & 0xff) ^ B5_AES_T2((s##0 >> 8) & 0xff) ^ B5_AES_T3(s##1 & 0xff) ^ (k)[2]; \
+    d##3 = T[s##3 >> 24] ^ B5_AES_T1((s##0 >> 16) & 0xff) ^ B5_AES_T2((s##1 >> 8) & 0xff) ^ B5_AES_T3(s##2 & 0xff) ^ (k)[3]; \
+}
+
+#define B5_AES_DEC_ROUND(d, s, k)                                                                                   \
+{                                                                                                                   \
+    d##0 = T[s##0 >> 24] ^ B5_AES_T1((s##3 >> 16) & 0xff) ^ B5_AES_T2((s##2 >> 8) & 0xff) ^ B5_AES_T3(s##1 & 0xff) ^ (k)[0]; \
+    d##1 = T[s##1 >> 24] ^ B5_AES_T1((s##0 >> 16) & 0xff) ^ B5_AES_T2((s##3 >> 8) & 0xff) ^ B5_AES_T3(s##2 & 0xff) ^ (k)[1]; \
+    d##2 = T[s##2 >> 24] ^ B5_AES_T1((s##1 >> 16) & 0xff) ^ B5_AES_T2((s##0 >> 8) & 0xff) ^ B5_AES_T3(s##3 & 0xff) ^ (k)[2]; \
+    d##3 = T[s##3 >> 24] ^ B5_AES_T1((s##2 >> 16) & 0xff) ^ B5_AES_T2((s##1 >> 8) & 0xff) ^ B5_AES_T3(s##0 & 0xff) ^ (k)[3]; \
+}
+
+#define B5_AES_LAST_WORD(x0, x1, x2, x3, k)         \
+    ((T4[(x0) >> 24] & 0xff000000) ^                \
+     (T4[((x1) >> 16) & 0xff] & 0x00ff0000) ^       \
+     (T4[((x2) >> 8) & 0xff] & 0x0000ff00) ^        \
+     (T4[(x3) & 0xff] & 0x000000ff) ^ (k))
+
+
+static uint32_t B5_Aes_Load32 (const uint8_t *p)
+{
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | (uint32_t)p[3];
+}
+
+static void B5_Aes_Store32 (uint8_t *p, uint32_t w)
+{
+    p[0] = (uint8_t)(w >> 24);
+    p[1] = (uint8_t)(w >> 16);
+    p[2] = (uint8_t)(w >>  8);
+    p[3] = (uint8_t)(w      );
+}
+
+
+/**
+ * @brief AES encryption of two blocks.
+ * @param ctx Pointer to the current AES256 context.
+ * @param a first block, as four big endian words, replaced by the output
+ * @param b second block, as four big endian words, replaced by the output
+ */
+static void B5_rijndaelEncrypt2 (const B5_tAesCtx *ctx, uint32_t *a, uint32_t *b)
+{
+    const uint32_t *T = ctx->Te0;
+#if !defined(__arm__)
+    const uint32_t *T1 = ctx->Te1;
+    const uint32_t *T2 = ctx->Te2;
+    const uint32_t *T3 = ctx->Te3;
+#endif
+    const uint32_t *T4 = ctx->Te4;
+    const uint32_t *rk = ctx->rk;
+    uint32_t sa0, sa1, sa2, sa3, ta0, ta1, ta2, ta3;
+    uint32_t sb0, sb1, sb2, sb3, tb0, tb1, tb2, tb3;
+    int16_t r;
+
+    sa0 = a[0] ^ rk[0]; sa1 = a[1] ^ rk[1]; sa2 = a[2] ^ rk[2]; sa3 = a[3] ^ rk[3];
+    sb0 = b[0] ^ rk[0]; sb1 = b[1] ^ rk[1]; sb2 = b[2] ^ rk[2]; sb3 = b[3] ^ rk[3];
+
+    for (r = 1; r < ctx->Nr - 1; r += 2)
+    {
+        rk += 4;
+        B5_AES_ENC_ROUND(ta, sa, rk);
+        B5_AES_ENC_ROUND(tb, sb, rk);
+        rk += 4;
+        B5_AES_ENC_ROUND(sa, ta, rk);
+        B5_AES_ENC_ROUND(sb, tb, rk);
+    }
+    rk += 4;
+    B5_AES_ENC_ROUND(ta, sa, rk);
+    B5_AES_ENC_ROUND(tb, sb, rk);
+    rk += 4;
+
+    a[0] = B5_AES_LAST_WORD(ta0, ta1, ta2, ta3, rk[0]);
+    a[1] = B5_AES_LAST_WORD(ta1, ta2, ta3, ta0, rk[1]);
+    a[2] = B5_AES_LAST_WORD(ta2, ta3, ta0, ta1, rk[2]);
+    a[3] = B5_AES_LAST_WORD(ta3, ta0, ta1, ta2, rk[3]);
+    b[0] = B5_AES_LAST_WORD(tb0, tb1, tb2, tb3, rk[0]);
+    b[1] = B5_AES_LAST_WORD(tb1, tb2, tb3, tb0, rk[1]);
+    b[2] = B5_AES_LAST_WORD(tb2, tb3, tb0, tb1, rk[2]);
+    b[3] = B5_AES_LAST_WORD(tb3, tb0, tb1, tb2, rk[3]);
+}
+
+
+/**
+ * @brief AES decryption of two blocks.
+ * @param ctx Pointer to the current AES256 context.
+ * @param a first block, as four big endian words, replaced by the output
+ * @param b second block, as four big endian words, replaced by the output
+ */
+static void B5_rijndaelDecrypt2 (const B5_tAesCtx *ctx, uint32_t *a, uint32_t *b)
+{
+    const uint32_t *T = ctx->Td0;
+#if !defined(__arm__)
+    const uint32_t *T1 = ctx->Td1;
+    const uint32_t *T2 = ctx->Td2;
+    const uint32_t *T3 = ctx->Td3;
+#endif
+    const uint32_t *T4 = ctx->Td4;
+    const uint32_t *rk = ctx->rk;
+    uint32_t sa0, sa1, sa2, sa3, ta0, ta1, ta2, ta3;
+    uint32_t sb0, sb1, sb2, sb3, tb0, tb1, tb2, tb3;
+    int16_t r;
+
+    sa0 = a[0] ^ rk[0]; sa1 = a[1] ^ rk[1]; sa2 = a[2] ^ rk[2]; sa3 = a[3] ^ rk[3];
+    sb0 = b[0] ^ rk[0]; sb1 = b[1] ^ rk[1]; sb2 = b[2] ^ rk[2]; sb3 = b[3] ^ rk[3];
+
+    for (r = 1; r < ctx->Nr - 1; r += 2)
+    {
+        rk += 4;
+        B5_AES_DEC_ROUND(ta, sa, rk);
+        B5_AES_DEC_ROUND(tb, sb, rk);
+        rk += 4;
+        B5_AES_DEC_ROUND(sa, ta, rk);
+        B5_AES_DEC_ROUND(sb, tb, rk);
+    }
+    rk += 4;
+    B5_AES_DEC_ROUND(ta, sa, rk);
+    B5_AES_DEC_ROUND(tb, sb, rk);
+    rk += 4;
+
+    a[0] = B5_AES_LAST_WORD(ta0, ta3, ta2, ta1, rk[0]);
+    a[1] = B5_AES_LAST_WORD(ta1, ta0, ta3, ta2, rk[1]);
+    a[2] = B5_AES_LAST_WORD(ta2, ta1, ta0, ta3, rk[2]);
+    a[3] = B5_AES_LAST_WORD(ta3, ta2, ta1, ta0, rk[3]);
+    b[0] = B5_AES_LAST_WORD(tb0, tb3, tb2, tb1, rk[0]);
+    b[1] = B5_AES_LAST_WORD(tb1, tb0, tb3, tb2, rk[1]);
+    b[2] = B5_AES_LAST_WORD(tb2, tb1, tb0, tb3, rk[2]);
+    b[3] = B5_AES_LAST_WORD(tb3, tb2, tb1, tb0, rk[3]);
+}
+
+
+
+/* Load two consecutive blocks as big endian words */
+static void B5_Aes_Load2 (const uint8_t *p, uint32_t *a, uint32_t *b)
+{
+    int16_t j;
+
+    for (j = 0; j < 4; j++)
+    {
+        a[j] = B5_Aes_Load32(p + 4*j);
+        b[j] = B5_Aes_Load32(p + 16 + 4*j);
+    }
+}
+
+/* Store two consecutive blocks, XORed word by word with the blocks at x (if not NULL) */
+static void B5_Aes_Store2 (uint8_t *p, const uint32_t *a, const uint32_t *b, const uint8_t *x)
+{
+    int16_t j;
+
+    for (j = 0; j < 4; j++)
+    {
+        B5_Aes_Store32(p + 4*j,      (x == NULL) ? a[j] : (a[j] ^ B5_Aes_Load32(x + 4*j)));
+        B5_Aes_Store32(p + 16 + 4*j, (x == NULL) ? b[j] : (b[j] ^ B5_Aes_Load32(x + 16 + 4*j)));
+    }
+}
+
+/* Increment a 128 bit big endian counter held in four words */
+static void B5_Aes_CtrInc (uint32_t *c)
+{
+    if (++c[3] == 0)
+        if (++c[2] == 0)
+            if (++c[1] == 0)
+                ++c[0];
+}
+
+
+
 int32_t B5_Aes256_Init (B5_tAesCtx *ctx, const uint8_t *Key, int16_t keySize, uint8_t aesMode)
 {
     if(Key == NULL) 
@@ -1208,6 +1415,32 @@ int32_t B5_Aes256_Init (B5_tAesCtx *ctx, const uint8_t *Key, int16_t keySize, ui
     
     ctx->mode = aesMode;
     
+#ifdef B5_AES256_CCM
+    if (!B5_AesTables_Ready)
+    {
+        memcpy(B5_AesTables_CCM[0], B5Te0_S, sizeof(B5Te0_S));
+        memcpy(B5_AesTables_CCM[1], B5Te1_S, sizeof(B5Te1_S));
+        memcpy(B5_AesTables_CCM[2], B5Te2_S, sizeof(B5Te2_S));
+        memcpy(B5_AesTables_CCM[3], B5Te3_S, sizeof(B5Te3_S));
+        memcpy(B5_AesTables_CCM[4], B5Te4_S, sizeof(B5Te4_S));
+        memcpy(B5_AesTables_CCM[5], B5Td0_S, sizeof(B5Td0_S));
+        memcpy(B5_AesTables_CCM[6], B5Td1_S, sizeof(B5Td1_S));
+        memcpy(B5_AesTables_CCM[7], B5Td2_S, sizeof(B5Td2_S));
+        memcpy(B5_AesTables_CCM[8], B5Td3_S, sizeof(B5Td3_S));
+        memcpy(B5_AesTables_CCM[9], B5Td4_S, sizeof(B5Td4_S));
+        B5_AesTables_Ready = 1;
+    }
+    ctx->Te0 = B5_AesTables_CCM[0];
+    ctx->Te1 = B5_AesTables_CCM[1];
+    ctx->Te2 = B5_AesTables_CCM[2];
+    ctx->Te3 = B5_AesTables_CCM[3];
+    ctx->Te4 = B5_AesTables_CCM[4];
+    ctx->Td0 = B5_AesTables_CCM[5];
+    ctx->Td1 = B5_AesTables_CCM[6];
+    ctx->Td2 = B5_AesTables_CCM[7];
+    ctx->Td3 = B5_AesTables_CCM[8];
+    ctx->Td4 = B5_AesTables_CCM[9];
+#else
     ctx->Te0 = B5Te0_S;
     ctx->Te1 = B5Te1_S;
     ctx->Te2 = B5Te2_S;
@@ -1218,6 +1451,7 @@ int32_t B5_Aes256_Init (B5_tAesCtx *ctx, const uint8_t *Key, int16_t keySize, ui
     ctx->Td2 = B5Td2_S;
     ctx->Td3 = B5Td3_S;
     ctx->Td4 = B5Td4_S;
+#endif
     
     memset(ctx->InitVector, 0x55, B5_AES_IV_SIZE);
     
@@ -1234,6 +1468,14 @@ int32_t B5_Aes256_Init (B5_tAesCtx *ctx, const uint8_t *Key, int16_t keySize, ui
         return B5_AES256_RES_INVALID_MODE;        
     }
     
+    ctx->backend = B5_AES256_BACKEND_SW;
+#ifdef B5_AES256_NI
+    if ((B5_Aes256_Backend != B5_AES256_BACKEND_SW) && B5_Aes256Ni_Available())
+    {
+        B5_Aes256Ni_Setup(ctx);
+        ctx->backend = B5_AES256_BACKEND_NI;
+    }
+#endif
     
     return B5_AES256_RES_OK;
 }
@@ -1269,6 +1511,7 @@ int32_t B5_Aes256_Update (B5_tAesCtx	*ctx, uint8_t *encData, uint8_t *clrData, i
 {
     int16_t    i, j, cb;
     uint8_t    tmp[B5_AES_BLK_SIZE];
+    uint32_t   a[4], b[4], c[4], x[4], y[4];
     
     
     
@@ -1279,21 +1522,40 @@ int32_t B5_Aes256_Update (B5_tAesCtx	*ctx, uint8_t *encData, uint8_t *clrData, i
     if((encData == NULL) || (clrData == NULL) || (nBlk <= 0))
         return B5_AES256_RES_INVALID_ARGUMENT;
     
+#ifdef B5_AES256_NI
+    if (ctx->backend == B5_AES256_BACKEND_NI)
+        return B5_Aes256Ni_Update(ctx, encData, clrData, nBlk);
+#endif
+    
     
     switch(ctx->mode) {
         
         
         case B5_AES256_CTR: 
         {
-            for (i = 0; i < nBlk; i++) 
+            for (j = 0; j < 4; j++)
+                c[j] = B5_Aes_Load32(ctx->InitVector + 4*j);
+            for (i = 0; i + 1 < nBlk; i += 2)
+            {
+                memcpy(a, c, sizeof(a));
+                B5_Aes_CtrInc(c);
+                memcpy(b, c, sizeof(b));
+                B5_Aes_CtrInc(c);
+                B5_rijndaelEncrypt2(ctx, a, b);
+                B5_Aes_Store2(encData, a, b, clrData);
+                encData += 2*B5_AES_BLK_SIZE;
+                clrData += 2*B5_AES_BLK_SIZE;
+            }
+            for (j = 0; j < 4; j++)
+                B5_Aes_Store32(ctx->InitVector + 4*j, c[j]);
+            
+            for (; i < nBlk; i++) 
             {
-                B5_rijndaelEncrypt(ctx, ctx->rk, ctx->Nr, ctx->InitVector, encData);
+                // key stream in tmp, so that encData may be the same buffer as clrData
+                B5_rijndaelEncrypt(ctx, ctx->rk, ctx->Nr, ctx->InitVector, tmp);
                 for (j = 0; j < B5_AES_BLK_SIZE; j++) 
                 {
-                    //*encData = *clrData++ ^ encData[j];
-                    //*encData++;
-                    /*Working*/
-					*encData = *encData ^ *clrData;
+					*encData = tmp[j] ^ *clrData;
 					encData++;
 					clrData++;
                 }
@@ -1327,7 +1589,15 @@ int32_t B5_Aes256_Update (B5_tAesCtx	*ctx, uint8_t *encData, uint8_t *clrData, i
         
         case B5_AES256_ECB_ENC:
         {
-            for (i = 0; i < nBlk; i++) 
+            for (i = 0; i + 1 < nBlk; i += 2)
+            {
+                B5_Aes_Load2(clrData, a, b);
+                B5_rijndaelEncrypt2(ctx, a, b);
+                B5_Aes_Store2(encData, a, b, NULL);
+                clrData += 2*B5_AES_BLK_SIZE;
+                encData += 2*B5_AES_BLK_SIZE;
+            }
+            for (; i < nBlk; i++) 
             {
                 B5_rijndaelEncrypt(ctx, ctx->rk, ctx->Nr, clrData, encData);
                 clrData += 16;
@@ -1340,7 +1610,15 @@ int32_t B5_Aes256_Update (B5_tAesCtx	*ctx, uint8_t *encData, uint8_t *clrData, i
         
         case B5_AES256_ECB_DEC:
         {
-            for (i = 0; i < nBlk; i++) 
+            for (i = 0; i + 1 < nBlk; i += 2)
+            {
+                B5_Aes_Load2(encData, a, b);
+                B5_rijndaelDecrypt2(ctx, a, b);
+                B5_Aes_Store2(clrData, a, b, NULL);
+                clrData += 2*B5_AES_BLK_SIZE;
+                encData += 2*B5_AES_BLK_SIZE;
+            }
+            for (; i < nBlk; i++) 
             {
                 B5_rijndaelDecrypt(ctx, ctx->rk, ctx->Nr, encData, clrData);
                 clrData += 16;
@@ -1376,7 +1654,29 @@ int32_t B5_Aes256_Update (B5_tAesCtx	*ctx, uint8_t *encData, uint8_t *clrData, i
         
         case B5_AES256_CBC_DEC:
         {
-            for (i = 0; i < nBlk; i++) 
+            // the decryptions are independent, only the final XOR is chained
+            for (j = 0; j < 4; j++)
+                c[j] = B5_Aes_Load32(ctx->InitVector + 4*j);
+            for (i = 0; i + 1 < nBlk; i += 2)
+            {
+                B5_Aes_Load2(encData, a, b);
+                memcpy(x, a, sizeof(x));
+                memcpy(y, b, sizeof(y));
+                B5_rijndaelDecrypt2(ctx, a, b);
+                for (j = 0; j < 4; j++)
+                {
+                    a[j] ^= c[j];
+                    b[j] ^= x[j];
+                    c[j] = y[j];
+                }
+                B5_Aes_Store2(clrData, a, b, NULL);
+                clrData += 2*B5_AES_BLK_SIZE;
+                encData += 2*B5_AES_BLK_SIZE;
+            }
+            for (j = 0; j < 4; j++)
+                B5_Aes_Store32(ctx->InitVector + 4*j, c[j]);
+            
+            for (; i < nBlk; i++) 
             {
                 for (j = 0; j < 16; j++) 
                 {
@@ -1461,6 +1761,34 @@ int32_t B5_Aes256_Finit (B5_tAesCtx    *ctx)
 
 
 
+int32_t B5_Aes256_SetBackend (uint8_t backend)
+{
+    switch (backend)
+    {
+        case B5_AES256_BACKEND_AUTO:
+        case B5_AES256_BACKEND_SW:
+            break;
+            
+#ifdef B5_AES256_NI
+        case B5_AES256_BACKEND_NI:
+            if (!B5_Aes256Ni_Available())
+                return B5_AES256_RES_INVALID_ARGUMENT;
+            break;
+#endif
+            
+        default:
+            return B5_AES256_RES_INVALID_ARGUMENT;
+    }
+    
+    B5_Aes256_Backend = backend;
+    
+    return B5_AES256_RES_OK;
+}
+
+
+
+
+
 
 
 
@@ -1472,90 +1800,54 @@ int32_t B5_Aes256_Finit (B5_tAesCtx    *ctx)
 
 int32_t B5_CmacAes256_Sign (const uint8_t *data, int32_t dataLen, const uint8_t *Key, int16_t keySize, uint8_t *rSignature)
 {
-    uint8_t        K1[B5_AES_BLK_SIZE], K2[B5_AES_BLK_SIZE];
-    uint8_t        L[B5_AES_BLK_SIZE], C[B5_AES_BLK_SIZE], Z[B5_AES_BLK_SIZE];
-    uint8_t        MN[B5_AES_BLK_SIZE];
-    uint8_t        Rb16[16]={0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x87};
-    int32_t        i;
-    B5_tAesCtx      aesCtx;
+    B5_tCmacAesCtx  ctx;
+    int32_t         res;
     
     
     if((data == NULL) || (dataLen < 0) || (Key == NULL) || (rSignature == NULL))
         return B5_CMAC_AES256_RES_INVALID_ARGUMENT;
     
-    if((keySize != B5_CMAC_AES_128) && (keySize != B5_CMAC_AES_192) && (keySize != B5_CMAC_AES_256)) 
-        return B5_CMAC_AES256_RES_INVALID_KEY_SIZE;
-    
-    
-    memset(Z, 0x00, sizeof(Z));
-    
-    
-    // Init AES to prepare K1 and K2 subKeys
-    B5_Aes256_Init(&aesCtx, Key, keySize, B5_AES256_ECB_ENC);
-    B5_Aes256_Update(&aesCtx, L, Z, 1);
-    
-    
-    // Prepare K1
-    for (i=0; i < (B5_AES_BLK_SIZE-1); i++)
-        K1[i] = (L[i] << 1) + (L[i+1] >> 7);
-    K1[i] = L[i] << 1;
-    
-    if ((L[0] & 0x80) == 0x80) 
-    {
-        for (i=0; i < B5_AES_BLK_SIZE; i++)
-            K1[i] ^= Rb16[i];
-    }
-    
-    
-    // Prepare K2
-    for (i=0; i < (B5_AES_BLK_SIZE-1); i++)
-        K2[i] = (K1[i] << 1) + (K1[i+1] >> 7);
-    K2[i] = K1[i] << 1;
-    
-    if ((K1[0] & 0x80) == 0x80) {
-        for (i=0; i < B5_AES_BLK_SIZE; i++)
-            K2[i] ^= Rb16[i];
-    }
+    res = B5_CmacAes256_Init(&ctx, Key, keySize);
+    if (res == B5_CMAC_AES256_RES_OK)
+        res = B5_CmacAes256_Update(&ctx, data, dataLen);
+    if (res == B5_CMAC_AES256_RES_OK)
+        res = B5_CmacAes256_Finit(&ctx, rSignature);
     
+    B5_Aes256_Finit(&ctx.aesCtx);
+    memset(&ctx, 0, sizeof(ctx));
     
-    // Calculate MAC (from 1 to N-1 blk)
-    memcpy(C, Z, sizeof(Z));
-    while(dataLen > B5_AES_BLK_SIZE)
-    {
-        for (i=0; i < B5_AES_BLK_SIZE; i++)
-            C[i] ^= data[i];
-        
-        B5_Aes256_Update(&aesCtx, C, C, 1);
-        
-        dataLen -= B5_AES_BLK_SIZE;
-        data += B5_AES_BLK_SIZE;
-    }
+    return res;
+}
+
+
+
+
+
+#define B5_CMAC_CHAIN_BLK   4   /**< Blocks chained per B5_Aes256_Update call */
+
+/**
+ * @brief Chain whole blocks into the MAC. The CBC-MAC is a CBC encryption with C as IV whose
+ * output is discarded but for the last block, so the AES context runs in CBC mode and takes
+ * several blocks per call, straight from the input buffer.
+ * @param ctx Pointer to the current CMAC-AES context.
+ * @param data Input blocks.
+ * @param nBlk Number of blocks, at least one.
+ */
+static void B5_Cmac_Chain (B5_tCmacAesCtx *ctx, const uint8_t *data, int32_t nBlk)
+{
+    uint8_t    out[B5_CMAC_CHAIN_BLK * B5_AES_BLK_SIZE];
+    int16_t    n;
     
     
-    // Last Block
-    if(dataLen == B5_AES_BLK_SIZE)
-    {
-        for (i=0; i < dataLen; i++)
-            MN[i] = K1[i] ^ data[i];
-    }
-    else
+    B5_Aes256_SetIV(&ctx->aesCtx, ctx->C);
+    do
     {
-        for (i=0; i < B5_AES_BLK_SIZE; i++)
-            MN[i] = K2[i];	
-        for (i=0; i < dataLen; i++)
-            MN[i] ^= data[i];
-        MN[dataLen] ^= 0x80;
-    }
-    
-    
-    for (i=0; i<B5_AES_BLK_SIZE; i++)
-        C[i] ^= MN[i];
-    
-    B5_Aes256_Update(&aesCtx, rSignature, C, 1);
-    B5_Aes256_Finit(&aesCtx);
-    
-    
-    return B5_CMAC_AES256_RES_OK;
+        n = (nBlk < B5_CMAC_CHAIN_BLK) ? (int16_t)nBlk : B5_CMAC_CHAIN_BLK;
+        B5_Aes256_Update(&ctx->aesCtx, out, (uint8_t*)data, n);
+        data += n * B5_AES_BLK_SIZE;
+        nBlk -= n;
+    } while (nBlk > 0);
+    memcpy(ctx->C, &out[(n - 1) * B5_AES_BLK_SIZE], B5_AES_BLK_SIZE);
 }
 
 
@@ -1578,12 +1870,16 @@ int32_t B5_CmacAes256_Init (B5_tCmacAesCtx *ctx, const uint8_t *Key, int16_t key
     
     memset(ctx, 0, sizeof(B5_tCmacAesCtx));
     
+    if((keySize != B5_CMAC_AES_128) && (keySize != B5_CMAC_AES_192) && (keySize != B5_CMAC_AES_256)) 
+        return B5_CMAC_AES256_RES_INVALID_KEY_SIZE;
+    
     
     memset(Z, 0x00, sizeof(Z));
     
     
-    // Init AES to prepare K1 and K2 subKeys
-    B5_Aes256_Init(&ctx->aesCtx, Key, keySize, B5_AES256_ECB_ENC);
+    // Init AES to prepare K1 and K2 subKeys; with a zero IV, CBC gives L = E(0)
+    B5_Aes256_Init(&ctx->aesCtx, Key, keySize, B5_AES256_CBC_ENC);
+    B5_Aes256_SetIV(&ctx->aesCtx, Z);
     B5_Aes256_Update(&ctx->aesCtx, L, Z, 1);
     
     // Prepare K1
@@ -1608,6 +1904,7 @@ int32_t B5_CmacAes256_Init (B5_tCmacAesCtx *ctx, const uint8_t *Key, int16_t key
     }
     
     memcpy(ctx->C, Z, sizeof(Z));
+    memset(L, 0, sizeof(L));
     
     ctx->tmpBlkLen = 0;
     
@@ -1620,7 +1917,7 @@ int32_t B5_CmacAes256_Init (B5_tCmacAesCtx *ctx, const uint8_t *Key, int16_t key
 
 int32_t B5_CmacAes256_Update (B5_tCmacAesCtx *ctx, const uint8_t *data, int32_t dataLen)
 {
-    int32_t    i;
+    uint8_t    n;
     
     
     if(ctx == NULL)
@@ -1635,10 +1932,13 @@ int32_t B5_CmacAes256_Update (B5_tCmacAesCtx *ctx, const uint8_t *data, int32_t
         return B5_CMAC_AES256_RES_OK;
     
     
+    // The last block is always kept in tmpBlk, since Finit must mask it with K1 or K2
     if(ctx->tmpBlkLen > 0)
     {
+        n = B5_AES_BLK_SIZE - ctx->tmpBlkLen;
+        
         // Not enough
-        if((dataLen + ctx->tmpBlkLen) <= B5_AES_BLK_SIZE)
+        if(dataLen <= n)
         {
             memcpy(&ctx->tmpBlk[ctx->tmpBlkLen], data, dataLen);
             ctx->tmpBlkLen += dataLen;
@@ -1646,30 +1946,25 @@ int32_t B5_CmacAes256_Update (B5_tCmacAesCtx *ctx, const uint8_t *data, int32_t
         }
         
         // Process the first block (merging tmpBlk and data) and adjust data pointer
-        memcpy(&ctx->tmpBlk[ctx->tmpBlkLen], data, B5_AES_BLK_SIZE-ctx->tmpBlkLen);
-        for (i=0; i < B5_AES_BLK_SIZE; i++)
-            ctx->C[i] ^= ctx->tmpBlk[i];
-                B5_Aes256_Update(&ctx->aesCtx, ctx->C, ctx->C, 1);   
-        data += (B5_AES_BLK_SIZE-ctx->tmpBlkLen);
-        dataLen -= (B5_AES_BLK_SIZE-ctx->tmpBlkLen);
+        memcpy(&ctx->tmpBlk[ctx->tmpBlkLen], data, n);
+        B5_Cmac_Chain(ctx, ctx->tmpBlk, 1);
+        data += n;
+        dataLen -= n;
         ctx->tmpBlkLen = 0;
     }
     
     
-    
-    // Other Blocks
-    while (dataLen > B5_AES_BLK_SIZE) 
+    // Other Blocks, but the last one
+    if (dataLen > B5_AES_BLK_SIZE)
     {
-        for (i=0; i < B5_AES_BLK_SIZE; i++)
-            ctx->C[i] ^= data[i];   
-                B5_Aes256_Update(&ctx->aesCtx, ctx->C, ctx->C, 1);   
-        dataLen -= B5_AES_BLK_SIZE;
-        data += B5_AES_BLK_SIZE;
+        B5_Cmac_Chain(ctx, data, (dataLen - 1) / B5_AES_BLK_SIZE);
+        data += ((dataLen - 1) / B5_AES_BLK_SIZE) * B5_AES_BLK_SIZE;
+        dataLen -= ((dataLen - 1) / B5_AES_BLK_SIZE) * B5_AES_BLK_SIZE;
     }
     
     
     memcpy(&ctx->tmpBlk[0], data, dataLen);
-    ctx->tmpBlkLen = dataLen;
+    ctx->tmpBlkLen = (uint8_t)dataLen;
     
     
     return B5_CMAC_AES256_RES_OK;
@@ -1709,10 +2004,9 @@ int32_t B5_CmacAes256_Finit (B5_tCmacAesCtx *ctx, uint8_t *rSignature)
     }
     
     
-    for (i=0; i<B5_AES_BLK_SIZE; i++)
-        ctx->C[i] ^= MN[i];
-    
-    B5_Aes256_Update(&ctx->aesCtx, rSignature, ctx->C, 1);   
+    // E(C ^ MN), the CBC chaining does the XOR
+    B5_Aes256_SetIV(&ctx->aesCtx, ctx->C);
+    B5_Aes256_Update(&ctx->aesCtx, rSignature, MN, 1);   
 
     
     return B5_CMAC_AES256_RES_OK;
@@ -1733,3 +2027,742 @@ int32_t B5_CmacAes256_Reset (B5_tCmacAesCtx *ctx)
     return B5_CMAC_AES256_RES_OK;
 }
 
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+/** Longest message accepted by GCM, in Bytes (2^39 - 256 bits) */
+#define B5_GCM_MAX_DATA_LEN     ((((uint64_t)1) << 36) - 32)
+
+/** Blocks given to B5_Aes256_Update in one call */
+#define B5_GCM_CTR_CHUNK        1024
+
+/** Reduction of the four bits shifted out of the field element, for the 4-bit table multiplication */
+static const uint64_t B5_Gcm_Last4[16] = {
+    0x0000, 0x1c20, 0x3840, 0x2460, 0x7080, 0x6ca0, 0x48c0, 0x54e0,
+    0xe100, 0xfd20, 0xd940, 0xc560, 0x9180, 0x8da0, 0xa9c0, 0xb5e0
+};
+
+static const uint8_t B5_Gcm_Zero[B5_AES_BLK_SIZE] = { 0 };
+
+
+static uint64_t B5_Gcm_Load64 (const uint8_t *p)
+{
+    return ((uint64_t)B5_Aes_Load32(p) << 32) | (uint64_t)B5_Aes_Load32(p + 4);
+}
+
+static void B5_Gcm_Store64 (uint8_t *p, uint64_t w)
+{
+    B5_Aes_Store32(p, (uint32_t)(w >> 32));
+    B5_Aes_Store32(p + 4, (uint32_t)w);
+}
+
+
+/**
+ * @brief Multiply the GHASH accumulator by H, four bits at a time (Shoup's method).
+ * @param ctx Pointer to the current GCM-AES context.
+ */
+static void B5_Gcm_Mult (B5_tGcmAesCtx *ctx)
+{
+    uint64_t   zh, zl;
+    uint8_t    lo, hi, rem;
+    int32_t    i;
+    
+    
+    lo = ctx->X[15] & 0x0f;
+    zh = ctx->HH[lo];
+    zl = ctx->HL[lo];
+    
+    for (i = 15; i >= 0; i--)
+    {
+        lo = ctx->X[i] & 0x0f;
+        hi = (ctx->X[i] >> 4) & 0x0f;
+        
+        if (i != 15)
+        {
+            rem = (uint8_t)(zl & 0x0f);
+            zl = (zh << 60) | (zl >> 4);
+            zh = (zh >> 4) ^ (B5_Gcm_Last4[rem] << 48);
+            zh ^= ctx->HH[lo];
+            zl ^= ctx->HL[lo];
+        }
+        
+        rem = (uint8_t)(zl & 0x0f);
+        zl = (zh << 60) | (zl >> 4);
+        zh = (zh >> 4) ^ (B5_Gcm_Last4[rem] << 48);
+        zh ^= ctx->HH[hi];
+        zl ^= ctx->HL[hi];
+    }
+    
+    B5_Gcm_Store64(ctx->X, zh);
+    B5_Gcm_Store64(ctx->X + 8, zl);
+}
+
+
+/**
+ * @brief Absorb whole blocks into the GHASH accumulator.
+ * @param ctx Pointer to the current GCM-AES context.
+ * @param data Input blocks.
+ * @param nBlk Number of blocks.
+ */
+static void B5_Gcm_Hash (B5_tGcmAesCtx *ctx, const uint8_t *data, int32_t nBlk)
+{
+    int32_t    i;
+    
+    
+    for (; nBlk > 0; nBlk--)
+    {
+        for (i = 0; i < B5_AES_BLK_SIZE; i++)
+            ctx->X[i] ^= data[i];
+        B5_Gcm_Mult(ctx);
+        data += B5_AES_BLK_SIZE;
+    }
+}
+
+
+/**
+ * @brief Absorb the pending partial block, padded with zeros.
+ * @param ctx Pointer to the current GCM-AES context.
+ * @param len Bytes pending in tmpBlk.
+ */
+static void B5_Gcm_HashPending (B5_tGcmAesCtx *ctx, uint8_t len)
+{
+    if (len == 0)
+        return;
+    
+    memset(&ctx->tmpBlk[len], 0, B5_AES_BLK_SIZE - len);
+    B5_Gcm_Hash(ctx, ctx->tmpBlk, 1);
+}
+
+
+/**
+ * @brief CTR encryption incrementing only the rightmost 32 bits of the counter, as GCM requires.
+ * B5_Aes256_Update increments the whole block, so the calls are split where the low word
+ * wraps and the upper 96 bits are restored after each call.
+ * @param ctx Pointer to the current GCM-AES context.
+ * @param out Output blocks.
+ * @param in Input blocks, may be the same as out.
+ * @param nBlk Number of blocks.
+ */
+static void B5_Gcm_Ctr (B5_tGcmAesCtx *ctx, uint8_t *out, const uint8_t *in, int32_t nBlk)
+{
+    uint8_t    upper[B5_AES_BLK_SIZE - 4];
+    uint32_t   avail;
+    int32_t    n;
+    
+    
+    while (nBlk > 0)
+    {
+        n = (nBlk > B5_GCM_CTR_CHUNK) ? B5_GCM_CTR_CHUNK : nBlk;
+        
+        // blocks left before the low word wraps; 0 means 2^32
+        avail = (uint32_t)0 - B5_Aes_Load32(&ctx->aesCtx.InitVector[12]);
+        if ((avail != 0) && ((uint32_t)n > avail))
+            n = (int32_t)avail;
+        
+        memcpy(upper, ctx->aesCtx.InitVector, sizeof(upper));
+        B5_Aes256_Update(&ctx->aesCtx, out, (uint8_t*)in, (int16_t)n);
+        memcpy(ctx->aesCtx.InitVector, upper, sizeof(upper));
+        
+        out += n * B5_AES_BLK_SIZE;
+        in += n * B5_AES_BLK_SIZE;
+        nBlk -= n;
+    }
+}
+
+
+
+
+
+int32_t B5_GcmAes256_Init (B5_tGcmAesCtx *ctx, const uint8_t *Key, int16_t keySize, uint8_t gcmMode)
+{
+    uint8_t    H[B5_AES_BLK_SIZE];
+    uint64_t   vh, vl;
+    uint32_t   T;
+    int32_t    i, j;
+    
+    
+    if(Key == NULL) 
+        return B5_GCM_AES256_RES_INVALID_ARGUMENT;
+    
+    if(ctx == NULL)
+        return  B5_GCM_AES256_RES_INVALID_CONTEXT;
+    
+    memset(ctx, 0, sizeof(B5_tGcmAesCtx));
+    
+    if ((gcmMode != B5_GCM_AES256_ENC) && (gcmMode != B5_GCM_AES256_DEC))
+        return B5_GCM_AES256_RES_INVALID_MODE;
+    
+    if (B5_AES256_RES_OK != B5_Aes256_Init(&ctx->aesCtx, Key, keySize, B5_AES256_CTR))
+        return B5_GCM_AES256_RES_INVALID_KEY_SIZE;
+    
+    ctx->mode = gcmMode;
+    ctx->state = B5_GCM_STATE_NO_IV;
+    
+    // H = E(K, 0^128): with a zero counter the first key stream block is H
+    B5_Aes256_SetIV(&ctx->aesCtx, B5_Gcm_Zero);
+    B5_Gcm_Ctr(ctx, H, B5_Gcm_Zero, 1);
+    
+    // HH/HL[i] = i * H for the 4-bit values i, bit-reflected as in the GCM specification
+    vh = B5_Gcm_Load64(H);
+    vl = B5_Gcm_Load64(H + 8);
+    
+    ctx->HL[8] = vl;
+    ctx->HH[8] = vh;
+    ctx->HL[0] = 0;
+    ctx->HH[0] = 0;
+    
+    for (i = 4; i > 0; i >>= 1)
+    {
+        T = (uint32_t)(vl & 1) * 0xe1000000U;
+        vl = (vh << 63) | (vl >> 1);
+        vh = (vh >> 1) ^ ((uint64_t)T << 32);
+        ctx->HL[i] = vl;
+        ctx->HH[i] = vh;
+    }
+    
+    for (i = 2; i <= 8; i *= 2)
+    {
+        for (j = 1; j < i; j++)
+        {
+            ctx->HH[i + j] = ctx->HH[i] ^ ctx->HH[j];
+            ctx->HL[i + j] = ctx->HL[i] ^ ctx->HL[j];
+        }
+    }
+    
+    memset(H, 0, sizeof(H));
+    
+    return B5_GCM_AES256_RES_OK;
+}
+
+
+
+
+
+int32_t B5_GcmAes256_SetIV (B5_tGcmAesCtx *ctx, const uint8_t *IV, int32_t ivLen)
+{
+    uint8_t    J0[B5_AES_BLK_SIZE];
+    
+    
+    if(ctx == NULL)
+        return  B5_GCM_AES256_RES_INVALID_CONTEXT;
+    
+    if((IV == NULL) || (ivLen <= 0))
+        return B5_GCM_AES256_RES_INVALID_ARGUMENT;
+    
+    
+    memset(ctx->X, 0, sizeof(ctx->X));
+    
+    if (ivLen == B5_GCM_AES_IV_SIZE)
+    {
+        // J0 = IV || 0^31 || 1
+        memcpy(J0, IV, B5_GCM_AES_IV_SIZE);
+        B5_Aes_Store32(&J0[12], 1);
+    }
+    else
+    {
+        // J0 = GHASH(IV || 0^s || 0^64 || [len(IV)]64)
+        B5_Gcm_Hash(ctx, IV, ivLen / B5_AES_BLK_SIZE);
+        memcpy(ctx->tmpBlk, IV + (ivLen - ivLen % B5_AES_BLK_SIZE), ivLen % B5_AES_BLK_SIZE);
+        B5_Gcm_HashPending(ctx, (uint8_t)(ivLen % B5_AES_BLK_SIZE));
+        
+        memset(J0, 0, 8);
+        B5_Gcm_Store64(&J0[8], (uint64_t)ivLen * 8);
+        B5_Gcm_Hash(ctx, J0, 1);
+        
+        memcpy(J0, ctx->X, sizeof(J0));
+        memset(ctx->X, 0, sizeof(ctx->X));
+    }
+    
+    // the first counter block masks the tag, data starts from inc32(J0)
+    B5_Aes256_SetIV(&ctx->aesCtx, J0);
+    B5_Gcm_Ctr(ctx, ctx->EkJ0, B5_Gcm_Zero, 1);
+    
+    ctx->aadLen = 0;
+    ctx->dataLen = 0;
+    ctx->state = B5_GCM_STATE_AAD;
+    
+    return B5_GCM_AES256_RES_OK;
+}
+
+
+
+
+
+int32_t B5_GcmAes256_UpdateAad (B5_tGcmAesCtx *ctx, const uint8_t *aad, int32_t aadLen)
+{
+    uint8_t    off, n;
+    
+    
+    if(ctx == NULL)
+        return  B5_GCM_AES256_RES_INVALID_CONTEXT;
+    
+    if((aadLen < 0) || ((aad == NULL) && (aadLen > 0)))
+        return B5_GCM_AES256_RES_INVALID_ARGUMENT;
+    
+    if(ctx->state != B5_GCM_STATE_AAD)
+        return B5_GCM_AES256_RES_INVALID_STATE;
+    
+    if(aadLen == 0)
+        return B5_GCM_AES256_RES_OK;
+    
+    
+    off = (uint8_t)(ctx->aadLen % B5_AES_BLK_SIZE);
+    ctx->aadLen += (uint64_t)aadLen;
+    
+    // Complete the pending block
+    if (off > 0)
+    {
+        n = (aadLen < (B5_AES_BLK_SIZE - off)) ? (uint8_t)aadLen : (uint8_t)(B5_AES_BLK_SIZE - off);
+        memcpy(&ctx->tmpBlk[off], aad, n);
+        aad += n;
+        aadLen -= n;
+        if ((off + n) < B5_AES_BLK_SIZE)
+            return B5_GCM_AES256_RES_OK;
+        B5_Gcm_Hash(ctx, ctx->tmpBlk, 1);
+    }
+    
+    // Whole blocks, then keep the tail
+    B5_Gcm_Hash(ctx, aad, aadLen / B5_AES_BLK_SIZE);
+    memcpy(ctx->tmpBlk, aad + (aadLen - aadLen % B5_AES_BLK_SIZE), aadLen % B5_AES_BLK_SIZE);
+    
+    return B5_GCM_AES256_RES_OK;
+}
+
+
+
+
+
+int32_t B5_GcmAes256_Update (B5_tGcmAesCtx *ctx, uint8_t *encData, uint8_t *clrData, int32_t dataLen)
+{
+    const uint8_t  *in;
+    uint8_t        *out;
+    uint8_t        off, c;
+    int32_t        nBlk;
+    uint8_t        enc;
+    
+    
+    if(ctx == NULL)
+        return  B5_GCM_AES256_RES_INVALID_CONTEXT;
+    
+    if((dataLen < 0) || (((encData == NULL) || (clrData == NULL)) && (dataLen > 0)))
+        return B5_GCM_AES256_RES_INVALID_ARGUMENT;
+    
+    if(ctx->state == B5_GCM_STATE_AAD)
+    {
+        B5_Gcm_HashPending(ctx, (uint8_t)(ctx->aadLen % B5_AES_BLK_SIZE));
+        ctx->state = B5_GCM_STATE_DATA;
+    }
+    else if(ctx->state != B5_GCM_STATE_DATA)
+        return B5_GCM_AES256_RES_INVALID_STATE;
+    
+    if(ctx->dataLen + (uint64_t)dataLen > B5_GCM_MAX_DATA_LEN)
+        return B5_GCM_AES256_RES_INVALID_ARGUMENT;
+    
+    if(dataLen == 0)
+        return B5_GCM_AES256_RES_OK;
+    
+    
+    enc = (ctx->mode == B5_GCM_AES256_ENC);
+    in = enc ? clrData : encData;
+    out = enc ? encData : clrData;
+    
+    off = (uint8_t)(ctx->dataLen % B5_AES_BLK_SIZE);
+    ctx->dataLen += (uint64_t)dataLen;
+    
+    // Use the rest of the key stream of the pending block
+    if (off > 0)
+    {
+        while ((off < B5_AES_BLK_SIZE) && (dataLen > 0))
+        {
+            c = *in++;
+            *out = c ^ ctx->keyStream[off];
+            ctx->tmpBlk[off++] = enc ? *out : c;
+            out++;
+            dataLen--;
+        }
+        if (off < B5_AES_BLK_SIZE)
+            return B5_GCM_AES256_RES_OK;
+        B5_Gcm_Hash(ctx, ctx->tmpBlk, 1);
+    }
+    
+    // Whole blocks: the cipher text is hashed before decryption and after encryption, so in-place works
+    nBlk = dataLen / B5_AES_BLK_SIZE;
+    if (nBlk > 0)
+    {
+        if (!enc)
+            B5_Gcm_Hash(ctx, in, nBlk);
+        B5_Gcm_Ctr(ctx, out, in, nBlk);
+        if (enc)
+            B5_Gcm_Hash(ctx, out, nBlk);
+        in += nBlk * B5_AES_BLK_SIZE;
+        out += nBlk * B5_AES_BLK_SIZE;
+        dataLen -= nBlk * B5_AES_BLK_SIZE;
+    }
+    
+    // Start a new pending block with the tail
+    if (dataLen > 0)
+    {
+        B5_Gcm_Ctr(ctx, ctx->keyStream, B5_Gcm_Zero, 1);
+        for (off = 0; off < dataLen; off++)
+        {
+            c = in[off];
+            out[off] = c ^ ctx->keyStream[off];
+            ctx->tmpBlk[off] = enc ? out[off] : c;
+        }
+    }
+    
+    return B5_GCM_AES256_RES_OK;
+}
+
+
+
+
+
+int32_t B5_GcmAes256_Finit (B5_tGcmAesCtx *ctx, uint8_t *rTag)
+{
+    uint8_t    lenBlk[B5_AES_BLK_SIZE];
+    int32_t    i;
+    
+    
+    if(ctx == NULL)
+        return  B5_GCM_AES256_RES_INVALID_CONTEXT;
+    
+    if(rTag == NULL)
+        return B5_GCM_AES256_RES_INVALID_ARGUMENT;
+    
+    if(ctx->state == B5_GCM_STATE_AAD)
+        B5_Gcm_HashPending(ctx, (uint8_t)(ctx->aadLen % B5_AES_BLK_SIZE));
+    else if(ctx->state == B5_GCM_STATE_DATA)
+        B5_Gcm_HashPending(ctx, (uint8_t)(ctx->dataLen % B5_AES_BLK_SIZE));
+    else
+        return B5_GCM_AES256_RES_INVALID_STATE;
+    
+    
+    // [len(A)]64 || [len(C)]64
+    B5_Gcm_Store64(lenBlk, ctx->aadLen * 8);
+    B5_Gcm_Store64(lenBlk + 8, ctx->dataLen * 8);
+    B5_Gcm_Hash(ctx, lenBlk, 1);
+    
+    for (i = 0; i < B5_GCM_AES_TAG_SIZE; i++)
+        rTag[i] = ctx->X[i] ^ ctx->EkJ0[i];
+    
+    ctx->state = B5_GCM_STATE_NO_IV;
+    
+    return B5_GCM_AES256_RES_OK;
+}
+
+
+
+
+
+int32_t B5_GcmAes256_Verify (B5_tGcmAesCtx *ctx, const uint8_t *tag, int16_t tagLen)
+{
+    uint8_t    T[B5_GCM_AES_TAG_SIZE];
+    uint8_t    diff = 0;
+    int32_t    i, res;
+    
+    
+    if(ctx == NULL)
+        return  B5_GCM_AES256_RES_INVALID_CONTEXT;
+    
+    if((tag == NULL) || (tagLen < 4) || (tagLen > B5_GCM_AES_TAG_SIZE))
+        return B5_GCM_AES256_RES_INVALID_ARGUMENT;
+    
+    res = B5_GcmAes256_Finit(ctx, T);
+    if (res != B5_GCM_AES256_RES_OK)
+        return res;
+    
+    for (i = 0; i < tagLen; i++)
+        diff |= T[i] ^ tag[i];
+    
+    memset(T, 0, sizeof(T));
+    
+    return (diff == 0) ? B5_GCM_AES256_RES_OK : B5_GCM_AES256_RES_AUTH_FAILED;
+}
+
+
+
+
+
+/** Load a little endian 64-bit word */
+static uint64_t B5_Xts_Load64 (const uint8_t *p)
+{
+    return ((uint64_t)p[0]) | ((uint64_t)p[1] << 8) | ((uint64_t)p[2] << 16) | ((uint64_t)p[3] << 24) |
+           ((uint64_t)p[4] << 32) | ((uint64_t)p[5] << 40) | ((uint64_t)p[6] << 48) | ((uint64_t)p[7] << 56);
+}
+
+
+/** XOR one block with the tweak t, stored as two little endian 64-bit halves */
+static void B5_Xts_Xor (uint8_t *out, const uint8_t *in, const uint64_t *t)
+{
+    int32_t    i;
+    
+    for (i = 0; i < 8; i++)
+    {
+        out[i] = in[i] ^ (uint8_t)(t[0] >> (8*i));
+        out[i + 8] = in[i + 8] ^ (uint8_t)(t[1] >> (8*i));
+    }
+}
+
+
+/** Multiply the tweak by the primitive element alpha of GF(2^128), x^128 + x^7 + x^2 + x + 1 */
+static void B5_Xts_Double (uint64_t *t)
+{
+    uint64_t   carry = t[1] >> 63;
+    
+    t[1] = (t[1] << 1) | (t[0] >> 63);
+    t[0] = (t[0] << 1) ^ (carry * 0x87);
+}
+
+
+
+
+
+int32_t B5_XtsAes256_Init (B5_tXtsAesCtx *ctx, const uint8_t *Key, int16_t keySize, uint8_t xtsMode)
+{
+    int16_t    half;
+    
+    
+    if(Key == NULL) 
+        return B5_XTS_AES256_RES_INVALID_ARGUMENT;
+    
+    if(ctx == NULL)
+        return  B5_XTS_AES256_RES_INVALID_CONTEXT;
+    
+    memset(ctx, 0, sizeof(B5_tXtsAesCtx));
+    
+    if ((xtsMode != B5_XTS_AES256_ENC) && (xtsMode != B5_XTS_AES256_DEC))
+        return B5_XTS_AES256_RES_INVALID_MODE;
+    
+    if ((keySize != B5_XTS_AES_256) && (keySize != B5_XTS_AES_128))
+        return B5_XTS_AES256_RES_INVALID_KEY_SIZE;
+    
+    // IEEE 1619-2018 requires two different keys
+    half = keySize / 2;
+    if (memcmp(Key, Key + half, half) == 0)
+        return B5_XTS_AES256_RES_INVALID_ARGUMENT;
+    
+    if (B5_AES256_RES_OK != B5_Aes256_Init(&ctx->dataCtx, Key, half,
+            (xtsMode == B5_XTS_AES256_ENC) ? B5_AES256_ECB_ENC : B5_AES256_ECB_DEC))
+        return B5_XTS_AES256_RES_INVALID_KEY_SIZE;
+    
+    if (B5_AES256_RES_OK != B5_Aes256_Init(&ctx->tweakCtx, Key + half, half, B5_AES256_ECB_ENC))
+        return B5_XTS_AES256_RES_INVALID_KEY_SIZE;
+    
+    ctx->mode = xtsMode;
+    
+    return B5_XTS_AES256_RES_OK;
+}
+
+
+
+
+
+int32_t B5_XtsAes256_Update (B5_tXtsAesCtx *ctx, uint8_t *encData, uint8_t *clrData, uint64_t sector, int32_t nSectors)
+{
+    uint8_t    T[B5_AES_BLK_SIZE];
+    uint64_t   t0[2], t[2];
+    uint8_t    *in, *out;
+    int32_t    i, j;
+    
+    
+    if(ctx == NULL)
+        return  B5_XTS_AES256_RES_INVALID_CONTEXT;
+    
+    if((encData == NULL) || (clrData == NULL) || (nSectors < 0))
+        return B5_XTS_AES256_RES_INVALID_ARGUMENT;
+    
+    if ((ctx->mode != B5_XTS_AES256_ENC) && (ctx->mode != B5_XTS_AES256_DEC))
+        return B5_XTS_AES256_RES_INVALID_MODE;
+    
+    if (ctx->mode == B5_XTS_AES256_ENC)
+    {
+        in = clrData;
+        out = encData;
+    }
+    else
+    {
+        in = encData;
+        out = clrData;
+    }
+    
+    for (i = 0; i < nSectors; i++, sector++)
+    {
+        // T = E(K2, sector), the sector number as a 128-bit little endian value
+        for (j = 0; j < 8; j++)
+            T[j] = (uint8_t)(sector >> (8*j));
+        memset(T + 8, 0, 8);
+        B5_Aes256_Update(&ctx->tweakCtx, T, T, 1);
+        t0[0] = B5_Xts_Load64(T);
+        t0[1] = B5_Xts_Load64(T + 8);
+        
+        // whiten the whole sector first, so that the block cipher runs on all of its blocks in one call
+        t[0] = t0[0];
+        t[1] = t0[1];
+        for (j = 0; j < B5_XTS_AES_SECTOR_BLKS; j++)
+        {
+            B5_Xts_Xor(out + j*B5_AES_BLK_SIZE, in + j*B5_AES_BLK_SIZE, t);
+            B5_Xts_Double(t);
+        }
+        
+        B5_Aes256_Update(&ctx->dataCtx, out, out, B5_XTS_AES_SECTOR_BLKS);
+        
+        t[0] = t0[0];
+        t[1] = t0[1];
+        for (j = 0; j < B5_XTS_AES_SECTOR_BLKS; j++)
+        {
+            B5_Xts_Xor(out + j*B5_AES_BLK_SIZE, out + j*B5_AES_BLK_SIZE, t);
+            B5_Xts_Double(t);
+        }
+        
+        in += B5_XTS_AES_SECTOR_SIZE;
+        out += B5_XTS_AES_SECTOR_SIZE;
+    }
+    
+    memset(T, 0, sizeof(T));
+    t0[0] = t0[1] = t[0] = t[1] = 0;
+    
+    return B5_XTS_AES256_RES_OK;
+}
+
+
+
+
+
+/** Initial value of RFC 3394, checked when unwrapping */
+static const uint8_t B5_Kw_IV[B5_KW_AES_SEMIBLK_SIZE] = {
+    0xA6, 0xA6, 0xA6, 0xA6, 0xA6, 0xA6, 0xA6, 0xA6
+};
+
+
+
+
+
+int32_t B5_KwAes256_Init (B5_tKwAesCtx *ctx, const uint8_t *Key, int16_t keySize)
+{
+    if(Key == NULL) 
+        return B5_KW_AES256_RES_INVALID_ARGUMENT;
+    
+    if(ctx == NULL)
+        return  B5_KW_AES256_RES_INVALID_CONTEXT;
+    
+    memset(ctx, 0, sizeof(B5_tKwAesCtx));
+    
+    if (B5_AES256_RES_OK != B5_Aes256_Init(&ctx->encCtx, Key, keySize, B5_AES256_ECB_ENC))
+        return B5_KW_AES256_RES_INVALID_KEY_SIZE;
+    
+    if (B5_AES256_RES_OK != B5_Aes256_Init(&ctx->decCtx, Key, keySize, B5_AES256_ECB_DEC))
+        return B5_KW_AES256_RES_INVALID_KEY_SIZE;
+    
+    return B5_KW_AES256_RES_OK;
+}
+
+
+
+
+
+int32_t B5_KwAes256_Wrap (B5_tKwAesCtx *ctx, uint8_t *out, const uint8_t *in, int32_t inLen)
+{
+    uint8_t    B[B5_AES_BLK_SIZE];
+    uint8_t    *R;
+    uint32_t   t;
+    int32_t    i, j, k, n;
+    
+    
+    if(ctx == NULL)
+        return  B5_KW_AES256_RES_INVALID_CONTEXT;
+    
+    if((out == NULL) || (in == NULL) || (inLen < B5_KW_AES_MIN_DATA) || (inLen % B5_KW_AES_SEMIBLK_SIZE))
+        return B5_KW_AES256_RES_INVALID_ARGUMENT;
+    
+    n = inLen / B5_KW_AES_SEMIBLK_SIZE;
+    
+    // R[1..n] are kept in place in the output, A in the first half of B
+    memmove(out + B5_KW_AES_SEMIBLK_SIZE, in, inLen);
+    memcpy(B, B5_Kw_IV, B5_KW_AES_SEMIBLK_SIZE);
+    
+    t = 1;
+    for (j = 0; j < 6; j++)
+    {
+        R = out + B5_KW_AES_SEMIBLK_SIZE;
+        for (i = 0; i < n; i++, t++)
+        {
+            memcpy(B + B5_KW_AES_SEMIBLK_SIZE, R, B5_KW_AES_SEMIBLK_SIZE);
+            B5_Aes256_Update(&ctx->encCtx, B, B, 1);
+            memcpy(R, B + B5_KW_AES_SEMIBLK_SIZE, B5_KW_AES_SEMIBLK_SIZE);
+            // A = MSB(B) ^ t, t as a 64-bit big endian value
+            for (k = 0; k < 4; k++)
+                B[7 - k] ^= (uint8_t)(t >> (8*k));
+            R += B5_KW_AES_SEMIBLK_SIZE;
+        }
+    }
+    
+    memcpy(out, B, B5_KW_AES_SEMIBLK_SIZE);
+    memset(B, 0, sizeof(B));
+    
+    return B5_KW_AES256_RES_OK;
+}
+
+
+
+
+
+int32_t B5_KwAes256_Unwrap (B5_tKwAesCtx *ctx, uint8_t *out, const uint8_t *in, int32_t inLen)
+{
+    uint8_t    B[B5_AES_BLK_SIZE];
+    uint8_t    *R;
+    uint8_t    diff = 0;
+    uint32_t   t;
+    int32_t    i, j, k, n;
+    
+    
+    if(ctx == NULL)
+        return  B5_KW_AES256_RES_INVALID_CONTEXT;
+    
+    if((out == NULL) || (in == NULL) || (inLen < B5_KW_AES_MIN_DATA + B5_KW_AES_SEMIBLK_SIZE) || (inLen % B5_KW_AES_SEMIBLK_SIZE))
+        return B5_KW_AES256_RES_INVALID_ARGUMENT;
+    
+    n = inLen / B5_KW_AES_SEMIBLK_SIZE - 1;
+    
+    memcpy(B, in, B5_KW_AES_SEMIBLK_SIZE);
+    memmove(out, in + B5_KW_AES_SEMIBLK_SIZE, inLen - B5_KW_AES_SEMIBLK_SIZE);
+    
+    t = 6 * (uint32_t)n;
+    for (j = 0; j < 6; j++)
+    {
+        R = out + (n - 1) * B5_KW_AES_SEMIBLK_SIZE;
+        for (i = 0; i < n; i++, t--)
+        {
+            for (k = 0; k < 4; k++)
+                B[7 - k] ^= (uint8_t)(t >> (8*k));
+            memcpy(B + B5_KW_AES_SEMIBLK_SIZE, R, B5_KW_AES_SEMIBLK_SIZE);
+            B5_Aes256_Update(&ctx->decCtx, B, B, 1);
+            memcpy(R, B + B5_KW_AES_SEMIBLK_SIZE, B5_KW_AES_SEMIBLK_SIZE);
+            R -= B5_KW_AES_SEMIBLK_SIZE;
+        }
+    }
+    
+    for (k = 0; k < B5_KW_AES_SEMIBLK_SIZE; k++)
+        diff |= B[k] ^ B5_Kw_IV[k];
+    
+    memset(B, 0, sizeof(B));
+    
+    if (diff != 0)
+    {
+        memset(out, 0, inLen - B5_KW_AES_SEMIBLK_SIZE);
+        return B5_KW_AES256_RES_AUTH_FAILED;
+    }
+    
+    return B5_KW_AES256_RES_OK;
+}
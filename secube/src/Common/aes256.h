@@ -65,6 +65,18 @@ extern "C" {
 /** @} */
 
 
+/** \defgroup aesBackends AES implementations
+ * @{
+ */
+/** \name AES implementations */
+///@{
+#define B5_AES256_BACKEND_AUTO  0       /**< Fastest implementation supported by the CPU */
+#define B5_AES256_BACKEND_SW    1       /**< Table based implementation */
+#define B5_AES256_BACKEND_NI    2       /**< x86 AES-NI instructions */
+///@}
+/** @} */
+
+
 
 
 /** \defgroup aesStr AES data structures
@@ -77,6 +89,7 @@ typedef struct {
     uint8_t  Nr;                   /**< Number of rounds */
     uint8_t  InitVector[16];       /**< IV for OFB, CBC, CTR */
     uint8_t  mode;                 /**< Active mode */
+    uint8_t  backend;              /**< Implementation selected by B5_Aes256_Init */
     uint32_t const *Te0;
     uint32_t const *Te1;
     uint32_t const *Te2;
@@ -136,6 +149,14 @@ int32_t    B5_Aes256_Update (B5_tAesCtx *ctx, uint8_t *encData, uint8_t *clrData
  * @return See \ref aesReturn .
  */
 int32_t    B5_Aes256_Finit  (B5_tAesCtx *ctx);
+
+/**
+ *
+ * @brief Select the implementation used by the contexts initialized afterwards.
+ * @param backend See \ref aesBackends . B5_AES256_BACKEND_AUTO is the default.
+ * @return See \ref aesReturn ; B5_AES256_RES_INVALID_ARGUMENT if the implementation is not supported.
+ */
+int32_t    B5_Aes256_SetBackend (uint8_t backend);
     
 ///@}
 /** @} */
@@ -210,6 +231,8 @@ int32_t    B5_CmacAes256_Init (B5_tCmacAesCtx *ctx, const uint8_t *Key, int16_t
 /**
  *
  * @brief Compute the CMAC-AES algorithm on input data depending on the current status of the CMAC-AES context.
+ * Any length is accepted: a partial block, and the last full block, are kept in the context until
+ * the next call or until B5_CmacAes256_Finit.
  * @param ctx Pointer to the current CMAC-AES context.
  * @param data Pointer to the input data.
  * @param dataLen Bytes to be processed.
@@ -248,6 +271,334 @@ int32_t    B5_CmacAes256_Sign (const uint8_t *data, int32_t dataLen, const uint8
 
 ///@}
 /** @} */
+
+
+
+
+/** \defgroup gcmaesKeys GCM-AES Key, IV, Tag Sizes
+ * @{
+ */
+/** \name GCM-AES Key, IV, Tag Sizes */
+///@{
+#define B5_GCM_AES_256              32  /**< Key Size in Bytes */
+#define B5_GCM_AES_192              24  /**< Key Size in Bytes */
+#define B5_GCM_AES_128              16  /**< Key Size in Bytes */
+#define B5_GCM_AES_IV_SIZE          12  /**< Recommended IV Size in Bytes */
+#define B5_GCM_AES_TAG_SIZE         16  /**< Tag Size in Bytes */
+///@}
+/** @} */
+
+
+/** \defgroup gcmaesReturn GCM-AES return values
+ * @{
+ */
+/** \name GCM-AES return values */
+///@{
+#define B5_GCM_AES256_RES_OK                                    ( 0)
+#define B5_GCM_AES256_RES_INVALID_CONTEXT                       (-1)
+#define B5_GCM_AES256_RES_CANNOT_ALLOCATE_CONTEXT               (-2)
+#define B5_GCM_AES256_RES_INVALID_KEY_SIZE                      (-3)
+#define B5_GCM_AES256_RES_INVALID_ARGUMENT                      (-4)
+#define B5_GCM_AES256_RES_INVALID_MODE                          (-5)
+#define B5_GCM_AES256_RES_INVALID_STATE                         (-6)
+#define B5_GCM_AES256_RES_AUTH_FAILED                           (-7)
+///@}
+/** @} */
+
+
+/** \defgroup gcmaesModes GCM-AES modes
+ * @{
+ */
+/** \name GCM-AES modes */
+///@{
+#define B5_GCM_AES256_ENC       1       /**< Authenticated encryption */
+#define B5_GCM_AES256_DEC       2       /**< Authenticated decryption */
+///@}
+/** @} */
+
+
+/** \defgroup gcmaesStates GCM-AES message phases
+ * @{
+ */
+/** \name GCM-AES message phases */
+///@{
+#define B5_GCM_STATE_NO_IV      0       /**< No IV set, or the last message has been completed */
+#define B5_GCM_STATE_AAD        1       /**< IV set, accepting AAD */
+#define B5_GCM_STATE_DATA       2       /**< Accepting data */
+///@}
+/** @} */
+
+
+/** \defgroup gcmaesStr GCM-AES data structures
+ * @{
+ */
+/** \name GCM-AES data structures */
+///@{
+typedef struct {
+    B5_tAesCtx  aesCtx;                     /**< AES context in CTR mode */
+    
+    uint64_t    HL[16];                     /**< Multiples of the hash key H, low halves (4-bit Shoup table) */
+    uint64_t    HH[16];                     /**< Multiples of the hash key H, high halves */
+    
+    uint8_t     EkJ0[B5_AES_BLK_SIZE];      /**< Encrypted pre-counter block, masks the tag */
+    uint8_t     X[B5_AES_BLK_SIZE];         /**< GHASH accumulator */
+    uint8_t     tmpBlk[B5_AES_BLK_SIZE];    /**< Pending bytes of a partial AAD or ciphertext block */
+    uint8_t     keyStream[B5_AES_BLK_SIZE]; /**< Key stream of the current partial block */
+    
+    uint64_t    aadLen;                     /**< AAD bytes processed */
+    uint64_t    dataLen;                    /**< Data bytes processed */
+    
+    uint8_t     mode;                       /**< See \ref gcmaesModes */
+    uint8_t     state;                      /**< See \ref gcmaesStates */
+} B5_tGcmAesCtx;
+///@}
+/** @} */
+
+
+
+/** \defgroup gcmaesFunc GCM-AES functions
+ * @{
+ */
+/** \name GCM-AES functions */
+///@{
+/**
+ *
+ * @brief Initialize the GCM-AES context and precompute the GHASH tables.
+ * @param ctx Pointer to the GCM-AES data structure to be initialized.
+ * @param Key Pointer to the Key that must be used.
+ * @param keySize Key size. See \ref gcmaesKeys for supported sizes.
+ * @param gcmMode See \ref gcmaesModes .
+ * @return See \ref gcmaesReturn .
+ */
+int32_t    B5_GcmAes256_Init (B5_tGcmAesCtx *ctx, const uint8_t *Key, int16_t keySize, uint8_t gcmMode);
+
+/**
+ *
+ * @brief Start a new message. Must be called before any AAD or data, and again for each message.
+ * @param ctx Pointer to the current GCM-AES context.
+ * @param IV Pointer to the IV.
+ * @param ivLen IV length in Bytes; B5_GCM_AES_IV_SIZE is recommended, any non-zero length is accepted.
+ * @return See \ref gcmaesReturn .
+ */
+int32_t    B5_GcmAes256_SetIV (B5_tGcmAesCtx *ctx, const uint8_t *IV, int32_t ivLen);
+
+/**
+ *
+ * @brief Authenticate additional data. It may be called several times, but only before B5_GcmAes256_Update.
+ * @param ctx Pointer to the current GCM-AES context.
+ * @param aad Pointer to the additional data.
+ * @param aadLen Bytes to be processed.
+ * @return See \ref gcmaesReturn .
+ */
+int32_t    B5_GcmAes256_UpdateAad (B5_tGcmAesCtx *ctx, const uint8_t *aad, int32_t aadLen);
+
+/**
+ *
+ * @brief Encrypt or decrypt data and authenticate the cipher text. Any length is accepted; encData and clrData may be the same buffer.
+ * @param ctx Pointer to the current GCM-AES context.
+ * @param encData Encrypted data (output when encrypting, input when decrypting).
+ * @param clrData Clear data (input when encrypting, output when decrypting).
+ * @param dataLen Bytes to be processed.
+ * @return See \ref gcmaesReturn .
+ */
+int32_t    B5_GcmAes256_Update (B5_tGcmAesCtx *ctx, uint8_t *encData, uint8_t *clrData, int32_t dataLen);
+
+/**
+ *
+ * @brief Complete the message and compute its tag. A new IV must be set before the next message.
+ * @param ctx Pointer to the current GCM-AES context.
+ * @param rTag Pointer to a blank memory area of B5_GCM_AES_TAG_SIZE Bytes.
+ * @return See \ref gcmaesReturn .
+ */
+int32_t    B5_GcmAes256_Finit (B5_tGcmAesCtx *ctx, uint8_t *rTag);
+
+/**
+ *
+ * @brief Complete the message and compare its tag with the expected one in constant time.
+ * @param ctx Pointer to the current GCM-AES context.
+ * @param tag Pointer to the expected tag.
+ * @param tagLen Tag length in Bytes, from 4 to B5_GCM_AES_TAG_SIZE (leftmost bytes are compared).
+ * @return See \ref gcmaesReturn ; B5_GCM_AES256_RES_AUTH_FAILED if the tags differ.
+ */
+int32_t    B5_GcmAes256_Verify (B5_tGcmAesCtx *ctx, const uint8_t *tag, int16_t tagLen);
+
+///@}
+/** @} */
+
+
+
+
+/** \defgroup xtsaesKeys XTS-AES Key, Sector Sizes
+ * @{
+ */
+/** \name XTS-AES Key, Sector Sizes */
+///@{
+#define B5_XTS_AES_256              64  /**< Key Size in Bytes (data key followed by tweak key) */
+#define B5_XTS_AES_128              32  /**< Key Size in Bytes (data key followed by tweak key) */
+#define B5_XTS_AES_SECTOR_SIZE      512 /**< Data unit (sector) Size in Bytes */
+#define B5_XTS_AES_SECTOR_BLKS      (B5_XTS_AES_SECTOR_SIZE / B5_AES_BLK_SIZE)
+///@}
+/** @} */
+
+
+/** \defgroup xtsaesReturn XTS-AES return values
+ * @{
+ */
+/** \name XTS-AES return values */
+///@{
+#define B5_XTS_AES256_RES_OK                                    ( 0)
+#define B5_XTS_AES256_RES_INVALID_CONTEXT                       (-1)
+#define B5_XTS_AES256_RES_CANNOT_ALLOCATE_CONTEXT               (-2)
+#define B5_XTS_AES256_RES_INVALID_KEY_SIZE                      (-3)
+#define B5_XTS_AES256_RES_INVALID_ARGUMENT                      (-4)
+#define B5_XTS_AES256_RES_INVALID_MODE                          (-5)
+///@}
+/** @} */
+
+
+/** \defgroup xtsaesModes XTS-AES modes
+ * @{
+ */
+/** \name XTS-AES modes */
+///@{
+#define B5_XTS_AES256_ENC       1       /**< Sector encryption */
+#define B5_XTS_AES256_DEC       2       /**< Sector decryption */
+///@}
+/** @} */
+
+
+/** \defgroup xtsaesStr XTS-AES data structures
+ * @{
+ */
+/** \name XTS-AES data structures */
+///@{
+typedef struct {
+    B5_tAesCtx  dataCtx;                    /**< Data key, ECB encryption or decryption */
+    B5_tAesCtx  tweakCtx;                   /**< Tweak key, ECB encryption */
+    uint8_t     mode;                       /**< See \ref xtsaesModes */
+} B5_tXtsAesCtx;
+///@}
+/** @} */
+
+
+
+/** \defgroup xtsaesFunc XTS-AES functions
+ * @{
+ */
+/** \name XTS-AES functions */
+///@{
+/**
+ *
+ * @brief Initialize the XTS-AES (IEEE 1619) context.
+ * @param ctx Pointer to the XTS-AES data structure to be initialized.
+ * @param Key Pointer to the Key: the data key followed by the tweak key, of the same size.
+ * @param keySize Key size. See \ref xtsaesKeys for supported sizes.
+ * @param xtsMode See \ref xtsaesModes .
+ * @return See \ref xtsaesReturn .
+ */
+int32_t    B5_XtsAes256_Init (B5_tXtsAesCtx *ctx, const uint8_t *Key, int16_t keySize, uint8_t xtsMode);
+
+/**
+ *
+ * @brief Encrypt or decrypt a run of consecutive sectors. The tweak of each sector is its number,
+ * encoded as a 128-bit little endian value. encData and clrData may be the same buffer.
+ * @param ctx Pointer to the current XTS-AES context.
+ * @param encData Encrypted data (output when encrypting, input when decrypting).
+ * @param clrData Clear data (input when encrypting, output when decrypting).
+ * @param sector Number of the first sector.
+ * @param nSectors Number of B5_XTS_AES_SECTOR_SIZE Byte sectors to process.
+ * @return See \ref xtsaesReturn .
+ */
+int32_t    B5_XtsAes256_Update (B5_tXtsAesCtx *ctx, uint8_t *encData, uint8_t *clrData, uint64_t sector, int32_t nSectors);
+
+///@}
+/** @} */
+
+
+
+
+/** \defgroup kwaesKeys KW-AES Key, Semiblock Sizes
+ * @{
+ */
+/** \name KW-AES Key, Semiblock Sizes */
+///@{
+#define B5_KW_AES_256               32  /**< Key Size in Bytes */
+#define B5_KW_AES_192               24  /**< Key Size in Bytes */
+#define B5_KW_AES_128               16  /**< Key Size in Bytes */
+#define B5_KW_AES_SEMIBLK_SIZE      8   /**< Semiblock Size in Bytes; wrapping adds one semiblock */
+#define B5_KW_AES_MIN_DATA          16  /**< Shortest data that can be wrapped, in Bytes */
+///@}
+/** @} */
+
+
+/** \defgroup kwaesReturn KW-AES return values
+ * @{
+ */
+/** \name KW-AES return values */
+///@{
+#define B5_KW_AES256_RES_OK                                     ( 0)
+#define B5_KW_AES256_RES_INVALID_CONTEXT                        (-1)
+#define B5_KW_AES256_RES_CANNOT_ALLOCATE_CONTEXT                (-2)
+#define B5_KW_AES256_RES_INVALID_KEY_SIZE                       (-3)
+#define B5_KW_AES256_RES_INVALID_ARGUMENT                       (-4)
+#define B5_KW_AES256_RES_AUTH_FAILED                            (-5)
+///@}
+/** @} */
+
+
+/** \defgroup kwaesStr KW-AES data structures
+ * @{
+ */
+/** \name KW-AES data structures */
+///@{
+typedef struct {
+    B5_tAesCtx  encCtx;                     /**< Key encryption key, ECB encryption (wrap) */
+    B5_tAesCtx  decCtx;                     /**< Key encryption key, ECB decryption (unwrap) */
+} B5_tKwAesCtx;
+///@}
+/** @} */
+
+
+
+/** \defgroup kwaesFunc KW-AES functions
+ * @{
+ */
+/** \name KW-AES functions */
+///@{
+/**
+ *
+ * @brief Initialize the AES key wrap (RFC 3394) context, for both wrapping and unwrapping.
+ * @param ctx Pointer to the KW-AES data structure to be initialized.
+ * @param Key Pointer to the key encryption key.
+ * @param keySize Key size. See \ref kwaesKeys for supported sizes.
+ * @return See \ref kwaesReturn .
+ */
+int32_t    B5_KwAes256_Init (B5_tKwAesCtx *ctx, const uint8_t *Key, int16_t keySize);
+
+/**
+ *
+ * @brief Wrap data, usually a key. out and in may be the same buffer.
+ * @param ctx Pointer to the current KW-AES context.
+ * @param out Wrapped data, inLen + B5_KW_AES_SEMIBLK_SIZE Bytes.
+ * @param in Data to wrap.
+ * @param inLen Bytes to wrap, a multiple of B5_KW_AES_SEMIBLK_SIZE and at least B5_KW_AES_MIN_DATA.
+ * @return See \ref kwaesReturn .
+ */
+int32_t    B5_KwAes256_Wrap (B5_tKwAesCtx *ctx, uint8_t *out, const uint8_t *in, int32_t inLen);
+
+/**
+ *
+ * @brief Unwrap and check data produced by B5_KwAes256_Wrap. out and in may be the same buffer.
+ * @param ctx Pointer to the current KW-AES context.
+ * @param out Unwrapped data, inLen - B5_KW_AES_SEMIBLK_SIZE Bytes; cleared if the check fails.
+ * @param in Wrapped data.
+ * @param inLen Wrapped Bytes.
+ * @return See \ref kwaesReturn ; B5_KW_AES256_RES_AUTH_FAILED if the wrapped data has been modified.
+ */
+int32_t    B5_KwAes256_Unwrap (B5_tKwAesCtx *ctx, uint8_t *out, const uint8_t *in, int32_t inLen);
+
+///@}
+/** @} */
     
 
 
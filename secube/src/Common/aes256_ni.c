@@ -0,0 +1,399 @@
+/*  LICENSE  */
+
+/**
+ * @file aes256_ni.c
+ * @brief This file includes the AES-NI implementation of the AES modes. See \ref aes256_ni.h .
+ *
+ */
+
+#include "aes256_ni.h"
+
+#ifdef B5_AES256_NI
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define B5_AESNI_TARGET
+#else
+#include <cpuid.h>
+#define B5_AESNI_TARGET __attribute__((target("aes,sse2")))
+#endif
+#include <emmintrin.h>
+#include <wmmintrin.h>
+
+
+/** Number of blocks processed in parallel by the modes which allow it */
+#define B5_AESNI_LANES  4
+
+
+
+int B5_Aes256Ni_Available (void)
+{
+    static int available = -1;
+
+    if (available < 0)
+    {
+#if defined(_MSC_VER)
+        int info[4];
+        __cpuid(info, 1);
+        available = (info[2] >> 25) & 1;
+#else
+        unsigned int a, b, c, d;
+        available = (__get_cpuid(1, &a, &b, &c, &d) && (c & bit_AES)) ? 1 : 0;
+#endif
+    }
+    return available;
+}
+
+
+
+
+/*
+ * The table based key schedule stores each round key as four big endian words; the AES-NI
+ * instructions expect the bytes in memory order. The decryption schedule of the table based
+ * implementation (reversed, InvMixColumns applied to the inner round keys) is the one expected
+ * by AESDEC as well.
+ */
+void B5_Aes256Ni_Setup (B5_tAesCtx *ctx)
+{
+    int16_t i;
+    uint32_t w;
+    uint8_t *p;
+
+    for (i = 0; i < 4*(ctx->Nr + 1); i++)
+    {
+        w = ctx->rk[i];
+        p = (uint8_t*)&(ctx->rk[i]);
+        p[0] = (uint8_t)(w >> 24);
+        p[1] = (uint8_t)(w >> 16);
+        p[2] = (uint8_t)(w >>  8);
+        p[3] = (uint8_t)(w      );
+    }
+}
+
+
+
+
+B5_AESNI_TARGET static void B5_AesNi_LoadKeys (const B5_tAesCtx *ctx, __m128i *k)
+{
+    int16_t i;
+
+    for (i = 0; i <= ctx->Nr; i++)
+    {
+        k[i] = _mm_loadu_si128((const __m128i*)&(ctx->rk[4*i]));
+    }
+}
+
+
+B5_AESNI_TARGET static __m128i B5_AesNi_Encrypt (const __m128i *k, int16_t Nr, __m128i b)
+{
+    int16_t i;
+
+    b = _mm_xor_si128(b, k[0]);
+    for (i = 1; i < Nr; i++)
+    {
+        b = _mm_aesenc_si128(b, k[i]);
+    }
+    return _mm_aesenclast_si128(b, k[Nr]);
+}
+
+
+B5_AESNI_TARGET static __m128i B5_AesNi_Decrypt (const __m128i *k, int16_t Nr, __m128i b)
+{
+    int16_t i;
+
+    b = _mm_xor_si128(b, k[0]);
+    for (i = 1; i < Nr; i++)
+    {
+        b = _mm_aesdec_si128(b, k[i]);
+    }
+    return _mm_aesdeclast_si128(b, k[Nr]);
+}
+
+
+/* Interleaving independent blocks hides the latency of the AES instructions */
+B5_AESNI_TARGET static void B5_AesNi_Encrypt4 (const __m128i *k, int16_t Nr, __m128i *b)
+{
+    int16_t i;
+
+    b[0] = _mm_xor_si128(b[0], k[0]);
+    b[1] = _mm_xor_si128(b[1], k[0]);
+    b[2] = _mm_xor_si128(b[2], k[0]);
+    b[3] = _mm_xor_si128(b[3], k[0]);
+    for (i = 1; i < Nr; i++)
+    {
+        b[0] = _mm_aesenc_si128(b[0], k[i]);
+        b[1] = _mm_aesenc_si128(b[1], k[i]);
+        b[2] = _mm_aesenc_si128(b[2], k[i]);
+        b[3] = _mm_aesenc_si128(b[3], k[i]);
+    }
+    b[0] = _mm_aesenclast_si128(b[0], k[Nr]);
+    b[1] = _mm_aesenclast_si128(b[1], k[Nr]);
+    b[2] = _mm_aesenclast_si128(b[2], k[Nr]);
+    b[3] = _mm_aesenclast_si128(b[3], k[Nr]);
+}
+
+
+B5_AESNI_TARGET static void B5_AesNi_Decrypt4 (const __m128i *k, int16_t Nr, __m128i *b)
+{
+    int16_t i;
+
+    b[0] = _mm_xor_si128(b[0], k[0]);
+    b[1] = _mm_xor_si128(b[1], k[0]);
+    b[2] = _mm_xor_si128(b[2], k[0]);
+    b[3] = _mm_xor_si128(b[3], k[0]);
+    for (i = 1; i < Nr; i++)
+    {
+        b[0] = _mm_aesdec_si128(b[0], k[i]);
+        b[1] = _mm_aesdec_si128(b[1], k[i]);
+        b[2] = _mm_aesdec_si128(b[2], k[i]);
+        b[3] = _mm_aesdec_si128(b[3], k[i]);
+    }
+    b[0] = _mm_aesdeclast_si128(b[0], k[Nr]);
+    b[1] = _mm_aesdeclast_si128(b[1], k[Nr]);
+    b[2] = _mm_aesdeclast_si128(b[2], k[Nr]);
+    b[3] = _mm_aesdeclast_si128(b[3], k[Nr]);
+}
+
+
+/* Big endian increment of the whole 128-bit counter, as in the table based implementation */
+static void B5_AesNi_CtrInc (uint8_t *ctr)
+{
+    int16_t j = 15;
+
+    while (j >= 0 && ++ctr[j] == 0)
+    {
+        j--;
+    }
+}
+
+
+
+
+B5_AESNI_TARGET int32_t B5_Aes256Ni_Update (B5_tAesCtx *ctx, uint8_t *encData, uint8_t *clrData, int16_t nBlk)
+{
+    __m128i k[14 + 1];
+    __m128i b[B5_AESNI_LANES], c[B5_AESNI_LANES];
+    __m128i iv;
+    int16_t i, j;
+
+    B5_AesNi_LoadKeys(ctx, k);
+    iv = _mm_loadu_si128((const __m128i*)ctx->InitVector);
+    i = 0;
+
+    switch(ctx->mode) {
+
+        case B5_AES256_CTR:
+        {
+            for (; i + B5_AESNI_LANES <= nBlk; i += B5_AESNI_LANES)
+            {
+                if (ctx->InitVector[15] <= 0xFF - B5_AESNI_LANES)
+                {
+                    /* no carry out of the last byte */
+                    iv = _mm_loadu_si128((const __m128i*)ctx->InitVector);
+                    b[0] = iv;
+                    b[1] = _mm_add_epi8(iv, _mm_set_epi8(1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0));
+                    b[2] = _mm_add_epi8(iv, _mm_set_epi8(2, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0));
+                    b[3] = _mm_add_epi8(iv, _mm_set_epi8(3, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0));
+                    ctx->InitVector[15] += B5_AESNI_LANES;
+                }
+                else
+                {
+                    for (j = 0; j < B5_AESNI_LANES; j++)
+                    {
+                        b[j] = _mm_loadu_si128((const __m128i*)ctx->InitVector);
+                        B5_AesNi_CtrInc(ctx->InitVector);
+                    }
+                }
+                B5_AesNi_Encrypt4(k, ctx->Nr, b);
+                for (j = 0; j < B5_AESNI_LANES; j++)
+                {
+                    c[j] = _mm_loadu_si128((const __m128i*)(clrData + j*B5_AES_BLK_SIZE));
+                    _mm_storeu_si128((__m128i*)(encData + j*B5_AES_BLK_SIZE), _mm_xor_si128(b[j], c[j]));
+                }
+                clrData += B5_AESNI_LANES*B5_AES_BLK_SIZE;
+                encData += B5_AESNI_LANES*B5_AES_BLK_SIZE;
+            }
+            for (; i < nBlk; i++)
+            {
+                b[0] = B5_AesNi_Encrypt(k, ctx->Nr, _mm_loadu_si128((const __m128i*)ctx->InitVector));
+                B5_AesNi_CtrInc(ctx->InitVector);
+                c[0] = _mm_loadu_si128((const __m128i*)clrData);
+                _mm_storeu_si128((__m128i*)encData, _mm_xor_si128(b[0], c[0]));
+                clrData += B5_AES_BLK_SIZE;
+                encData += B5_AES_BLK_SIZE;
+            }
+            return B5_AES256_RES_OK;
+        }
+
+
+        case B5_AES256_OFB:
+        {
+            for (; i < nBlk; i++)
+            {
+                iv = B5_AesNi_Encrypt(k, ctx->Nr, iv);
+                c[0] = _mm_loadu_si128((const __m128i*)clrData);
+                _mm_storeu_si128((__m128i*)encData, _mm_xor_si128(iv, c[0]));
+                clrData += B5_AES_BLK_SIZE;
+                encData += B5_AES_BLK_SIZE;
+            }
+            break;
+        }
+
+
+        case B5_AES256_ECB_ENC:
+        {
+            for (; i + B5_AESNI_LANES <= nBlk; i += B5_AESNI_LANES)
+            {
+                for (j = 0; j < B5_AESNI_LANES; j++)
+                {
+                    b[j] = _mm_loadu_si128((const __m128i*)(clrData + j*B5_AES_BLK_SIZE));
+                }
+                B5_AesNi_Encrypt4(k, ctx->Nr, b);
+                for (j = 0; j < B5_AESNI_LANES; j++)
+                {
+                    _mm_storeu_si128((__m128i*)(encData + j*B5_AES_BLK_SIZE), b[j]);
+                }
+                clrData += B5_AESNI_LANES*B5_AES_BLK_SIZE;
+                encData += B5_AESNI_LANES*B5_AES_BLK_SIZE;
+            }
+            for (; i < nBlk; i++)
+            {
+                b[0] = B5_AesNi_Encrypt(k, ctx->Nr, _mm_loadu_si128((const __m128i*)clrData));
+                _mm_storeu_si128((__m128i*)encData, b[0]);
+                clrData += B5_AES_BLK_SIZE;
+                encData += B5_AES_BLK_SIZE;
+            }
+            return B5_AES256_RES_OK;
+        }
+
+
+        case B5_AES256_ECB_DEC:
+        {
+            for (; i + B5_AESNI_LANES <= nBlk; i += B5_AESNI_LANES)
+            {
+                for (j = 0; j < B5_AESNI_LANES; j++)
+                {
+                    b[j] = _mm_loadu_si128((const __m128i*)(encData + j*B5_AES_BLK_SIZE));
+                }
+                B5_AesNi_Decrypt4(k, ctx->Nr, b);
+                for (j = 0; j < B5_AESNI_LANES; j++)
+                {
+                    _mm_storeu_si128((__m128i*)(clrData + j*B5_AES_BLK_SIZE), b[j]);
+                }
+                clrData += B5_AESNI_LANES*B5_AES_BLK_SIZE;
+                encData += B5_AESNI_LANES*B5_AES_BLK_SIZE;
+            }
+            for (; i < nBlk; i++)
+            {
+                b[0] = B5_AesNi_Decrypt(k, ctx->Nr, _mm_loadu_si128((const __m128i*)encData));
+                _mm_storeu_si128((__m128i*)clrData, b[0]);
+                clrData += B5_AES_BLK_SIZE;
+                encData += B5_AES_BLK_SIZE;
+            }
+            return B5_AES256_RES_OK;
+        }
+
+
+        case B5_AES256_CBC_ENC:
+        {
+            for (; i < nBlk; i++)
+            {
+                iv = B5_AesNi_Encrypt(k, ctx->Nr, _mm_xor_si128(iv, _mm_loadu_si128((const __m128i*)clrData)));
+                _mm_storeu_si128((__m128i*)encData, iv);
+                clrData += B5_AES_BLK_SIZE;
+                encData += B5_AES_BLK_SIZE;
+            }
+            break;
+        }
+
+
+        case B5_AES256_CBC_DEC:
+        {
+            for (; i + B5_AESNI_LANES <= nBlk; i += B5_AESNI_LANES)
+            {
+                for (j = 0; j < B5_AESNI_LANES; j++)
+                {
+                    c[j] = _mm_loadu_si128((const __m128i*)(encData + j*B5_AES_BLK_SIZE));
+                    b[j] = c[j];
+                }
+                B5_AesNi_Decrypt4(k, ctx->Nr, b);
+                _mm_storeu_si128((__m128i*)clrData, _mm_xor_si128(b[0], iv));
+                for (j = 1; j < B5_AESNI_LANES; j++)
+                {
+                    _mm_storeu_si128((__m128i*)(clrData + j*B5_AES_BLK_SIZE), _mm_xor_si128(b[j], c[j - 1]));
+                }
+                iv = c[B5_AESNI_LANES - 1];
+                clrData += B5_AESNI_LANES*B5_AES_BLK_SIZE;
+                encData += B5_AESNI_LANES*B5_AES_BLK_SIZE;
+            }
+            for (; i < nBlk; i++)
+            {
+                c[0] = _mm_loadu_si128((const __m128i*)encData);
+                b[0] = B5_AesNi_Decrypt(k, ctx->Nr, c[0]);
+                _mm_storeu_si128((__m128i*)clrData, _mm_xor_si128(b[0], iv));
+                iv = c[0];
+                clrData += B5_AES_BLK_SIZE;
+                encData += B5_AES_BLK_SIZE;
+            }
+            break;
+        }
+
+
+        case B5_AES256_CFB_ENC:
+        {
+            for (; i < nBlk; i++)
+            {
+                iv = _mm_xor_si128(B5_AesNi_Encrypt(k, ctx->Nr, iv), _mm_loadu_si128((const __m128i*)clrData));
+                _mm_storeu_si128((__m128i*)encData, iv);
+                clrData += B5_AES_BLK_SIZE;
+                encData += B5_AES_BLK_SIZE;
+            }
+            break;
+        }
+
+
+        case B5_AES256_CFB_DEC:
+        {
+            for (; i + B5_AESNI_LANES <= nBlk; i += B5_AESNI_LANES)
+            {
+                b[0] = iv;
+                for (j = 0; j < B5_AESNI_LANES; j++)
+                {
+                    c[j] = _mm_loadu_si128((const __m128i*)(encData + j*B5_AES_BLK_SIZE));
+                    if (j + 1 < B5_AESNI_LANES)
+                    {
+                        b[j + 1] = c[j];
+                    }
+                }
+                B5_AesNi_Encrypt4(k, ctx->Nr, b);
+                for (j = 0; j < B5_AESNI_LANES; j++)
+                {
+                    _mm_storeu_si128((__m128i*)(clrData + j*B5_AES_BLK_SIZE), _mm_xor_si128(b[j], c[j]));
+                }
+                iv = c[B5_AESNI_LANES - 1];
+                clrData += B5_AESNI_LANES*B5_AES_BLK_SIZE;
+                encData += B5_AESNI_LANES*B5_AES_BLK_SIZE;
+            }
+            for (; i < nBlk; i++)
+            {
+                c[0] = _mm_loadu_si128((const __m128i*)encData);
+                _mm_storeu_si128((__m128i*)clrData, _mm_xor_si128(B5_AesNi_Encrypt(k, ctx->Nr, iv), c[0]));
+                iv = c[0];
+                clrData += B5_AES_BLK_SIZE;
+                encData += B5_AES_BLK_SIZE;
+            }
+            break;
+        }
+
+
+        default:
+        {
+            return B5_AES256_RES_INVALID_MODE;
+        }
+    }
+
+    _mm_storeu_si128((__m128i*)ctx->InitVector, iv);
+    return B5_AES256_RES_OK;
+}
+
+#endif
@@ -0,0 +1,52 @@
+#pragma once
+/*  LICENSE  */
+
+/**
+ * @file aes256_ni.h
+ * @brief AES implementation based on the x86 AES-NI instructions. It is selected at run time by
+ * B5_Aes256_Init when the CPU supports it; the table based implementation is used otherwise.
+ *
+ */
+
+#include "aes256.h"
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define B5_AES256_NI
+#endif
+
+#ifdef B5_AES256_NI
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ *
+ * @brief Check if the CPU supports the AES-NI instructions.
+ * @return 1 if supported, 0 otherwise.
+ */
+int        B5_Aes256Ni_Available (void);
+
+/**
+ *
+ * @brief Convert the key schedule computed by B5_Aes256_Init to the layout used by the AES-NI instructions.
+ * @param ctx Pointer to the AES context, initialized by the table based implementation.
+ */
+void       B5_Aes256Ni_Setup (B5_tAesCtx *ctx);
+
+/**
+ *
+ * @brief AES-NI version of B5_Aes256_Update. Arguments have already been checked.
+ * @param ctx Pointer to the current AES context.
+ * @param encData Encrypted data.
+ * @param clrData Clear data.
+ * @param nBlk Number of AES blocks to process.
+ * @return See \ref aesReturn .
+ */
+int32_t    B5_Aes256Ni_Update (B5_tAesCtx *ctx, uint8_t *encData, uint8_t *clrData, int16_t nBlk);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
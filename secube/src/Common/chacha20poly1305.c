@@ -0,0 +1,501 @@
+/*  LICENSE  */
+
+/**
+ * @file chacha20poly1305.c
+ * @brief Implementation of ChaCha20-Poly1305 (RFC 8439). See \ref chacha20poly1305.h .
+ *
+ */
+
+
+#include "chacha20poly1305.h"
+
+
+/** Longest message accepted, in Bytes: the 32-bit block counter starts from 1 */
+#define B5_CHACHA20_MAX_DATA_LEN    ((((uint64_t)1) << 38) - B5_CHACHA20_BLK_SIZE)
+
+#define B5_CHACHA20_ROTL(v, n)      (((v) << (n)) | ((v) >> (32 - (n))))
+
+#define B5_CHACHA20_QR(a, b, c, d)                                   \
+    a += b; d ^= a; d = B5_CHACHA20_ROTL(d, 16);                    \
+    c += d; b ^= c; b = B5_CHACHA20_ROTL(b, 12);                    \
+    a += b; d ^= a; d = B5_CHACHA20_ROTL(d,  8);                    \
+    c += d; b ^= c; b = B5_CHACHA20_ROTL(b,  7);
+
+
+static uint32_t B5_ChaCha20_Load32 (const uint8_t *p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static void B5_ChaCha20_Store32 (uint8_t *p, uint32_t w)
+{
+    p[0] = (uint8_t)(w      );
+    p[1] = (uint8_t)(w >>  8);
+    p[2] = (uint8_t)(w >> 16);
+    p[3] = (uint8_t)(w >> 24);
+}
+
+
+/**
+ * @brief Compute the next key stream block and advance the block counter.
+ * @param ctx Pointer to the current context.
+ * @param x Key stream block, as 16 words.
+ */
+static void B5_ChaCha20_Core (B5_tChaCha20Poly1305Ctx *ctx, uint32_t *x)
+{
+    int32_t    i;
+    
+    
+    memcpy(x, ctx->input, sizeof(ctx->input));
+    
+    for (i = 0; i < 10; i++)
+    {
+        B5_CHACHA20_QR(x[0], x[4], x[ 8], x[12]);
+        B5_CHACHA20_QR(x[1], x[5], x[ 9], x[13]);
+        B5_CHACHA20_QR(x[2], x[6], x[10], x[14]);
+        B5_CHACHA20_QR(x[3], x[7], x[11], x[15]);
+        B5_CHACHA20_QR(x[0], x[5], x[10], x[15]);
+        B5_CHACHA20_QR(x[1], x[6], x[11], x[12]);
+        B5_CHACHA20_QR(x[2], x[7], x[ 8], x[13]);
+        B5_CHACHA20_QR(x[3], x[4], x[ 9], x[14]);
+    }
+    
+    for (i = 0; i < 16; i++)
+        x[i] += ctx->input[i];
+    
+    ctx->input[12]++;
+}
+
+
+/**
+ * @brief Encrypt or decrypt one whole block; out may be the same as in.
+ */
+static void B5_ChaCha20_Xor (B5_tChaCha20Poly1305Ctx *ctx, uint8_t *out, const uint8_t *in)
+{
+    uint32_t   x[16];
+    int32_t    i;
+    
+    
+    B5_ChaCha20_Core(ctx, x);
+    for (i = 0; i < 16; i++)
+        B5_ChaCha20_Store32(out + 4*i, B5_ChaCha20_Load32(in + 4*i) ^ x[i]);
+}
+
+
+/**
+ * @brief Store the next key stream block in ctx->keyStream.
+ */
+static void B5_ChaCha20_KeyStream (B5_tChaCha20Poly1305Ctx *ctx)
+{
+    uint32_t   x[16];
+    int32_t    i;
+    
+    
+    B5_ChaCha20_Core(ctx, x);
+    for (i = 0; i < 16; i++)
+        B5_ChaCha20_Store32(ctx->keyStream + 4*i, x[i]);
+}
+
+
+/**
+ * @brief Absorb whole 16 byte blocks into the Poly1305 accumulator, with 26-bit limbs so that
+ * every product fits 64 bits.
+ * @param ctx Pointer to the current context.
+ * @param m Input blocks.
+ * @param nBlk Number of blocks.
+ */
+static void B5_Poly1305_Blocks (B5_tChaCha20Poly1305Ctx *ctx, const uint8_t *m, int32_t nBlk)
+{
+    const uint32_t  hibit = ((uint32_t)1) << 24;
+    uint32_t        r0, r1, r2, r3, r4;
+    uint32_t        s1, s2, s3, s4;
+    uint32_t        h0, h1, h2, h3, h4;
+    uint64_t        d0, d1, d2, d3, d4;
+    uint32_t        c;
+    
+    
+    r0 = ctx->r[0]; r1 = ctx->r[1]; r2 = ctx->r[2]; r3 = ctx->r[3]; r4 = ctx->r[4];
+    s1 = r1 * 5; s2 = r2 * 5; s3 = r3 * 5; s4 = r4 * 5;
+    h0 = ctx->h[0]; h1 = ctx->h[1]; h2 = ctx->h[2]; h3 = ctx->h[3]; h4 = ctx->h[4];
+    
+    for (; nBlk > 0; nBlk--)
+    {
+        // h += m
+        h0 += (B5_ChaCha20_Load32(m     )     ) & 0x3ffffff;
+        h1 += (B5_ChaCha20_Load32(m +  3) >> 2) & 0x3ffffff;
+        h2 += (B5_ChaCha20_Load32(m +  6) >> 4) & 0x3ffffff;
+        h3 += (B5_ChaCha20_Load32(m +  9) >> 6) & 0x3ffffff;
+        h4 += (B5_ChaCha20_Load32(m + 12) >> 8) | hibit;
+        
+        // h *= r, reduced modulo 2^130 - 5
+        d0 = ((uint64_t)h0 * r0) + ((uint64_t)h1 * s4) + ((uint64_t)h2 * s3) + ((uint64_t)h3 * s2) + ((uint64_t)h4 * s1);
+        d1 = ((uint64_t)h0 * r1) + ((uint64_t)h1 * r0) + ((uint64_t)h2 * s4) + ((uint64_t)h3 * s3) + ((uint64_t)h4 * s2);
+        d2 = ((uint64_t)h0 * r2) + ((uint64_t)h1 * r1) + ((uint64_t)h2 * r0) + ((uint64_t)h3 * s4) + ((uint64_t)h4 * s3);
+        d3 = ((uint64_t)h0 * r3) + ((uint64_t)h1 * r2) + ((uint64_t)h2 * r1) + ((uint64_t)h3 * r0) + ((uint64_t)h4 * s4);
+        d4 = ((uint64_t)h0 * r4) + ((uint64_t)h1 * r3) + ((uint64_t)h2 * r2) + ((uint64_t)h3 * r1) + ((uint64_t)h4 * r0);
+        
+        c = (uint32_t)(d0 >> 26); h0 = (uint32_t)d0 & 0x3ffffff;
+        d1 += c; c = (uint32_t)(d1 >> 26); h1 = (uint32_t)d1 & 0x3ffffff;
+        d2 += c; c = (uint32_t)(d2 >> 26); h2 = (uint32_t)d2 & 0x3ffffff;
+        d3 += c; c = (uint32_t)(d3 >> 26); h3 = (uint32_t)d3 & 0x3ffffff;
+        d4 += c; c = (uint32_t)(d4 >> 26); h4 = (uint32_t)d4 & 0x3ffffff;
+        h0 += c * 5; c = h0 >> 26; h0 &= 0x3ffffff;
+        h1 += c;
+        
+        m += B5_POLY1305_BLK_SIZE;
+    }
+    
+    ctx->h[0] = h0; ctx->h[1] = h1; ctx->h[2] = h2; ctx->h[3] = h3; ctx->h[4] = h4;
+}
+
+
+/**
+ * @brief Absorb bytes of the current section (AAD or cipher text), buffering a partial block.
+ * @param ctx Pointer to the current context.
+ * @param m Input bytes.
+ * @param len Number of bytes.
+ * @param done Bytes of the section already absorbed.
+ */
+static void B5_Poly1305_Absorb (B5_tChaCha20Poly1305Ctx *ctx, const uint8_t *m, int32_t len, uint64_t done)
+{
+    uint8_t    off, n;
+    
+    
+    off = (uint8_t)(done % B5_POLY1305_BLK_SIZE);
+    
+    // Complete the pending block
+    if (off > 0)
+    {
+        n = (len < (B5_POLY1305_BLK_SIZE - off)) ? (uint8_t)len : (uint8_t)(B5_POLY1305_BLK_SIZE - off);
+        memcpy(&ctx->tmpBlk[off], m, n);
+        m += n;
+        len -= n;
+        if ((off + n) < B5_POLY1305_BLK_SIZE)
+            return;
+        B5_Poly1305_Blocks(ctx, ctx->tmpBlk, 1);
+    }
+    
+    // Whole blocks, then keep the tail
+    B5_Poly1305_Blocks(ctx, m, len / B5_POLY1305_BLK_SIZE);
+    memcpy(ctx->tmpBlk, m + (len - len % B5_POLY1305_BLK_SIZE), len % B5_POLY1305_BLK_SIZE);
+}
+
+
+/**
+ * @brief Absorb the pending partial block of a section, padded with zeros.
+ * @param ctx Pointer to the current context.
+ * @param len Bytes of the section.
+ */
+static void B5_Poly1305_Pad (B5_tChaCha20Poly1305Ctx *ctx, uint64_t len)
+{
+    uint8_t    off = (uint8_t)(len % B5_POLY1305_BLK_SIZE);
+    
+    
+    if (off == 0)
+        return;
+    
+    memset(&ctx->tmpBlk[off], 0, B5_POLY1305_BLK_SIZE - off);
+    B5_Poly1305_Blocks(ctx, ctx->tmpBlk, 1);
+}
+
+
+
+
+
+int32_t B5_ChaCha20Poly1305_Init (B5_tChaCha20Poly1305Ctx *ctx, const uint8_t *Key, int16_t keySize, uint8_t mode)
+{
+    int32_t    i;
+    
+    
+    if(Key == NULL) 
+        return B5_CHACHA20_POLY1305_RES_INVALID_ARGUMENT;
+    
+    if(ctx == NULL)
+        return  B5_CHACHA20_POLY1305_RES_INVALID_CONTEXT;
+    
+    memset(ctx, 0, sizeof(B5_tChaCha20Poly1305Ctx));
+    
+    if ((mode != B5_CHACHA20_POLY1305_ENC) && (mode != B5_CHACHA20_POLY1305_DEC))
+        return B5_CHACHA20_POLY1305_RES_INVALID_MODE;
+    
+    if (keySize != B5_CHACHA20_KEY_SIZE)
+        return B5_CHACHA20_POLY1305_RES_INVALID_KEY_SIZE;
+    
+    // "expand 32-byte k"
+    ctx->input[0] = 0x61707865;
+    ctx->input[1] = 0x3320646e;
+    ctx->input[2] = 0x79622d32;
+    ctx->input[3] = 0x6b206574;
+    for (i = 0; i < 8; i++)
+        ctx->input[4 + i] = B5_ChaCha20_Load32(Key + 4*i);
+    
+    ctx->mode = mode;
+    ctx->state = B5_CHACHA20_POLY1305_STATE_NO_NONCE;
+    
+    return B5_CHACHA20_POLY1305_RES_OK;
+}
+
+
+
+
+
+int32_t B5_ChaCha20Poly1305_SetNonce (B5_tChaCha20Poly1305Ctx *ctx, const uint8_t *Nonce)
+{
+    uint8_t    *k;
+    
+    
+    if(ctx == NULL)
+        return  B5_CHACHA20_POLY1305_RES_INVALID_CONTEXT;
+    
+    if(Nonce == NULL)
+        return B5_CHACHA20_POLY1305_RES_INVALID_ARGUMENT;
+    
+    
+    ctx->input[12] = 0;
+    ctx->input[13] = B5_ChaCha20_Load32(Nonce);
+    ctx->input[14] = B5_ChaCha20_Load32(Nonce + 4);
+    ctx->input[15] = B5_ChaCha20_Load32(Nonce + 8);
+    
+    // One-time Poly1305 key from block 0, clamped; data starts from block 1
+    B5_ChaCha20_KeyStream(ctx);
+    k = ctx->keyStream;
+    ctx->r[0] = (B5_ChaCha20_Load32(k     )     ) & 0x3ffffff;
+    ctx->r[1] = (B5_ChaCha20_Load32(k +  3) >> 2) & 0x3ffff03;
+    ctx->r[2] = (B5_ChaCha20_Load32(k +  6) >> 4) & 0x3ffc0ff;
+    ctx->r[3] = (B5_ChaCha20_Load32(k +  9) >> 6) & 0x3f03fff;
+    ctx->r[4] = (B5_ChaCha20_Load32(k + 12) >> 8) & 0x00fffff;
+    ctx->pad[0] = B5_ChaCha20_Load32(k + 16);
+    ctx->pad[1] = B5_ChaCha20_Load32(k + 20);
+    ctx->pad[2] = B5_ChaCha20_Load32(k + 24);
+    ctx->pad[3] = B5_ChaCha20_Load32(k + 28);
+    memset(ctx->keyStream, 0, sizeof(ctx->keyStream));
+    memset(ctx->h, 0, sizeof(ctx->h));
+    
+    ctx->aadLen = 0;
+    ctx->dataLen = 0;
+    ctx->state = B5_CHACHA20_POLY1305_STATE_AAD;
+    
+    return B5_CHACHA20_POLY1305_RES_OK;
+}
+
+
+
+
+
+int32_t B5_ChaCha20Poly1305_UpdateAad (B5_tChaCha20Poly1305Ctx *ctx, const uint8_t *aad, int32_t aadLen)
+{
+    if(ctx == NULL)
+        return  B5_CHACHA20_POLY1305_RES_INVALID_CONTEXT;
+    
+    if((aadLen < 0) || ((aad == NULL) && (aadLen > 0)))
+        return B5_CHACHA20_POLY1305_RES_INVALID_ARGUMENT;
+    
+    if(ctx->state != B5_CHACHA20_POLY1305_STATE_AAD)
+        return B5_CHACHA20_POLY1305_RES_INVALID_STATE;
+    
+    if(aadLen == 0)
+        return B5_CHACHA20_POLY1305_RES_OK;
+    
+    
+    B5_Poly1305_Absorb(ctx, aad, aadLen, ctx->aadLen);
+    ctx->aadLen += (uint64_t)aadLen;
+    
+    return B5_CHACHA20_POLY1305_RES_OK;
+}
+
+
+
+
+
+int32_t B5_ChaCha20Poly1305_Update (B5_tChaCha20Poly1305Ctx *ctx, uint8_t *encData, uint8_t *clrData, int32_t dataLen)
+{
+    const uint8_t  *in;
+    uint8_t        *out;
+    uint8_t        off, enc;
+    uint64_t       done;
+    int32_t        i, n;
+    
+    
+    if(ctx == NULL)
+        return  B5_CHACHA20_POLY1305_RES_INVALID_CONTEXT;
+    
+    if((dataLen < 0) || (((encData == NULL) || (clrData == NULL)) && (dataLen > 0)))
+        return B5_CHACHA20_POLY1305_RES_INVALID_ARGUMENT;
+    
+    if(ctx->state == B5_CHACHA20_POLY1305_STATE_AAD)
+    {
+        B5_Poly1305_Pad(ctx, ctx->aadLen);
+        ctx->state = B5_CHACHA20_POLY1305_STATE_DATA;
+    }
+    else if(ctx->state != B5_CHACHA20_POLY1305_STATE_DATA)
+        return B5_CHACHA20_POLY1305_RES_INVALID_STATE;
+    
+    if(ctx->dataLen + (uint64_t)dataLen > B5_CHACHA20_MAX_DATA_LEN)
+        return B5_CHACHA20_POLY1305_RES_INVALID_ARGUMENT;
+    
+    if(dataLen == 0)
+        return B5_CHACHA20_POLY1305_RES_OK;
+    
+    
+    enc = (ctx->mode == B5_CHACHA20_POLY1305_ENC);
+    in = enc ? clrData : encData;
+    out = enc ? encData : clrData;
+    
+    done = ctx->dataLen;
+    ctx->dataLen += (uint64_t)dataLen;
+    
+    // The cipher text is absorbed before decryption and after encryption, so in-place works
+    
+    // Rest of the key stream of the pending block
+    off = (uint8_t)(done % B5_CHACHA20_BLK_SIZE);
+    if (off > 0)
+    {
+        n = (dataLen < (B5_CHACHA20_BLK_SIZE - off)) ? dataLen : (B5_CHACHA20_BLK_SIZE - off);
+        if (!enc)
+            B5_Poly1305_Absorb(ctx, in, n, done);
+        for (i = 0; i < n; i++)
+            out[i] = in[i] ^ ctx->keyStream[off + i];
+        if (enc)
+            B5_Poly1305_Absorb(ctx, out, n, done);
+        in += n;
+        out += n;
+        done += n;
+        dataLen -= n;
+    }
+    
+    // Whole blocks, each absorbed while still in registers and cache
+    while (dataLen >= B5_CHACHA20_BLK_SIZE)
+    {
+        if (!enc)
+            B5_Poly1305_Blocks(ctx, in, B5_CHACHA20_BLK_SIZE / B5_POLY1305_BLK_SIZE);
+        B5_ChaCha20_Xor(ctx, out, in);
+        if (enc)
+            B5_Poly1305_Blocks(ctx, out, B5_CHACHA20_BLK_SIZE / B5_POLY1305_BLK_SIZE);
+        in += B5_CHACHA20_BLK_SIZE;
+        out += B5_CHACHA20_BLK_SIZE;
+        done += B5_CHACHA20_BLK_SIZE;
+        dataLen -= B5_CHACHA20_BLK_SIZE;
+    }
+    
+    // Start a new pending block with the tail
+    if (dataLen > 0)
+    {
+        B5_ChaCha20_KeyStream(ctx);
+        if (!enc)
+            B5_Poly1305_Absorb(ctx, in, dataLen, done);
+        for (i = 0; i < dataLen; i++)
+            out[i] = in[i] ^ ctx->keyStream[i];
+        if (enc)
+            B5_Poly1305_Absorb(ctx, out, dataLen, done);
+    }
+    
+    return B5_CHACHA20_POLY1305_RES_OK;
+}
+
+
+
+
+
+int32_t B5_ChaCha20Poly1305_Finit (B5_tChaCha20Poly1305Ctx *ctx, uint8_t *rTag)
+{
+    uint8_t    lenBlk[B5_POLY1305_BLK_SIZE];
+    uint32_t   h0, h1, h2, h3, h4;
+    uint32_t   g0, g1, g2, g3, g4;
+    uint32_t   c, mask;
+    uint64_t   f;
+    
+    
+    if(ctx == NULL)
+        return  B5_CHACHA20_POLY1305_RES_INVALID_CONTEXT;
+    
+    if(rTag == NULL)
+        return B5_CHACHA20_POLY1305_RES_INVALID_ARGUMENT;
+    
+    if(ctx->state == B5_CHACHA20_POLY1305_STATE_AAD)
+        B5_Poly1305_Pad(ctx, ctx->aadLen);
+    else if(ctx->state == B5_CHACHA20_POLY1305_STATE_DATA)
+        B5_Poly1305_Pad(ctx, ctx->dataLen);
+    else
+        return B5_CHACHA20_POLY1305_RES_INVALID_STATE;
+    
+    
+    // le64(len(AAD)) || le64(len(C))
+    B5_ChaCha20_Store32(lenBlk     , (uint32_t)ctx->aadLen);
+    B5_ChaCha20_Store32(lenBlk +  4, (uint32_t)(ctx->aadLen >> 32));
+    B5_ChaCha20_Store32(lenBlk +  8, (uint32_t)ctx->dataLen);
+    B5_ChaCha20_Store32(lenBlk + 12, (uint32_t)(ctx->dataLen >> 32));
+    B5_Poly1305_Blocks(ctx, lenBlk, 1);
+    
+    // Fully carry h
+    h0 = ctx->h[0]; h1 = ctx->h[1]; h2 = ctx->h[2]; h3 = ctx->h[3]; h4 = ctx->h[4];
+    c = h1 >> 26; h1 &= 0x3ffffff;
+    h2 += c; c = h2 >> 26; h2 &= 0x3ffffff;
+    h3 += c; c = h3 >> 26; h3 &= 0x3ffffff;
+    h4 += c; c = h4 >> 26; h4 &= 0x3ffffff;
+    h0 += c * 5; c = h0 >> 26; h0 &= 0x3ffffff;
+    h1 += c;
+    
+    // g = h + -p; select h if h < p, g otherwise, without branches
+    g0 = h0 + 5; c = g0 >> 26; g0 &= 0x3ffffff;
+    g1 = h1 + c; c = g1 >> 26; g1 &= 0x3ffffff;
+    g2 = h2 + c; c = g2 >> 26; g2 &= 0x3ffffff;
+    g3 = h3 + c; c = g3 >> 26; g3 &= 0x3ffffff;
+    g4 = h4 + c - (((uint32_t)1) << 26);
+    
+    mask = (g4 >> 31) - 1;
+    g0 &= mask; g1 &= mask; g2 &= mask; g3 &= mask; g4 &= mask;
+    mask = ~mask;
+    h0 = (h0 & mask) | g0;
+    h1 = (h1 & mask) | g1;
+    h2 = (h2 & mask) | g2;
+    h3 = (h3 & mask) | g3;
+    h4 = (h4 & mask) | g4;
+    
+    // tag = (h + pad) mod 2^128
+    h0 = (h0      ) | (h1 << 26);
+    h1 = (h1 >>  6) | (h2 << 20);
+    h2 = (h2 >> 12) | (h3 << 14);
+    h3 = (h3 >> 18) | (h4 <<  8);
+    
+    f = (uint64_t)h0 + ctx->pad[0];             B5_ChaCha20_Store32(rTag     , (uint32_t)f);
+    f = (uint64_t)h1 + ctx->pad[1] + (f >> 32); B5_ChaCha20_Store32(rTag +  4, (uint32_t)f);
+    f = (uint64_t)h2 + ctx->pad[2] + (f >> 32); B5_ChaCha20_Store32(rTag +  8, (uint32_t)f);
+    f = (uint64_t)h3 + ctx->pad[3] + (f >> 32); B5_ChaCha20_Store32(rTag + 12, (uint32_t)f);
+    
+    // the one-time key must not be used again
+    memset(ctx->r, 0, sizeof(ctx->r));
+    memset(ctx->h, 0, sizeof(ctx->h));
+    memset(ctx->pad, 0, sizeof(ctx->pad));
+    ctx->state = B5_CHACHA20_POLY1305_STATE_NO_NONCE;
+    
+    return B5_CHACHA20_POLY1305_RES_OK;
+}
+
+
+
+
+
+int32_t B5_ChaCha20Poly1305_Verify (B5_tChaCha20Poly1305Ctx *ctx, const uint8_t *tag)
+{
+    uint8_t    T[B5_POLY1305_TAG_SIZE];
+    uint8_t    diff = 0;
+    int32_t    i, res;
+    
+    
+    if(ctx == NULL)
+        return  B5_CHACHA20_POLY1305_RES_INVALID_CONTEXT;
+    
+    if(tag == NULL)
+        return B5_CHACHA20_POLY1305_RES_INVALID_ARGUMENT;
+    
+    res = B5_ChaCha20Poly1305_Finit(ctx, T);
+    if (res != B5_CHACHA20_POLY1305_RES_OK)
+        return res;
+    
+    for (i = 0; i < B5_POLY1305_TAG_SIZE; i++)
+        diff |= T[i] ^ tag[i];
+    
+    memset(T, 0, sizeof(T));
+    
+    return (diff == 0) ? B5_CHACHA20_POLY1305_RES_OK : B5_CHACHA20_POLY1305_RES_AUTH_FAILED;
+}
@@ -0,0 +1,169 @@
+#pragma once
+/*  LICENSE  */
+
+/**
+ * @file chacha20poly1305.h
+ * @brief ChaCha20-Poly1305 authenticated encryption (RFC 8439). Only 32-bit additions, rotations
+ * and multiplications are used, with no table lookups, so the timing does not depend on the data.
+ *
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/** \defgroup chachaReturn ChaCha20-Poly1305 return values
+ * @{
+ */
+/** \name ChaCha20-Poly1305 return values */
+///@{
+#define B5_CHACHA20_POLY1305_RES_OK                             ( 0)
+#define B5_CHACHA20_POLY1305_RES_INVALID_CONTEXT                (-1)
+#define B5_CHACHA20_POLY1305_RES_CANNOT_ALLOCATE_CONTEXT        (-2)
+#define B5_CHACHA20_POLY1305_RES_INVALID_KEY_SIZE               (-3)
+#define B5_CHACHA20_POLY1305_RES_INVALID_ARGUMENT               (-4)
+#define B5_CHACHA20_POLY1305_RES_INVALID_MODE                   (-5)
+#define B5_CHACHA20_POLY1305_RES_INVALID_STATE                  (-6)
+#define B5_CHACHA20_POLY1305_RES_AUTH_FAILED                    (-7)
+///@}
+/** @} */
+
+
+/** \defgroup chachaSizes ChaCha20-Poly1305 Key, Nonce, Tag, Block Sizes
+ * @{
+ */
+/** \name ChaCha20-Poly1305 Key, Nonce, Tag, Block Sizes */
+///@{
+#define B5_CHACHA20_KEY_SIZE            32  /**< Key Size in Bytes */
+#define B5_CHACHA20_NONCE_SIZE          12  /**< Nonce Size in Bytes */
+#define B5_CHACHA20_BLK_SIZE            64  /**< Key stream block Size in Bytes */
+#define B5_POLY1305_TAG_SIZE            16  /**< Tag Size in Bytes */
+#define B5_POLY1305_BLK_SIZE            16  /**< Block Size in Bytes */
+///@}
+/** @} */
+
+
+/** \defgroup chachaModes ChaCha20-Poly1305 modes
+ * @{
+ */
+/** \name ChaCha20-Poly1305 modes */
+///@{
+#define B5_CHACHA20_POLY1305_ENC        1   /**< Authenticated encryption */
+#define B5_CHACHA20_POLY1305_DEC        2   /**< Authenticated decryption */
+///@}
+/** @} */
+
+
+/** \defgroup chachaStates ChaCha20-Poly1305 message phases
+ * @{
+ */
+/** \name ChaCha20-Poly1305 message phases */
+///@{
+#define B5_CHACHA20_POLY1305_STATE_NO_NONCE     0   /**< No nonce set, or the last message has been completed */
+#define B5_CHACHA20_POLY1305_STATE_AAD          1   /**< Nonce set, accepting AAD */
+#define B5_CHACHA20_POLY1305_STATE_DATA         2   /**< Accepting data */
+///@}
+/** @} */
+
+
+/** \defgroup chachaStr ChaCha20-Poly1305 data structures
+ * @{
+ */
+/** \name ChaCha20-Poly1305 data structures */
+///@{
+typedef struct {
+    uint32_t    input[16];                          /**< ChaCha20 state: constants, key, block counter, nonce */
+    uint8_t     keyStream[B5_CHACHA20_BLK_SIZE];    /**< Key stream of the current partial block */
+    
+    uint32_t    r[5];                               /**< Poly1305 multiplier, 26-bit limbs */
+    uint32_t    h[5];                               /**< Poly1305 accumulator, 26-bit limbs */
+    uint32_t    pad[4];                             /**< Poly1305 final addend */
+    uint8_t     tmpBlk[B5_POLY1305_BLK_SIZE];       /**< Pending bytes of a partial AAD or cipher text block */
+    
+    uint64_t    aadLen;                             /**< AAD bytes processed */
+    uint64_t    dataLen;                            /**< Data bytes processed */
+    
+    uint8_t     mode;                               /**< See \ref chachaModes */
+    uint8_t     state;                              /**< See \ref chachaStates */
+} B5_tChaCha20Poly1305Ctx;
+///@}
+/** @} */
+
+
+/** \defgroup chachaFunc ChaCha20-Poly1305 functions
+ * @{
+ */
+/** \name ChaCha20-Poly1305 functions */
+///@{
+
+/**
+ *
+ * @brief Initialize the ChaCha20-Poly1305 context.
+ * @param ctx Pointer to the data structure to be initialized.
+ * @param Key Pointer to the Key that must be used.
+ * @param keySize Key size, must be B5_CHACHA20_KEY_SIZE.
+ * @param mode See \ref chachaModes .
+ * @return See \ref chachaReturn .
+ */
+int32_t    B5_ChaCha20Poly1305_Init (B5_tChaCha20Poly1305Ctx *ctx, const uint8_t *Key, int16_t keySize, uint8_t mode);
+
+/**
+ *
+ * @brief Start a new message. Must be called before any AAD or data, and again for each message.
+ * @param ctx Pointer to the current context.
+ * @param Nonce Pointer to the nonce, B5_CHACHA20_NONCE_SIZE Bytes. It must never be repeated with the same key.
+ * @return See \ref chachaReturn .
+ */
+int32_t    B5_ChaCha20Poly1305_SetNonce (B5_tChaCha20Poly1305Ctx *ctx, const uint8_t *Nonce);
+
+/**
+ *
+ * @brief Authenticate additional data. It may be called several times, but only before B5_ChaCha20Poly1305_Update.
+ * @param ctx Pointer to the current context.
+ * @param aad Pointer to the additional data.
+ * @param aadLen Bytes to be processed.
+ * @return See \ref chachaReturn .
+ */
+int32_t    B5_ChaCha20Poly1305_UpdateAad (B5_tChaCha20Poly1305Ctx *ctx, const uint8_t *aad, int32_t aadLen);
+
+/**
+ *
+ * @brief Encrypt or decrypt data and authenticate the cipher text. Any length is accepted; encData and clrData may be the same buffer.
+ * @param ctx Pointer to the current context.
+ * @param encData Encrypted data (output when encrypting, input when decrypting).
+ * @param clrData Clear data (input when encrypting, output when decrypting).
+ * @param dataLen Bytes to be processed.
+ * @return See \ref chachaReturn .
+ */
+int32_t    B5_ChaCha20Poly1305_Update (B5_tChaCha20Poly1305Ctx *ctx, uint8_t *encData, uint8_t *clrData, int32_t dataLen);
+
+/**
+ *
+ * @brief Complete the message and compute its tag. A new nonce must be set before the next message.
+ * @param ctx Pointer to the current context.
+ * @param rTag Pointer to a blank memory area of B5_POLY1305_TAG_SIZE Bytes.
+ * @return See \ref chachaReturn .
+ */
+int32_t    B5_ChaCha20Poly1305_Finit (B5_tChaCha20Poly1305Ctx *ctx, uint8_t *rTag);
+
+/**
+ *
+ * @brief Complete the message and compare its tag with the expected one in constant time.
+ * @param ctx Pointer to the current context.
+ * @param tag Pointer to the expected tag, B5_POLY1305_TAG_SIZE Bytes.
+ * @return See \ref chachaReturn ; B5_CHACHA20_POLY1305_RES_AUTH_FAILED if the tags differ.
+ */
+int32_t    B5_ChaCha20Poly1305_Verify (B5_tChaCha20Poly1305Ctx *ctx, const uint8_t *tag);
+
+///@}
+/** @} */
+
+
+
+#ifdef __cplusplus
+}
+#endif
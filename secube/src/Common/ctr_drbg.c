@@ -0,0 +1,187 @@
+/*  LICENSE  */
+
+/**
+ * @file ctr_drbg.c
+ * @brief Implementation of CTR_DRBG with AES-256 (NIST SP 800-90A). See \ref ctr_drbg.h .
+ *
+ */
+
+
+#include "ctr_drbg.h"
+
+
+/**
+ * @brief Increment a 128-bit big endian counter.
+ */
+static void B5_CtrDrbg_Inc (uint8_t *v)
+{
+    int32_t    j = B5_AES_BLK_SIZE - 1;
+    
+    
+    do {
+        v[j]++;
+    } while ((v[j] == 0) && (j-- > 0));
+}
+
+
+
+
+
+/**
+ * @brief CTR_DRBG_Update: (Key, V) = E(Key, V+1) || E(Key, V+2) || E(Key, V+3) xor provided data.
+ * The AES context runs in CTR mode with V + 1 as IV, so the key stream is XORed straight into the
+ * provided data.
+ * @param ctx Pointer to the current context.
+ * @param data Pointer to the provided data, may be NULL.
+ * @param dataLen Provided data size, up to B5_CTR_DRBG_SEED_SIZE Bytes; the rest is zero.
+ */
+static void B5_CtrDrbg_Update (B5_tCtrDrbgCtx *ctx, const uint8_t *data, int16_t dataLen)
+{
+    uint8_t    temp[B5_CTR_DRBG_SEED_SIZE];
+    
+    
+    memset(temp, 0, sizeof(temp));
+    if (data != NULL)
+        memcpy(temp, data, dataLen);
+    
+    B5_Aes256_Update(&ctx->aesCtx, temp, temp, B5_CTR_DRBG_SEED_SIZE / B5_AES_BLK_SIZE);
+    
+    B5_Aes256_Init(&ctx->aesCtx, temp, B5_AES_256, B5_AES256_CTR);
+    B5_CtrDrbg_Inc(&temp[B5_AES_256]);
+    B5_Aes256_SetIV(&ctx->aesCtx, &temp[B5_AES_256]);
+    
+    memset(temp, 0, sizeof(temp));
+}
+
+
+
+
+
+int32_t B5_CtrDrbg_Instantiate (B5_tCtrDrbgCtx *ctx, const uint8_t *entropy, const uint8_t *pers, int16_t persLen)
+{
+    uint8_t    seed[B5_CTR_DRBG_SEED_SIZE];
+    int32_t    i;
+    
+    
+    if(ctx == NULL)
+        return B5_CTR_DRBG_RES_INVALID_CONTEXT;
+    
+    if((entropy == NULL) || (persLen < 0) || (persLen > B5_CTR_DRBG_SEED_SIZE) || ((pers == NULL) && (persLen > 0)))
+        return B5_CTR_DRBG_RES_INVALID_ARGUMENT;
+    
+    memset(ctx, 0, sizeof(B5_tCtrDrbgCtx));
+    
+    
+    // Key = 0, V = 0
+    memset(seed, 0, sizeof(seed));
+    B5_Aes256_Init(&ctx->aesCtx, seed, B5_AES_256, B5_AES256_CTR);
+    B5_CtrDrbg_Inc(seed);
+    B5_Aes256_SetIV(&ctx->aesCtx, seed);
+    
+    memcpy(seed, entropy, B5_CTR_DRBG_SEED_SIZE);
+    for (i = 0; i < persLen; i++)
+        seed[i] ^= pers[i];
+    
+    B5_CtrDrbg_Update(ctx, seed, B5_CTR_DRBG_SEED_SIZE);
+    ctx->reseedCounter = 1;
+    
+    memset(seed, 0, sizeof(seed));
+    
+    return B5_CTR_DRBG_RES_OK;
+}
+
+
+
+
+
+int32_t B5_CtrDrbg_Reseed (B5_tCtrDrbgCtx *ctx, const uint8_t *entropy, const uint8_t *addInput, int16_t addLen)
+{
+    uint8_t    seed[B5_CTR_DRBG_SEED_SIZE];
+    int32_t    i;
+    
+    
+    if((ctx == NULL) || (ctx->reseedCounter == 0))
+        return B5_CTR_DRBG_RES_INVALID_CONTEXT;
+    
+    if((entropy == NULL) || (addLen < 0) || (addLen > B5_CTR_DRBG_SEED_SIZE) || ((addInput == NULL) && (addLen > 0)))
+        return B5_CTR_DRBG_RES_INVALID_ARGUMENT;
+    
+    memcpy(seed, entropy, B5_CTR_DRBG_SEED_SIZE);
+    for (i = 0; i < addLen; i++)
+        seed[i] ^= addInput[i];
+    
+    B5_CtrDrbg_Update(ctx, seed, B5_CTR_DRBG_SEED_SIZE);
+    ctx->reseedCounter = 1;
+    
+    memset(seed, 0, sizeof(seed));
+    
+    return B5_CTR_DRBG_RES_OK;
+}
+
+
+
+
+
+int32_t B5_CtrDrbg_Generate (B5_tCtrDrbgCtx *ctx, uint8_t *out, int32_t outLen, const uint8_t *addInput, int16_t addLen)
+{
+    uint8_t    tmp[B5_AES_BLK_SIZE];
+    int32_t    nBlk, n;
+    
+    
+    if((ctx == NULL) || (ctx->reseedCounter == 0))
+        return B5_CTR_DRBG_RES_INVALID_CONTEXT;
+    
+    if((out == NULL) || (outLen < 0) || (outLen > B5_CTR_DRBG_MAX_REQUEST) || 
+       (addLen < 0) || (addLen > B5_CTR_DRBG_SEED_SIZE) || ((addInput == NULL) && (addLen > 0)))
+        return B5_CTR_DRBG_RES_INVALID_ARGUMENT;
+    
+    if(ctx->reseedCounter > B5_CTR_DRBG_RESEED_INTERVAL)
+        return B5_CTR_DRBG_RES_RESEED_REQUIRED;
+    
+    
+    if(addLen > 0)
+        B5_CtrDrbg_Update(ctx, addInput, addLen);
+    
+    
+    // Output blocks are E(V+1), E(V+2), ...: CTR mode over a zero buffer
+    nBlk = outLen / B5_AES_BLK_SIZE;
+    memset(out, 0, nBlk * B5_AES_BLK_SIZE);
+    while (nBlk > 0)
+    {
+        n = (nBlk < 0x4000) ? nBlk : 0x4000;
+        B5_Aes256_Update(&ctx->aesCtx, out, out, (int16_t)n);
+        out += n * B5_AES_BLK_SIZE;
+        nBlk -= n;
+    }
+    
+    n = outLen % B5_AES_BLK_SIZE;
+    if(n > 0)
+    {
+        memset(tmp, 0, sizeof(tmp));
+        B5_Aes256_Update(&ctx->aesCtx, tmp, tmp, 1);
+        memcpy(out, tmp, n);
+        memset(tmp, 0, sizeof(tmp));
+    }
+    
+    
+    // The IV is now V + 1 for the last block generated
+    B5_CtrDrbg_Update(ctx, addInput, addLen);
+    ctx->reseedCounter++;
+    
+    return B5_CTR_DRBG_RES_OK;
+}
+
+
+
+
+
+int32_t B5_CtrDrbg_Uninstantiate (B5_tCtrDrbgCtx *ctx)
+{
+    if(ctx == NULL)
+        return B5_CTR_DRBG_RES_INVALID_CONTEXT;
+    
+    B5_Aes256_Finit(&ctx->aesCtx);
+    memset(ctx, 0, sizeof(B5_tCtrDrbgCtx));
+    
+    return B5_CTR_DRBG_RES_OK;
+}
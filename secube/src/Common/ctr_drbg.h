@@ -0,0 +1,113 @@
+#pragma once
+/*  LICENSE  */
+
+/**
+ * @file ctr_drbg.h
+ * @brief CTR_DRBG deterministic random bit generator (NIST SP 800-90A) based on AES-256, without
+ * derivation function: entropy inputs must be full entropy, as produced by a hardware RNG.
+ *
+ */
+
+#include "aes256.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/** \defgroup drbgReturn CTR_DRBG return values
+ * @{
+ */
+/** \name CTR_DRBG return values */
+///@{
+#define B5_CTR_DRBG_RES_OK                                      ( 0)
+#define B5_CTR_DRBG_RES_INVALID_CONTEXT                         (-1)
+#define B5_CTR_DRBG_RES_CANNOT_ALLOCATE_CONTEXT                 (-2)
+#define B5_CTR_DRBG_RES_INVALID_ARGUMENT                        (-4)
+#define B5_CTR_DRBG_RES_RESEED_REQUIRED                         (-5)
+///@}
+/** @} */
+
+
+/** \defgroup drbgSizes CTR_DRBG sizes and limits
+ * @{
+ */
+/** \name CTR_DRBG sizes and limits */
+///@{
+#define B5_CTR_DRBG_SEED_SIZE           48          /**< Entropy input, personalization string and max additional input size in Bytes */
+#define B5_CTR_DRBG_MAX_REQUEST         65536       /**< Max Bytes returned by one B5_CtrDrbg_Generate call */
+#define B5_CTR_DRBG_RESEED_INTERVAL     0x7FFFFFFF  /**< Max B5_CtrDrbg_Generate calls between two reseeds */
+///@}
+/** @} */
+
+
+/** \defgroup drbgStr CTR_DRBG data structures
+ * @{
+ */
+/** \name CTR_DRBG data structures */
+///@{
+typedef struct {
+    B5_tAesCtx  aesCtx;             /**< AES-256 CTR context: the key is the DRBG Key, the IV is V + 1 */
+    uint32_t    reseedCounter;      /**< Generate calls since the last (re)seed, plus one; 0 if not instantiated */
+} B5_tCtrDrbgCtx;
+///@}
+/** @} */
+
+
+/** \defgroup drbgFunc CTR_DRBG functions
+ * @{
+ */
+/** \name CTR_DRBG functions */
+///@{
+
+/**
+ *
+ * @brief Instantiate the DRBG.
+ * @param ctx Pointer to the data structure to be initialized.
+ * @param entropy Pointer to B5_CTR_DRBG_SEED_SIZE Bytes of full entropy.
+ * @param pers Pointer to the personalization string, may be NULL.
+ * @param persLen Personalization string size, up to B5_CTR_DRBG_SEED_SIZE Bytes.
+ * @return See \ref drbgReturn .
+ */
+int32_t    B5_CtrDrbg_Instantiate (B5_tCtrDrbgCtx *ctx, const uint8_t *entropy, const uint8_t *pers, int16_t persLen);
+
+/**
+ *
+ * @brief Mix fresh entropy into the DRBG state and reset the reseed counter.
+ * @param ctx Pointer to the current context.
+ * @param entropy Pointer to B5_CTR_DRBG_SEED_SIZE Bytes of full entropy.
+ * @param addInput Pointer to the additional input, may be NULL.
+ * @param addLen Additional input size, up to B5_CTR_DRBG_SEED_SIZE Bytes.
+ * @return See \ref drbgReturn .
+ */
+int32_t    B5_CtrDrbg_Reseed (B5_tCtrDrbgCtx *ctx, const uint8_t *entropy, const uint8_t *addInput, int16_t addLen);
+
+/**
+ *
+ * @brief Generate random Bytes.
+ * @param ctx Pointer to the current context.
+ * @param out Pointer to the output buffer.
+ * @param outLen Bytes to generate, up to B5_CTR_DRBG_MAX_REQUEST.
+ * @param addInput Pointer to the additional input, may be NULL.
+ * @param addLen Additional input size, up to B5_CTR_DRBG_SEED_SIZE Bytes.
+ * @return See \ref drbgReturn ; B5_CTR_DRBG_RES_RESEED_REQUIRED once B5_CTR_DRBG_RESEED_INTERVAL
+ * requests have been served since the last reseed.
+ */
+int32_t    B5_CtrDrbg_Generate (B5_tCtrDrbgCtx *ctx, uint8_t *out, int32_t outLen, const uint8_t *addInput, int16_t addLen);
+
+/**
+ *
+ * @brief Erase the DRBG state.
+ * @param ctx Pointer to the context to de-initialize.
+ * @return See \ref drbgReturn .
+ */
+int32_t    B5_CtrDrbg_Uninstantiate (B5_tCtrDrbgCtx *ctx);
+
+///@}
+/** @} */
+
+
+
+#ifdef __cplusplus
+}
+#endif
@@ -9,64 +9,87 @@ static  void xor_bb(uint8_t *out, const uint8_t *x, const uint8_t *y, size_t len
 		out[i] = x[i] ^ y[i];
 }
 
-static void F(const B5_tHmacSha256Ctx *startctx,
-	uint32_t counter,
+void PBKDF2HmacSha256(
+	const uint8_t *pw, size_t npw,
 	const uint8_t *salt, size_t nsalt,
 	uint32_t iterations,
-	uint8_t *out)
+	uint8_t *out, size_t nout)
 {
-	uint8_t U[B5_SHA256_DIGEST_SIZE];
-	B5_tHmacSha256Ctx ctx = *startctx;
-	uint8_t countbuf[4];
-	uint32_t i;
-	countbuf[0] = ((counter >> 3 * 8) & 0xFF);
-	countbuf[1] = ((counter >> 2 * 8) & 0xFF);
-	countbuf[2] = ((counter >> 1 * 8) & 0xFF);
-	countbuf[3] = (counter & 0xFF);
-
-	/* First iteration:
-	*   U_1 = PRF(P, S || INT_32_BE(i))
-	*/
-	
-	B5_HmacSha256_Update(&ctx, salt, nsalt);
-	B5_HmacSha256_Update(&ctx, countbuf, sizeof(countbuf));
-	B5_HmacSha256_Finit(&ctx, U);
-	memcpy(out, U, B5_SHA256_DIGEST_SIZE);
-
-	/* Subsequent iterations:
-	*   U_c = PRF(P, U_{c-1})
-	*/
-	for (i = 1; i < iterations; i++)
-	{
-		ctx = *startctx;
-		B5_HmacSha256_Update(&ctx, U, B5_SHA256_DIGEST_SIZE);
-		B5_HmacSha256_Finit(&ctx, U);
-		xor_bb(out, out, U, B5_SHA256_DIGEST_SIZE);
-	}
+	PBKDF2HmacSha256_Multi(&pw, &npw, &salt, nsalt, iterations, &out, nout, 1);
 }
 
 
-void PBKDF2HmacSha256(
-	const uint8_t *pw, size_t npw,
-	const uint8_t *salt, size_t nsalt,
+/* Every output block of every derivation is an independent lane:
+*  T_i = U_1 ^ U_2 ^ ... ^ U_c, with U_1 = PRF(P, S || INT_32_BE(i)), U_c = PRF(P, U_{c-1})
+*/
+void PBKDF2HmacSha256_Multi(
+	const uint8_t *const pw[], const size_t npw[],
+	const uint8_t *const salt[], size_t nsalt,
 	uint32_t iterations,
-	uint8_t *out, size_t nout)
+	uint8_t *const out[], size_t nout,
+	int16_t n)
 {
-	uint32_t counter = 1;
-	uint8_t block[B5_SHA256_DIGEST_SIZE];
-	size_t taken;
-
-	/* Starting point for inner loop. */
-	B5_tHmacSha256Ctx ctx;
-	B5_HmacSha256_Init(&ctx, pw, (int16_t)npw);
+	B5_tHmacSha256Ctx startctx[B5_SHA256_MULTI_LANES];
+	B5_tHmacSha256Ctx ctx[B5_SHA256_MULTI_LANES];
+	const B5_tHmacSha256Ctx *pctx[B5_SHA256_MULTI_LANES];
+	const uint8_t *pdata[B5_SHA256_MULTI_LANES];
+	uint8_t *pU[B5_SHA256_MULTI_LANES];
+	uint8_t U[B5_SHA256_MULTI_LANES][B5_SHA256_DIGEST_SIZE];
+	uint8_t T[B5_SHA256_MULTI_LANES][B5_SHA256_DIGEST_SIZE];
+	uint8_t countbuf[B5_SHA256_MULTI_LANES][4];
+	size_t blocks = (nout + B5_SHA256_DIGEST_SIZE - 1) / B5_SHA256_DIGEST_SIZE;
+	size_t lanes = blocks * (size_t)((n > 0) ? n : 0);
+	size_t first, job, block, taken;
+	uint32_t counter, i;
+	int16_t l, m;
 
-	while(nout)
+	for (first = 0; first < lanes; first += (size_t)m)
 	{
-		F(&ctx, counter, salt, nsalt, iterations, block);
-		taken = (nout < B5_SHA256_DIGEST_SIZE)?(nout):(B5_SHA256_DIGEST_SIZE);
-		memcpy(out, block, taken);
-		out += taken;
-		nout -= taken;
-		counter++;
+		m = ((lanes - first) < B5_SHA256_MULTI_LANES) ? (int16_t)(lanes - first) : B5_SHA256_MULTI_LANES;
+
+		/* First iteration:
+		*   U_1 = PRF(P, S || INT_32_BE(i))
+		*/
+		for (l = 0; l < m; l++)
+		{
+			job = (first + (size_t)l) / blocks;
+			counter = (uint32_t)((first + (size_t)l) % blocks) + 1;
+			B5_HmacSha256_Init(&startctx[l], pw[job], (int16_t)npw[job]);
+			ctx[l] = startctx[l];
+			B5_HmacSha256_Update(&ctx[l], salt[job], (int32_t)nsalt);
+			countbuf[l][0] = ((counter >> 3 * 8) & 0xFF);
+			countbuf[l][1] = ((counter >> 2 * 8) & 0xFF);
+			countbuf[l][2] = ((counter >> 1 * 8) & 0xFF);
+			countbuf[l][3] = (counter & 0xFF);
+			pctx[l] = &ctx[l];
+			pdata[l] = countbuf[l];
+			pU[l] = U[l];
+		}
+		B5_HmacSha256_Multi(pctx, pdata, sizeof(countbuf[0]), pU, m);
+		memcpy(T, U, (size_t)m * B5_SHA256_DIGEST_SIZE);
+
+		/* Subsequent iterations:
+		*   U_c = PRF(P, U_{c-1})
+		*/
+		for (l = 0; l < m; l++)
+		{
+			pctx[l] = &startctx[l];
+			pdata[l] = U[l];
+		}
+		for (i = 1; i < iterations; i++)
+		{
+			B5_HmacSha256_Multi(pctx, pdata, B5_SHA256_DIGEST_SIZE, pU, m);
+			for (l = 0; l < m; l++)
+				xor_bb(T[l], T[l], U[l], B5_SHA256_DIGEST_SIZE);
+		}
+
+		for (l = 0; l < m; l++)
+		{
+			job = (first + (size_t)l) / blocks;
+			block = (first + (size_t)l) % blocks;
+			taken = nout - block * B5_SHA256_DIGEST_SIZE;
+			taken = (taken < B5_SHA256_DIGEST_SIZE) ? (taken) : (B5_SHA256_DIGEST_SIZE);
+			memcpy(out[job] + block * B5_SHA256_DIGEST_SIZE, T[l], taken);
+		}
 	}
 }
\ No newline at end of file
@@ -33,6 +33,27 @@ extern "C" {
 		uint32_t iterations,
 		uint8_t *out, size_t nout);
 
+	/**
+	 *  \brief Compute n independent PBKDF2 derivations with the same salt length,
+	 *         iteration count and output length, several of them at once when the CPU allows it
+	 *  
+	 *  \param [in] pw Master passwords, one per derivation
+	 *  \param [in] npw Length of each Master password
+	 *  \param [in] salt Salts, one per derivation
+	 *  \param [in] nsalt Length of each Salt
+	 *  \param [in] iterations Number of iterations
+	 *  \param [in] out Pointers to the outputs, one per derivation
+	 *  \param [in] nout Length of each output
+	 *  \param [in] n Number of derivations
+	 *  
+	 */
+	void PBKDF2HmacSha256_Multi(
+		const uint8_t *const pw[], const size_t npw[],
+		const uint8_t *const salt[], size_t nsalt,
+		uint32_t iterations,
+		uint8_t *const out[], size_t nout,
+		int16_t n);
+
 #ifdef __cplusplus
 }
 #endif
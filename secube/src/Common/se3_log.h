@@ -0,0 +1,86 @@
+/**
+ *  \file se3_log.h
+ *  \brief Binary event log of the device, kept in a RAM ring and written to the SD card when idle
+ *
+ *  \details An event is an ID and two 32 bit arguments, stamped with the cycle counter. Any
+ *  context, interrupts included, records events with \ref SE3_LOG without locks or formatting;
+ *  the main loop packs them in 512 byte blocks and writes several blocks at a time to a
+ *  reserved range of the SD card. The host decodes the range with the se3log tool.
+ *
+ *  USAGE:
+ *  1) Define SE3_LOG_SD below, and SE3_LOG_SD_FIRST and SE3_LOG_SD_BLOCKS if the default range
+ *     overlaps a partition of the card: it is overwritten at every boot.
+ *  2) Record events anywhere with SE3_LOG(id, arg0, arg1), using SE3_LOG_USER + n for ad hoc IDs.
+ *  3) Read the range from the host, e.g. se3log /dev/sdX or se3log -f 0 image.bin after dd.
+ */
+
+#pragma once
+
+#include "se3c1def.h"
+
+
+//#define SE3_LOG_SD
+
+#ifndef SE3_LOG_SD_FIRST
+#define SE3_LOG_SD_FIRST (41024)  ///< first SD block of the log
+#endif
+#ifndef SE3_LOG_SD_BLOCKS
+#define SE3_LOG_SD_BLOCKS (2048)  ///< SD blocks of the log, written circularly
+#endif
+
+/** Event IDs */
+enum {
+	SE3_LOG_BOOT = 1,  ///< device initialized; cycle counter frequency
+	SE3_LOG_CMD0 = 2,  ///< L0 command executed; command | status << 16, cycles
+	SE3_LOG_CMD1 = 3,  ///< L1 command executed; command | status << 16, cycles
+	SE3_LOG_FLASH_COLLECT = 4,  ///< flash sector collected by the garbage collector; sector
+	SE3_LOG_FLASH_ERASE = 5,  ///< flash sector erased; sector
+	SE3_LOG_MEM_DEFRAG = 6,  ///< crypto session memory defragmented; blocks in use
+	SE3_LOG_SD_ERROR = 7,  ///< SD operation failed; first block, blocks | 0x80000000 for writes
+	SE3_LOG_USER = 0x8000  ///< first ID free for ad hoc events
+};
+
+/** Log block fields, one SD block */
+enum {
+	SE3_LOG_MAGIC = 0x4C334553,  ///< "SE3L"
+
+	SE3_LOG_BLOCK_OFF_MAGIC = 0,
+	SE3_LOG_BLOCK_OFF_BOOT = 4,  ///< random at each boot; the previous one plus one if the RNG fails
+	SE3_LOG_BLOCK_OFF_SEQ = 8,  ///< blocks written before this one since boot
+	SE3_LOG_BLOCK_OFF_COUNT = 12,  ///< records in the block
+	SE3_LOG_BLOCK_OFF_DROPPED = 14,  ///< events lost because the ring was full, up to 0xFFFF
+	SE3_LOG_BLOCK_OFF_HZ = 16,  ///< cycle counter frequency
+	SE3_LOG_BLOCK_OFF_RECORDS = 32,
+	SE3_LOG_BLOCK_SIZE = 512,
+
+	SE3_LOG_RECORD_OFF_TIME = 0,  ///< cycle counter
+	SE3_LOG_RECORD_OFF_ID = 4,
+	SE3_LOG_RECORD_OFF_SEQ = 6,  ///< event number since boot, low 16 bits
+	SE3_LOG_RECORD_OFF_ARG0 = 8,
+	SE3_LOG_RECORD_OFF_ARG1 = 12,
+	SE3_LOG_RECORD_SIZE = 16,
+
+	SE3_LOG_BLOCK_RECORDS = (SE3_LOG_BLOCK_SIZE - SE3_LOG_BLOCK_OFF_RECORDS) / SE3_LOG_RECORD_SIZE
+};
+
+#ifdef SE3_LOG_SD
+
+/** \brief Prepare the log; the events recorded before are kept */
+void se3_log_init();
+
+/** \brief Record an event; safe from interrupts, never blocks
+ *
+ *  The event is dropped, and counted in the next block, if the ring is full.
+ */
+void se3_log_event(uint16_t id, uint32_t arg0, uint32_t arg1);
+
+/** \brief Write the recorded events to the SD card, called by the main loop when idle
+ *
+ *  Blocks are written when a batch is full or when the oldest event has waited for a second.
+ */
+void se3_log_idle();
+
+#define SE3_LOG(id, arg0, arg1) se3_log_event((id), (uint32_t)(arg0), (uint32_t)(arg1))
+#else
+#define SE3_LOG(id, arg0, arg1)
+#endif
@@ -0,0 +1,127 @@
+/**
+ *  \file se3_payload.c
+ *  \brief Protection of the L1 payload, shared by the device and the host library
+ */
+
+#include "se3_payload.h"
+#include <string.h>
+
+void se3_payload_cryptoinit(se3_payload_cryptoctx* ctx, const uint8_t* key)
+{
+    uint8_t keys[3 * B5_AES_256];
+
+    // PBKDF2 blocks are independent: the first two keys are the same as before the GCM key was added
+    PBKDF2HmacSha256(key, B5_AES_256, NULL, 0, 1, keys, 3 * B5_AES_256);
+    B5_Aes256_Init(&(ctx->aesenc), keys, B5_AES_256, B5_AES256_CBC_ENC);
+    B5_Aes256_Init(&(ctx->aesdec), keys, B5_AES_256, B5_AES256_CBC_DEC);
+    memcpy(ctx->hmac_key, keys + B5_AES_256, B5_AES_256);
+    B5_GcmAes256_Init(&(ctx->gcmenc), keys + 2 * B5_AES_256, B5_AES_256, B5_GCM_AES256_ENC);
+    B5_GcmAes256_Init(&(ctx->gcmdec), keys + 2 * B5_AES_256, B5_AES_256, B5_GCM_AES256_DEC);
+    memset(keys, 0, 3 * B5_AES_256);
+}
+
+/** \brief AES-256-GCM, or GMAC alone when the payload is not encrypted */
+static void payload_gcm(B5_tGcmAesCtx* gcm, uint8_t* tag, const uint8_t* iv, uint8_t* data, uint16_t nblocks, uint16_t flags)
+{
+    int32_t len = (int32_t)nblocks * SE3_CRYPTOBLOCK_SIZE;
+
+    B5_GcmAes256_SetIV(gcm, iv, SE3_PAYLOAD_GCM_IV_SIZE);
+    if (flags & SE3_CMDFLAG_ENCRYPT) {
+        // in place: the same call encrypts with gcmenc and decrypts with gcmdec
+        B5_GcmAes256_Update(gcm, data, data, len);
+    }
+    else {
+        B5_GcmAes256_UpdateAad(gcm, data, len);
+    }
+    B5_GcmAes256_Finit(gcm, tag);
+}
+
+/** \brief One pass of AES-256-CBC and HMAC-SHA256 over iv and the cipher text */
+static void payload_cbc_hmac(se3_payload_cryptoctx* ctx, B5_tAesCtx* aes, const uint8_t* iv, uint8_t* data, uint16_t nblocks, uint16_t flags)
+{
+    bool encrypt = (flags & SE3_CMDFLAG_ENCRYPT) != 0;
+    bool sign = (flags & SE3_CMDFLAG_SIGN) != 0;
+    bool decrypting = (aes == &(ctx->aesdec));
+    uint16_t n = (SE3_PAYLOAD_CHUNK - B5_AES_IV_SIZE) / B5_AES_BLK_SIZE;
+
+    if (encrypt) {
+        B5_Aes256_SetIV(aes, iv);
+    }
+    if (sign) {
+        B5_HmacSha256_Init(&(ctx->hmac), ctx->hmac_key, B5_AES_256);
+        B5_HmacSha256_Update(&(ctx->hmac), iv, B5_AES_IV_SIZE);
+    }
+
+    // the MAC covers the cipher text: before decryption, after encryption
+    while (nblocks > 0) {
+        if (n > nblocks) {
+            n = nblocks;
+        }
+        if (sign && decrypting) {
+            B5_HmacSha256_Update(&(ctx->hmac), data, n * B5_AES_BLK_SIZE);
+        }
+        if (encrypt) {
+            B5_Aes256_Update(aes, data, data, (int16_t)n);
+        }
+        if (sign && !decrypting) {
+            B5_HmacSha256_Update(&(ctx->hmac), data, n * B5_AES_BLK_SIZE);
+        }
+        data += n * B5_AES_BLK_SIZE;
+        nblocks -= n;
+        n = SE3_PAYLOAD_CHUNK / B5_AES_BLK_SIZE;
+    }
+
+    if (sign) {
+        B5_HmacSha256_Finit(&(ctx->hmac), ctx->auth);
+    }
+}
+
+void se3_payload_seal(se3_payload_cryptoctx* ctx, uint8_t* auth, const uint8_t* iv, uint8_t* data, uint16_t nblocks, uint16_t flags)
+{
+    if (!(flags & (SE3_CMDFLAG_ENCRYPT | SE3_CMDFLAG_SIGN))) {
+        memset(auth, 0, SE3_AUTH_SIZE);
+        return;
+    }
+
+    if (flags & SE3_CMDFLAG_AEAD) {
+        payload_gcm(&(ctx->gcmenc), ctx->auth, iv, data, nblocks, flags);
+    }
+    else {
+        payload_cbc_hmac(ctx, &(ctx->aesenc), iv, data, nblocks, flags);
+    }
+
+    if (flags & SE3_CMDFLAG_SIGN) {
+        memcpy(auth, ctx->auth, SE3_AUTH_SIZE);
+    }
+    else {
+        memset(auth, 0, SE3_AUTH_SIZE);
+    }
+}
+
+bool se3_payload_open(se3_payload_cryptoctx* ctx, const uint8_t* auth, const uint8_t* iv, uint8_t* data, uint16_t nblocks, uint16_t flags)
+{
+    uint8_t diff = 0;
+    size_t i;
+
+    if (!(flags & (SE3_CMDFLAG_ENCRYPT | SE3_CMDFLAG_SIGN))) {
+        return true;
+    }
+
+    if (flags & SE3_CMDFLAG_AEAD) {
+        payload_gcm(&(ctx->gcmdec), ctx->auth, iv, data, nblocks, flags);
+    }
+    else {
+        payload_cbc_hmac(ctx, &(ctx->aesdec), iv, data, nblocks, flags);
+    }
+
+    if (flags & SE3_CMDFLAG_SIGN) {
+        for (i = 0; i < SE3_AUTH_SIZE; i++) {
+            diff |= auth[i] ^ ctx->auth[i];
+        }
+        if (diff != 0) {
+            memset(data, 0, (size_t)nblocks * SE3_CRYPTOBLOCK_SIZE);
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,57 @@
+/**
+ *  \file se3_payload.h
+ *  \brief Protection of the L1 payload, shared by the device and the host library
+ */
+
+#pragma once
+
+#include "se3c1def.h"
+#include "aes256.h"
+#include "sha256.h"
+#include "pbkdf2.h"
+
+/** Bytes encrypted and authenticated per step; the first step is shortened by the IV, so
+ *  that HMAC-SHA256 is always fed whole SHA-256 blocks */
+#define SE3_PAYLOAD_CHUNK (4 * B5_SHA256_BLOCK_SIZE)
+
+/** Bytes of the IV field used as GCM nonce when SE3_CMDFLAG_AEAD is set */
+#define SE3_PAYLOAD_GCM_IV_SIZE (12)
+
+/** \brief Keys and work areas for the protection of the L1 payload */
+typedef struct se3_payload_cryptoctx_ {
+	B5_tAesCtx aesenc;
+    B5_tAesCtx aesdec;
+	B5_tHmacSha256Ctx hmac;
+	uint8_t hmac_key[B5_AES_256];
+    uint8_t auth[B5_SHA256_DIGEST_SIZE];
+    B5_tGcmAesCtx gcmenc;  ///< AES-256-GCM, used with SE3_CMDFLAG_AEAD
+    B5_tGcmAesCtx gcmdec;
+} se3_payload_cryptoctx;
+
+/** \brief Crypto algo initializator
+ *
+ *  Initialise the cryptographics algorithms. The CBC and HMAC keys are the first 64 bytes
+ *  derived from key, the GCM key the following 32.
+ */
+void se3_payload_cryptoinit(se3_payload_cryptoctx* ctx, const uint8_t* key);
+
+/** \brief Encrypt and authenticate a payload in place
+ *
+ *  Without SE3_CMDFLAG_AEAD, AES-256-CBC and HMAC-SHA256 over iv and cipher text, computed
+ *  in a single pass of SE3_PAYLOAD_CHUNK bytes steps. With SE3_CMDFLAG_AEAD, AES-256-GCM
+ *  with the first SE3_PAYLOAD_GCM_IV_SIZE bytes of iv as nonce (GMAC alone if only
+ *  SE3_CMDFLAG_SIGN is set); iv must then be random even when not encrypting.
+ *  \param auth SE3_AUTH_SIZE bytes, receives the tag, or zeros without SE3_CMDFLAG_SIGN
+ *  \param iv SE3_IV_SIZE bytes
+ *  \param data payload
+ *  \param nblocks payload size in SE3_CRYPTOBLOCK_SIZE blocks
+ *  \param flags SE3_CMDFLAG_ENCRYPT, SE3_CMDFLAG_SIGN, SE3_CMDFLAG_AEAD
+ */
+void se3_payload_seal(se3_payload_cryptoctx* ctx, uint8_t* auth, const uint8_t* iv, uint8_t* data, uint16_t nblocks, uint16_t flags);
+
+/** \brief Check and decrypt a payload protected by \ref se3_payload_seal
+ *
+ *  The tag is computed while decrypting; on mismatch the payload is cleared.
+ *  \return false if the tag does not match
+ */
+bool se3_payload_open(se3_payload_cryptoctx* ctx, const uint8_t* auth, const uint8_t* iv, uint8_t* data, uint16_t nblocks, uint16_t flags);
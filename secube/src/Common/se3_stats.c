@@ -0,0 +1,94 @@
+/**
+ *  \file se3_stats.c
+ *  \brief Performance counters of the device, returned by SE3_CMD0_STATS
+ */
+
+#include "se3_stats.h"
+
+void se3_stats_cmd_add(se3_stats_cmd* cmd, uint32_t cycles)
+{
+	(cmd->count)++;
+	cmd->total_cycles += cycles;
+	if (cycles > cmd->max_cycles) {
+		cmd->max_cycles = cycles;
+	}
+}
+
+static void stats_cmd_encode(const se3_stats_cmd* cmd, size_t n, uint8_t* buf)
+{
+	size_t i;
+	for (i = 0; i < n; i++, buf += SE3_STATS_CMD_SIZE) {
+		SE3_SET32(buf, SE3_STATS_CMD_OFF_COUNT, cmd[i].count);
+		SE3_SET32(buf, SE3_STATS_CMD_OFF_MAX_CYCLES, cmd[i].max_cycles);
+		SE3_SET64(buf, SE3_STATS_CMD_OFF_TOTAL_CYCLES, cmd[i].total_cycles);
+	}
+}
+
+static void stats_cmd_decode(se3_stats_cmd* cmd, size_t n, const uint8_t* buf)
+{
+	size_t i;
+	for (i = 0; i < n; i++, buf += SE3_STATS_CMD_SIZE) {
+		SE3_GET32(buf, SE3_STATS_CMD_OFF_COUNT, cmd[i].count);
+		SE3_GET32(buf, SE3_STATS_CMD_OFF_MAX_CYCLES, cmd[i].max_cycles);
+		SE3_GET64(buf, SE3_STATS_CMD_OFF_TOTAL_CYCLES, cmd[i].total_cycles);
+	}
+}
+
+void se3_stats_encode(const se3_stats* stats, uint8_t* buf)
+{
+	uint16_t version = SE3_STATS_VERSION;
+	size_t i;
+
+	memset(buf, 0, SE3_STATS_SIZE);
+	SE3_SET16(buf, SE3_STATS_OFF_VERSION, version);
+	stats_cmd_encode(stats->cmd0, SE3_STATS_CMD0_COUNT, buf + SE3_STATS_OFF_CMD0);
+	stats_cmd_encode(stats->cmd1, SE3_STATS_CMD1_COUNT, buf + SE3_STATS_OFF_CMD1);
+	for (i = 0; i < SE3_STATS_ALGO_COUNT; i++) {
+		SE3_SET64(buf, SE3_STATS_OFF_ALGO_BYTES + 8 * i, stats->algo_bytes[i]);
+	}
+	SE3_SET32(buf, SE3_STATS_OFF_MEM, stats->mem_used);
+	SE3_SET32(buf, SE3_STATS_OFF_MEM + 4, stats->mem_size);
+	SE3_SET32(buf, SE3_STATS_OFF_MEM + 8, stats->mem_peak);
+	SE3_SET32(buf, SE3_STATS_OFF_MEM + 12, stats->mem_defrags);
+	SE3_SET32(buf, SE3_STATS_OFF_FLASH, stats->flash_used);
+	SE3_SET32(buf, SE3_STATS_OFF_FLASH + 4, stats->flash_allocated);
+	SE3_SET32(buf, SE3_STATS_OFF_FLASH + 8, stats->flash_capacity);
+	SE3_SET32(buf, SE3_STATS_OFF_FLASH + 12, stats->flash_swaps);
+	SE3_SET32(buf, SE3_STATS_OFF_FLASH + 16, stats->flash_erases);
+	SE3_SET32(buf, SE3_STATS_OFF_SD, stats->sd_read_blocks);
+	SE3_SET32(buf, SE3_STATS_OFF_SD + 4, stats->sd_write_blocks);
+	SE3_SET32(buf, SE3_STATS_OFF_SD + 8, stats->sd_errors);
+	SE3_SET64(buf, SE3_STATS_OFF_SD + 16, stats->sd_read_cycles);
+	SE3_SET64(buf, SE3_STATS_OFF_SD + 24, stats->sd_write_cycles);
+}
+
+bool se3_stats_decode(se3_stats* stats, const uint8_t* buf)
+{
+	uint16_t version;
+	size_t i;
+
+	SE3_GET16(buf, SE3_STATS_OFF_VERSION, version);
+	if (version != SE3_STATS_VERSION) {
+		return false;
+	}
+	stats_cmd_decode(stats->cmd0, SE3_STATS_CMD0_COUNT, buf + SE3_STATS_OFF_CMD0);
+	stats_cmd_decode(stats->cmd1, SE3_STATS_CMD1_COUNT, buf + SE3_STATS_OFF_CMD1);
+	for (i = 0; i < SE3_STATS_ALGO_COUNT; i++) {
+		SE3_GET64(buf, SE3_STATS_OFF_ALGO_BYTES + 8 * i, stats->algo_bytes[i]);
+	}
+	SE3_GET32(buf, SE3_STATS_OFF_MEM, stats->mem_used);
+	SE3_GET32(buf, SE3_STATS_OFF_MEM + 4, stats->mem_size);
+	SE3_GET32(buf, SE3_STATS_OFF_MEM + 8, stats->mem_peak);
+	SE3_GET32(buf, SE3_STATS_OFF_MEM + 12, stats->mem_defrags);
+	SE3_GET32(buf, SE3_STATS_OFF_FLASH, stats->flash_used);
+	SE3_GET32(buf, SE3_STATS_OFF_FLASH + 4, stats->flash_allocated);
+	SE3_GET32(buf, SE3_STATS_OFF_FLASH + 8, stats->flash_capacity);
+	SE3_GET32(buf, SE3_STATS_OFF_FLASH + 12, stats->flash_swaps);
+	SE3_GET32(buf, SE3_STATS_OFF_FLASH + 16, stats->flash_erases);
+	SE3_GET32(buf, SE3_STATS_OFF_SD, stats->sd_read_blocks);
+	SE3_GET32(buf, SE3_STATS_OFF_SD + 4, stats->sd_write_blocks);
+	SE3_GET32(buf, SE3_STATS_OFF_SD + 8, stats->sd_errors);
+	SE3_GET64(buf, SE3_STATS_OFF_SD + 16, stats->sd_read_cycles);
+	SE3_GET64(buf, SE3_STATS_OFF_SD + 24, stats->sd_write_cycles);
+	return true;
+}
@@ -0,0 +1,109 @@
+/**
+ *  \file se3_stats.h
+ *  \brief Performance counters of the device, returned by SE3_CMD0_STATS
+ *
+ *  \details The layout of the response is shared by the device, which encodes the counters,
+ *  and by the host library, which decodes them. Integers are in the byte order of the
+ *  device like the rest of the protocol; cycles are counted by the DWT cycle counter.
+ */
+
+#pragma once
+
+#include "se3c1def.h"
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Statistics request fields
+ *
+ *  stats : (flags:ui16) => (stats[SE3_STATS_SIZE])
+ */
+enum {
+	SE3_STATS_REQ_OFF_FLAGS = 0,
+	SE3_STATS_REQ_SIZE = 2
+};
+
+/** Statistics request flags */
+enum {
+	SE3_STATS_FLAG_RESET = (1 << 0)  ///< clear the counters after reading them
+};
+
+/** Counters kept for each command and algorithm */
+enum {
+	SE3_STATS_VERSION = 1,
+	SE3_STATS_CMD0_COUNT = 8,  ///< SE3_CMD0_* codes
+	SE3_STATS_CMD1_COUNT = 16,  ///< SE3_CMD1_* codes
+	SE3_STATS_ALGO_COUNT = 16  ///< SE3_ALGO_* codes
+};
+
+/** Statistics response fields */
+enum {
+	SE3_STATS_CMD_OFF_COUNT = 0,
+	SE3_STATS_CMD_OFF_MAX_CYCLES = 4,
+	SE3_STATS_CMD_OFF_TOTAL_CYCLES = 8,
+	SE3_STATS_CMD_SIZE = 16,
+
+	SE3_STATS_OFF_VERSION = 0,
+	SE3_STATS_OFF_CMD0 = 4,
+	SE3_STATS_OFF_CMD1 = SE3_STATS_OFF_CMD0 + SE3_STATS_CMD0_COUNT * SE3_STATS_CMD_SIZE,
+	SE3_STATS_OFF_ALGO_BYTES = SE3_STATS_OFF_CMD1 + SE3_STATS_CMD1_COUNT * SE3_STATS_CMD_SIZE,
+	SE3_STATS_OFF_MEM = SE3_STATS_OFF_ALGO_BYTES + SE3_STATS_ALGO_COUNT * 8,  ///< used, size, peak, defrags
+	SE3_STATS_OFF_FLASH = SE3_STATS_OFF_MEM + 16,  ///< used, allocated, capacity, swaps, erases
+	SE3_STATS_OFF_SD = SE3_STATS_OFF_FLASH + 20,  ///< read blocks, write blocks, errors, padding, read cycles, write cycles
+	SE3_STATS_SIZE = SE3_STATS_OFF_SD + 32
+};
+
+/** \brief Requests of one command */
+typedef struct se3_stats_cmd_ {
+	uint32_t count;  ///< requests executed
+	uint32_t max_cycles;  ///< longest request
+	uint64_t total_cycles;  ///< all the requests
+} se3_stats_cmd;
+
+/** \brief Device counters
+ *
+ *  The command, algorithm, defrag, swap, erase and SD counters start from zero at boot and
+ *  when read with SE3_STATS_FLAG_RESET; the memory and flash usage reflect the current state,
+ *  except for mem_peak which restarts from the current usage.
+ */
+typedef struct se3_stats_ {
+	se3_stats_cmd cmd0[SE3_STATS_CMD0_COUNT];  ///< L0 commands, by SE3_CMD0_* code
+	se3_stats_cmd cmd1[SE3_STATS_CMD1_COUNT];  ///< L1 commands, by SE3_CMD1_* code; decryption of the request included
+	uint64_t algo_bytes[SE3_STATS_ALGO_COUNT];  ///< input bytes of crypto_update, by SE3_ALGO_* code
+	uint32_t mem_used;  ///< bytes of the crypto session memory in use
+	uint32_t mem_size;  ///< bytes of the crypto session memory
+	uint32_t mem_peak;  ///< highest mem_used
+	uint32_t mem_defrags;  ///< times the crypto session memory has been defragmented
+	uint32_t flash_used;  ///< bytes of valid flash nodes
+	uint32_t flash_allocated;  ///< bytes written to the flash sectors of the log, valid or not
+	uint32_t flash_capacity;  ///< bytes available to flash nodes
+	uint32_t flash_swaps;  ///< flash sectors collected by the garbage collector
+	uint32_t flash_erases;  ///< flash sectors erased
+	uint32_t sd_read_blocks;  ///< SD blocks read
+	uint32_t sd_write_blocks;  ///< SD blocks written
+	uint32_t sd_errors;  ///< SD operations failed
+	uint64_t sd_read_cycles;  ///< time spent reading the SD card
+	uint64_t sd_write_cycles;  ///< time spent writing the SD card
+} se3_stats;
+
+/** \brief Account one request of a command */
+void se3_stats_cmd_add(se3_stats_cmd* cmd, uint32_t cycles);
+
+/** \brief Serialize the counters
+ *  \param [in] stats Counters
+ *  \param [out] buf SE3_STATS_SIZE bytes
+ */
+void se3_stats_encode(const se3_stats* stats, uint8_t* buf);
+
+/** \brief Deserialize the counters
+ *  \param [out] stats Counters
+ *  \param [in] buf SE3_STATS_SIZE bytes
+ *  \return false if the version is not supported
+ */
+bool se3_stats_decode(se3_stats* stats, const uint8_t* buf);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,119 @@
+/**
+ *  \file se3_timeline.c
+ *  \brief Timestamped events of the requests, drained from the device by SE3_CMD0_TIMELINE
+ */
+
+#include "se3_timeline.h"
+
+void se3_timeline_init(se3_timeline* t, se3_timeline_event* events, size_t size)
+{
+	t->events = events;
+	t->size = size;
+	t->head = 0;
+	t->count = 0;
+	t->dropped = 0;
+}
+
+void se3_timeline_add(se3_timeline* t, uint64_t time, uint32_t token, uint8_t type, uint16_t arg)
+{
+	se3_timeline_event* ev;
+
+	if (t->size == 0) {
+		return;
+	}
+	ev = t->events + t->head;
+	ev->time = time;
+	ev->token = token;
+	ev->arg = arg;
+	ev->type = type;
+	t->head = (t->head + 1) % t->size;
+	if (t->count < t->size) {
+		(t->count)++;
+	}
+	else {
+		(t->dropped)++;
+	}
+}
+
+size_t se3_timeline_take(se3_timeline* t, se3_timeline_event* events, size_t max, uint32_t* dropped)
+{
+	size_t n = (t->count < max) ? (t->count) : (max);
+	size_t tail, i;
+
+	if (t->size == 0) {
+		return 0;
+	}
+	tail = (t->head + t->size - t->count) % t->size;
+	if (events != NULL) {
+		for (i = 0; i < n; i++) {
+			events[i] = t->events[(tail + i) % t->size];
+		}
+	}
+	t->count -= n;
+	if (dropped != NULL) {
+		*dropped = t->dropped;
+	}
+	t->dropped = 0;
+	return n;
+}
+
+uint16_t se3_timeline_encode(se3_timeline* t, uint16_t max, uint32_t now, uint32_t hz, uint8_t* buf)
+{
+	uint16_t version = SE3_TIMELINE_VERSION;
+	uint16_t count;
+	uint32_t u32tmp;
+	size_t tail = (t->head + t->size - t->count) % t->size;
+	size_t i;
+	uint8_t* p;
+
+	count = (uint16_t)((t->count < max) ? (t->count) : (max));
+	SE3_SET16(buf, SE3_TIMELINE_OFF_VERSION, version);
+	SE3_SET16(buf, SE3_TIMELINE_OFF_COUNT, count);
+	SE3_SET32(buf, SE3_TIMELINE_OFF_DROPPED, t->dropped);
+	SE3_SET32(buf, SE3_TIMELINE_OFF_NOW, now);
+	SE3_SET32(buf, SE3_TIMELINE_OFF_HZ, hz);
+
+	p = buf + SE3_TIMELINE_OFF_EVENTS;
+	for (i = 0; i < count; i++, p += SE3_TIMELINE_EVENT_SIZE) {
+		const se3_timeline_event* ev = t->events + (tail + i) % t->size;
+		u32tmp = (uint32_t)ev->time;
+		SE3_SET32(p, SE3_TIMELINE_EVENT_OFF_TIME, u32tmp);
+		SE3_SET32(p, SE3_TIMELINE_EVENT_OFF_TOKEN, ev->token);
+		SE3_SET16(p, SE3_TIMELINE_EVENT_OFF_ARG, ev->arg);
+		p[SE3_TIMELINE_EVENT_OFF_TYPE] = ev->type;
+		p[SE3_TIMELINE_EVENT_OFF_TYPE + 1] = 0;
+	}
+	t->count -= count;
+	t->dropped = 0;
+	return (uint16_t)(SE3_TIMELINE_OFF_EVENTS + count * SE3_TIMELINE_EVENT_SIZE);
+}
+
+bool se3_timeline_decode(const uint8_t* buf, uint16_t len, uint16_t* count, uint32_t* dropped, uint32_t* now, uint32_t* hz)
+{
+	uint16_t version;
+
+	if (len < SE3_TIMELINE_OFF_EVENTS) {
+		return false;
+	}
+	SE3_GET16(buf, SE3_TIMELINE_OFF_VERSION, version);
+	if (version != SE3_TIMELINE_VERSION) {
+		return false;
+	}
+	SE3_GET16(buf, SE3_TIMELINE_OFF_COUNT, *count);
+	SE3_GET32(buf, SE3_TIMELINE_OFF_DROPPED, *dropped);
+	SE3_GET32(buf, SE3_TIMELINE_OFF_NOW, *now);
+	SE3_GET32(buf, SE3_TIMELINE_OFF_HZ, *hz);
+	return (SE3_TIMELINE_OFF_EVENTS + (uint32_t)(*count) * SE3_TIMELINE_EVENT_SIZE <= len);
+}
+
+void se3_timeline_decode_event(const uint8_t* buf, uint16_t index, se3_timeline_event* ev)
+{
+	const uint8_t* p = buf + SE3_TIMELINE_OFF_EVENTS + (size_t)index * SE3_TIMELINE_EVENT_SIZE;
+	uint32_t u32tmp;
+
+	SE3_GET32(p, SE3_TIMELINE_EVENT_OFF_TIME, u32tmp);
+	ev->time = u32tmp;
+	SE3_GET32(p, SE3_TIMELINE_EVENT_OFF_TOKEN, ev->token);
+	SE3_GET16(p, SE3_TIMELINE_EVENT_OFF_ARG, ev->arg);
+	ev->type = p[SE3_TIMELINE_EVENT_OFF_TYPE];
+}
@@ -0,0 +1,133 @@
+/**
+ *  \file se3_timeline.h
+ *  \brief Timestamped events of the requests, drained from the device by SE3_CMD0_TIMELINE
+ *
+ *  \details The device records the progress of each request (USB blocks received, command
+ *  started, payload decrypted, handler run, payload encrypted, USB blocks sent) in a fixed
+ *  size ring; the host library records its own side of the same requests in a ring owned by
+ *  the application. Events of both sides carry the command token of the request, which
+ *  correlates them. Device times are cycles of the DWT counter, host times are microseconds.
+ */
+
+#pragma once
+
+#include "se3c1def.h"
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Event types; the BEGIN/END pairs of a request nest, the others are instants */
+enum {
+	/* device */
+	SE3_TIMELINE_RECV = 1,  ///< request block received by the USB interrupt, arg is the block index
+	SE3_TIMELINE_READY = 2,  ///< all the blocks of the request received
+	SE3_TIMELINE_EXEC_BEGIN = 3,  ///< request picked up by the main loop, arg is the L0 command
+	SE3_TIMELINE_EXEC_END = 4,  ///< response ready
+	SE3_TIMELINE_DECRYPT_BEGIN = 5,  ///< L1 payload decryption
+	SE3_TIMELINE_DECRYPT_END = 6,
+	SE3_TIMELINE_HANDLER_BEGIN = 7,  ///< L1 command handler, arg is the L1 command
+	SE3_TIMELINE_HANDLER_END = 8,
+	SE3_TIMELINE_ENCRYPT_BEGIN = 9,  ///< L1 payload encryption
+	SE3_TIMELINE_ENCRYPT_END = 10,
+	SE3_TIMELINE_SEND = 11,  ///< response block read by the host, arg is the block index
+	/* host */
+	SE3_TIMELINE_HOST_TX_BEGIN = 16,  ///< request written, arg is the L0 command
+	SE3_TIMELINE_HOST_TX_END = 17,
+	SE3_TIMELINE_HOST_RX_BEGIN = 18,  ///< response polled and read
+	SE3_TIMELINE_HOST_RX_READY = 19,  ///< first poll that found the response, arg is the number of polls
+	SE3_TIMELINE_HOST_RX_END = 20,
+	SE3_TIMELINE_HOST_SEAL_BEGIN = 21,  ///< L1 payload encryption, arg is the L1 command
+	SE3_TIMELINE_HOST_SEAL_END = 22,
+	SE3_TIMELINE_HOST_OPEN_BEGIN = 23,  ///< L1 payload decryption, arg is the L1 command
+	SE3_TIMELINE_HOST_OPEN_END = 24
+};
+
+/** Events kept by the device */
+#define SE3_TIMELINE_DEVICE_EVENTS (256)
+
+/** Timeline request fields
+ *
+ *  timeline : (max:ui16) => (version:ui16, count:ui16, dropped:ui32, now:ui32, hz:ui32, events[count])
+ *
+ *  At most max events are returned, oldest first, and removed from the ring. dropped counts
+ *  the events overwritten since the previous request; now is the cycle counter when the
+ *  response was built and hz its frequency, 0 if unknown.
+ */
+enum {
+	SE3_TIMELINE_REQ_OFF_MAX = 0,
+	SE3_TIMELINE_REQ_SIZE = 2
+};
+
+/** Timeline response fields */
+enum {
+	SE3_TIMELINE_VERSION = 1,
+
+	SE3_TIMELINE_OFF_VERSION = 0,
+	SE3_TIMELINE_OFF_COUNT = 2,
+	SE3_TIMELINE_OFF_DROPPED = 4,
+	SE3_TIMELINE_OFF_NOW = 8,
+	SE3_TIMELINE_OFF_HZ = 12,
+	SE3_TIMELINE_OFF_EVENTS = 16,
+
+	SE3_TIMELINE_EVENT_OFF_TIME = 0,
+	SE3_TIMELINE_EVENT_OFF_TOKEN = 4,
+	SE3_TIMELINE_EVENT_OFF_ARG = 8,
+	SE3_TIMELINE_EVENT_OFF_TYPE = 10,
+	SE3_TIMELINE_EVENT_SIZE = 12,
+
+	SE3_TIMELINE_SIZE_MAX = SE3_TIMELINE_OFF_EVENTS + SE3_TIMELINE_DEVICE_EVENTS * SE3_TIMELINE_EVENT_SIZE
+};
+
+/** \brief One event */
+typedef struct se3_timeline_event_ {
+	uint64_t time;  ///< cycles on the device, microseconds on the host
+	uint32_t token;  ///< command token of the request
+	uint16_t arg;  ///< depends on the type
+	uint8_t type;  ///< SE3_TIMELINE_* code
+} se3_timeline_event;
+
+/** \brief Ring of events
+ *
+ *  When full, a new event overwrites the oldest one. Not synchronized: the device masks
+ *  interrupts around it, the host must not share one ring between threads.
+ */
+typedef struct se3_timeline_ {
+	se3_timeline_event* events;  ///< storage
+	size_t size;  ///< capacity in events
+	size_t head;  ///< index of the next event written
+	size_t count;  ///< events stored
+	uint32_t dropped;  ///< events overwritten since the last \ref se3_timeline_take
+} se3_timeline;
+
+/** \brief Initialize an empty ring on caller provided storage */
+void se3_timeline_init(se3_timeline* t, se3_timeline_event* events, size_t size);
+
+/** \brief Record an event */
+void se3_timeline_add(se3_timeline* t, uint64_t time, uint32_t token, uint8_t type, uint16_t arg);
+
+/** \brief Remove the oldest events
+ *  \param [out] events at most max events, oldest first; may be NULL to discard them
+ *  \param [out] dropped events overwritten since the previous call, then reset; may be NULL
+ *  \return number of events removed
+ */
+size_t se3_timeline_take(se3_timeline* t, se3_timeline_event* events, size_t max, uint32_t* dropped);
+
+/** \brief Serialize a response, removing the encoded events from the ring
+ *  \param [out] buf at least SE3_TIMELINE_OFF_EVENTS + max * SE3_TIMELINE_EVENT_SIZE bytes
+ *  \return response size
+ */
+uint16_t se3_timeline_encode(se3_timeline* t, uint16_t max, uint32_t now, uint32_t hz, uint8_t* buf);
+
+/** \brief Deserialize the header of a response
+ *  \return false if the version is not supported or the events do not fit in len
+ */
+bool se3_timeline_decode(const uint8_t* buf, uint16_t len, uint16_t* count, uint32_t* dropped, uint32_t* now, uint32_t* hz);
+
+/** \brief Deserialize an event of a response; the time is the 32 bit cycle counter */
+void se3_timeline_decode_event(const uint8_t* buf, uint16_t index, se3_timeline_event* ev);
+
+#ifdef __cplusplus
+}
+#endif
@@ -59,13 +59,16 @@ enum {
     SE3_CMD0_FACTORY_INIT = 1,
     SE3_CMD0_ECHO = 2,
 	SE3_CMD0_MIX = 3,
-	SE3_CMD0_BOOT_MODE_RESET = 4
+	SE3_CMD0_BOOT_MODE_RESET = 4,
+	SE3_CMD0_STATS = 5,  ///< performance counters, see se3_stats.h
+	SE3_CMD0_TIMELINE = 6  ///< events of the last requests, see se3_timeline.h
 };
 
 /** command flags */
 enum {
     SE3_CMDFLAG_ENCRYPT = (1 << 15),  ///< encrypt packet
-    SE3_CMDFLAG_SIGN = (1 << 14) ///< sign payload
+    SE3_CMDFLAG_SIGN = (1 << 14), ///< sign payload
+    SE3_CMDFLAG_AEAD = (1 << 13) ///< AES-256-GCM instead of AES-256-CBC + HMAC-SHA256 for the above (negotiated at challenge)
 };
 
 /** Request fields */
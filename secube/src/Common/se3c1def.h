@@ -75,6 +75,7 @@ enum {
     SE3_RESP1_OFFSET_TOKEN = 32,
     SE3_RESP1_OFFSET_LEN = 48,
     SE3_RESP1_OFFSET_STATUS = 50,
+    SE3_RESP1_OFFSET_CYCLES = 52,  ///< device cycles spent on the request before the response is protected
     SE3_RESP1_OFFSET_DATA = 64,
 
     SE3_RESP1_MAX_DATA = (SE3_RESP_MAX_DATA - SE3_RESP1_OFFSET_DATA)
@@ -91,7 +92,9 @@ enum {
 	SE3_CMD1_CRYPTO_INIT = 7,
 	SE3_CMD1_CRYPTO_UPDATE = 8,
     SE3_CMD1_CRYPTO_LIST = 9,
-    SE3_CMD1_CRYPTO_SET_TIME = 10
+    SE3_CMD1_CRYPTO_SET_TIME = 10,
+    SE3_CMD1_KEY_IMPORT_BATCH = 11,
+    SE3_CMD1_KEY_GET_INFO = 12
 
 };
 
@@ -115,9 +118,13 @@ enum {
     SE3_CMD1_CHALLENGE_REQ_OFF_CC2 = 32,
     SE3_CMD1_CHALLENGE_REQ_OFF_ACCESS = 64,
     SE3_CMD1_CHALLENGE_REQ_SIZE = 66,
+    SE3_CMD1_CHALLENGE_REQ_OFF_CMDFLAGS = 66,  ///< optional: command flags the host would like to use
+    SE3_CMD1_CHALLENGE_REQ_SIZE_CMDFLAGS = 68,
     SE3_CMD1_CHALLENGE_RESP_OFF_SC = 0,
     SE3_CMD1_CHALLENGE_RESP_OFF_SRESP = 32,
-    SE3_CMD1_CHALLENGE_RESP_SIZE = 64
+    SE3_CMD1_CHALLENGE_RESP_SIZE = 64,
+    SE3_CMD1_CHALLENGE_RESP_OFF_CMDFLAGS = 64,  ///< only if requested: command flags accepted by the device
+    SE3_CMD1_CHALLENGE_RESP_SIZE_CMDFLAGS = 66
 };
 
 /** login fields */
@@ -167,8 +174,11 @@ enum {
     SE3_CMD1_KEY_LIST_REQ_OFF_SKIP = 0,
     SE3_CMD1_KEY_LIST_REQ_OFF_NMAX = 2,
 	SE3_CMD1_KEY_LIST_REQ_OFF_SALT = 4,
+    SE3_CMD1_KEY_LIST_REQ_OFF_CURSOR = 36,  ///< optional: cursor (ui64) returned by the previous request
+    SE3_CMD1_KEY_LIST_REQ_SIZE_CURSOR = 44,
     SE3_CMD1_KEY_LIST_RESP_OFF_COUNT = 0,
     SE3_CMD1_KEY_LIST_RESP_OFF_KEYINFO = 2,
+    SE3_CMD1_KEY_LIST_RESP_CURSOR_SIZE = 8,  ///< only if requested: cursor (ui64) after the last keyinfo
 
     SE3_CMD1_KEY_LIST_KEYINFO_OFF_ID = 0,
     SE3_CMD1_KEY_LIST_KEYINFO_OFF_VALIDITY = 4,
@@ -178,6 +188,40 @@ enum {
     SE3_CMD1_KEY_LIST_KEYINFO_OFF_NAME = 44
 };
 
+/** key_list cursor values */
+enum {
+    SE3_KEY_LIST_CURSOR_START = 0  ///< start listing from the first key
+};
+
+/** key_get_info fields, the response is a single key_list keyinfo */
+enum {
+    SE3_CMD1_KEY_GET_INFO_REQ_SIZE = 4,
+    SE3_CMD1_KEY_GET_INFO_REQ_OFF_ID = 0,
+    SE3_CMD1_KEY_GET_INFO_REQ_OFF_SALT = 4,  ///< optional: without a salt the fingerprint is not computed and is zero
+    SE3_CMD1_KEY_GET_INFO_REQ_SIZE_SALT = 36,
+    SE3_CMD1_KEY_GET_INFO_RESP_OFF_KEYINFO = 0
+};
+
+/** key_import_batch fields
+ *
+ *  Each key has the same layout as the key node stored in flash
+ */
+enum {
+    SE3_CMD1_KEY_IMPORT_REQ_OFF_OP = 0,
+    SE3_CMD1_KEY_IMPORT_REQ_OFF_COUNT = 2,
+    SE3_CMD1_KEY_IMPORT_REQ_OFF_KEYS = 4,
+    SE3_CMD1_KEY_IMPORT_RESP_OFF_COUNT = 0,
+    SE3_CMD1_KEY_IMPORT_RESP_SIZE = 2,
+
+    SE3_CMD1_KEY_IMPORT_KEY_OFF_ID = 0,
+    SE3_CMD1_KEY_IMPORT_KEY_OFF_VALIDITY = 4,
+    SE3_CMD1_KEY_IMPORT_KEY_OFF_DATA_LEN = 8,
+    SE3_CMD1_KEY_IMPORT_KEY_OFF_NAME_LEN = 10,
+    SE3_CMD1_KEY_IMPORT_KEY_OFF_DATA_AND_NAME = 12,
+
+    SE3_CMD1_KEY_IMPORT_MAX = 128  ///< maximum number of keys per request
+};
+
 /** Invalid handle values */
 enum {
 	SE3_ALGO_INVALID = 0xFFFF,
@@ -196,8 +240,13 @@ enum {
 	SE3_ALGO_HMACSHA256 = 2,  ///< HMAC-SHA256
 	SE3_ALGO_AES_HMACSHA256 = 3,  ///< AES + HMAC-SHA256
 	SE3_ALGO_AES_HMAC = 4,		///< AES 256 + HMAC Auth TODO remove
+	SE3_ALGO_AES_GCM = 5,  ///< AES-GCM
+	SE3_ALGO_CHACHA20_POLY1305 = 6,  ///< ChaCha20-Poly1305
+	SE3_ALGO_AES_CMAC = 7,  ///< AES-CMAC
+	SE3_ALGO_AES_XTS = 8,  ///< AES-XTS sector encryption
+	SE3_ALGO_AES_KW = 9,  ///< AES key wrap, for envelope encryption
 
-    SE3_ALGO_MAX = 8
+    SE3_ALGO_MAX = 10
 };
 /**
  *  @}
@@ -231,7 +280,8 @@ enum {
 	SE3_CRYPTO_FLAG_RESET = (1 << 14),
 	SE3_CRYPTO_FLAG_SETIV = SE3_CRYPTO_FLAG_RESET,
 	SE3_CRYPTO_FLAG_SETNONCE = (1 << 13),
-	SE3_CRYPTO_FLAG_AUTH = (1 << 12)
+	SE3_CRYPTO_FLAG_AUTH = (1 << 12),
+	SE3_CRYPTO_FLAG_GENKEY = (1 << 11)
 };
 
 /** crypto_update maximum buffer sizes */
@@ -240,6 +290,25 @@ enum {
     SE3_CRYPTO_MAX_DATAOUT = (SE3_RESP1_MAX_DATA - SE3_CMD1_CRYPTO_UPDATE_RESP_OFF_DATA)
 };
 
+/** tag appended by the authenticated encryption algorithms (SE3_ALGO_AES_GCM, SE3_ALGO_CHACHA20_POLY1305) */
+enum {
+    SE3_CRYPTO_AEAD_TAG_SIZE = 16
+};
+
+/** sectors processed by SE3_ALGO_AES_XTS; datain1 (the first sector number) takes one 16-byte row */
+enum {
+    SE3_CRYPTO_XTS_SECTOR_SIZE = 512,
+    SE3_CRYPTO_XTS_MAX_SECTORS = ((SE3_CRYPTO_MAX_DATAIN - 16) / SE3_CRYPTO_XTS_SECTOR_SIZE)
+};
+
+/** keys handled by SE3_ALGO_AES_KW; a wrapped key is SE3_CRYPTO_KW_OVERHEAD bytes longer */
+enum {
+    SE3_CRYPTO_KW_OVERHEAD = 8,
+    SE3_CRYPTO_KW_ALIGN = 8,
+    SE3_CRYPTO_KW_MIN_KEY = 16,
+    SE3_CRYPTO_KW_MAX_KEY = 512
+};
+
 /** crypto_set_time fields */
 enum {
     SE3_CMD1_CRYPTO_SET_TIME_REQ_SIZE = 4,
@@ -9,6 +9,15 @@
 
 
 #include "sha256.h"
+#include "sha256_ni.h"
+
+
+static uint8_t B5_Sha256_Backend = B5_SHA256_BACKEND_AUTO;
+
+static const uint32_t B5_Sha256_IV[8] =
+{
+    0x6A09E667, 0xBB67AE85, 0x3C6EF372, 0xA54FF53A, 0x510E527F, 0x9B05688C, 0x1F83D9AB, 0x5BE0CD19
+};
 
 
 void B5_SHA256_GETUINT32(uint32_t *n,const uint8_t *b, int32_t i)
@@ -175,6 +184,128 @@ static void B5_Sha256ProcessBlock(B5_tSha256Ctx *ctx, const uint8_t *data)
 
 
 
+static void B5_Sha256ProcessBlocks(B5_tSha256Ctx *ctx, const uint8_t *data, int32_t nBlk)
+{
+#ifdef B5_SHA256_NI
+    if (((B5_Sha256_Backend == B5_SHA256_BACKEND_AUTO) || (B5_Sha256_Backend == B5_SHA256_BACKEND_NI))
+        && B5_Sha256Ni_Available())
+    {
+        B5_Sha256Ni_ProcessBlocks(ctx->state, data, nBlk);
+        return;
+    }
+#endif
+    while (nBlk-- > 0)
+    {
+        B5_Sha256ProcessBlock(ctx, data);
+        data += B5_SHA256_BLOCK_SIZE;
+    }
+}
+
+
+
+/* Update n <= B5_SHA256_MULTI_LANES independent states with nBlk blocks each */
+static void B5_Sha256ProcessBlocksMulti(uint32_t state[][8], const uint8_t *const data[], int32_t nBlk, int16_t n)
+{
+    B5_tSha256Ctx ctx;
+    int16_t i;
+
+#ifdef B5_SHA256_NI
+    // one SHA extensions stream is faster than a lane of the AVX2 implementation
+    if ((n > 1) && B5_Sha256Avx2_Available() &&
+        ((B5_Sha256_Backend == B5_SHA256_BACKEND_AVX2) ||
+         ((B5_Sha256_Backend == B5_SHA256_BACKEND_AUTO) && !B5_Sha256Ni_Available())))
+    {
+        B5_Sha256Avx2_ProcessBlocks8(state, data, nBlk, n);
+        return;
+    }
+#endif
+    for (i = 0; i < n; i++)
+    {
+        memcpy(ctx.state, state[i], sizeof(ctx.state));
+        B5_Sha256ProcessBlocks(&ctx, data[i], nBlk);
+        memcpy(state[i], ctx.state, sizeof(ctx.state));
+    }
+}
+
+
+
+/*
+ * Append dataLen bytes to each of n <= B5_SHA256_MULTI_LANES messages and write their digests.
+ * The messages share the length already processed (total); the bytes of the last partial block
+ * are in buffer[i]. All the input is consumed before the digests are written.
+ */
+static void B5_Sha256FinitMulti(uint32_t state[][8], const uint8_t *const buffer[], const uint32_t total[2],
+                                const uint8_t *const data[], int32_t dataLen, uint8_t *const rDigest[], int16_t n)
+{
+    uint8_t tail[B5_SHA256_MULTI_LANES][2*B5_SHA256_BLOCK_SIZE];
+    const uint8_t *p[B5_SHA256_MULTI_LANES];
+    uint32_t left, fill, nBlk, high, low, j;
+    int32_t off = 0;
+    int16_t i;
+
+    left = total[0] & 0x3F;
+    fill = B5_SHA256_BLOCK_SIZE - left;
+
+    for (i = 0; i < n; i++)
+        p[i] = tail[i];
+
+    if (left)
+    {
+        if ((uint32_t)dataLen < fill)
+            fill = (uint32_t)dataLen;
+        for (i = 0; i < n; i++)
+        {
+            memcpy(tail[i], buffer[i], left);
+            memcpy(tail[i] + left, data[i], fill);
+        }
+        off = (int32_t)fill;
+        left += fill;
+        if (left == B5_SHA256_BLOCK_SIZE)
+        {
+            B5_Sha256ProcessBlocksMulti(state, p, 1, n);
+            left = 0;
+        }
+    }
+
+    nBlk = (uint32_t)(dataLen - off) / B5_SHA256_BLOCK_SIZE;
+    if (nBlk)
+    {
+        for (i = 0; i < n; i++)
+            p[i] = data[i] + off;
+        B5_Sha256ProcessBlocksMulti(state, p, (int32_t)nBlk, n);
+        off += (int32_t)nBlk * B5_SHA256_BLOCK_SIZE;
+        for (i = 0; i < n; i++)
+            p[i] = tail[i];
+    }
+
+    // the total length is the same for all the messages
+    low = total[0] + (uint32_t)dataLen;
+    high = total[1] + ((low < total[0]) ? 1 : 0);
+    high = (low >> 29) | (high << 3);
+    low = low << 3;
+
+    fill = (uint32_t)(dataLen - off);
+    nBlk = ((left + fill) < 56) ? 1 : 2;
+    for (i = 0; i < n; i++)
+    {
+        memcpy(tail[i] + left, data[i] + off, fill);
+        j = left + fill;
+        tail[i][j++] = 0x80;
+        memset(tail[i] + j, 0, nBlk*B5_SHA256_BLOCK_SIZE - 8 - j);
+        B5_SHA256_PUTUINT32(high, tail[i], nBlk*B5_SHA256_BLOCK_SIZE - 8);
+        B5_SHA256_PUTUINT32(low,  tail[i], nBlk*B5_SHA256_BLOCK_SIZE - 4);
+    }
+    B5_Sha256ProcessBlocksMulti(state, p, (int32_t)nBlk, n);
+
+    for (i = 0; i < n; i++)
+    {
+        for (j = 0; j < 8; j++)
+            B5_SHA256_PUTUINT32(state[i][j], rDigest[i], 4*j);
+    }
+}
+
+
+
 
 
 
@@ -232,17 +363,17 @@ int32_t B5_Sha256_Update (B5_tSha256Ctx *ctx, const uint8_t* data, int32_t dataL
     {
         memcpy( (void *) (ctx->buffer + left),
                 (void *) data, fill );
-        B5_Sha256ProcessBlock( ctx, ctx->buffer );
+        B5_Sha256ProcessBlocks( ctx, ctx->buffer, 1 );
         dataLen -= fill;
         data  += fill;
         left = 0;
     }
 
-    while( dataLen >= 64 )
+    if( dataLen >= 64 )
     {
-        B5_Sha256ProcessBlock( ctx, data );
-        dataLen -= 64;
-        data  += 64;
+        B5_Sha256ProcessBlocks( ctx, data, dataLen / 64 );
+        data  += dataLen & ~0x3F;
+        dataLen &= 0x3F;
     }
 
     if( dataLen )
@@ -311,6 +442,68 @@ int32_t B5_Sha256_Finit (B5_tSha256Ctx *ctx, uint8_t* rDigest)
 
 
 
+int32_t B5_Sha256_Multi (const uint8_t *const data[], int32_t dataLen, uint8_t *const rDigest[], int16_t n)
+{
+    static const uint32_t total[2] = { 0, 0 };
+    uint32_t state[B5_SHA256_MULTI_LANES][8];
+    int16_t i, j, m;
+
+    if((data == NULL) || (rDigest == NULL) || (dataLen < 0) || (n < 0))
+        return B5_SHA256_RES_INVALID_ARGUMENT;
+
+    for (i = 0; i < n; i += m)
+    {
+        m = ((n - i) < B5_SHA256_MULTI_LANES) ? (n - i) : B5_SHA256_MULTI_LANES;
+        for (j = 0; j < m; j++)
+        {
+            if((data[i + j] == NULL) || (rDigest[i + j] == NULL))
+                return B5_SHA256_RES_INVALID_ARGUMENT;
+            memcpy(state[j], B5_Sha256_IV, sizeof(state[j]));
+        }
+        // no partial block yet, the buffers are not read
+        B5_Sha256FinitMulti(state, data + i, total, data + i, dataLen, rDigest + i, m);
+    }
+
+    return B5_SHA256_RES_OK;
+}
+
+
+
+
+
+int32_t B5_Sha256_SetBackend (uint8_t backend)
+{
+    switch (backend)
+    {
+        case B5_SHA256_BACKEND_AUTO:
+        case B5_SHA256_BACKEND_SW:
+            break;
+
+#ifdef B5_SHA256_NI
+        case B5_SHA256_BACKEND_NI:
+            if (!B5_Sha256Ni_Available())
+                return B5_SHA256_RES_INVALID_ARGUMENT;
+            break;
+
+        case B5_SHA256_BACKEND_AVX2:
+            if (!B5_Sha256Avx2_Available())
+                return B5_SHA256_RES_INVALID_ARGUMENT;
+            break;
+#endif
+
+        default:
+            return B5_SHA256_RES_INVALID_ARGUMENT;
+    }
+
+    B5_Sha256_Backend = backend;
+
+    return B5_SHA256_RES_OK;
+}
+
+
+
+
+
 
 
 int32_t B5_HmacSha256_Init (B5_tHmacSha256Ctx *ctx, const uint8_t *Key, int16_t keySize)
@@ -419,3 +612,53 @@ int32_t B5_HmacSha256_Finit (B5_tHmacSha256Ctx *ctx, uint8_t *rDigest)
 }
 
 
+
+
+
+int32_t B5_HmacSha256_Multi (const B5_tHmacSha256Ctx *const ctx[], const uint8_t *const data[], int32_t dataLen, uint8_t *const rDigest[], int16_t n)
+{
+    static const uint32_t opadTotal[2] = { B5_SHA256_BLOCK_SIZE, 0 };
+    uint32_t state[B5_SHA256_MULTI_LANES][8];
+    uint8_t digest[B5_SHA256_MULTI_LANES][B5_SHA256_DIGEST_SIZE];
+    const uint8_t *buffer[B5_SHA256_MULTI_LANES];
+    const uint8_t *pad[B5_SHA256_MULTI_LANES];
+    const uint8_t *inner[B5_SHA256_MULTI_LANES];
+    uint8_t *pDigest[B5_SHA256_MULTI_LANES];
+    int16_t i, j, m;
+
+    if((ctx == NULL) || (n < 0) || ((n > 0) && (ctx[0] == NULL)))
+        return B5_HMAC_SHA256_RES_INVALID_CONTEXT;
+
+    if((data == NULL) || (rDigest == NULL) || (dataLen < 0))
+        return B5_HMAC_SHA256_RES_INVALID_ARGUMENT;
+
+    for (i = 0; i < n; i += m)
+    {
+        m = ((n - i) < B5_SHA256_MULTI_LANES) ? (n - i) : B5_SHA256_MULTI_LANES;
+        for (j = 0; j < m; j++)
+        {
+            // the messages are processed in lockstep, so they must be at the same offset
+            if((ctx[i + j] == NULL) || (ctx[i + j]->shaCtx.total[0] != ctx[0]->shaCtx.total[0]) ||
+               (ctx[i + j]->shaCtx.total[1] != ctx[0]->shaCtx.total[1]))
+                return B5_HMAC_SHA256_RES_INVALID_CONTEXT;
+            if((data[i + j] == NULL) || (rDigest[i + j] == NULL))
+                return B5_HMAC_SHA256_RES_INVALID_ARGUMENT;
+            memcpy(state[j], ctx[i + j]->shaCtx.state, sizeof(state[j]));
+            buffer[j] = ctx[i + j]->shaCtx.buffer;
+            pad[j] = ctx[i + j]->oPad;
+            inner[j] = digest[j];
+            pDigest[j] = digest[j];
+        }
+
+        // First pass
+        B5_Sha256FinitMulti(state, buffer, ctx[0]->shaCtx.total, data + i, dataLen, pDigest, m);
+
+        // Second pass: outer pad, then the result of the first hash
+        for (j = 0; j < m; j++)
+            memcpy(state[j], B5_Sha256_IV, sizeof(state[j]));
+        B5_Sha256ProcessBlocksMulti(state, pad, 1, m);
+        B5_Sha256FinitMulti(state, buffer, opadTotal, inner, B5_SHA256_DIGEST_SIZE, rDigest + i, m);
+    }
+
+    return B5_HMAC_SHA256_RES_OK;
+}
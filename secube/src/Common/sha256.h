@@ -32,6 +32,27 @@ extern "C" {
 ///@}
 /** @} */
 
+
+/** \defgroup shaBackends SHA256 implementations
+ * @{
+ */
+/** \name SHA256 implementations */
+///@{
+#define B5_SHA256_BACKEND_AUTO      0       /**< Fastest implementation supported by the CPU */
+#define B5_SHA256_BACKEND_SW        1       /**< Portable implementation */
+#define B5_SHA256_BACKEND_NI        2       /**< x86 SHA extensions, one message at a time */
+#define B5_SHA256_BACKEND_AVX2      3       /**< x86 AVX2, eight messages at a time in the multi-buffer functions */
+///@}
+/** @} */
+
+
+/** Number of messages hashed together by the multi-buffer functions */
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define B5_SHA256_MULTI_LANES       8
+#else
+#define B5_SHA256_MULTI_LANES       1
+#endif
+
 /** \defgroup shaStr SHA256 data structures
  * @{
  */
@@ -77,6 +98,23 @@ int32_t B5_Sha256_Update (B5_tSha256Ctx *ctx, const uint8_t *data, int32_t dataL
  * @return See \ref shaReturn .
  */
 int32_t B5_Sha256_Finit (B5_tSha256Ctx *ctx, uint8_t *rDigest);
+
+/**
+ * @brief Compute the SHA256 digest of n messages of the same length, processing several of them at once when the CPU allows it.
+ * @param data Pointers to the n messages.
+ * @param dataLen Length of each message.
+ * @param rDigest Pointers to the n output digests; each digest may overlap its own message.
+ * @param n Number of messages.
+ * @return See \ref shaReturn .
+ */
+int32_t B5_Sha256_Multi (const uint8_t *const data[], int32_t dataLen, uint8_t *const rDigest[], int16_t n);
+
+/**
+ * @brief Select the implementation used by the SHA256 and HMAC-SHA256 functions.
+ * @param backend See \ref shaBackends . B5_SHA256_BACKEND_AUTO is the default.
+ * @return See \ref shaReturn ; B5_SHA256_RES_INVALID_ARGUMENT if the implementation is not supported.
+ */
+int32_t B5_Sha256_SetBackend (uint8_t backend);
 ///@}
 /** @} */
 
@@ -142,6 +180,17 @@ int32_t B5_HmacSha256_Update (B5_tHmacSha256Ctx *ctx, const uint8_t *data, int32
  * @return See \ref hmacshaReturn .
  */
 int32_t B5_HmacSha256_Finit (B5_tHmacSha256Ctx *ctx, uint8_t *rDigest);
+
+/**
+ * @brief Compute the HMAC-SHA256 of n messages of the same length, processing several of them at once when the CPU allows it.
+ * @param ctx Pointers to n HMAC-SHA256 contexts which have processed the same number of bytes (e.g. just initialized); they are not modified.
+ * @param data Pointers to the n messages, appended to the data already processed by the respective context.
+ * @param dataLen Length of each message.
+ * @param rDigest Pointers to the n output digests; each digest may overlap its own message.
+ * @param n Number of messages.
+ * @return See \ref hmacshaReturn .
+ */
+int32_t B5_HmacSha256_Multi (const B5_tHmacSha256Ctx *const ctx[], const uint8_t *const data[], int32_t dataLen, uint8_t *const rDigest[], int16_t n);
 ///@}
 /** @} */
 
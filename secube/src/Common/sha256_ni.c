@@ -0,0 +1,299 @@
+/*  LICENSE  */
+
+/**
+ * @file sha256_ni.c
+ * @brief This file includes the SHA extensions and AVX2 implementations of the SHA256 block
+ * function. See \ref sha256_ni.h .
+ *
+ */
+
+#include "sha256_ni.h"
+
+#ifdef B5_SHA256_NI
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define B5_SHANI_TARGET
+#define B5_AVX2_TARGET
+#else
+#include <cpuid.h>
+#define B5_SHANI_TARGET __attribute__((target("sha,sse4.1,ssse3")))
+#define B5_AVX2_TARGET __attribute__((target("avx2")))
+#endif
+#include <immintrin.h>
+
+
+/** Number of messages processed by the AVX2 implementation */
+#define B5_SHA256_AVX2_LANES  8
+
+
+static const uint32_t B5_Sha256Ni_K[64] =
+{
+    0x428A2F98, 0x71374491, 0xB5C0FBCF, 0xE9B5DBA5, 0x3956C25B, 0x59F111F1, 0x923F82A4, 0xAB1C5ED5,
+    0xD807AA98, 0x12835B01, 0x243185BE, 0x550C7DC3, 0x72BE5D74, 0x80DEB1FE, 0x9BDC06A7, 0xC19BF174,
+    0xE49B69C1, 0xEFBE4786, 0x0FC19DC6, 0x240CA1CC, 0x2DE92C6F, 0x4A7484AA, 0x5CB0A9DC, 0x76F988DA,
+    0x983E5152, 0xA831C66D, 0xB00327C8, 0xBF597FC7, 0xC6E00BF3, 0xD5A79147, 0x06CA6351, 0x14292967,
+    0x27B70A85, 0x2E1B2138, 0x4D2C6DFC, 0x53380D13, 0x650A7354, 0x766A0ABB, 0x81C2C92E, 0x92722C85,
+    0xA2BFE8A1, 0xA81A664B, 0xC24B8B70, 0xC76C51A3, 0xD192E819, 0xD6990624, 0xF40E3585, 0x106AA070,
+    0x19A4C116, 0x1E376C08, 0x2748774C, 0x34B0BCB5, 0x391C0CB3, 0x4ED8AA4A, 0x5B9CCA4F, 0x682E6FF3,
+    0x748F82EE, 0x78A5636F, 0x84C87814, 0x8CC70208, 0x90BEFFFA, 0xA4506CEB, 0xBEF9A3F7, 0xC67178F2
+};
+
+
+
+
+static void B5_Sha256_Cpuid (uint32_t leaf, uint32_t *info)
+{
+#if defined(_MSC_VER)
+    __cpuidex((int*)info, (int)leaf, 0);
+#else
+    info[0] = info[1] = info[2] = info[3] = 0;
+    if (__get_cpuid_max(0, NULL) >= leaf)
+        __cpuid_count(leaf, 0, info[0], info[1], info[2], info[3]);
+#endif
+}
+
+
+
+
+int B5_Sha256Ni_Available (void)
+{
+    static int available = -1;
+    uint32_t info1[4], info7[4];
+
+    if (available < 0)
+    {
+        B5_Sha256_Cpuid(1, info1);
+        B5_Sha256_Cpuid(7, info7);
+        // SHA (leaf 7 EBX bit 29), SSE4.1 (leaf 1 ECX bit 19), SSSE3 (leaf 1 ECX bit 9)
+        available = ((info7[1] >> 29) & (info1[2] >> 19) & (info1[2] >> 9) & 1) ? 1 : 0;
+    }
+    return available;
+}
+
+
+
+
+int B5_Sha256Avx2_Available (void)
+{
+    static int available = -1;
+    uint32_t info1[4], info7[4];
+    uint32_t xcr0 = 0;
+
+    if (available < 0)
+    {
+        B5_Sha256_Cpuid(1, info1);
+        B5_Sha256_Cpuid(7, info7);
+        // the YMM registers must also be saved by the operating system (OSXSAVE, XCR0 bits 1-2)
+        if ((info1[2] >> 27) & 1)
+        {
+#if defined(_MSC_VER)
+            xcr0 = (uint32_t)_xgetbv(0);
+#else
+            uint32_t xcr0_high;
+            __asm__ volatile ("xgetbv" : "=a"(xcr0), "=d"(xcr0_high) : "c"(0));
+            (void)xcr0_high;
+#endif
+        }
+        available = (((info7[1] >> 5) & 1) && ((xcr0 & 6) == 6)) ? 1 : 0;
+    }
+    return available;
+}
+
+
+
+
+/*
+ * Four rounds of the SHA extensions. Group g uses the schedule words in M[g % 4]; the words of
+ * the following groups are prepared on the way (SHA256MSG1 three groups in advance, SHA256MSG2
+ * one group in advance).
+ */
+#define B5_SHANI_ROUNDS(g)                                                                  \
+{                                                                                           \
+    msg = _mm_add_epi32(M[(g) & 3], _mm_loadu_si128((const __m128i*)&B5_Sha256Ni_K[4*(g)])); \
+    state1 = _mm_sha256rnds2_epu32(state1, state0, msg);                                    \
+    if (((g) >= 3) && ((g) <= 14))                                                          \
+    {                                                                                       \
+        tmp = _mm_alignr_epi8(M[(g) & 3], M[((g) + 3) & 3], 4);                             \
+        M[((g) + 1) & 3] = _mm_add_epi32(M[((g) + 1) & 3], tmp);                            \
+        M[((g) + 1) & 3] = _mm_sha256msg2_epu32(M[((g) + 1) & 3], M[(g) & 3]);              \
+    }                                                                                       \
+    msg = _mm_shuffle_epi32(msg, 0x0E);                                                     \
+    state0 = _mm_sha256rnds2_epu32(state0, state1, msg);                                    \
+    if (((g) >= 1) && ((g) <= 12))                                                          \
+    {                                                                                       \
+        M[((g) + 3) & 3] = _mm_sha256msg1_epu32(M[((g) + 3) & 3], M[(g) & 3]);              \
+    }                                                                                       \
+}
+
+
+B5_SHANI_TARGET void B5_Sha256Ni_ProcessBlocks (uint32_t state[8], const uint8_t *data, int32_t nBlk)
+{
+    const __m128i mask = _mm_set_epi64x(0x0C0D0E0F08090A0BULL, 0x0405060700010203ULL);
+    __m128i state0, state1, abef, cdgh, msg, tmp;
+    __m128i M[4];
+
+    // DCBA, HGFE -> ABEF, CDGH
+    tmp = _mm_loadu_si128((const __m128i*)&state[0]);
+    state1 = _mm_loadu_si128((const __m128i*)&state[4]);
+    tmp = _mm_shuffle_epi32(tmp, 0xB1);
+    state1 = _mm_shuffle_epi32(state1, 0x1B);
+    state0 = _mm_alignr_epi8(tmp, state1, 8);
+    state1 = _mm_blend_epi16(state1, tmp, 0xF0);
+
+    while (nBlk-- > 0)
+    {
+        abef = state0;
+        cdgh = state1;
+
+        M[0] = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(data +  0)), mask);
+        M[1] = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(data + 16)), mask);
+        M[2] = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(data + 32)), mask);
+        M[3] = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(data + 48)), mask);
+
+        B5_SHANI_ROUNDS( 0);
+        B5_SHANI_ROUNDS( 1);
+        B5_SHANI_ROUNDS( 2);
+        B5_SHANI_ROUNDS( 3);
+        B5_SHANI_ROUNDS( 4);
+        B5_SHANI_ROUNDS( 5);
+        B5_SHANI_ROUNDS( 6);
+        B5_SHANI_ROUNDS( 7);
+        B5_SHANI_ROUNDS( 8);
+        B5_SHANI_ROUNDS( 9);
+        B5_SHANI_ROUNDS(10);
+        B5_SHANI_ROUNDS(11);
+        B5_SHANI_ROUNDS(12);
+        B5_SHANI_ROUNDS(13);
+        B5_SHANI_ROUNDS(14);
+        B5_SHANI_ROUNDS(15);
+
+        state0 = _mm_add_epi32(state0, abef);
+        state1 = _mm_add_epi32(state1, cdgh);
+        data += B5_SHA256_BLOCK_SIZE;
+    }
+
+    // ABEF, CDGH -> DCBA, HGFE
+    tmp = _mm_shuffle_epi32(state0, 0x1B);
+    state1 = _mm_shuffle_epi32(state1, 0xB1);
+    state0 = _mm_blend_epi16(tmp, state1, 0xF0);
+    state1 = _mm_alignr_epi8(state1, tmp, 8);
+    _mm_storeu_si128((__m128i*)&state[0], state0);
+    _mm_storeu_si128((__m128i*)&state[4], state1);
+}
+
+
+
+
+#define B5_AVX2_ROTR(x,n) _mm256_or_si256(_mm256_srli_epi32((x), (n)), _mm256_slli_epi32((x), 32 - (n)))
+
+#define B5_AVX2_S0(x) _mm256_xor_si256(_mm256_xor_si256(B5_AVX2_ROTR(x, 7), B5_AVX2_ROTR(x,18)), _mm256_srli_epi32(x, 3))
+#define B5_AVX2_S1(x) _mm256_xor_si256(_mm256_xor_si256(B5_AVX2_ROTR(x,17), B5_AVX2_ROTR(x,19)), _mm256_srli_epi32(x,10))
+#define B5_AVX2_S2(x) _mm256_xor_si256(_mm256_xor_si256(B5_AVX2_ROTR(x, 2), B5_AVX2_ROTR(x,13)), B5_AVX2_ROTR(x,22))
+#define B5_AVX2_S3(x) _mm256_xor_si256(_mm256_xor_si256(B5_AVX2_ROTR(x, 6), B5_AVX2_ROTR(x,11)), B5_AVX2_ROTR(x,25))
+
+#define B5_AVX2_F0(x,y,z) _mm256_or_si256(_mm256_and_si256(x, y), _mm256_and_si256(z, _mm256_or_si256(x, y)))
+#define B5_AVX2_F1(x,y,z) _mm256_xor_si256(z, _mm256_and_si256(x, _mm256_xor_si256(y, z)))
+
+
+/* Load 32 bytes of each message as big endian words, transposed so that W[i] holds word i of every lane */
+B5_AVX2_TARGET static void B5_Sha256Avx2_Load (__m256i *W, const uint8_t *const *p, size_t off)
+{
+    const __m256i mask = _mm256_set_epi64x(0x0C0D0E0F08090A0BULL, 0x0405060700010203ULL,
+                                           0x0C0D0E0F08090A0BULL, 0x0405060700010203ULL);
+    __m256i r[8], t[8], u[8];
+    int i;
+
+    for (i = 0; i < 8; i++)
+        r[i] = _mm256_shuffle_epi8(_mm256_loadu_si256((const __m256i*)(p[i] + off)), mask);
+
+    for (i = 0; i < 8; i += 2)
+    {
+        t[i]     = _mm256_unpacklo_epi32(r[i], r[i + 1]);
+        t[i + 1] = _mm256_unpackhi_epi32(r[i], r[i + 1]);
+    }
+    for (i = 0; i < 8; i += 4)
+    {
+        u[i]     = _mm256_unpacklo_epi64(t[i],     t[i + 2]);
+        u[i + 1] = _mm256_unpackhi_epi64(t[i],     t[i + 2]);
+        u[i + 2] = _mm256_unpacklo_epi64(t[i + 1], t[i + 3]);
+        u[i + 3] = _mm256_unpackhi_epi64(t[i + 1], t[i + 3]);
+    }
+    for (i = 0; i < 4; i++)
+    {
+        W[i]     = _mm256_permute2x128_si256(u[i], u[i + 4], 0x20);
+        W[i + 4] = _mm256_permute2x128_si256(u[i], u[i + 4], 0x31);
+    }
+}
+
+
+B5_AVX2_TARGET void B5_Sha256Avx2_ProcessBlocks8 (uint32_t state[][8], const uint8_t *const data[], int32_t nBlk, int16_t n)
+{
+    uint32_t dummy[8];
+    uint32_t *st[B5_SHA256_AVX2_LANES];
+    const uint8_t *p[B5_SHA256_AVX2_LANES];
+    uint32_t lane[B5_SHA256_AVX2_LANES];
+    __m256i S[8], V[8], W[16];
+    __m256i T1, T2;
+    int16_t i, j;
+    int t;
+
+    // unused lanes hash the first message again and drop the result
+    for (i = 0; i < B5_SHA256_AVX2_LANES; i++)
+    {
+        st[i] = (i < n) ? state[i] : dummy;
+        p[i] = (i < n) ? data[i] : data[0];
+    }
+    memcpy(dummy, state[0], sizeof(dummy));
+
+    for (j = 0; j < 8; j++)
+    {
+        for (i = 0; i < B5_SHA256_AVX2_LANES; i++)
+            lane[i] = st[i][j];
+        S[j] = _mm256_loadu_si256((const __m256i*)lane);
+    }
+
+    while (nBlk-- > 0)
+    {
+        B5_Sha256Avx2_Load(&W[0], p, 0);
+        B5_Sha256Avx2_Load(&W[8], p, 32);
+
+        for (j = 0; j < 8; j++)
+            V[j] = S[j];
+
+        for (t = 0; t < 64; t++)
+        {
+            if (t >= 16)
+            {
+                W[t & 15] = _mm256_add_epi32(_mm256_add_epi32(B5_AVX2_S1(W[(t - 2) & 15]), W[(t - 7) & 15]),
+                                             _mm256_add_epi32(B5_AVX2_S0(W[(t - 15) & 15]), W[t & 15]));
+            }
+            T1 = _mm256_add_epi32(_mm256_add_epi32(V[7], B5_AVX2_S3(V[4])),
+                                  _mm256_add_epi32(B5_AVX2_F1(V[4], V[5], V[6]),
+                                                   _mm256_add_epi32(_mm256_set1_epi32((int)B5_Sha256Ni_K[t]), W[t & 15])));
+            T2 = _mm256_add_epi32(B5_AVX2_S2(V[0]), B5_AVX2_F0(V[0], V[1], V[2]));
+            V[7] = V[6];
+            V[6] = V[5];
+            V[5] = V[4];
+            V[4] = _mm256_add_epi32(V[3], T1);
+            V[3] = V[2];
+            V[2] = V[1];
+            V[1] = V[0];
+            V[0] = _mm256_add_epi32(T1, T2);
+        }
+
+        for (j = 0; j < 8; j++)
+            S[j] = _mm256_add_epi32(S[j], V[j]);
+        for (i = 0; i < B5_SHA256_AVX2_LANES; i++)
+            p[i] += B5_SHA256_BLOCK_SIZE;
+    }
+
+    for (j = 0; j < 8; j++)
+    {
+        _mm256_storeu_si256((__m256i*)lane, S[j]);
+        for (i = 0; i < n; i++)
+            state[i][j] = lane[i];
+    }
+}
+
+#endif
@@ -0,0 +1,61 @@
+#pragma once
+/*  LICENSE  */
+
+/**
+ * @file sha256_ni.h
+ * @brief SHA256 block functions based on the x86 SHA extensions (single message) and on AVX2
+ * (eight independent messages). They are selected at run time by the functions in sha256.h when
+ * the CPU supports them; the portable implementation is used otherwise.
+ *
+ */
+
+#include "sha256.h"
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define B5_SHA256_NI
+#endif
+
+#ifdef B5_SHA256_NI
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ *
+ * @brief Check if the CPU supports the SHA extensions.
+ * @return 1 if supported, 0 otherwise.
+ */
+int        B5_Sha256Ni_Available (void);
+
+/**
+ *
+ * @brief Check if the CPU and the operating system support the AVX2 instructions.
+ * @return 1 if supported, 0 otherwise.
+ */
+int        B5_Sha256Avx2_Available (void);
+
+/**
+ *
+ * @brief Update the hash state with consecutive 64 byte blocks using the SHA extensions.
+ * @param state Hash state, as stored in B5_tSha256Ctx.
+ * @param data Input blocks.
+ * @param nBlk Number of blocks to process.
+ */
+void       B5_Sha256Ni_ProcessBlocks (uint32_t state[8], const uint8_t *data, int32_t nBlk);
+
+/**
+ *
+ * @brief Update up to eight independent hash states with the same number of blocks using AVX2.
+ * @param state Hash states, one per message.
+ * @param data Input blocks, one pointer per message.
+ * @param nBlk Number of blocks to process for each message.
+ * @param n Number of messages, from 1 to 8.
+ */
+void       B5_Sha256Avx2_ProcessBlocks8 (uint32_t state[][8], const uint8_t *const data[], int32_t nBlk, int16_t n);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
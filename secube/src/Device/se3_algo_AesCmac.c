@@ -0,0 +1,51 @@
+/**
+ *  \file se3_algo_AesCmac.c
+ *  \brief SE3_ALGO_AES_CMAC crypto handlers
+ */
+
+#include "se3_algo_AesCmac.h"
+
+
+uint16_t se3_algo_AesCmac_init(se3_flash_key* key, uint16_t mode, uint8_t* ctx)
+{
+	B5_tCmacAesCtx* cmac = (B5_tCmacAesCtx*)ctx;
+
+	if (B5_CMAC_AES256_RES_OK != B5_CmacAes256_Init(cmac, key->data, key->data_size)) {
+		SE3_TRACE(("[algo_AesCmac.init] B5_CmacAes256_Init failed\n"));
+		return SE3_ERR_PARAMS;
+	}
+
+	return SE3_OK;
+}
+
+
+uint16_t se3_algo_AesCmac_update(
+	uint8_t* ctx, uint16_t flags,
+	uint16_t datain1_len, const uint8_t* datain1,
+	uint16_t datain2_len, const uint8_t* datain2,
+	uint16_t* dataout_len, uint8_t* dataout)
+{
+	B5_tCmacAesCtx* cmac = (B5_tCmacAesCtx*)ctx;
+
+	bool do_update = (datain1_len > 0);
+	bool do_tag = (flags & (SE3_CRYPTO_FLAG_AUTH | SE3_CRYPTO_FLAG_FINIT));
+
+	if (do_update) {
+		if (B5_CMAC_AES256_RES_OK != B5_CmacAes256_Update(cmac, datain1, datain1_len)) {
+			SE3_TRACE(("[algo_AesCmac.update] B5_CmacAes256_Update failed\n"));
+			return SE3_ERR_HW;
+		}
+	}
+
+	if (do_tag) {
+		if (B5_CMAC_AES256_RES_OK != B5_CmacAes256_Finit(cmac, dataout)) {
+			SE3_TRACE(("[algo_AesCmac.update] B5_CmacAes256_Finit failed\n"));
+			return SE3_ERR_HW;
+		}
+		*dataout_len = B5_CMAC_AES_BLK_SIZE;
+		// the key schedule and subkeys are kept, only the chaining state is cleared
+		B5_CmacAes256_Reset(cmac);
+	}
+
+	return SE3_OK;
+}
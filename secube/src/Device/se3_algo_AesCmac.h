@@ -0,0 +1,35 @@
+/**
+ *  \file se3_algo_AesCmac.h
+ *  \brief SE3_ALGO_AES_CMAC crypto handlers
+ */
+
+#pragma once
+#include "se3_security_core.h"
+
+/** \brief SE3_ALGO_AES_CMAC init handler
+ *  
+ *  Mode is not used
+ *  
+ *  Supported key sizes
+ *  128-bit, 192-bit, 256-bit
+ */
+uint16_t se3_algo_AesCmac_init(se3_flash_key* key, uint16_t mode, uint8_t* ctx);
+
+/** \brief SE3_ALGO_AES_CMAC update handler
+ *
+ *  Supported operations
+ *  (default): update the CMAC context with datain1. Any length is accepted; partial blocks
+ *    are buffered in the context until the next request.
+ *  SE3_CRYPTO_FLAG_AUTH: produce the tag in dataout and start a new message with the same key
+ *  SE3_CRYPTO_FLAG_FINIT: produce the tag in dataout and release session
+ *  
+ *  Contribution of each operation to the output size:
+ *    (default): + 0
+ *    SE3_CRYPTO_FLAG_AUTH: + B5_CMAC_AES_BLK_SIZE
+ *    SE3_CRYPTO_FLAG_FINIT: + B5_CMAC_AES_BLK_SIZE
+ */
+uint16_t se3_algo_AesCmac_update(
+	uint8_t* ctx, uint16_t flags,
+	uint16_t datain1_len, const uint8_t* datain1,
+	uint16_t datain2_len, const uint8_t* datain2,
+	uint16_t* dataout_len, uint8_t* dataout);
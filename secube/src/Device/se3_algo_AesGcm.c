@@ -0,0 +1,118 @@
+/**
+ *  \file se3_algo_AesGcm.c
+ *  \brief SE3_ALGO_AES_GCM crypto handlers
+ */
+
+#include "se3_algo_AesGcm.h"
+
+
+uint16_t se3_algo_AesGcm_init(
+	se3_flash_key* key, uint16_t mode, uint8_t* ctx)
+{
+	B5_tGcmAesCtx* gcm = (B5_tGcmAesCtx*)ctx;
+	uint8_t b5_mode;
+
+	switch (mode & (SE3_DIR_ENCRYPT | SE3_DIR_DECRYPT)) {
+	case SE3_DIR_ENCRYPT: b5_mode = B5_GCM_AES256_ENC; break;
+	case SE3_DIR_DECRYPT: b5_mode = B5_GCM_AES256_DEC; break;
+	default: return SE3_ERR_PARAMS;
+	}
+
+	if (B5_GCM_AES256_RES_OK != B5_GcmAes256_Init(gcm, key->data, key->data_size, b5_mode)) {
+		SE3_TRACE(("[algo_AesGcm.init] B5_GcmAes256_Init failed\n"));
+		return SE3_ERR_PARAMS;
+	}
+
+	return SE3_OK;
+}
+
+uint16_t se3_algo_AesGcm_update(
+	uint8_t* ctx, uint16_t flags,
+	uint16_t datain1_len, const uint8_t* datain1,
+	uint16_t datain2_len, const uint8_t* datain2,
+	uint16_t* dataout_len, uint8_t* dataout)
+{
+	B5_tGcmAesCtx* gcm = (B5_tGcmAesCtx*)ctx;
+	bool decrypt = (gcm->mode == B5_GCM_AES256_DEC);
+	bool in_progress = (gcm->state != B5_GCM_STATE_NO_IV);
+	bool do_setnonce = (flags & SE3_CRYPTO_FLAG_SETNONCE);
+	bool do_tag = (flags & SE3_CRYPTO_FLAG_AUTH) || ((flags & SE3_CRYPTO_FLAG_FINIT) && in_progress);
+	uint16_t data_len = datain2_len;
+	size_t outsize;
+	int32_t res;
+
+	*dataout_len = 0;
+
+	if (do_setnonce) {
+		if (datain1_len == 0 || datain2_len > 0 || (flags & SE3_CRYPTO_FLAG_AUTH)) {
+			SE3_TRACE(("[algo_AesGcm.update] invalid nonce request\n"));
+			return SE3_ERR_PARAMS;
+		}
+		if (B5_GCM_AES256_RES_OK != B5_GcmAes256_SetIV(gcm, datain1, datain1_len)) {
+			SE3_TRACE(("[algo_AesGcm.update] B5_GcmAes256_SetIV failed\n"));
+			return SE3_ERR_PARAMS;
+		}
+		return SE3_OK;
+	}
+
+	// check params
+	if (!in_progress && (datain1_len > 0 || datain2_len > 0 || do_tag)) {
+		SE3_TRACE(("[algo_AesGcm.update] nonce not set\n"));
+		return SE3_ERR_STATE;
+	}
+	if (datain1_len > 0 && gcm->state != B5_GCM_STATE_AAD) {
+		SE3_TRACE(("[algo_AesGcm.update] additional data after data\n"));
+		return SE3_ERR_STATE;
+	}
+	if (do_tag && decrypt) {
+		if (datain2_len < B5_GCM_AES_TAG_SIZE) {
+			SE3_TRACE(("[algo_AesGcm.update] tag missing\n"));
+			return SE3_ERR_PARAMS;
+		}
+		data_len -= B5_GCM_AES_TAG_SIZE;
+	}
+	outsize = data_len + ((do_tag && !decrypt) ? B5_GCM_AES_TAG_SIZE : 0);
+	if (outsize > SE3_CRYPTO_MAX_DATAOUT) {
+		SE3_TRACE(("[algo_AesGcm.update] data size exceeds output buffer\n"));
+		return SE3_ERR_PARAMS;
+	}
+
+	if (datain1_len > 0) {
+		if (B5_GCM_AES256_RES_OK != B5_GcmAes256_UpdateAad(gcm, datain1, datain1_len)) {
+			SE3_TRACE(("[algo_AesGcm.update] B5_GcmAes256_UpdateAad failed\n"));
+			return SE3_ERR_HW;
+		}
+	}
+
+	if (data_len > 0) {
+		if (decrypt) {
+			res = B5_GcmAes256_Update(gcm, (uint8_t*)datain2, dataout, data_len);
+		}
+		else {
+			res = B5_GcmAes256_Update(gcm, dataout, (uint8_t*)datain2, data_len);
+		}
+		if (B5_GCM_AES256_RES_OK != res) {
+			SE3_TRACE(("[algo_AesGcm.update] B5_GcmAes256_Update failed\n"));
+			return (res == B5_GCM_AES256_RES_INVALID_ARGUMENT) ? SE3_ERR_PARAMS : SE3_ERR_HW;
+		}
+	}
+
+	if (do_tag) {
+		if (decrypt) {
+			if (B5_GCM_AES256_RES_OK != B5_GcmAes256_Verify(gcm, datain2 + data_len, B5_GCM_AES_TAG_SIZE)) {
+				memset(dataout, 0, data_len);
+				SE3_TRACE(("[algo_AesGcm.update] NOT AUTHENTICATED\n"));
+				return SE3_ERR_AUTH;
+			}
+		}
+		else {
+			if (B5_GCM_AES256_RES_OK != B5_GcmAes256_Finit(gcm, dataout + data_len)) {
+				SE3_TRACE(("[algo_AesGcm.update] B5_GcmAes256_Finit failed\n"));
+				return SE3_ERR_HW;
+			}
+		}
+	}
+
+	*dataout_len = (uint16_t)outsize;
+	return SE3_OK;
+}
@@ -0,0 +1,92 @@
+/**
+ *  \file se3_algo_AesKw.c
+ *  \brief SE3_ALGO_AES_KW crypto handlers
+ */
+
+#include "se3_algo_AesKw.h"
+#include "se3_rand.h"
+
+
+static bool key_size_valid(uint16_t size)
+{
+	return (size >= SE3_CRYPTO_KW_MIN_KEY) && (size <= SE3_CRYPTO_KW_MAX_KEY) && (size % SE3_CRYPTO_KW_ALIGN == 0);
+}
+
+
+uint16_t se3_algo_AesKw_init(se3_flash_key* key, uint16_t mode, uint8_t* ctx)
+{
+	B5_tKwAesCtx* kw = (B5_tKwAesCtx*)ctx;
+
+	if (B5_KW_AES256_RES_OK != B5_KwAes256_Init(kw, key->data, (int16_t)key->data_size)) {
+		SE3_TRACE(("[algo_AesKw.init] B5_KwAes256_Init failed\n"));
+		return SE3_ERR_PARAMS;
+	}
+
+	return SE3_OK;
+}
+
+
+uint16_t se3_algo_AesKw_update(
+	uint8_t* ctx, uint16_t flags,
+	uint16_t datain1_len, const uint8_t* datain1,
+	uint16_t datain2_len, const uint8_t* datain2,
+	uint16_t* dataout_len, uint8_t* dataout)
+{
+	B5_tKwAesCtx* kw = (B5_tKwAesCtx*)ctx;
+	uint16_t size = 0;
+	int32_t res;
+
+	if ((datain1_len > 0) && (datain2_len > 0)) {
+		SE3_TRACE(("[algo_AesKw.update] only one operation per request\n"));
+		return SE3_ERR_PARAMS;
+	}
+
+	if (((flags & SE3_CRYPTO_FLAG_GENKEY) || (datain2_len > 0)) && !se3_request_protected()) {
+		SE3_TRACE(("[algo_AesKw.update] clear keys only in encrypted and signed responses\n"));
+		return SE3_ERR_ACCESS;
+	}
+
+	if (flags & SE3_CRYPTO_FLAG_GENKEY) {
+		if (datain1_len != sizeof(uint16_t)) {
+			return SE3_ERR_PARAMS;
+		}
+		SE3_GET16(datain1, 0, size);
+		if (!key_size_valid(size)) {
+			return SE3_ERR_PARAMS;
+		}
+		if (size != se3_rand(size, dataout)) {
+			SE3_TRACE(("[algo_AesKw.update] se3_rand failed\n"));
+			return SE3_ERR_HW;
+		}
+		if (B5_KW_AES256_RES_OK != B5_KwAes256_Wrap(kw, dataout + size, dataout, size)) {
+			memset(dataout, 0, size);
+			return SE3_ERR_HW;
+		}
+		*dataout_len = 2 * size + SE3_CRYPTO_KW_OVERHEAD;
+	}
+	else if (datain1_len > 0) {
+		if (!key_size_valid(datain1_len)) {
+			return SE3_ERR_PARAMS;
+		}
+		if (B5_KW_AES256_RES_OK != B5_KwAes256_Wrap(kw, dataout, datain1, datain1_len)) {
+			return SE3_ERR_HW;
+		}
+		*dataout_len = datain1_len + SE3_CRYPTO_KW_OVERHEAD;
+	}
+	else if (datain2_len > 0) {
+		if ((datain2_len < SE3_CRYPTO_KW_OVERHEAD) || !key_size_valid(datain2_len - SE3_CRYPTO_KW_OVERHEAD)) {
+			return SE3_ERR_PARAMS;
+		}
+		res = B5_KwAes256_Unwrap(kw, dataout, datain2, datain2_len);
+		if (B5_KW_AES256_RES_AUTH_FAILED == res) {
+			SE3_TRACE(("[algo_AesKw.update] integrity check failed\n"));
+			return SE3_ERR_AUTH;
+		}
+		if (B5_KW_AES256_RES_OK != res) {
+			return SE3_ERR_HW;
+		}
+		*dataout_len = datain2_len - SE3_CRYPTO_KW_OVERHEAD;
+	}
+
+	return SE3_OK;
+}
@@ -0,0 +1,44 @@
+/**
+ *  \file se3_algo_AesKw.h
+ *  \brief SE3_ALGO_AES_KW crypto handlers
+ */
+
+#pragma once
+#include "se3_security_core.h"
+
+/** \brief SE3_ALGO_AES_KW init handler
+ *  
+ *  Mode is not used: the same session wraps, unwraps and generates keys
+ *  
+ *  Supported key sizes
+ *  128-bit, 192-bit, 256-bit
+ */
+uint16_t se3_algo_AesKw_init(se3_flash_key* key, uint16_t mode, uint8_t* ctx);
+
+/** \brief SE3_ALGO_AES_KW update handler
+ *
+ *  Keys are from SE3_CRYPTO_KW_MIN_KEY to SE3_CRYPTO_KW_MAX_KEY bytes, in multiples of
+ *  SE3_CRYPTO_KW_ALIGN. At most one operation is performed by each request.
+ *
+ *  Supported operations
+ *  SE3_CRYPTO_FLAG_GENKEY: datain1 holds the key size (ui16). A random key is generated,
+ *    and dataout holds the key followed by the key wrapped under the session key.
+ *  (default), datain1 only: wrap the key in datain1
+ *  (default), datain2 only: unwrap the key in datain2; SE3_ERR_AUTH if it was not wrapped
+ *    under the session key, or has been modified
+ *  SE3_CRYPTO_FLAG_FINIT: release session after the operation
+ *
+ *  SE3_CRYPTO_FLAG_GENKEY and unwrap return clear keys, so they fail with SE3_ERR_ACCESS
+ *  unless the request was sent with SE3_CMDFLAG_ENCRYPT and SE3_CMDFLAG_SIGN.
+ *  
+ *  Contribution of each operation to the output size:
+ *    SE3_CRYPTO_FLAG_GENKEY: + 2 * size + SE3_CRYPTO_KW_OVERHEAD
+ *    wrap: + datain1_len + SE3_CRYPTO_KW_OVERHEAD
+ *    unwrap: + datain2_len - SE3_CRYPTO_KW_OVERHEAD
+ *    SE3_CRYPTO_FLAG_FINIT: + 0
+ */
+uint16_t se3_algo_AesKw_update(
+	uint8_t* ctx, uint16_t flags,
+	uint16_t datain1_len, const uint8_t* datain1,
+	uint16_t datain2_len, const uint8_t* datain2,
+	uint16_t* dataout_len, uint8_t* dataout);
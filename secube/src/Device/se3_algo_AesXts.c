@@ -0,0 +1,82 @@
+/**
+ *  \file se3_algo_AesXts.c
+ *  \brief SE3_ALGO_AES_XTS crypto handlers
+ */
+
+#include "se3_algo_AesXts.h"
+
+
+uint16_t se3_algo_AesXts_init(se3_flash_key* key, uint16_t mode, uint8_t* ctx)
+{
+	B5_tXtsAesCtx* xts = (B5_tXtsAesCtx*)ctx;
+	uint8_t b5_mode;
+
+	switch (mode & (SE3_DIR_ENCRYPT | SE3_DIR_DECRYPT)) {
+	case SE3_DIR_ENCRYPT: b5_mode = B5_XTS_AES256_ENC; break;
+	case SE3_DIR_DECRYPT: b5_mode = B5_XTS_AES256_DEC; break;
+	default: return SE3_ERR_PARAMS;
+	}
+
+	switch (key->data_size) {
+	case B5_XTS_AES_256:
+	case B5_XTS_AES_128:
+		break;
+	default:
+		// unsupported key size
+		return SE3_ERR_PARAMS;
+	}
+
+	if (B5_XTS_AES256_RES_OK != B5_XtsAes256_Init(xts, key->data, (int16_t)key->data_size, b5_mode)) {
+		SE3_TRACE(("[algo_AesXts.init] B5_XtsAes256_Init failed\n"));
+		return SE3_ERR_PARAMS;
+	}
+
+	return SE3_OK;
+}
+
+
+uint16_t se3_algo_AesXts_update(
+	uint8_t* ctx, uint16_t flags,
+	uint16_t datain1_len, const uint8_t* datain1,
+	uint16_t datain2_len, const uint8_t* datain2,
+	uint16_t* dataout_len, uint8_t* dataout)
+{
+	B5_tXtsAesCtx* xts = (B5_tXtsAesCtx*)ctx;
+	uint64_t sector = 0;
+	uint8_t* data_enc, *data_dec;
+	int32_t res;
+
+	if (datain2_len == 0) {
+		return SE3_OK;
+	}
+
+	// check params
+	if (datain1_len != sizeof(uint64_t)) {
+		SE3_TRACE(("[algo_AesXts.update] sector number missing\n"));
+		return SE3_ERR_PARAMS;
+	}
+	if (datain2_len % SE3_CRYPTO_XTS_SECTOR_SIZE) {
+		SE3_TRACE(("[algo_AesXts.update] data is not a whole number of sectors\n"));
+		return SE3_ERR_PARAMS;
+	}
+
+	SE3_GET64(datain1, 0, sector);
+
+	if (xts->mode == B5_XTS_AES256_ENC) {
+		data_enc = dataout;
+		data_dec = (uint8_t*)datain2;
+	}
+	else {
+		data_enc = (uint8_t*)datain2;
+		data_dec = dataout;
+	}
+
+	res = B5_XtsAes256_Update(xts, data_enc, data_dec, sector, datain2_len / SE3_CRYPTO_XTS_SECTOR_SIZE);
+	if (B5_XTS_AES256_RES_OK != res) {
+		SE3_TRACE(("[algo_AesXts.update] B5_XtsAes256_Update failed\n"));
+		return SE3_ERR_HW;
+	}
+	*dataout_len = datain2_len;
+
+	return SE3_OK;
+}
@@ -0,0 +1,36 @@
+/**
+ *  \file se3_algo_AesXts.h
+ *  \brief SE3_ALGO_AES_XTS crypto handlers
+ */
+
+#pragma once
+#include "se3_security_core.h"
+
+/** \brief SE3_ALGO_AES_XTS init handler
+ *  
+ *  Supported modes
+ *  SE3_DIR_ENCRYPT, SE3_DIR_DECRYPT
+ *  
+ *  Supported key sizes
+ *  256-bit (two AES-128 keys), 512-bit (two AES-256 keys); the data key comes first,
+ *  followed by the tweak key, and the two halves must differ
+ */
+uint16_t se3_algo_AesXts_init(se3_flash_key* key, uint16_t mode, uint8_t* ctx);
+
+/** \brief SE3_ALGO_AES_XTS update handler
+ *
+ *  Supported operations
+ *  (default): encrypt or decrypt the sectors in datain2, a run of SE3_CRYPTO_XTS_SECTOR_SIZE
+ *    byte sectors. datain1 holds the number of the first sector (ui64); the following sectors
+ *    are numbered consecutively, and each sector uses its number as tweak.
+ *  SE3_CRYPTO_FLAG_FINIT: release session after the sectors have been processed
+ *  
+ *  Contribution of each operation to the output size:
+ *    (default): + datain2_len
+ *    SE3_CRYPTO_FLAG_FINIT: + 0
+ */
+uint16_t se3_algo_AesXts_update(
+	uint8_t* ctx, uint16_t flags,
+	uint16_t datain1_len, const uint8_t* datain1,
+	uint16_t datain2_len, const uint8_t* datain2,
+	uint16_t* dataout_len, uint8_t* dataout);
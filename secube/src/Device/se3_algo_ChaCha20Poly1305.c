@@ -0,0 +1,118 @@
+/**
+ *  \file se3_algo_ChaCha20Poly1305.c
+ *  \brief SE3_ALGO_CHACHA20_POLY1305 crypto handlers
+ */
+
+#include "se3_algo_ChaCha20Poly1305.h"
+
+
+uint16_t se3_algo_ChaCha20Poly1305_init(
+	se3_flash_key* key, uint16_t mode, uint8_t* ctx)
+{
+	B5_tChaCha20Poly1305Ctx* cp = (B5_tChaCha20Poly1305Ctx*)ctx;
+	uint8_t b5_mode;
+
+	switch (mode & (SE3_DIR_ENCRYPT | SE3_DIR_DECRYPT)) {
+	case SE3_DIR_ENCRYPT: b5_mode = B5_CHACHA20_POLY1305_ENC; break;
+	case SE3_DIR_DECRYPT: b5_mode = B5_CHACHA20_POLY1305_DEC; break;
+	default: return SE3_ERR_PARAMS;
+	}
+
+	if (B5_CHACHA20_POLY1305_RES_OK != B5_ChaCha20Poly1305_Init(cp, key->data, key->data_size, b5_mode)) {
+		SE3_TRACE(("[algo_ChaCha20Poly1305.init] B5_ChaCha20Poly1305_Init failed\n"));
+		return SE3_ERR_PARAMS;
+	}
+
+	return SE3_OK;
+}
+
+uint16_t se3_algo_ChaCha20Poly1305_update(
+	uint8_t* ctx, uint16_t flags,
+	uint16_t datain1_len, const uint8_t* datain1,
+	uint16_t datain2_len, const uint8_t* datain2,
+	uint16_t* dataout_len, uint8_t* dataout)
+{
+	B5_tChaCha20Poly1305Ctx* cp = (B5_tChaCha20Poly1305Ctx*)ctx;
+	bool decrypt = (cp->mode == B5_CHACHA20_POLY1305_DEC);
+	bool in_progress = (cp->state != B5_CHACHA20_POLY1305_STATE_NO_NONCE);
+	bool do_setnonce = (flags & SE3_CRYPTO_FLAG_SETNONCE);
+	bool do_tag = (flags & SE3_CRYPTO_FLAG_AUTH) || ((flags & SE3_CRYPTO_FLAG_FINIT) && in_progress);
+	uint16_t data_len = datain2_len;
+	size_t outsize;
+	int32_t res;
+
+	*dataout_len = 0;
+
+	if (do_setnonce) {
+		if (datain1_len != B5_CHACHA20_NONCE_SIZE || datain2_len > 0 || (flags & SE3_CRYPTO_FLAG_AUTH)) {
+			SE3_TRACE(("[algo_ChaCha20Poly1305.update] invalid nonce request\n"));
+			return SE3_ERR_PARAMS;
+		}
+		if (B5_CHACHA20_POLY1305_RES_OK != B5_ChaCha20Poly1305_SetNonce(cp, datain1)) {
+			SE3_TRACE(("[algo_ChaCha20Poly1305.update] B5_ChaCha20Poly1305_SetNonce failed\n"));
+			return SE3_ERR_PARAMS;
+		}
+		return SE3_OK;
+	}
+
+	// check params
+	if (!in_progress && (datain1_len > 0 || datain2_len > 0 || do_tag)) {
+		SE3_TRACE(("[algo_ChaCha20Poly1305.update] nonce not set\n"));
+		return SE3_ERR_STATE;
+	}
+	if (datain1_len > 0 && cp->state != B5_CHACHA20_POLY1305_STATE_AAD) {
+		SE3_TRACE(("[algo_ChaCha20Poly1305.update] additional data after data\n"));
+		return SE3_ERR_STATE;
+	}
+	if (do_tag && decrypt) {
+		if (datain2_len < B5_POLY1305_TAG_SIZE) {
+			SE3_TRACE(("[algo_ChaCha20Poly1305.update] tag missing\n"));
+			return SE3_ERR_PARAMS;
+		}
+		data_len -= B5_POLY1305_TAG_SIZE;
+	}
+	outsize = data_len + ((do_tag && !decrypt) ? B5_POLY1305_TAG_SIZE : 0);
+	if (outsize > SE3_CRYPTO_MAX_DATAOUT) {
+		SE3_TRACE(("[algo_ChaCha20Poly1305.update] data size exceeds output buffer\n"));
+		return SE3_ERR_PARAMS;
+	}
+
+	if (datain1_len > 0) {
+		if (B5_CHACHA20_POLY1305_RES_OK != B5_ChaCha20Poly1305_UpdateAad(cp, datain1, datain1_len)) {
+			SE3_TRACE(("[algo_ChaCha20Poly1305.update] B5_ChaCha20Poly1305_UpdateAad failed\n"));
+			return SE3_ERR_HW;
+		}
+	}
+
+	if (data_len > 0) {
+		if (decrypt) {
+			res = B5_ChaCha20Poly1305_Update(cp, (uint8_t*)datain2, dataout, data_len);
+		}
+		else {
+			res = B5_ChaCha20Poly1305_Update(cp, dataout, (uint8_t*)datain2, data_len);
+		}
+		if (B5_CHACHA20_POLY1305_RES_OK != res) {
+			SE3_TRACE(("[algo_ChaCha20Poly1305.update] B5_ChaCha20Poly1305_Update failed\n"));
+			return (res == B5_CHACHA20_POLY1305_RES_INVALID_ARGUMENT) ? SE3_ERR_PARAMS : SE3_ERR_HW;
+		}
+	}
+
+	if (do_tag) {
+		if (decrypt) {
+			if (B5_CHACHA20_POLY1305_RES_OK != B5_ChaCha20Poly1305_Verify(cp, datain2 + data_len)) {
+				memset(dataout, 0, data_len);
+				SE3_TRACE(("[algo_ChaCha20Poly1305.update] NOT AUTHENTICATED\n"));
+				return SE3_ERR_AUTH;
+			}
+		}
+		else {
+			if (B5_CHACHA20_POLY1305_RES_OK != B5_ChaCha20Poly1305_Finit(cp, dataout + data_len)) {
+				SE3_TRACE(("[algo_ChaCha20Poly1305.update] B5_ChaCha20Poly1305_Finit failed\n"));
+				return SE3_ERR_HW;
+			}
+		}
+	}
+
+	*dataout_len = (uint16_t)outsize;
+	return SE3_OK;
+}
@@ -0,0 +1,53 @@
+/**
+ *  \file se3_algo_ChaCha20Poly1305.h
+ *  \brief SE3_ALGO_CHACHA20_POLY1305 crypto handlers
+ */
+
+#pragma once
+#include "se3_security_core.h"
+#include "chacha20poly1305.h"
+
+/** \brief SE3_ALGO_CHACHA20_POLY1305 init handler
+ *  
+ *  Supported modes
+ *  One of {SE3_DIR_ENCRYPT, SE3_DIR_DECRYPT}; the feedback bits are ignored
+ *  
+ *  Supported key sizes
+ *  256-bit
+ */
+uint16_t se3_algo_ChaCha20Poly1305_init(
+    se3_flash_key* key, uint16_t mode, uint8_t* ctx);
+
+/** \brief SE3_ALGO_CHACHA20_POLY1305 update handler
+ *
+ *  Supported operations
+ *  SE3_CRYPTO_FLAG_SETNONCE: start a new message with the B5_CHACHA20_NONCE_SIZE bytes nonce
+ *    in datain1. Required before the first message and after each tag. Cannot be combined
+ *    with data.
+ *  (default): authenticate datain1 as additional data, then encrypt/decrypt datain2. Both
+ *    may be split over several requests of any length, but all the additional data must
+ *    come before the first byte of datain2.
+ *  SE3_CRYPTO_FLAG_AUTH: complete the message. When encrypting, the tag is appended to dataout;
+ *    when decrypting, the last B5_POLY1305_TAG_SIZE bytes of datain2 are the expected tag,
+ *    and SE3_ERR_AUTH is returned, with no output, if it does not match.
+ *  SE3_CRYPTO_FLAG_FINIT: same as SE3_CRYPTO_FLAG_AUTH if a message is in progress, then
+ *    release session
+ *
+ *  Combined operations are executed in the following order:
+ *    (default)
+ *    SE3_CRYPTO_FLAG_AUTH
+ *    SE3_CRYPTO_FLAG_FINIT
+ *  
+ *  Contribution of each operation to the output size:
+ *    (default): + datain2_len
+ *    SE3_CRYPTO_FLAG_AUTH, SE3_CRYPTO_FLAG_FINIT: + B5_POLY1305_TAG_SIZE when encrypting,
+ *      - B5_POLY1305_TAG_SIZE when decrypting
+ *    Others: + 0
+ *
+ *  \remark plaintext returned before the tag is verified has not been authenticated yet
+ */
+uint16_t se3_algo_ChaCha20Poly1305_update(
+    uint8_t* ctx, uint16_t flags,
+    uint16_t datain1_len, const uint8_t* datain1,
+    uint16_t datain2_len, const uint8_t* datain2,
+    uint16_t* dataout_len, uint8_t* dataout);
@@ -0,0 +1,343 @@
+/**
+ *  \file se3_bench.c
+ *  \brief Cycle counts of the crypto primitives, on the device or in the host build
+ */
+
+#include "se3_bench.h"
+
+#ifdef CUBESIM
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+#else
+#include "stm32f4xx.h"
+#include "se3_rand.h"
+#endif
+
+static uint8_t bench_in[SE3_BENCH_AES_SIZE];
+static uint8_t bench_out[SE3_BENCH_AES_SIZE];
+static uint8_t bench_ref[SE3_BENCH_AES_SIZE];
+static uint8_t bench_tag[B5_SHA256_DIGEST_SIZE];
+static uint8_t bench_ref_tag[B5_SHA256_DIGEST_SIZE];
+
+enum {
+	BENCH_AEAD_GCM = 0,
+	BENCH_AEAD_CTR_HMAC = 1,
+	BENCH_AEAD_CBC_HMAC = 2,
+	BENCH_AEAD_CHACHA20_POLY1305 = 3
+};
+
+void se3_cycles_init()
+{
+#ifndef CUBESIM
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	DWT->CYCCNT = 0;
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+#endif
+}
+
+uint32_t se3_cycles()
+{
+#ifdef CUBESIM
+	return (uint32_t)__rdtsc();
+#else
+	return DWT->CYCCNT;
+#endif
+}
+
+static void bench_fill(uint8_t* key, uint8_t* iv)
+{
+	size_t i;
+
+	for (i = 0; i < sizeof(bench_in); i++) {
+		bench_in[i] = (uint8_t)(i * 7 + 1);
+	}
+	for (i = 0; i < B5_AES_256; i++) {
+		key[i] = (uint8_t)(i * 13 + 5);
+	}
+	// counter close to wrapping, to check the carry
+	memset(iv, 0xFF, B5_AES_IV_SIZE);
+	iv[0] = 0;
+}
+
+bool se3_bench_aes(se3_bench_result* results)
+{
+	static const struct {
+		uint8_t mode;
+		const char* name;
+	} modes[SE3_BENCH_AES_COUNT] = {
+		{ B5_AES256_CTR, "AES256 CTR" },
+		{ B5_AES256_ECB_ENC, "AES256 ECB encrypt" },
+		{ B5_AES256_ECB_DEC, "AES256 ECB decrypt" },
+		{ B5_AES256_CBC_DEC, "AES256 CBC decrypt" },
+		{ B5_AES256_CBC_ENC, "AES256 CBC encrypt" }
+	};
+	uint8_t key[B5_AES_256];
+	uint8_t iv[B5_AES_IV_SIZE];
+	B5_tAesCtx aes;
+	bool decrypt, success = true;
+	uint32_t start;
+	size_t i, j;
+
+	bench_fill(key, iv);
+
+	// the host build would otherwise measure AES-NI
+	B5_Aes256_SetBackend(B5_AES256_BACKEND_SW);
+	se3_cycles_init();
+
+	for (i = 0; i < SE3_BENCH_AES_COUNT; i++) {
+		decrypt = (modes[i].mode == B5_AES256_ECB_DEC) || (modes[i].mode == B5_AES256_CBC_DEC);
+
+		B5_Aes256_Init(&aes, key, B5_AES_256, modes[i].mode);
+		if (modes[i].mode != B5_AES256_ECB_ENC && modes[i].mode != B5_AES256_ECB_DEC) {
+			B5_Aes256_SetIV(&aes, iv);
+		}
+		for (j = 0; j < SE3_BENCH_AES_SIZE; j += B5_AES_BLK_SIZE) {
+			if (decrypt) {
+				B5_Aes256_Update(&aes, bench_in + j, bench_ref + j, 1);
+			}
+			else {
+				B5_Aes256_Update(&aes, bench_ref + j, bench_in + j, 1);
+			}
+		}
+
+		B5_Aes256_Init(&aes, key, B5_AES_256, modes[i].mode);
+		if (modes[i].mode != B5_AES256_ECB_ENC && modes[i].mode != B5_AES256_ECB_DEC) {
+			B5_Aes256_SetIV(&aes, iv);
+		}
+		start = se3_cycles();
+		if (decrypt) {
+			B5_Aes256_Update(&aes, bench_in, bench_out, SE3_BENCH_AES_SIZE / B5_AES_BLK_SIZE);
+		}
+		else {
+			B5_Aes256_Update(&aes, bench_out, bench_in, SE3_BENCH_AES_SIZE / B5_AES_BLK_SIZE);
+		}
+		results[i].cycles = se3_cycles() - start;
+		results[i].bytes = SE3_BENCH_AES_SIZE;
+		results[i].name = modes[i].name;
+		results[i].ok = (memcmp(bench_out, bench_ref, SE3_BENCH_AES_SIZE) == 0);
+		success = success && results[i].ok;
+
+		SE3_TRACE(("[se3_bench_aes] %s %u.%02u cycles/byte%s\n", results[i].name,
+			(unsigned)(results[i].cycles / results[i].bytes),
+			(unsigned)((results[i].cycles % results[i].bytes) * 100 / results[i].bytes),
+			results[i].ok ? "" : " MISMATCH"));
+	}
+
+	B5_Aes256_SetBackend(B5_AES256_BACKEND_AUTO);
+	return success;
+}
+
+/** \brief Encrypt and authenticate bench_in, passing chunk bytes per call */
+static void bench_aead_run(uint8_t scheme, const uint8_t* key, const uint8_t* iv,
+	uint8_t* out, uint8_t* tag, size_t chunk)
+{
+	B5_tGcmAesCtx gcm;
+	B5_tChaCha20Poly1305Ctx cp;
+	B5_tAesCtx aes;
+	B5_tHmacSha256Ctx hmac;
+	size_t i;
+
+	if (scheme == BENCH_AEAD_GCM) {
+		B5_GcmAes256_Init(&gcm, key, B5_AES_256, B5_GCM_AES256_ENC);
+		B5_GcmAes256_SetIV(&gcm, iv, B5_GCM_AES_IV_SIZE);
+		for (i = 0; i < SE3_BENCH_AES_SIZE; i += chunk) {
+			B5_GcmAes256_Update(&gcm, out + i, bench_in + i, (int32_t)chunk);
+		}
+		B5_GcmAes256_Finit(&gcm, tag);
+		memset(tag + B5_GCM_AES_TAG_SIZE, 0, B5_SHA256_DIGEST_SIZE - B5_GCM_AES_TAG_SIZE);
+		return;
+	}
+
+	if (scheme == BENCH_AEAD_CHACHA20_POLY1305) {
+		B5_ChaCha20Poly1305_Init(&cp, key, B5_CHACHA20_KEY_SIZE, B5_CHACHA20_POLY1305_ENC);
+		B5_ChaCha20Poly1305_SetNonce(&cp, iv);
+		for (i = 0; i < SE3_BENCH_AES_SIZE; i += chunk) {
+			B5_ChaCha20Poly1305_Update(&cp, out + i, bench_in + i, (int32_t)chunk);
+		}
+		B5_ChaCha20Poly1305_Finit(&cp, tag);
+		memset(tag + B5_POLY1305_TAG_SIZE, 0, B5_SHA256_DIGEST_SIZE - B5_POLY1305_TAG_SIZE);
+		return;
+	}
+
+	B5_Aes256_Init(&aes, key, B5_AES_256, (scheme == BENCH_AEAD_CTR_HMAC) ? B5_AES256_CTR : B5_AES256_CBC_ENC);
+	B5_Aes256_SetIV(&aes, iv);
+	B5_HmacSha256_Init(&hmac, key, B5_AES_256);
+	B5_HmacSha256_Update(&hmac, iv, B5_AES_IV_SIZE);
+	for (i = 0; i < SE3_BENCH_AES_SIZE; i += chunk) {
+		B5_Aes256_Update(&aes, out + i, bench_in + i, (int16_t)(chunk / B5_AES_BLK_SIZE));
+		B5_HmacSha256_Update(&hmac, out + i, (int32_t)chunk);
+	}
+	B5_HmacSha256_Finit(&hmac, tag);
+}
+
+bool se3_bench_aead(se3_bench_result* results)
+{
+	static const char* names[SE3_BENCH_AEAD_COUNT] = {
+		"AES256 GCM encrypt",
+		"AES256 CTR + HMAC-SHA256",
+		"AES256 CBC + HMAC-SHA256",
+		"ChaCha20-Poly1305 encrypt"
+	};
+	uint8_t key[B5_AES_256];
+	uint8_t iv[B5_AES_IV_SIZE];
+	bool success = true;
+	uint32_t start;
+	uint8_t i;
+
+	bench_fill(key, iv);
+
+	// the host build would otherwise measure AES-NI and the SHA extensions
+	B5_Aes256_SetBackend(B5_AES256_BACKEND_SW);
+	B5_Sha256_SetBackend(B5_SHA256_BACKEND_SW);
+	se3_cycles_init();
+
+	for (i = 0; i < SE3_BENCH_AEAD_COUNT; i++) {
+		bench_aead_run(i, key, iv, bench_ref, bench_ref_tag, B5_AES_BLK_SIZE);
+
+		start = se3_cycles();
+		bench_aead_run(i, key, iv, bench_out, bench_tag, SE3_BENCH_AES_SIZE);
+		results[i].cycles = se3_cycles() - start;
+		results[i].bytes = SE3_BENCH_AES_SIZE;
+		results[i].name = names[i];
+		results[i].ok = (memcmp(bench_out, bench_ref, SE3_BENCH_AES_SIZE) == 0) &&
+			(memcmp(bench_tag, bench_ref_tag, sizeof(bench_tag)) == 0);
+		success = success && results[i].ok;
+
+		SE3_TRACE(("[se3_bench_aead] %s %u.%02u cycles/byte%s\n", results[i].name,
+			(unsigned)(results[i].cycles / results[i].bytes),
+			(unsigned)((results[i].cycles % results[i].bytes) * 100 / results[i].bytes),
+			results[i].ok ? "" : " MISMATCH"));
+	}
+
+	B5_Sha256_SetBackend(B5_SHA256_BACKEND_AUTO);
+	B5_Aes256_SetBackend(B5_AES256_BACKEND_AUTO);
+	return success;
+}
+
+/** \brief Authenticate len bytes of bench_in, passing chunk bytes per call */
+static void bench_mac_run(bool cmac, const uint8_t* key, size_t len, uint8_t* tag, size_t chunk)
+{
+	B5_tCmacAesCtx aes_cmac;
+	B5_tHmacSha256Ctx hmac;
+	size_t i;
+
+	if (cmac) {
+		B5_CmacAes256_Init(&aes_cmac, key, B5_AES_256);
+		for (i = 0; i < len; i += chunk) {
+			B5_CmacAes256_Update(&aes_cmac, bench_in + i, (int32_t)chunk);
+		}
+		B5_CmacAes256_Finit(&aes_cmac, tag);
+		memset(tag + B5_CMAC_AES_BLK_SIZE, 0, B5_SHA256_DIGEST_SIZE - B5_CMAC_AES_BLK_SIZE);
+		return;
+	}
+
+	B5_HmacSha256_Init(&hmac, key, B5_AES_256);
+	for (i = 0; i < len; i += chunk) {
+		B5_HmacSha256_Update(&hmac, bench_in + i, (int32_t)chunk);
+	}
+	B5_HmacSha256_Finit(&hmac, tag);
+}
+
+bool se3_bench_mac(se3_bench_result* results)
+{
+	static const struct {
+		bool cmac;
+		uint32_t len;
+		const char* name;
+	} runs[SE3_BENCH_MAC_COUNT] = {
+		{ true, 16, "AES256 CMAC 16 bytes" },
+		{ false, 16, "HMAC-SHA256 16 bytes" },
+		{ true, 64, "AES256 CMAC 64 bytes" },
+		{ false, 64, "HMAC-SHA256 64 bytes" },
+		{ true, 256, "AES256 CMAC 256 bytes" },
+		{ false, 256, "HMAC-SHA256 256 bytes" }
+	};
+	uint8_t key[B5_AES_256];
+	uint8_t iv[B5_AES_IV_SIZE];
+	bool success = true;
+	uint32_t start;
+	uint8_t i;
+
+	bench_fill(key, iv);
+
+	// the host build would otherwise measure AES-NI and the SHA extensions
+	B5_Aes256_SetBackend(B5_AES256_BACKEND_SW);
+	B5_Sha256_SetBackend(B5_SHA256_BACKEND_SW);
+	se3_cycles_init();
+
+	for (i = 0; i < SE3_BENCH_MAC_COUNT; i++) {
+		bench_mac_run(runs[i].cmac, key, runs[i].len, bench_ref_tag, 1);
+
+		start = se3_cycles();
+		bench_mac_run(runs[i].cmac, key, runs[i].len, bench_tag, runs[i].len);
+		results[i].cycles = se3_cycles() - start;
+		results[i].bytes = runs[i].len;
+		results[i].name = runs[i].name;
+		results[i].ok = (memcmp(bench_tag, bench_ref_tag, sizeof(bench_tag)) == 0);
+		success = success && results[i].ok;
+
+		SE3_TRACE(("[se3_bench_mac] %s %u.%02u cycles/byte%s\n", results[i].name,
+			(unsigned)(results[i].cycles / results[i].bytes),
+			(unsigned)((results[i].cycles % results[i].bytes) * 100 / results[i].bytes),
+			results[i].ok ? "" : " MISMATCH"));
+	}
+
+	B5_Sha256_SetBackend(B5_SHA256_BACKEND_AUTO);
+	B5_Aes256_SetBackend(B5_AES256_BACKEND_AUTO);
+	return success;
+}
+
+bool se3_bench_rand(se3_bench_result* results)
+{
+	enum {
+		BENCH_RAND_SIZE = 16
+	};
+	uint8_t entropy[B5_CTR_DRBG_SEED_SIZE];
+	B5_tCtrDrbgCtx drbg;
+	bool success = true;
+	uint32_t start;
+	uint8_t i;
+
+	for (i = 0; i < B5_CTR_DRBG_SEED_SIZE; i++) {
+		entropy[i] = (uint8_t)(i * 11 + 3);
+	}
+	B5_Aes256_SetBackend(B5_AES256_BACKEND_SW);
+	se3_cycles_init();
+
+	B5_CtrDrbg_Instantiate(&drbg, entropy, NULL, 0);
+	start = se3_cycles();
+	results[0].ok = (B5_CTR_DRBG_RES_OK == B5_CtrDrbg_Generate(&drbg, bench_out, BENCH_RAND_SIZE, NULL, 0));
+	results[0].cycles = se3_cycles() - start;
+	results[0].name = "CTR_DRBG 16 bytes";
+	B5_CtrDrbg_Uninstantiate(&drbg);
+
+#ifndef CUBESIM
+	se3_rand_idle();
+	start = se3_cycles();
+	results[1].ok = (BENCH_RAND_SIZE == se3_rand(BENCH_RAND_SIZE, bench_out));
+	results[1].cycles = se3_cycles() - start;
+	results[1].name = "se3_rand 16 bytes";
+
+	// drain the pool, so that the RNG itself is waited for
+	se3_rand_entropy(SE3_RAND_POOL_WORDS * 4, bench_in);
+	start = se3_cycles();
+	results[2].ok = (BENCH_RAND_SIZE == se3_rand_entropy(BENCH_RAND_SIZE, bench_out));
+	results[2].cycles = se3_cycles() - start;
+	results[2].name = "RNG 16 bytes, empty pool";
+	se3_rand_idle();
+#endif
+
+	for (i = 0; i < SE3_BENCH_RAND_COUNT; i++) {
+		results[i].bytes = BENCH_RAND_SIZE;
+		success = success && results[i].ok;
+
+		SE3_TRACE(("[se3_bench_rand] %s %u cycles%s\n", results[i].name,
+			(unsigned)results[i].cycles, results[i].ok ? "" : " FAILED"));
+	}
+
+	B5_Aes256_SetBackend(B5_AES256_BACKEND_AUTO);
+	return success;
+}
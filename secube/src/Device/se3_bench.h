@@ -0,0 +1,82 @@
+/**
+ *  \file se3_bench.h
+ *  \brief Cycle counts of the crypto primitives, on the device or in the host build
+ */
+
+#pragma once
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "aes256.h"
+#include "sha256.h"
+#include "chacha20poly1305.h"
+#include "ctr_drbg.h"
+#include "se3c0def.h"
+
+/** Bytes processed by each measurement */
+#define SE3_BENCH_AES_SIZE (1024)
+/** Measurements made by \ref se3_bench_aes */
+#define SE3_BENCH_AES_COUNT (5)
+/** Measurements made by \ref se3_bench_aead */
+#define SE3_BENCH_AEAD_COUNT (4)
+/** Measurements made by \ref se3_bench_mac */
+#define SE3_BENCH_MAC_COUNT (6)
+/** Measurements made by \ref se3_bench_rand: the DRBG alone in the host build */
+#ifdef CUBESIM
+#define SE3_BENCH_RAND_COUNT (1)
+#else
+#define SE3_BENCH_RAND_COUNT (3)
+#endif
+
+/** \brief Enable the cycle counter read by \ref se3_cycles (DWT on the device) */
+void se3_cycles_init(void);
+
+/** \brief CPU cycle counter: DWT on the device, time stamp counter in the host build */
+uint32_t se3_cycles(void);
+
+/** \brief Result of one measurement */
+typedef struct se3_bench_result_ {
+	const char* name;  ///< mode name
+	uint32_t bytes;  ///< bytes processed
+	uint32_t cycles;  ///< CPU cycles spent
+	bool ok;  ///< the output matches the block by block reference
+} se3_bench_result;
+
+/** \brief Measure the table based AES-256 modes
+ *  
+ *  Each mode processes a buffer in one call, which takes the multi-block paths, and the
+ *  result is compared with the same buffer processed one block per call.
+ *  \param results array of \ref SE3_BENCH_AES_COUNT results
+ *  \return true if every mode matched its reference
+ */
+bool se3_bench_aes(se3_bench_result* results);
+
+/** \brief Measure the authenticated encryption schemes of the algorithm table
+ *  
+ *  AES-256-GCM is compared with AES-256 CTR and CBC followed by HMAC-SHA256, as done by
+ *  SE3_ALGO_AES_HMACSHA256 and SE3_ALGO_AES_HMAC, and with ChaCha20-Poly1305, which needs no
+ *  tables and is constant time on the Cortex-M4. Each measurement covers a whole message,
+ *  key setup and tag included, and is checked against the same message fed 16 bytes at a time.
+ *  \param results array of \ref SE3_BENCH_AEAD_COUNT results
+ *  \return true if every scheme matched its reference
+ */
+bool se3_bench_aead(se3_bench_result* results);
+
+/** \brief Measure AES-256-CMAC against HMAC-SHA256 on short messages
+ *  
+ *  Messages of 16, 64 and 256 bytes are authenticated from key setup to tag, as done by a
+ *  SE3_ALGO_AES_CMAC or SE3_ALGO_HMACSHA256 session. Each tag is checked against the same
+ *  message fed one byte at a time.
+ *  \param results array of \ref SE3_BENCH_MAC_COUNT results
+ *  \return true if every tag matched its reference
+ */
+bool se3_bench_mac(se3_bench_result* results);
+
+/** \brief Measure the latency of a 16 byte random number
+ *  
+ *  The CTR_DRBG generate call is measured alone; on the device, se3_rand served from the
+ *  output buffer and raw RNG output with an empty entropy pool are measured as well.
+ *  \param results array of \ref SE3_BENCH_RAND_COUNT results
+ *  \return true if every source returned the requested bytes
+ */
+bool se3_bench_rand(se3_bench_result* results);
@@ -6,6 +6,7 @@
  */
 
 #include "se3_communication_core.h"
+#include "se3_core.h"
 #ifndef CUBESIM
 #include <se3_sdio.h>
 #endif
@@ -206,8 +207,10 @@ static void handle_req_recv(int index, const uint8_t* blockdata)
         // update bit map
         SE3_BIT_CLEAR(comm.req_bmap, index);
     }
+    se3_timeline_mark(SE3_TIMELINE_RECV, req_hdr.cmdtok[index] - (uint32_t)index, (uint16_t)index);
 
     if (comm.req_bmap == 0) {
+        se3_timeline_mark(SE3_TIMELINE_READY, req_hdr.cmdtok[0], 0);
         comm.req_ready = true;
         comm.req_bmap = SE3_BMAP_MAKE(32);
         comm.block_guess = 0;
@@ -323,6 +326,7 @@ static void handle_resp_send(int index, uint8_t* blockdata)
             // response ready
             if (SE3_BIT_TEST(comm.resp_bmap, index)) {
                 // read valid block
+                se3_timeline_mark(SE3_TIMELINE_SEND, resp_hdr.cmdtok[0], (uint16_t)index);
                 if (index == 0) {
                     // RESP block
 
@@ -10,6 +10,7 @@
 #include "se3_dispatcher_core.h"
 #include "crc16.h"
 #include "se3_rand.h"
+#include "se3_bench.h"
 
 
 
@@ -22,34 +23,59 @@
 uint8_t se3_sessions_buf[SE3_SESSIONS_BUF];
 uint8_t* se3_sessions_index[SE3_SESSIONS_MAX];
 
+se3_stats se3_counters;
+
+static se3_timeline_event se3_events_buf[SE3_TIMELINE_DEVICE_EVENTS];
+static se3_timeline se3_events;
+
 void device_init()
 {
 
+	se3_cycles_init();
+	se3_timeline_init(&se3_events, se3_events_buf, SE3_TIMELINE_DEVICE_EVENTS);
 	se3_communication_core_init();
 	se3_time_init();
 	se3_flash_init();
+	se3_rand_init(serial.data, SE3_SERIAL_SIZE);
     se3_dispatcher_init();
 
-#ifdef SE3_DEBUG_SD
-    se3_create_log_file();
-    se3_write_trace(se3_debug_create_string("\n[se3_core_mio] Device Initalizations complete...\0"), debug_address++);
+#ifdef SE3_BENCH
+    {
+        se3_bench_result bench[SE3_BENCH_AES_COUNT];
+        se3_bench_result bench_aead[SE3_BENCH_AEAD_COUNT];
+        se3_bench_result bench_mac[SE3_BENCH_MAC_COUNT];
+        se3_bench_result bench_rand[SE3_BENCH_RAND_COUNT];
+        se3_bench_aes(bench);
+        se3_bench_aead(bench_aead);
+        se3_bench_mac(bench_mac);
+        se3_bench_rand(bench_rand);
+    }
+#endif
+
+#ifdef SE3_LOG_SD
+    se3_log_init();
 #endif
 
 }
 
 void device_loop()
 {
-	/*se3_write_trace(se3_debug_create_string("\nEntering in device_loop...\0"), debug_address++);*/
-
 	for (;;) {
 
 		if (comm.req_ready) {
-			/*se3_write_trace(se3_debug_create_string("\nreq_ready == true, executing cmd...\0"), debug_address++);*/
 			comm.resp_ready = false;
             se3_cmd_execute();
 			comm.req_ready = false;
 			comm.resp_ready = true;
 		}
+		else {
+			// use idle time to prepare the spare flash sector and the random numbers
+			se3_flash_compact_step();
+			se3_rand_idle();
+#ifdef SE3_LOG_SD
+			se3_log_idle();
+#endif
+		}
 	}
 
 }
@@ -143,7 +169,9 @@ void se3_cmd_execute()
     size_t i;
     se3_cmd_func handler = NULL;
 	uint32_t cmdtok0;
+	uint32_t start;
 
+	se3_timeline_mark(SE3_TIMELINE_EXEC_BEGIN, req_hdr.cmdtok[0], req_hdr.cmd);
     req_blocks = req_hdr.len / SE3_COMM_BLOCK;
     if (req_hdr.len % SE3_COMM_BLOCK != 0) {
         req_blocks++;
@@ -175,12 +203,24 @@ void se3_cmd_execute()
 		case SE3_CMD0_BOOT_MODE_RESET:
 			handler = bootmode_reset;
 			break;
+		case SE3_CMD0_STATS:
+			handler = stats;
+			break;
+		case SE3_CMD0_TIMELINE:
+			handler = timeline;
+			break;
 		default:
 			handler = invalid_cmd_handler;
 		}
 	}
 
+	start = se3_cycles();
     resp_blocks = se3_exec(handler);
+	start = se3_cycles() - start;
+	if (req_hdr.cmd < SE3_STATS_CMD0_COUNT) {
+		se3_stats_cmd_add(&(se3_counters.cmd0[req_hdr.cmd]), start);
+	}
+	SE3_LOG(SE3_LOG_CMD0, req_hdr.cmd | ((uint32_t)resp_hdr.status << 16), start);
 
     // set cmdtok
 	cmdtok0 = req_hdr.cmdtok[0];
@@ -193,6 +233,19 @@ void se3_cmd_execute()
 update_comm:
     // update comm response bit map
     comm.resp_bmap = SE3_BMAP_MAKE(resp_blocks);
+	se3_timeline_mark(SE3_TIMELINE_EXEC_END, req_hdr.cmdtok[0], req_hdr.cmd);
+}
+
+void se3_timeline_mark(uint8_t type, uint32_t token, uint16_t arg)
+{
+#ifndef CUBESIM
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+#endif
+	se3_timeline_add(&se3_events, se3_cycles(), token, type, arg);
+#ifndef CUBESIM
+	__set_PRIMASK(primask);
+#endif
 }
 
 uint16_t echo(uint16_t req_size, const uint8_t* req, uint16_t* resp_size, uint8_t* resp)
@@ -235,3 +288,73 @@ uint16_t bootmode_reset(uint16_t req_size, const uint8_t* req, uint16_t* resp_si
 
 	return SE3_OK;
 }
+
+uint16_t stats(uint16_t req_size, const uint8_t* req, uint16_t* resp_size, uint8_t* resp)
+{
+    struct {
+        uint16_t flags;
+    } req_params;
+    se3_mem* mem = &(se3_security_info.sessions);
+
+    if (req_size < SE3_STATS_REQ_SIZE) {
+        SE3_TRACE(("[stats] req size mismatch\n"));
+        return SE3_ERR_PARAMS;
+    }
+    SE3_GET16(req, SE3_STATS_REQ_OFF_FLAGS, req_params.flags);
+
+    // usage is read now, the rest has been counted by the modules
+    se3_counters.mem_used = (uint32_t)(mem->used * SE3_MEM_BLOCK);
+    se3_counters.mem_size = (uint32_t)(mem->dat_size * SE3_MEM_BLOCK);
+    se3_counters.mem_peak = (uint32_t)(mem->peak * SE3_MEM_BLOCK);
+    se3_counters.mem_defrags = mem->defrags;
+    se3_counters.flash_used = (uint32_t)(flash.used * SE3_FLASH_BLOCK_SIZE);
+    se3_counters.flash_allocated = (uint32_t)se3_flash_allocated();
+    se3_counters.flash_capacity = (uint32_t)se3_flash_capacity();
+    se3_counters.flash_swaps = flash.swaps;
+    se3_counters.flash_erases = flash.erases;
+
+    se3_stats_encode(&se3_counters, resp);
+    *resp_size = SE3_STATS_SIZE;
+
+    if (req_params.flags & SE3_STATS_FLAG_RESET) {
+        memset(&se3_counters, 0, sizeof(se3_stats));
+        mem->peak = mem->used;
+        mem->defrags = 0;
+        flash.swaps = 0;
+        flash.erases = 0;
+    }
+    return SE3_OK;
+}
+
+uint16_t timeline(uint16_t req_size, const uint8_t* req, uint16_t* resp_size, uint8_t* resp)
+{
+    struct {
+        uint16_t max;
+    } req_params;
+    uint32_t hz;
+#ifndef CUBESIM
+    uint32_t primask;
+#endif
+
+    if (req_size < SE3_TIMELINE_REQ_SIZE) {
+        SE3_TRACE(("[timeline] req size mismatch\n"));
+        return SE3_ERR_PARAMS;
+    }
+    SE3_GET16(req, SE3_TIMELINE_REQ_OFF_MAX, req_params.max);
+    if (req_params.max > SE3_TIMELINE_DEVICE_EVENTS) {
+        req_params.max = SE3_TIMELINE_DEVICE_EVENTS;
+    }
+
+#ifdef CUBESIM
+    hz = 0;
+#else
+    hz = SystemCoreClock;
+    primask = __get_PRIMASK();
+    __disable_irq();
+#endif
+    *resp_size = se3_timeline_encode(&se3_events, req_params.max, se3_cycles(), hz, resp);
+#ifndef CUBESIM
+    __set_PRIMASK(primask);
+#endif
+    return SE3_OK;
+}
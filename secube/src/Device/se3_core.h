@@ -8,6 +8,8 @@
 
 
 #include <se3c0def.h>
+#include "se3_stats.h"
+#include "se3_timeline.h"
 
 
 #if defined(_MSC_VER)
@@ -20,6 +22,23 @@
 
 
 
+/** \brief Counters returned by the STATS command
+ *
+ *  Updated by the modules as they work; the memory and flash usage are read when the
+ *  command is executed.
+ */
+extern se3_stats se3_counters;
+
+/** \brief Record an event of the current request in the ring returned by the TIMELINE command
+ *
+ *  Called both from the USB interrupt and from the main loop; interrupts are masked while
+ *  the ring is updated.
+ *  \param type SE3_TIMELINE_* code
+ *  \param token command token of the request
+ *  \param arg depends on the type
+ */
+void se3_timeline_mark(uint8_t type, uint32_t token, uint16_t arg);
+
 /** \brief Initialise the device modules
  *
  * Initialise the main cores and data structures
@@ -59,3 +78,15 @@ uint16_t factory_init(uint16_t req_size, const uint8_t* req, uint16_t* resp_size
  *  Reset USEcube to boot mode
  */
 uint16_t bootmode_reset(uint16_t req_size, const uint8_t* req, uint16_t* resp_size, uint8_t* resp);
+
+/** \brief STATS command handler
+ *
+ *  Send the performance counters, see \ref se3_stats.h; no login is required
+ */
+uint16_t stats(uint16_t req_size, const uint8_t* req, uint16_t* resp_size, uint8_t* resp);
+
+/** \brief TIMELINE command handler
+ *
+ *  Send and remove the oldest events of the ring, see \ref se3_timeline.h; no login is required
+ */
+uint16_t timeline(uint16_t req_size, const uint8_t* req, uint16_t* resp_size, uint8_t* resp);
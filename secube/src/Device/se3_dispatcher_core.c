@@ -6,6 +6,8 @@
  */
 
 #include "se3_dispatcher_core.h"
+#include "se3_core.h"
+#include "se3_bench.h"
 
 uint8_t algo_implementation;
 uint8_t crypto_algo;
@@ -136,6 +138,7 @@ uint16_t challenge(uint16_t req_size, const uint8_t* req, uint16_t* resp_size, u
 {
     static B5_tSha256Ctx sha;
     uint8_t pin[SE3_PIN_SIZE];
+    uint16_t cmd_flags;
     struct {
         const uint8_t* cc1;
         const uint16_t access;
@@ -146,7 +149,8 @@ uint16_t challenge(uint16_t req_size, const uint8_t* req, uint16_t* resp_size, u
         uint8_t* sresp;
     } resp_params;
 
-    if (req_size != SE3_CMD1_CHALLENGE_REQ_SIZE) {
+    // the host may append the optional command flags it would like to use
+    if (req_size != SE3_CMD1_CHALLENGE_REQ_SIZE && req_size != SE3_CMD1_CHALLENGE_REQ_SIZE_CMDFLAGS) {
         SE3_TRACE(("[challenge] req size mismatch\n"));
         return SE3_ERR_PARAMS;
     }
@@ -194,7 +198,16 @@ uint16_t challenge(uint16_t req_size, const uint8_t* req, uint16_t* resp_size, u
 
 	login_struct.challenge_access = req_params.access;
 
-    *resp_size = SE3_CMD1_CHALLENGE_RESP_SIZE;
+    if (req_size == SE3_CMD1_CHALLENGE_REQ_SIZE_CMDFLAGS) {
+        SE3_GET16(req, SE3_CMD1_CHALLENGE_REQ_OFF_CMDFLAGS, cmd_flags);
+        login_struct.cmd_flags = cmd_flags & SE3_CMDFLAG_AEAD;
+        SE3_SET16(resp, SE3_CMD1_CHALLENGE_RESP_OFF_CMDFLAGS, login_struct.cmd_flags);
+        *resp_size = SE3_CMD1_CHALLENGE_RESP_SIZE_CMDFLAGS;
+    }
+    else {
+        login_struct.cmd_flags = 0;
+        *resp_size = SE3_CMD1_CHALLENGE_RESP_SIZE;
+    }
 	return SE3_OK;
 }
 
@@ -366,20 +379,214 @@ uint16_t key_edit(uint16_t req_size, const uint8_t* req, uint16_t* resp_size, ui
 	return SE3_OK;
 }
 
+static uint16_t key_import_entry_size(const uint8_t* p)
+{
+    uint16_t data_len, name_len;
+    SE3_GET16(p, SE3_CMD1_KEY_IMPORT_KEY_OFF_DATA_LEN, data_len);
+    SE3_GET16(p, SE3_CMD1_KEY_IMPORT_KEY_OFF_NAME_LEN, name_len);
+    return (uint16_t)(SE3_CMD1_KEY_IMPORT_KEY_OFF_DATA_AND_NAME + data_len + name_len);
+}
+
+/** \brief insert or update many keys at once
+ *
+ *  key_import_batch : (op:ui16, count:ui16, key0, key1, ...) => (count:ui16)
+ *      key: (id:ui32, validity:ui32, data-len:ui16, name-len:ui16, data[data-len], name[name-len])
+ *  The whole batch is validated before touching the flash, including the space needed. Then, as
+ *  in key_edit, the replaced keys are deleted and each key is copied from the request with one
+ *  flash program: a flash failure or a reset in between leaves the replaced keys deleted.
+ */
+uint16_t key_import_batch(uint16_t req_size, const uint8_t* req, uint16_t* resp_size, uint8_t* resp)
+{
+    enum {
+        KEY_NEW = 0,
+        KEY_EQUAL = 1,
+        KEY_REPLACE = 2
+    };
+    struct {
+        uint16_t op;
+        uint16_t count;
+        const uint8_t* keys;
+    } req_params;
+    struct {
+        uint16_t count;
+    } resp_params;
+
+    uint8_t state[SE3_CMD1_KEY_IMPORT_MAX];
+    uint16_t size[SE3_CMD1_KEY_IMPORT_MAX];
+    se3_flash_key key;
+    se3_flash_it it = { .addr = NULL };
+    const uint8_t* p;
+    const uint8_t* q;
+    size_t i, j, off;
+    size_t needed = 0, freed = 0, nblocks;
+    uint32_t id, id2;
+    uint16_t data_len, name_len;
+    bool replace = false;
+
+    if (req_size < SE3_CMD1_KEY_IMPORT_REQ_OFF_KEYS) {
+        SE3_TRACE(("[key_import_batch] req size mismatch\n"));
+        return SE3_ERR_PARAMS;
+    }
+
+    if (!login_struct.y) {
+        SE3_TRACE(("[key_import_batch] not logged in\n"));
+        return SE3_ERR_ACCESS;
+    }
+
+    SE3_GET16(req, SE3_CMD1_KEY_IMPORT_REQ_OFF_OP, req_params.op);
+    SE3_GET16(req, SE3_CMD1_KEY_IMPORT_REQ_OFF_COUNT, req_params.count);
+    req_params.keys = req + SE3_CMD1_KEY_IMPORT_REQ_OFF_KEYS;
+
+    // check params
+    if (req_params.op != SE3_KEY_OP_INSERT && req_params.op != SE3_KEY_OP_UPSERT) {
+        SE3_TRACE(("[key_import_batch] invalid op\n"));
+        return SE3_ERR_PARAMS;
+    }
+    if (req_params.count > SE3_CMD1_KEY_IMPORT_MAX) {
+        SE3_TRACE(("[key_import_batch] too many keys\n"));
+        return SE3_ERR_PARAMS;
+    }
+    off = SE3_CMD1_KEY_IMPORT_REQ_OFF_KEYS;
+    for (i = 0; i < req_params.count; i++) {
+        if (off + SE3_CMD1_KEY_IMPORT_KEY_OFF_DATA_AND_NAME > req_size) {
+            return SE3_ERR_PARAMS;
+        }
+        SE3_GET16(req + off, SE3_CMD1_KEY_IMPORT_KEY_OFF_DATA_LEN, data_len);
+        SE3_GET16(req + off, SE3_CMD1_KEY_IMPORT_KEY_OFF_NAME_LEN, name_len);
+        if ((data_len > SE3_KEY_DATA_MAX) || (name_len > SE3_KEY_NAME_MAX)) {
+            return SE3_ERR_PARAMS;
+        }
+        size[i] = key_import_entry_size(req + off);
+        if (off + size[i] > req_size) {
+            return SE3_ERR_PARAMS;
+        }
+        // the same id cannot appear twice in a batch
+        SE3_GET32(req + off, SE3_CMD1_KEY_IMPORT_KEY_OFF_ID, id);
+        for (j = 0, q = req_params.keys; j < i; q += size[j], j++) {
+            SE3_GET32(q, SE3_CMD1_KEY_IMPORT_KEY_OFF_ID, id2);
+            if (id2 == id) {
+                SE3_TRACE(("[key_import_batch] duplicate id\n"));
+                return SE3_ERR_PARAMS;
+            }
+        }
+        state[i] = KEY_NEW;
+        off += size[i];
+    }
+    if (off != req_size) {
+        SE3_TRACE(("[key_import_batch] req size mismatch\n"));
+        return SE3_ERR_PARAMS;
+    }
+
+    // single walk over the flash to find the keys which are already stored
+    se3_flash_it_init(&it);
+    while (se3_flash_it_next(&it)) {
+        if (it.type != SE3_TYPE_KEY) {
+            continue;
+        }
+        SE3_GET32(it.addr, SE3_FLASH_KEY_OFF_ID, id);
+        for (i = 0, p = req_params.keys; i < req_params.count; p += size[i], i++) {
+            SE3_GET32(p, SE3_CMD1_KEY_IMPORT_KEY_OFF_ID, id2);
+            if (id2 != id) {
+                continue;
+            }
+            if (req_params.op == SE3_KEY_OP_INSERT) {
+                return SE3_ERR_RESOURCE;
+            }
+            SE3_GET32(p, SE3_CMD1_KEY_IMPORT_KEY_OFF_VALIDITY, key.validity);
+            SE3_GET16(p, SE3_CMD1_KEY_IMPORT_KEY_OFF_DATA_LEN, key.data_size);
+            SE3_GET16(p, SE3_CMD1_KEY_IMPORT_KEY_OFF_NAME_LEN, key.name_size);
+            key.id = id;
+            key.data = (uint8_t*)p + SE3_CMD1_KEY_IMPORT_KEY_OFF_DATA_AND_NAME;
+            key.name = key.data + key.data_size;
+            // do not replace if equal
+            if (se3_key_equal(&it, &key)) {
+                state[i] = KEY_EQUAL;
+            }
+            else {
+                state[i] = KEY_REPLACE;
+                freed += it.blocks*SE3_FLASH_BLOCK_SIZE;
+                replace = true;
+            }
+            break;
+        }
+    }
+
+    // all or nothing: check that the new nodes fit before deleting the replaced keys
+    for (i = 0, j = 0; i < req_params.count; i++) {
+        if (state[i] == KEY_EQUAL) {
+            continue;
+        }
+        nblocks = (size[i] + 2 + SE3_FLASH_BLOCK_SIZE - 1) / SE3_FLASH_BLOCK_SIZE;
+        needed += nblocks*SE3_FLASH_BLOCK_SIZE;
+        size[j++] = size[i];
+    }
+    if (needed > se3_flash_unused() + freed) {
+        SE3_TRACE(("[key_import_batch] not enough space\n"));
+        return SE3_ERR_MEMORY;
+    }
+
+    if (replace) {
+        se3_flash_it_init(&it);
+        while (se3_flash_it_next(&it)) {
+            if (it.type != SE3_TYPE_KEY) {
+                continue;
+            }
+            SE3_GET32(it.addr, SE3_FLASH_KEY_OFF_ID, id);
+            for (i = 0, p = req_params.keys; i < req_params.count; p += key_import_entry_size(p), i++) {
+                SE3_GET32(p, SE3_CMD1_KEY_IMPORT_KEY_OFF_ID, id2);
+                if (id2 == id && state[i] == KEY_REPLACE) {
+                    if (!se3_flash_it_delete(&it)) {
+                        return SE3_ERR_HW;
+                    }
+                    break;
+                }
+            }
+        }
+    }
+
+    resp_params.count = (uint16_t)j;
+    if (resp_params.count > 0) {
+        for (i = 0, j = 0, p = req_params.keys; i < req_params.count; p += key_import_entry_size(p), i++) {
+            if (state[i] == KEY_EQUAL) {
+                continue;
+            }
+            if (!se3_flash_it_new(&it, SE3_TYPE_KEY, size[j++])) {
+                SE3_TRACE(("[key_import_batch] se3_flash_it_new failed\n"));
+                return (hwerror) ? (SE3_ERR_HW) : (SE3_ERR_MEMORY);
+            }
+            if (!se3_flash_it_write(&it, 0, p, key_import_entry_size(p))) {
+                return SE3_ERR_HW;
+            }
+        }
+    }
+
+    SE3_SET16(resp, SE3_CMD1_KEY_IMPORT_RESP_OFF_COUNT, resp_params.count);
+    *resp_size = SE3_CMD1_KEY_IMPORT_RESP_SIZE;
+
+    return SE3_OK;
+}
+
 /** \brief list all keys in device
  *
- *  key_list : (skip:ui16, nmax:ui16, salt[32]) => (count:ui16, keyinfo0, keyinfo1, ...)
+ *  key_list : (skip:ui16, nmax:ui16, salt[32], [cursor:ui64]) => (count:ui16, keyinfo0, keyinfo1, ..., [cursor:ui64])
  *      keyinfo: (id:ui32, validity:ui32, data-len:ui16, name-len:ui16, name[name-len], fingerprint[32])
+ *  When the request carries a cursor, the response ends with the cursor that resumes the listing after
+ *  the last key returned; skip keys are skipped after the cursor. A cursor is valid until a node is moved
+ *  or a sector erased, then SE3_ERR_EXPIRED is returned. The background garbage collection is suspended
+ *  until the listing reaches the last key, a listing without cursor is requested, or the session ends,
+ *  so that only writes needing space can expire a cursor.
  */
 uint16_t key_list(uint16_t req_size, const uint8_t* req, uint16_t* resp_size, uint8_t* resp)
 {
     struct {
         uint16_t skip;
         uint16_t nmax;
-		uint8_t* salt;
+		const uint8_t* salt;
+		uint64_t cursor;
     } req_params;
     struct {
         uint16_t count;
+        uint64_t cursor;
     } resp_params;
 
     se3_flash_key key;
@@ -388,10 +595,10 @@ uint16_t key_list(uint16_t req_size, const uint8_t* req, uint16_t* resp_size, ui
     size_t key_info_size = 0;
     uint8_t* p;
     uint16_t skip;
+    bool end = false;
     uint8_t tmp[SE3_KEY_NAME_MAX];
-	uint8_t fingerprint[SE3_KEY_FINGERPRINT_SIZE];
 
-    if (req_size != SE3_CMD1_KEY_LIST_REQ_SIZE) {
+    if (req_size != SE3_CMD1_KEY_LIST_REQ_SIZE && req_size != SE3_CMD1_KEY_LIST_REQ_SIZE_CURSOR) {
         SE3_TRACE(("[key_list] req size mismatch\n"));
         return SE3_ERR_PARAMS;
     }
@@ -404,15 +611,35 @@ uint16_t key_list(uint16_t req_size, const uint8_t* req, uint16_t* resp_size, ui
     SE3_GET16(req, SE3_CMD1_KEY_LIST_REQ_OFF_SKIP, req_params.skip);
     SE3_GET16(req, SE3_CMD1_KEY_LIST_REQ_OFF_NMAX, req_params.nmax);
 	req_params.salt = req + SE3_CMD1_KEY_LIST_REQ_OFF_SALT;
+    req_params.cursor = SE3_KEY_LIST_CURSOR_START;
+    if (req_size == SE3_CMD1_KEY_LIST_REQ_SIZE_CURSOR) {
+        SE3_GET64(req, SE3_CMD1_KEY_LIST_REQ_OFF_CURSOR, req_params.cursor);
+    }
+
+    // cursor: (flash epoch << 16) | (index position)
+    se3_flash_it_init(&it);
+    if (req_params.cursor != SE3_KEY_LIST_CURSOR_START) {
+        if ((req_params.cursor >> 16) != flash.epoch) {
+            SE3_TRACE(("[key_list] cursor expired\n"));
+            se3_flash_compact_pause(false);
+            return SE3_ERR_EXPIRED;
+        }
+        se3_flash_it_seek(&it, (size_t)(req_params.cursor & 0xFFFF));
+    }
 
-	/* ! will write key data to request buffer */
-	key.data = (uint8_t*)req + ((SE3_CMD1_KEY_LIST_REQ_SIZE / 16) + 1) * 16;
+	// key data is not copied, the fingerprint is computed on the flash contents
+	key.data = NULL;
     key.name = tmp;
     resp_params.count = 0;
+    resp_params.cursor = req_params.cursor;
     skip = req_params.skip;
     size = SE3_CMD1_KEY_LIST_RESP_OFF_KEYINFO;
     p = resp + SE3_CMD1_KEY_LIST_RESP_OFF_KEYINFO;
-    while (se3_flash_it_next(&it)) {
+    while (resp_params.count < req_params.nmax) {
+        if (!se3_flash_it_next(&it)) {
+            end = true;
+            break;
+        }
         if (it.type == SE3_TYPE_KEY) {
             if (skip) {
                 skip--;
@@ -420,32 +647,94 @@ uint16_t key_list(uint16_t req_size, const uint8_t* req, uint16_t* resp_size, ui
             }
             se3_key_read(&it, &key);
             key_info_size = SE3_CMD1_KEY_LIST_KEYINFO_OFF_NAME + key.name_size;
-            if (size + key_info_size > SE3_RESP1_MAX_DATA) {
+            if (size + key_info_size + SE3_CMD1_KEY_LIST_RESP_CURSOR_SIZE > SE3_RESP1_MAX_DATA) {
                 break;
             }
-			se3_key_fingerprint(&key, req_params.salt, fingerprint);
+			se3_key_fingerprint_cached(&it, req_params.salt, p + SE3_CMD1_KEY_LIST_KEYINFO_OFF_FINGERPRINT);
             SE3_SET32(p, SE3_CMD1_KEY_LIST_KEYINFO_OFF_ID, key.id);
             SE3_SET32(p, SE3_CMD1_KEY_LIST_KEYINFO_OFF_VALIDITY, key.validity);
             SE3_SET16(p, SE3_CMD1_KEY_LIST_KEYINFO_OFF_DATA_LEN, key.data_size);
             SE3_SET16(p, SE3_CMD1_KEY_LIST_KEYINFO_OFF_NAME_LEN, key.name_size);
-			memcpy(p + SE3_CMD1_KEY_LIST_KEYINFO_OFF_FINGERPRINT, fingerprint, SE3_KEY_FINGERPRINT_SIZE);
             memcpy(p + SE3_CMD1_KEY_LIST_KEYINFO_OFF_NAME, key.name, key.name_size);
             p += key_info_size;
             size += key_info_size;
             (resp_params.count)++;
-            if (resp_params.count >= req_params.nmax) {
-                break;
-            }
+            resp_params.cursor = ((uint64_t)flash.epoch << 16) | (uint64_t)(it.pos + it.blocks);
         }
     }
-	memset(key.data, 0, SE3_KEY_DATA_MAX);
 
     SE3_SET16(resp, SE3_CMD1_KEY_LIST_RESP_OFF_COUNT, resp_params.count);
+    if (req_size == SE3_CMD1_KEY_LIST_REQ_SIZE_CURSOR) {
+        SE3_SET64(resp, size, resp_params.cursor);
+        size += SE3_CMD1_KEY_LIST_RESP_CURSOR_SIZE;
+        // keep the cursor valid until the host reaches the last key
+        se3_flash_compact_pause(!end);
+    }
+    else {
+        se3_flash_compact_pause(false);
+    }
     *resp_size = (uint16_t)size;
 
     return SE3_OK;
 }
 
+/** \brief get information about a single key
+ *
+ *  key_get_info : (id:ui32, [salt[32]]) => (keyinfo)
+ *      keyinfo: (id:ui32, validity:ui32, data-len:ui16, name-len:ui16, name[name-len], fingerprint[32])
+ *  Without a salt the fingerprint is zero.
+ */
+uint16_t key_get_info(uint16_t req_size, const uint8_t* req, uint16_t* resp_size, uint8_t* resp)
+{
+    struct {
+        uint32_t id;
+        const uint8_t* salt;
+    } req_params;
+
+    se3_flash_key key;
+    se3_flash_it it = { .addr = NULL };
+    uint8_t* p;
+    uint8_t tmp[SE3_KEY_NAME_MAX];
+
+    if (req_size != SE3_CMD1_KEY_GET_INFO_REQ_SIZE && req_size != SE3_CMD1_KEY_GET_INFO_REQ_SIZE_SALT) {
+        SE3_TRACE(("[key_get_info] req size mismatch\n"));
+        return SE3_ERR_PARAMS;
+    }
+
+    if (!login_struct.y) {
+        SE3_TRACE(("[key_get_info] not logged in\n"));
+        return SE3_ERR_ACCESS;
+    }
+
+    SE3_GET32(req, SE3_CMD1_KEY_GET_INFO_REQ_OFF_ID, req_params.id);
+    req_params.salt = (req_size == SE3_CMD1_KEY_GET_INFO_REQ_SIZE_SALT) ? (req + SE3_CMD1_KEY_GET_INFO_REQ_OFF_SALT) : (NULL);
+
+    se3_flash_it_init(&it);
+    if (!se3_key_find(req_params.id, &it)) {
+        return SE3_ERR_RESOURCE;
+    }
+
+    key.data = NULL;
+    key.name = tmp;
+    se3_key_read(&it, &key);
+    p = resp + SE3_CMD1_KEY_GET_INFO_RESP_OFF_KEYINFO;
+    if (req_params.salt != NULL) {
+        se3_key_fingerprint_cached(&it, req_params.salt, p + SE3_CMD1_KEY_LIST_KEYINFO_OFF_FINGERPRINT);
+    }
+    else {
+        // only existence or metadata asked, the cached fingerprints are kept
+        memset(p + SE3_CMD1_KEY_LIST_KEYINFO_OFF_FINGERPRINT, 0, SE3_KEY_FINGERPRINT_SIZE);
+    }
+    SE3_SET32(p, SE3_CMD1_KEY_LIST_KEYINFO_OFF_ID, key.id);
+    SE3_SET32(p, SE3_CMD1_KEY_LIST_KEYINFO_OFF_VALIDITY, key.validity);
+    SE3_SET16(p, SE3_CMD1_KEY_LIST_KEYINFO_OFF_DATA_LEN, key.data_size);
+    SE3_SET16(p, SE3_CMD1_KEY_LIST_KEYINFO_OFF_NAME_LEN, key.name_size);
+    memcpy(p + SE3_CMD1_KEY_LIST_KEYINFO_OFF_NAME, key.name, key.name_size);
+    *resp_size = (uint16_t)(SE3_CMD1_KEY_GET_INFO_RESP_OFF_KEYINFO + SE3_CMD1_KEY_LIST_KEYINFO_OFF_NAME + key.name_size);
+
+    return SE3_OK;
+}
+
 uint16_t dispatcher_call(uint16_t req_size, const uint8_t* req, uint16_t* resp_size, uint8_t* resp)
 {
     se3_cmd_func handler = NULL;
@@ -454,6 +743,7 @@ uint16_t dispatcher_call(uint16_t req_size, const uint8_t* req, uint16_t* resp_s
     const uint8_t* req1;
     uint8_t* resp1;
     uint16_t status;
+    uint32_t start = se3_cycles();
     struct {
         const uint8_t* auth;
         const uint8_t* iv;
@@ -468,6 +758,7 @@ uint16_t dispatcher_call(uint16_t req_size, const uint8_t* req, uint16_t* resp_s
         uint8_t* token;
         uint16_t len;
         uint16_t status;
+        uint32_t cycles;
         uint8_t* data;
     } resp_params;
 
@@ -486,18 +777,25 @@ uint16_t dispatcher_call(uint16_t req_size, const uint8_t* req, uint16_t* resp_s
     	return SE3_ERR_ACCESS;
     }
     // prepare request
+    if ((req_hdr.cmd_flags & SE3_CMDFLAG_AEAD) && !(login_struct.cmd_flags & SE3_CMDFLAG_AEAD)) {
+        SE3_TRACE(("[dispatcher_call] SE3_CMDFLAG_AEAD not negotiated\n"));
+        return SE3_ERR_COMM;
+    }
     if (!login_struct.cryptoctx_initialized) {
         se3_payload_cryptoinit(&(login_struct.cryptoctx), login_struct.key);
         login_struct.cryptoctx_initialized = true;
     }
+    se3_timeline_mark(SE3_TIMELINE_DECRYPT_BEGIN, req_hdr.cmdtok[0], 0);
     if (!se3_payload_decrypt(
         &(login_struct.cryptoctx), req_params.auth, req_params.iv,
         /* !! modifying request */ (uint8_t*)(req  + SE3_AUTH_SIZE + SE3_IV_SIZE),
         (req_size - SE3_AUTH_SIZE - SE3_IV_SIZE) / SE3_CRYPTOBLOCK_SIZE, req_hdr.cmd_flags, crypto_algo))
     {
+        se3_timeline_mark(SE3_TIMELINE_DECRYPT_END, req_hdr.cmdtok[0], 0);
         SE3_TRACE(("[dispatcher_call] AUTH failed\n"));
         return SE3_ERR_COMM;
     }
+    se3_timeline_mark(SE3_TIMELINE_DECRYPT_END, req_hdr.cmdtok[0], 0);
 
     if (login_struct.y) {
         if (memcmp(login_struct.token, req_params.token, SE3_TOKEN_SIZE)) {
@@ -531,14 +829,21 @@ uint16_t dispatcher_call(uint16_t req_size, const uint8_t* req, uint16_t* resp_s
     resp1 = resp + SE3_RESP1_OFFSET_DATA;
     resp1_size = 0;
 
+    se3_timeline_mark(SE3_TIMELINE_HANDLER_BEGIN, req_hdr.cmdtok[0], req_params.cmd);
     status = handler(req1_size, req1, &resp1_size, resp1);
+    se3_timeline_mark(SE3_TIMELINE_HANDLER_END, req_hdr.cmdtok[0], req_params.cmd);
 
     resp_params.len = resp1_size;
     resp_params.auth = resp + SE3_RESP1_OFFSET_AUTH;
     resp_params.iv = resp + SE3_RESP1_OFFSET_IV;
     resp_params.token = resp + SE3_RESP1_OFFSET_TOKEN;
     resp_params.status = status;
+    resp_params.cycles = se3_cycles() - start;
     resp_params.data = resp1;
+    if (req_params.cmd < SE3_STATS_CMD1_COUNT) {
+        se3_stats_cmd_add(&(se3_counters.cmd1[req_params.cmd]), resp_params.cycles);
+    }
+    SE3_LOG(SE3_LOG_CMD1, req_params.cmd | ((uint32_t)status << 16), resp_params.cycles);
 
     resp1_size_padded = resp1_size;
     if (resp1_size_padded % SE3_CRYPTOBLOCK_SIZE != 0) {
@@ -551,20 +856,26 @@ uint16_t dispatcher_call(uint16_t req_size, const uint8_t* req, uint16_t* resp_s
     // prepare response
     SE3_SET16(resp, SE3_RESP1_OFFSET_LEN, resp_params.len);
     SE3_SET16(resp, SE3_RESP1_OFFSET_STATUS, resp_params.status);
+    SE3_SET32(resp, SE3_RESP1_OFFSET_CYCLES, resp_params.cycles);
     if (login_struct.y) {
         memcpy(resp + SE3_RESP1_OFFSET_TOKEN, login_struct.token, SE3_TOKEN_SIZE);
     }
     else {
         memset(resp + SE3_RESP1_OFFSET_TOKEN, 0, SE3_TOKEN_SIZE);
     }
-	if (req_hdr.cmd_flags & SE3_CMDFLAG_ENCRYPT) {
-		se3_rand(SE3_IV_SIZE, resp_params.iv);
+	// GMAC needs a fresh nonce even when the payload is not encrypted
+	if (req_hdr.cmd_flags & (SE3_CMDFLAG_ENCRYPT | SE3_CMDFLAG_AEAD)) {
+		if (SE3_IV_SIZE != se3_rand(SE3_IV_SIZE, resp_params.iv)) {
+			SE3_TRACE(("[dispatcher_call] se3_rand failed\n"));
+			return SE3_ERR_HW;
+		}
 	}
 	else {
 		memset(resp_params.iv, 0, SE3_IV_SIZE);
 	}
 
 	//Implementation choice, depended on the SEkey choice
+	se3_timeline_mark(SE3_TIMELINE_ENCRYPT_BEGIN, req_hdr.cmdtok[0], 0);
 	switch(algo_implementation){
 	case SE3_SECURITY_CORE: se3_payload_encrypt(
 						&(login_struct.cryptoctx), resp_params.auth, resp_params.iv,
@@ -577,13 +888,17 @@ uint16_t dispatcher_call(uint16_t req_size, const uint8_t* req, uint16_t* resp_s
 
 	default: return SE3_ERR_RESOURCE; break;
 	}
+	se3_timeline_mark(SE3_TIMELINE_ENCRYPT_END, req_hdr.cmdtok[0], 0);
 
+	SE3_TRACE(("[dispatcher_call] cmd %u: %u cycles, %u with the response\n", (unsigned)req_params.cmd,
+		(unsigned)resp_params.cycles, (unsigned)(se3_cycles() - start)));
     return SE3_OK;
 }
 
 void se3_dispatcher_init()
 {
 	se3_security_core_init();
+	se3_cycles_init();
 
     memset(&login_struct, 0, sizeof(login_struct));
 
@@ -606,6 +921,11 @@ void set_req_hdr(se3_comm_req_header req_hdr_i){
 	req_hdr = req_hdr_i;
 }
 
+bool se3_request_protected()
+{
+    return (req_hdr.cmd_flags & (SE3_CMDFLAG_ENCRYPT | SE3_CMDFLAG_SIGN)) == (SE3_CMDFLAG_ENCRYPT | SE3_CMDFLAG_SIGN);
+}
+
 static void login_cleanup()
 {
     size_t i;
@@ -614,6 +934,8 @@ static void login_cleanup()
     login_struct.access = 0;
     login_struct.challenge_access = SE3_ACCESS_MAX;
     login_struct.cryptoctx_initialized = false;
+    login_struct.cmd_flags = 0;
+    se3_flash_compact_pause(false);
     //memset(login.key, 0, SE3_KEY_SIZE);
     memcpy(login_struct.key, se3_magic, SE3_KEY_SIZE);
     memset(login_struct.token, 0, SE3_TOKEN_SIZE);
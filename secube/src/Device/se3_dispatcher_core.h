@@ -26,6 +26,7 @@ typedef struct SE3_LOGIN_STATUS_ {
     uint8_t key[SE3_KEY_SIZE];  ///< session key for protocol encryption
     se3_payload_cryptoctx cryptoctx;  ///< context for protocol encryption
     bool cryptoctx_initialized;  ///< context initialized flag
+    uint16_t cmd_flags;  ///< optional command flags accepted at challenge (SE3_CMDFLAG_AEAD)
 } SE3_LOGIN_STATUS;
 
 /** \brief Contains the useful status data for login operations. */
@@ -43,12 +44,24 @@ uint16_t config(uint16_t req_size, const uint8_t* req, uint16_t* resp_size, uint
  */
 uint16_t key_edit(uint16_t req_size, const uint8_t* req, uint16_t* resp_size, uint8_t* resp);
 
+/** \brief KEY_IMPORT_BATCH
+ *
+ *  Insert or update many keys with a single request
+ */
+uint16_t key_import_batch(uint16_t req_size, const uint8_t* req, uint16_t* resp_size, uint8_t* resp);
+
 /** \brief KEY_LIST
  *
  *  Get a list of keys in the device
  */
 uint16_t key_list(uint16_t req_size, const uint8_t* req, uint16_t* resp_size, uint8_t* resp);
 
+/** \brief KEY_GET_INFO
+ *
+ *  Get information about a single key
+ */
+uint16_t key_get_info(uint16_t req_size, const uint8_t* req, uint16_t* resp_size, uint8_t* resp);
+
 /** \brief CHALLENGE command handler
  *
  *  Get a login challenge from the device
@@ -101,8 +114,8 @@ static se3_cmd_func handlers[SE3_N_HARDWARE][SE3_CMD1_MAX] = {{
     /* 8  */ crypto_update,
     /* 9  */ crypto_list,
     /* 10 */ crypto_set_time,
-    /* 11 */ NULL,
-    /* 12 */ NULL,
+    /* 11 */ key_import_batch,
+    /* 12 */ key_get_info,
     /* 13 */ NULL,
     /* 14 */ NULL,
     /* 15 */ error
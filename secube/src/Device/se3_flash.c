@@ -6,12 +6,23 @@
 
 #include "se3_flash.h"
 #include "se3_common.h"
+#include "se3_security_core.h"
 
 SE3_FLASH_INFO flash;
+static SE3_FLASH_GC gc;
+
+/** Result of the background erase, HAL_BUSY until the flash interrupt reports its end */
+static volatile HAL_StatusTypeDef erase_status = HAL_OK;
+
+static bool flash_erase_wait();
+
+/** Blocks available for nodes, one sector is reserved for the garbage collection */
+#define SE3_FLASH_CAPACITY ((SE3_FLASH_SECTORS - 1) * (SE3_FLASH_INDEX_SIZE - 1))
 
 static bool flash_fill(uint32_t addr, uint8_t val, size_t size)
 {
 	bool success = true;
+	flash_erase_wait();
 	HAL_FLASH_Unlock();
 	while (size) {
 		if (HAL_OK != HAL_FLASH_Program(FLASH_TYPEPROGRAM_BYTE, addr, (uint64_t)val)) {
@@ -29,6 +40,7 @@ static bool flash_fill(uint32_t addr, uint8_t val, size_t size)
 static bool flash_zero(uint32_t addr, size_t size)
 {
 	bool success = true;
+	flash_erase_wait();
 	HAL_FLASH_Unlock();
 	while (size) {
 		if (HAL_OK != HAL_FLASH_Program(FLASH_TYPEPROGRAM_BYTE, addr, 0)) {
@@ -46,6 +58,7 @@ static bool flash_zero(uint32_t addr, size_t size)
 static bool flash_program(uint32_t addr, const uint8_t* data, size_t size)
 {
 	bool success = true;
+	flash_erase_wait();
 	HAL_FLASH_Unlock();
 	while (size) {
 		if (HAL_OK != HAL_FLASH_Program(FLASH_TYPEPROGRAM_BYTE, addr, (uint64_t)*data)) {
@@ -63,10 +76,10 @@ static bool flash_program(uint32_t addr, const uint8_t* data, size_t size)
 	return success;
 }
 
-static bool flash_erase(uint32_t sector) {
+static bool flash_erase(const SE3_FLASH_SECTOR* sec) {
     bool success = true;
 #ifdef CUBESIM
-    memset((sector == SE3_FLASH_S0) ? (uint8_t*)(SE3_FLASH_S0_ADDR) : (uint8_t*)(SE3_FLASH_S1_ADDR), 0xFF, SE3_FLASH_SECTOR_SIZE);
+    memset((uint8_t*)sec->base, 0xFF, SE3_FLASH_SECTOR_SIZE);
 #else
 	FLASH_EraseInitTypeDef EraseInitStruct;
 	uint32_t SectorError;
@@ -76,7 +89,7 @@ static bool flash_erase(uint32_t sector) {
 
 	EraseInitStruct.TypeErase = FLASH_TYPEERASE_SECTORS;
 	EraseInitStruct.VoltageRange = FLASH_VOLTAGE_RANGE_3;
-	EraseInitStruct.Sector = sector;
+	EraseInitStruct.Sector = sec->sector;
 	EraseInitStruct.NbSectors = 1;
 	result = HAL_FLASHEx_Erase(&EraseInitStruct, (uint32_t*)&SectorError);
 	if (result != HAL_OK){
@@ -88,168 +101,585 @@ static bool flash_erase(uint32_t sector) {
     return success;
 }
 
-static bool flash_swap()
+/* Start the erase of a sector in bank 2 and return: the flash interrupt reports its end */
+static bool flash_erase_start(const SE3_FLASH_SECTOR* sec)
+{
+#ifdef CUBESIM
+	memset((uint8_t*)sec->base, 0xFF, SE3_FLASH_SECTOR_SIZE);
+	erase_status = HAL_OK;
+#else
+	FLASH_EraseInitTypeDef EraseInitStruct;
+
+	HAL_FLASH_Unlock();
+
+	EraseInitStruct.TypeErase = FLASH_TYPEERASE_SECTORS;
+	EraseInitStruct.VoltageRange = FLASH_VOLTAGE_RANGE_3;
+	EraseInitStruct.Sector = sec->sector;
+	EraseInitStruct.NbSectors = 1;
+	erase_status = HAL_BUSY;
+	if (HAL_OK != HAL_FLASHEx_Erase_IT(&EraseInitStruct)) {
+		erase_status = HAL_ERROR;
+		HAL_FLASH_Lock();
+		hwerror = true;
+		return false;
+	}
+#endif
+	return true;
+}
+
+#ifndef CUBESIM
+void HAL_FLASH_EndOfOperationCallback(uint32_t ReturnValue)
+{
+	// also called after an error
+	if (erase_status == HAL_BUSY) {
+		erase_status = HAL_OK;
+	}
+}
+
+void HAL_FLASH_OperationErrorCallback(uint32_t ReturnValue)
+{
+	erase_status = HAL_ERROR;
+}
+#endif
+
+static size_t flash_blocks(size_t size_on_flash)
+{
+	return (size_on_flash + SE3_FLASH_BLOCK_SIZE - 1) / SE3_FLASH_BLOCK_SIZE;
+}
+
+/* Number of blocks of the node starting at pos, counting the 'CONT' blocks after it */
+static size_t flash_node_blocks(const SE3_FLASH_SECTOR* sec, size_t pos)
 {
-	uint32_t other;
-	uint32_t other_base;
-	uint32_t other_index;
-	size_t other_used;
-	size_t other_pos;
+	size_t pos2 = pos + 1;
+	while (pos2 < SE3_FLASH_INDEX_SIZE && sec->index[pos2] == SE3_FLASH_TYPE_CONT)pos2++;
+	return pos2 - pos;
+}
+
+/* True if a region has not been programmed since the last erase */
+static bool flash_erased(const uint8_t* p, size_t size)
+{
+	while (size) {
+		if (*p != 0xFF) return false;
+		p++;
+		size--;
+	}
+	return true;
+}
 
+static size_t flash_find(uint8_t state)
+{
 	size_t n;
-	bool success, b;
-	se3_flash_it it;
-	if (flash.sector == SE3_FLASH_S0) {
-		other = SE3_FLASH_S1;
-		other_base = SE3_FLASH_S1_ADDR;
+	for (n = 0; n < SE3_FLASH_SECTORS; n++) {
+		if (flash.sectors[n].state == state) break;
+	}
+	return n;
+}
+
+static size_t flash_free_sectors()
+{
+	size_t n, count = 0;
+	for (n = 0; n < SE3_FLASH_SECTORS; n++) {
+		if (flash.sectors[n].state == SE3_FLASH_SECTOR_FREE) count++;
 	}
-	else if (flash.sector == SE3_FLASH_S1) {
-		other = SE3_FLASH_S0;
-		other_base = SE3_FLASH_S0_ADDR;
+	return count;
+}
+
+/* Blocks that would be reclaimed by collecting a sector. The unwritten tail of a sector
+   which is no longer the head is lost as well. */
+static size_t flash_invalid_blocks(size_t n)
+{
+	const SE3_FLASH_SECTOR* sec = &flash.sectors[n];
+	size_t header = (sec->index[0] == SE3_FLASH_TYPE_SECTOR) ? 1 : 0;
+	if (n == flash.head) {
+		return sec->first_free_pos - header - sec->used;
 	}
-	else {
+	return SE3_FLASH_INDEX_SIZE - header - sec->used;
+}
+
+static uint32_t flash_get_generation(const SE3_FLASH_SECTOR* sec)
+{
+	const uint8_t* p = sec->data + 2 + SE3_FLASH_SECTOR_OFF_GENERATION;
+	return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | (uint32_t)p[3];
+}
+
+/* Write the header node of an erased sector. The magic is written last, so that an interrupted
+   format leaves a dirty sector. The generation is programmed when the sector becomes the head. */
+static bool flash_format_end(SE3_FLASH_SECTOR* sec)
+{
+	uint8_t type = SE3_FLASH_TYPE_SECTOR;
+	uint8_t header[2 + SE3_FLASH_SECTOR_HEADER_SIZE];
+	uint16_t size = SE3_FLASH_SECTOR_HEADER_SIZE;
+	uint32_t erase_count = sec->erase_count + 1;
+
+	(flash.erases)++;
+	SE3_LOG(SE3_LOG_FLASH_ERASE, sec->sector, erase_count);
+	memset(header, 0xFF, sizeof(header));
+	SE3_SET16(header, 0, size);
+	SE3_SET32(header, 2 + SE3_FLASH_SECTOR_OFF_ERASE_COUNT, erase_count);
+	if (!flash_program((uint32_t)sec->index, &type, 1)) {
 		return false;
 	}
-	other_index = other_base + SE3_FLASH_MAGIC_SIZE;
-	//erase other sector
-	flash_erase(other);
-	//zero non-programmed slots in index table (first_free_pos to end)
-	if (flash.first_free_pos < SE3_FLASH_INDEX_SIZE) {
-		n = SE3_FLASH_INDEX_SIZE - flash.first_free_pos;
-		flash_zero((uint32_t)flash.index + flash.first_free_pos, n);
-	}
-
-	//copy good blocks to other sector
-	success = true;
-	other_used = SE3_FLASH_MAGIC_SIZE + SE3_FLASH_INDEX_SIZE;
-	other_pos = 0;
-	se3_flash_it_init(&it);	
-	while (se3_flash_it_next(&it)) {
-		if (it.type != SE3_FLASH_TYPE_INVALID) {
-			//copy data
-			b = flash_program(
-				other_base + other_used, 
-				flash.data + it.pos*SE3_FLASH_BLOCK_SIZE,
-				it.blocks*SE3_FLASH_BLOCK_SIZE
-			);
-			if (!b) {
-				success = false; break;
-			}
+	if (!flash_program((uint32_t)sec->data, header, sizeof(header))) {
+		return false;
+	}
+	if (!flash_program((uint32_t)sec->base, se3_magic, SE3_FLASH_MAGIC_SIZE)) {
+		return false;
+	}
+	sec->erase_count = erase_count;
+	sec->generation = SE3_FLASH_GENERATION_NONE;
+	sec->first_free_pos = 1;
+	sec->used = 0;
+	sec->state = SE3_FLASH_SECTOR_FREE;
+	return true;
+}
 
-			//write index
-			b = flash_program(other_index + other_pos, &(it.type), 1);
-			if (!b) {
-				success = false; break;
-			}
-			if (it.blocks > 1) {
-				b = flash_fill(other_index + other_pos + 1, 0xFE, it.blocks - 1);
-				if (!b) {
-					success = false; break;
-				}
-			}
+/* Erase a sector and write its header node */
+static bool flash_format(SE3_FLASH_SECTOR* sec)
+{
+	sec->state = SE3_FLASH_SECTOR_DIRTY;
+	(flash.epoch)++;
+	if (!flash_erase(sec)) {
+		return false;
+	}
+	return flash_format_end(sec);
+}
 
-			other_used += it.blocks*SE3_FLASH_BLOCK_SIZE;
-			other_pos += it.blocks;
-		}
+/* Start formatting a sector of bank 2, the erase runs in background */
+static bool flash_format_start(SE3_FLASH_SECTOR* sec)
+{
+	sec->state = SE3_FLASH_SECTOR_DIRTY;
+	(flash.epoch)++;
+	if (!flash_erase_start(sec)) {
+		return false;
 	}
-	if (!success) {
+	sec->state = SE3_FLASH_SECTOR_ERASING;
+	return true;
+}
+
+/* Wait for the background erase, if any, and complete the format of its sector: the flash
+   cannot be programmed while it runs */
+static bool flash_erase_wait()
+{
+	SE3_FLASH_SECTOR* sec;
+	size_t n = flash_find(SE3_FLASH_SECTOR_ERASING);
+	if (n == SE3_FLASH_SECTORS) {
+		return true;
+	}
+	while (erase_status == HAL_BUSY);
+#ifndef CUBESIM
+	HAL_FLASH_Lock();
+#endif
+	sec = &flash.sectors[n];
+	sec->state = SE3_FLASH_SECTOR_DIRTY;
+	if (erase_status != HAL_OK) {
+		hwerror = true;
 		return false;
 	}
+	return flash_format_end(sec);
+}
 
-	//write magic to other sector
-	if (!flash_program(other_base, se3_magic, SE3_FLASH_MAGIC_SIZE)) {
+/* Make the least worn free sector the head of the log. The generation is programmed most
+   significant byte first: if interrupted, the value is still greater than the previous one. */
+static bool flash_open_head()
+{
+	size_t i, n = SE3_FLASH_SECTORS;
+	uint32_t generation = flash.generation + 1;
+	uint8_t tmp[4];
+
+	for (i = 0; i < SE3_FLASH_SECTORS; i++) {
+		if (flash.sectors[i].state != SE3_FLASH_SECTOR_FREE) continue;
+		if (n == SE3_FLASH_SECTORS || flash.sectors[i].erase_count < flash.sectors[n].erase_count) {
+			n = i;
+		}
+	}
+	if (n == SE3_FLASH_SECTORS) {
+		return false;
+	}
+	tmp[0] = (uint8_t)(generation >> 24);
+	tmp[1] = (uint8_t)(generation >> 16);
+	tmp[2] = (uint8_t)(generation >> 8);
+	tmp[3] = (uint8_t)(generation);
+	if (!flash_program((uint32_t)flash.sectors[n].data + 2 + SE3_FLASH_SECTOR_OFF_GENERATION, tmp, 4)) {
 		return false;
 	}
+	flash.sectors[n].generation = generation;
+	flash.sectors[n].state = SE3_FLASH_SECTOR_LOG;
+	flash.generation = generation;
+	flash.head = n;
+	return true;
+}
+
+/* Sector with the most invalid blocks */
+static size_t flash_gc_victim()
+{
+	size_t i, n = SE3_FLASH_SECTORS, best = 0, invalid;
+	for (i = 0; i < SE3_FLASH_SECTORS; i++) {
+		if (flash.sectors[i].state != SE3_FLASH_SECTOR_LOG) continue;
+		invalid = flash_invalid_blocks(i);
+		if (invalid > best) {
+			best = invalid;
+			n = i;
+		}
+	}
+	return n;
+}
 
-	//clear magic from this sector
-	if (!flash_zero((uint32_t)flash.base, 1)) {
+static bool flash_gc_start(size_t n)
+{
+	// the head cannot be collected, a new one is opened
+	if (n == flash.head && !flash_open_head()) {
 		return false;
 	}
+	gc.state = SE3_FLASH_GC_COPY;
+	gc.victim = n;
+	gc.pos = 0;
+	return true;
+}
+
+static bool flash_gc_run();
+
+/* Make room for a node in the head. The last free sector can be used only by the garbage
+   collector: other nodes wait for a synchronous collection, bounded to avoid looping when
+   fragmentation eats the reclaimed space. */
+static bool flash_reserve(size_t nblocks, bool gc_move)
+{
+	size_t runs = 0;
+	while (flash.sectors[flash.head].first_free_pos + nblocks > SE3_FLASH_INDEX_SIZE) {
+		if (gc_move || flash_free_sectors() > 1) {
+			if (!flash_open_head()) {
+				return false;
+			}
+		}
+		else if (runs++ == SE3_FLASH_SECTORS || !flash_gc_run()) {
+			return false;
+		}
+	}
+	return true;
+}
+
+/* Move the next live node of the victim to the head. The copy is typed only when complete and
+   the original is zeroed right after: se3_flash_init discards an untyped copy (flash_scan) and
+   removes the duplicate left by a reset in between (flash_gc_recover). */
+static bool flash_gc_move()
+{
+	SE3_FLASH_SECTOR* src = &flash.sectors[gc.victim];
+	SE3_FLASH_SECTOR* dst;
+	uint8_t type;
+	size_t pos, blocks;
+	bool success = true;
+
+	while (gc.pos < src->first_free_pos) {
+		type = src->index[gc.pos];
+		if (type == SE3_FLASH_TYPE_INVALID || type == SE3_FLASH_TYPE_CONT || type == SE3_FLASH_TYPE_SECTOR) {
+			(gc.pos)++;
+			continue;
+		}
+		blocks = flash_node_blocks(src, gc.pos);
+		if (!flash_reserve(blocks, true)) {
+			gc.state = SE3_FLASH_GC_IDLE;
+			return false;
+		}
+		dst = &flash.sectors[flash.head];
+		pos = dst->first_free_pos;
+		dst->first_free_pos += blocks;
 
-	//swap sectors
-	flash.base = (uint8_t*)other_base;
-    flash.sector = other;
-    flash.index = flash.base + SE3_FLASH_MAGIC_SIZE;
-    flash.data = flash.index + SE3_FLASH_INDEX_SIZE;
-    flash.allocated = flash.used = other_used;
-    flash.first_free_pos = other_pos;
+		if (blocks > 1) {
+			success = flash_fill((uint32_t)dst->index + pos + 1, SE3_FLASH_TYPE_CONT, blocks - 1);
+		}
+		if (success) {
+			success = flash_program((uint32_t)dst->data + pos*SE3_FLASH_BLOCK_SIZE, src->data + gc.pos*SE3_FLASH_BLOCK_SIZE, blocks*SE3_FLASH_BLOCK_SIZE);
+		}
+		if (success) {
+			success = flash_program((uint32_t)dst->index + pos, &type, 1);
+		}
+		if (success) {
+			success = flash_zero((uint32_t)src->index + gc.pos, blocks);
+		}
+		if (!success) {
+			gc.state = SE3_FLASH_GC_IDLE;
+			return false;
+		}
+		dst->used += blocks;
+		src->used -= blocks;
+		gc.pos += blocks;
+		(flash.epoch)++;
+		return true;
+	}
+	//no live node left, the victim can be erased
+	src->state = SE3_FLASH_SECTOR_DIRTY;
+	gc.state = SE3_FLASH_GC_IDLE;
+	(flash.swaps)++;
+	SE3_LOG(SE3_LOG_FLASH_COLLECT, src->sector, 0);
+	return true;
+}
 
+/* Stop-the-world fallback: free one sector, completing the collection in progress if any */
+static bool flash_gc_run()
+{
+	size_t n;
+	// a sector is being erased in background, it is free once formatted
+	if (flash_find(SE3_FLASH_SECTOR_ERASING) < SE3_FLASH_SECTORS) {
+		return flash_erase_wait();
+	}
+	n = flash_find(SE3_FLASH_SECTOR_DIRTY);
+	if (n == SE3_FLASH_SECTORS && gc.state == SE3_FLASH_GC_IDLE) {
+		n = flash_gc_victim();
+		if (n == SE3_FLASH_SECTORS || !flash_gc_start(n)) {
+			return false;
+		}
+	}
+	while (gc.state == SE3_FLASH_GC_COPY) {
+		if (!flash_gc_move()) {
+			return false;
+		}
+	}
+	n = flash_find(SE3_FLASH_SECTOR_DIRTY);
+	if (n < SE3_FLASH_SECTORS) {
+		return flash_format(&flash.sectors[n]);
+	}
 	return true;
 }
 
-void se3_flash_info_setup(uint32_t sector, const uint8_t* base)
+bool se3_flash_compact_step()
+{
+	size_t n = flash_find(SE3_FLASH_SECTOR_ERASING);
+	if (n < SE3_FLASH_SECTORS) {
+		// nothing else to do until the background erase has ended
+		return (erase_status != HAL_BUSY) && flash_erase_wait();
+	}
+	if (gc.paused) {
+		return false;
+	}
+	n = flash_find(SE3_FLASH_SECTOR_DIRTY);
+	if (n < SE3_FLASH_SECTORS) {
+		if (SE3_FLASH_SECTOR_ASYNC(n)) {
+			return flash_format_start(&flash.sectors[n]);
+		}
+		return flash_format(&flash.sectors[n]);
+	}
+	if (gc.state == SE3_FLASH_GC_COPY) {
+		return flash_gc_move();
+	}
+	// start only if free sectors are running out, and the victim is worth copying its live nodes
+	if (flash_free_sectors() < SE3_FLASH_GC_FREE_SECTORS) {
+		n = flash_gc_victim();
+		if (n < SE3_FLASH_SECTORS && flash_invalid_blocks(n)*SE3_FLASH_BLOCK_SIZE >= SE3_FLASH_GC_THRESHOLD) {
+			return flash_gc_start(n);
+		}
+	}
+	return false;
+}
+
+void se3_flash_compact_pause(bool pause)
+{
+	gc.paused = pause;
+}
+
+void se3_flash_info_setup(size_t n, uint32_t sector, const uint8_t* base)
 {
-	flash.base = base;
-    flash.sector = sector;
-    flash.index = flash.base + SE3_FLASH_MAGIC_SIZE;
-    flash.data = flash.index + SE3_FLASH_INDEX_SIZE;
-    flash.allocated = flash.used = SE3_FLASH_MAGIC_SIZE + SE3_FLASH_INDEX_SIZE;
-    flash.first_free_pos = 0;
+	SE3_FLASH_SECTOR* sec = &flash.sectors[n];
+	sec->base = base;
+	sec->sector = sector;
+	sec->index = sec->base + SE3_FLASH_MAGIC_SIZE;
+	sec->data = sec->index + SE3_FLASH_INDEX_SIZE;
+	sec->state = SE3_FLASH_SECTOR_DIRTY;
+	sec->generation = SE3_FLASH_GENERATION_NONE;
+	sec->erase_count = 0;
+	sec->first_free_pos = 0;
+	sec->used = 0;
 }
 
 bool se3_flash_canfit(size_t size)
 {
 	size_t size_on_flash = size + 2;
-	return (size_on_flash <= (SE3_FLASH_SECTOR_SIZE - flash.used));
+	return (flash_blocks(size_on_flash) <= (SE3_FLASH_CAPACITY - flash.used));
 }
 
-bool se3_flash_init()
+/* Count the valid blocks of a sector and find its first free position */
+static void flash_scan(SE3_FLASH_SECTOR* sec)
 {
-	se3_flash_it it;
-	uint8_t* base;
-	uint32_t sector;
-	//uint16_t record_key;
+	size_t pos = 0, blocks;
+	uint8_t type;
 
-	// check for flash magic
-	bool magic0 = !memcmp((void*)SE3_FLASH_S0_ADDR, se3_magic, SE3_FLASH_MAGIC_SIZE);
-	bool magic1 = !memcmp((void*)SE3_FLASH_S1_ADDR, se3_magic, SE3_FLASH_MAGIC_SIZE);
-	
-	//choose active sector
-	if (magic0 && magic1) {
-		//both marked, the one with last index programmed should be deleted
-		if (0xFF == *((uint8_t*)(SE3_FLASH_S1_ADDR + SE3_FLASH_MAGIC_SIZE + SE3_FLASH_INDEX_SIZE - 1))){
-			magic0 = false;
-			flash_zero(SE3_FLASH_S0_ADDR, 1);
+	sec->used = 0;
+	while (pos < SE3_FLASH_INDEX_SIZE) {
+		type = sec->index[pos];
+		if (type == SE3_FLASH_TYPE_EMPTY) break;
+		blocks = flash_node_blocks(sec, pos);
+		if (type != SE3_FLASH_TYPE_INVALID && type != SE3_FLASH_TYPE_CONT && type != SE3_FLASH_TYPE_SECTOR) {
+			sec->used += blocks;
+		}
+		pos += blocks;
+	}
+	//a node moved by the garbage collector is typed last, a reset may leave only its 'CONT' blocks,
+	//or the data of a single-block node under an empty index entry
+	if (pos < SE3_FLASH_INDEX_SIZE) {
+		if (pos + 1 < SE3_FLASH_INDEX_SIZE && sec->index[pos + 1] == SE3_FLASH_TYPE_CONT) {
+			blocks = flash_node_blocks(sec, pos);
 		}
 		else {
-			magic1 = false;
-			flash_zero(SE3_FLASH_S1_ADDR, 1);
+			blocks = flash_erased(sec->data + pos*SE3_FLASH_BLOCK_SIZE, SE3_FLASH_BLOCK_SIZE) ? 0 : 1;
+		}
+		if (blocks > 0) {
+			flash_zero((uint32_t)sec->index + pos, blocks);
+			pos += blocks;
 		}
 	}
+	sec->first_free_pos = pos;
+}
+
+/* A reset during a garbage collection move leaves the node both at the end of the head and in
+   the victim. The copy in the head is kept. */
+static void flash_gc_recover()
+{
+	SE3_FLASH_SECTOR* head = &flash.sectors[flash.head];
+	SE3_FLASH_SECTOR* sec;
+	size_t n, pos, last = SE3_FLASH_INDEX_SIZE, blocks = 0;
+	uint8_t type;
 
-	if (magic0) {
-		base = (uint8_t*)SE3_FLASH_S0_ADDR;
-		sector = SE3_FLASH_S0;
+	for (pos = 0; pos < head->first_free_pos; pos += blocks) {
+		last = pos;
+		blocks = flash_node_blocks(head, pos);
 	}
-	else if (magic1) {
-		base = (uint8_t*)SE3_FLASH_S1_ADDR;
-		sector = SE3_FLASH_S1;
+	if (last == SE3_FLASH_INDEX_SIZE) {
+		return;
 	}
-	else {
-		// initialize S0 as active sector
-		flash_erase(SE3_FLASH_S0);
-		flash_program(SE3_FLASH_S0_ADDR, se3_magic, SE3_FLASH_MAGIC_SIZE);
-		base = (uint8_t*)SE3_FLASH_S0_ADDR;
-		sector = SE3_FLASH_S0;
+	type = head->index[last];
+	if (type == SE3_FLASH_TYPE_INVALID || type == SE3_FLASH_TYPE_CONT || type == SE3_FLASH_TYPE_SECTOR) {
+		return;
+	}
+	for (n = 0; n < SE3_FLASH_SECTORS; n++) {
+		sec = &flash.sectors[n];
+		if (n == flash.head || sec->state != SE3_FLASH_SECTOR_LOG) continue;
+		for (pos = 0; pos < sec->first_free_pos; pos++) {
+			if (sec->index[pos] != type || flash_node_blocks(sec, pos) != blocks) continue;
+			if (!memcmp(sec->data + pos*SE3_FLASH_BLOCK_SIZE, head->data + last*SE3_FLASH_BLOCK_SIZE, blocks*SE3_FLASH_BLOCK_SIZE)) {
+				if (flash_zero((uint32_t)sec->index + pos, blocks)) {
+					sec->used -= blocks;
+				}
+				return;
+			}
+		}
 	}
-	se3_flash_info_setup(sector, base);
+}
 
-	//scan flash
+/* Read serial and records of a sector */
+static void flash_load(size_t n)
+{
+	se3_flash_it it;
 	se3_flash_it_init(&it);
-	while (se3_flash_it_next(&it)) {
-		flash.allocated += it.blocks*SE3_FLASH_BLOCK_SIZE;
-		if (it.type != 0) {
-			flash.used += it.blocks*SE3_FLASH_BLOCK_SIZE;
-            if (it.type == SE3_FLASH_TYPE_SERIAL) {
-                memcpy(serial.data, it.addr, SE3_SERIAL_SIZE);
-                serial.written = true;
-            }
+	se3_flash_it_seek(&it, n*SE3_FLASH_INDEX_SIZE);
+	while (se3_flash_it_next(&it) && it.pos < (n + 1)*SE3_FLASH_INDEX_SIZE) {
+		if (it.type == SE3_FLASH_TYPE_SERIAL) {
+			memcpy(serial.data, it.addr, SE3_SERIAL_SIZE);
+			serial.written = true;
+		}
+		else if (it.type == SE3_FLASH_TYPE_RECORD) {
+			record_load(&it);
 		}
 	}
-	if (it.pos > SE3_FLASH_INDEX_SIZE) {
-		it.pos = SE3_FLASH_INDEX_SIZE;
+}
+
+bool se3_flash_init()
+{
+	SE3_FLASH_SECTOR* sec;
+	size_t i, n;
+	uint32_t max_erase_count = 0;
+	bool legacy0, legacy1;
+
+	flash.generation = 0;
+	flash.used = 0;
+	flash.swaps = 0;
+	flash.erases = 0;
+	gc.state = SE3_FLASH_GC_IDLE;
+	gc.paused = false;
+	erase_status = HAL_OK;
+
+	// check for flash magic and sector header
+	for (i = 0; i < SE3_FLASH_SECTORS; i++) {
+		se3_flash_info_setup(i, SE3_FLASH_SECTOR_NUMBER(i), (const uint8_t*)SE3_FLASH_SECTOR_ADDR(i));
+		sec = &flash.sectors[i];
+		if (memcmp(sec->base, se3_magic, SE3_FLASH_MAGIC_SIZE)) {
+			continue;
+		}
+		if (sec->index[0] == SE3_FLASH_TYPE_SECTOR) {
+			sec->generation = flash_get_generation(sec);
+			SE3_GET32(sec->data + 2, SE3_FLASH_SECTOR_OFF_ERASE_COUNT, sec->erase_count);
+			sec->state = (sec->generation == SE3_FLASH_GENERATION_NONE) ? SE3_FLASH_SECTOR_FREE : SE3_FLASH_SECTOR_LOG;
+		}
+		else {
+			// written by the two-sector layout, older than any other sector
+			sec->generation = 0;
+			sec->state = SE3_FLASH_SECTOR_LOG;
+		}
+		if (sec->state == SE3_FLASH_SECTOR_LOG && sec->generation > flash.generation) {
+			flash.generation = sec->generation;
+		}
+		if (sec->erase_count > max_erase_count) {
+			max_erase_count = sec->erase_count;
+		}
+	}
+
+	// two-sector layout, both marked: the one with last index programmed should be deleted
+	legacy0 = flash.sectors[0].state == SE3_FLASH_SECTOR_LOG && flash.sectors[0].generation == 0;
+	legacy1 = flash.sectors[1].state == SE3_FLASH_SECTOR_LOG && flash.sectors[1].generation == 0;
+	if (legacy0 && legacy1) {
+		n = (0xFF == flash.sectors[1].index[SE3_FLASH_INDEX_SIZE - 1]) ? 0 : 1;
+		flash_zero((uint32_t)flash.sectors[n].base, 1);
+		flash.sectors[n].state = SE3_FLASH_SECTOR_DIRTY;
+	}
+
+	// the erase count of a dirty sector is unknown, assume the worst
+	flash.head = SE3_FLASH_SECTORS;
+	for (i = 0; i < SE3_FLASH_SECTORS; i++) {
+		sec = &flash.sectors[i];
+		if (sec->state == SE3_FLASH_SECTOR_DIRTY) {
+			sec->erase_count = max_erase_count;
+		}
+		else {
+			flash_scan(sec);
+		}
+		if (sec->state == SE3_FLASH_SECTOR_LOG) {
+			if (flash.head == SE3_FLASH_SECTORS || sec->generation > flash.sectors[flash.head].generation) {
+				flash.head = i;
+			}
+		}
+	}
+
+	if (flash.head == SE3_FLASH_SECTORS) {
+		// empty store
+		if (flash_find(SE3_FLASH_SECTOR_FREE) == SE3_FLASH_SECTORS) {
+			if (!flash_format(&flash.sectors[0])) {
+				return false;
+			}
+		}
+		if (!flash_open_head()) {
+			return false;
+		}
+	}
+	else {
+		flash_gc_recover();
+	}
+
+	for (i = 0; i < SE3_FLASH_SECTORS; i++) {
+		flash.used += flash.sectors[i].used;
+	}
+
+	// load serial and records, oldest sector first
+	n = SE3_FLASH_SECTORS;
+	for (;;) {
+		sec = (n < SE3_FLASH_SECTORS) ? &flash.sectors[n] : NULL;
+		n = SE3_FLASH_SECTORS;
+		for (i = 0; i < SE3_FLASH_SECTORS; i++) {
+			if (flash.sectors[i].state != SE3_FLASH_SECTOR_LOG) continue;
+			if (sec != NULL && flash.sectors[i].generation <= sec->generation) continue;
+			if (n == SE3_FLASH_SECTORS || flash.sectors[i].generation < flash.sectors[n].generation) {
+				n = i;
+			}
+		}
+		if (n == SE3_FLASH_SECTORS) break;
+		flash_load(n);
 	}
-	flash.first_free_pos = it.pos;
 
 	return true;
 }
@@ -257,7 +687,7 @@ bool se3_flash_init()
 bool se3_flash_it_write(se3_flash_it* it, uint16_t off, const uint8_t* data, uint16_t size)
 {
 	if (off + size > 2 + it->size)return false;
-    return flash_program((uint32_t)it->addr + off, data, size);
+	return flash_program((uint32_t)it->addr + off, data, size);
 }
 
 void se3_flash_it_init(se3_flash_it* it)
@@ -265,31 +695,42 @@ void se3_flash_it_init(se3_flash_it* it)
 	it->addr = NULL;
 }
 
+void se3_flash_it_seek(se3_flash_it* it, size_t pos)
+{
+	it->addr = flash.sectors[0].data + 2;
+	it->pos = pos;
+	it->blocks = 0;
+}
+
 bool se3_flash_it_next(se3_flash_it* it)
 {
+	const SE3_FLASH_SECTOR* sec;
 	uint8_t type;
 	const uint8_t* node;
-	size_t pos2;
+	size_t n, pos;
 	if (it->addr == NULL) {
 		it->pos = 0;
-		it->addr = flash.data + 2;
+		it->addr = flash.sectors[0].data + 2;
 	}
 	else {
 		(it->pos)+=it->blocks;
 	}
-	while (it->pos < SE3_FLASH_INDEX_SIZE) {
-		type = *(flash.index + it->pos);
-		if (type == 0xFF) return false;
-		if (type != 0xFE) {
-			node = flash.data + (it->pos) * SE3_FLASH_BLOCK_SIZE;
+	while (it->pos < SE3_FLASH_SECTORS*SE3_FLASH_INDEX_SIZE) {
+		n = it->pos / SE3_FLASH_INDEX_SIZE;
+		pos = it->pos % SE3_FLASH_INDEX_SIZE;
+		sec = &flash.sectors[n];
+		if (sec->state != SE3_FLASH_SECTOR_LOG || pos >= sec->first_free_pos) {
+			//go to next sector
+			it->pos = (n + 1)*SE3_FLASH_INDEX_SIZE;
+			continue;
+		}
+		type = sec->index[pos];
+		if (type != SE3_FLASH_TYPE_CONT && type != SE3_FLASH_TYPE_SECTOR) {
+			node = sec->data + pos * SE3_FLASH_BLOCK_SIZE;
 			it->addr = node + 2;
             SE3_GET16(node, 0, it->size);
 			it->type = type;
-
-			//count 'CONT' nodes after
-			pos2 = it->pos + 1;
-			while (pos2 < SE3_FLASH_INDEX_SIZE && *(flash.index + pos2) == 0xFE)pos2++;
-			it->blocks = (uint16_t)(pos2 - it->pos);
+			it->blocks = (uint16_t)flash_node_blocks(sec, pos);
 			return true;
 		}
 		(it->pos)++;
@@ -299,84 +740,92 @@ bool se3_flash_it_next(se3_flash_it* it)
 
 size_t se3_flash_unused()
 {
-	return SE3_FLASH_SECTOR_SIZE - flash.used;
+	return (SE3_FLASH_CAPACITY - flash.used)*SE3_FLASH_BLOCK_SIZE;
+}
+
+size_t se3_flash_allocated()
+{
+	const SE3_FLASH_SECTOR* sec;
+	size_t i, blocks = 0;
+	for (i = 0; i < SE3_FLASH_SECTORS; i++) {
+		sec = &flash.sectors[i];
+		if (sec->state == SE3_FLASH_SECTOR_LOG) {
+			blocks += sec->first_free_pos - ((sec->index[0] == SE3_FLASH_TYPE_SECTOR) ? 1 : 0);
+		}
+	}
+	return blocks*SE3_FLASH_BLOCK_SIZE;
+}
+
+size_t se3_flash_capacity()
+{
+	return SE3_FLASH_CAPACITY*SE3_FLASH_BLOCK_SIZE;
 }
 
 bool se3_flash_it_new(se3_flash_it* it, uint8_t type, uint16_t size)
 {
+	SE3_FLASH_SECTOR* sec;
 	size_t pos, nblocks;
 	const uint8_t* node;
-	size_t avail = SE3_FLASH_SECTOR_SIZE - flash.allocated;
 	uint16_t size_on_flash = size + 2;
 	if (size_on_flash > SE3_FLASH_NODE_MAX)return false;
-	if (size_on_flash > (SE3_FLASH_SECTOR_SIZE - flash.used)) {
+	nblocks = flash_blocks(size_on_flash);
+	if (nblocks > (SE3_FLASH_CAPACITY - flash.used)) {
 		return false;
 	}
-	if (size_on_flash > avail) {
-		// swap sector
-		if (!flash_swap()) {
-			return false;
-		}
-	}
-	if (flash.first_free_pos >= SE3_FLASH_INDEX_SIZE) {
+	if (!flash_reserve(nblocks, false)) {
 		return false;
 	}
-	pos = flash.first_free_pos;
-	node = flash.data + pos*SE3_FLASH_BLOCK_SIZE;
+	sec = &flash.sectors[flash.head];
+	pos = sec->first_free_pos;
+	node = sec->data + pos*SE3_FLASH_BLOCK_SIZE;
 
-	nblocks = size_on_flash / SE3_FLASH_BLOCK_SIZE;
-	if (size_on_flash % SE3_FLASH_BLOCK_SIZE)nblocks++;
-	if (!flash_program((uint32_t)flash.index + pos, &type, 1)) {
+	if (!flash_program((uint32_t)sec->index + pos, &type, 1)) {
 		return false;
 	}
-	flash.first_free_pos += 1;
+	sec->first_free_pos += 1;
 	if (nblocks > 1) {
-		if (!flash_fill((uint32_t)flash.index + pos + 1, 0xFE, nblocks - 1)) {
+		if (!flash_fill((uint32_t)sec->index + pos + 1, SE3_FLASH_TYPE_CONT, nblocks - 1)) {
 			return false;
 		}
-		flash.first_free_pos += nblocks - 1;
+		sec->first_free_pos += nblocks - 1;
 	}
 	
 	if (!flash_program((uint32_t)node, (uint8_t*)&size, 2)) {
 		return false;
 	}
 	it->addr = node + 2;
-	it->pos = pos;
+	it->pos = flash.head*SE3_FLASH_INDEX_SIZE + pos;
 	it->size = size;
 	it->type = type;
 	it->blocks = (uint16_t)nblocks;
 
-	flash.used += nblocks*SE3_FLASH_BLOCK_SIZE;
-	flash.allocated += nblocks*SE3_FLASH_BLOCK_SIZE;
+	sec->used += nblocks;
+	flash.used += nblocks;
 
 	return true;
 }
 
 bool se3_flash_pos_delete(size_t pos)
 {
-	size_t pos2, blocks;
-	if (pos >= SE3_FLASH_INDEX_SIZE)return false;
-	pos2 = pos + 1;
-	while (pos2 < SE3_FLASH_INDEX_SIZE && *(flash.index + pos2) == 0xFE)pos2++;
-	blocks = (pos2 - pos);
-	if (pos + blocks > SE3_FLASH_INDEX_SIZE)return false;
-	if (!flash_zero((uint32_t)flash.index + pos, blocks)) {
+	SE3_FLASH_SECTOR* sec;
+	size_t blocks;
+	if (pos >= SE3_FLASH_SECTORS*SE3_FLASH_INDEX_SIZE)return false;
+	sec = &flash.sectors[pos / SE3_FLASH_INDEX_SIZE];
+	pos %= SE3_FLASH_INDEX_SIZE;
+	if (sec->state != SE3_FLASH_SECTOR_LOG || pos >= sec->first_free_pos)return false;
+	if (sec->index[pos] == SE3_FLASH_TYPE_INVALID)return true;
+	blocks = flash_node_blocks(sec, pos);
+	if (!flash_zero((uint32_t)sec->index + pos, blocks)) {
 		return false;
 	}
-	flash.used -= blocks*SE3_FLASH_BLOCK_SIZE;
+	sec->used -= blocks;
+	flash.used -= blocks;
 	return true;
 }
 
 bool se3_flash_it_delete(se3_flash_it* it)
 {
-	if (it->pos + it->blocks > SE3_FLASH_INDEX_SIZE) {
-		return false;
-	}
-	if (!flash_zero((uint32_t)flash.index + it->pos, it->blocks)) {
-		return false;
-	}
-	flash.used -= it->blocks*SE3_FLASH_BLOCK_SIZE;
-	return true;
+	return se3_flash_pos_delete(it->pos);
 }
 
 bool se3_flash_bootmode_reset(uint32_t addr, size_t size){
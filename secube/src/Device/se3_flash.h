@@ -10,11 +10,12 @@
 #include "stm32f4xx.h"
 #include "stm32f4xx_hal.h"
 #include <stdbool.h>
-#define SE3_FLASH_S0  (FLASH_SECTOR_10)
-#define SE3_FLASH_S1  (FLASH_SECTOR_11)
-#define SE3_FLASH_S0_ADDR  ((uint32_t)0x080C0000)
-#define SE3_FLASH_S1_ADDR  ((uint32_t)0x080E0000)
+#define SE3_FLASH_SECTORS (6)
+#define SE3_FLASH_SECTOR_NUMBER(n) (((n) < 2) ? (FLASH_SECTOR_10 + (n)) : (FLASH_SECTOR_20 + (n) - 2))
+#define SE3_FLASH_SECTOR_ADDR(n) (((n) < 2) ? ((uint32_t)0x080C0000 + (n)*0x20000) : ((uint32_t)0x08180000 + ((n) - 2)*0x20000))
 #define SE3_FLASH_SECTOR_SIZE (128*1024)
+/** Sectors 20-23 are in bank 2: they are erased in background while the code runs from bank 1 */
+#define SE3_FLASH_SECTOR_ASYNC(n) ((n) >= 2)
 #endif
 
 /*
@@ -28,8 +29,16 @@ Structure of flash:
 	A special value (SE3_FLASH_TYPE_CONT) indicates that the block is the continuation of the 
 	previous one.
 	if the block is invalid, its type is 0. If it has not been written yet, the type is 0xFF.
-*/
 
+	The store is a log spanning SE3_FLASH_SECTORS sectors. New nodes are appended to the head
+	sector; when it is full, the free sector with the lowest erase count becomes the new head.
+	The first node of each sector (SE3_FLASH_TYPE_SECTOR) holds its generation, which orders the
+	sectors in the log, and its erase count. Sectors written by the two-sector layout have no
+	such node and are the oldest in the log.
+	The garbage collector moves the live nodes of the sector with the most invalid blocks to the
+	head, then erases it. One sector is always kept free for this purpose.
+	Node positions (se3_flash_it.pos) are global: sector * SE3_FLASH_INDEX_SIZE + index position.
+*/
 /** \brief Flash node iterator structure */
 typedef struct se3_flash_it_ {
 	const uint8_t* addr;
@@ -39,20 +48,40 @@ typedef struct se3_flash_it_ {
 	size_t pos;
 } se3_flash_it;
 
-typedef struct SE3_FLASH_INFO_ {
-    uint32_t sector;  ///< active sector number
+/** \brief Flash sector status */
+typedef struct SE3_FLASH_SECTOR_ {
+    uint32_t sector;  ///< hardware sector number
     const uint8_t* base;
     const uint8_t* index;
     const uint8_t* data;
+    uint8_t state;  ///< one of SE3_FLASH_SECTOR_*
+    uint32_t generation;  ///< position of the sector in the log
+    uint32_t erase_count;  ///< number of times the sector has been erased
     size_t first_free_pos;
-    size_t used;
-    size_t allocated;
+    size_t used;  ///< blocks of valid nodes
+} SE3_FLASH_SECTOR;
+
+typedef struct SE3_FLASH_INFO_ {
+    SE3_FLASH_SECTOR sectors[SE3_FLASH_SECTORS];
+    size_t head;  ///< sector receiving new nodes
+    uint32_t generation;  ///< generation of the head sector
+    size_t used;  ///< blocks of valid nodes in all sectors
+    uint32_t epoch;  ///< incremented each time a node is moved or a sector erased
+    uint32_t swaps;  ///< sectors collected by the garbage collector, for SE3_CMD0_STATS
+    uint32_t erases;  ///< sectors erased, for SE3_CMD0_STATS
 } SE3_FLASH_INFO;
 
+/** \brief Flash management status
+ *
+ *  Node positions remain valid until the epoch changes
+ */
+extern SE3_FLASH_INFO flash;
+
 /** Flash nodes' default and reserved types */
 enum {
 	SE3_FLASH_TYPE_INVALID = 0,  ///< Invalid node
 	SE3_FLASH_TYPE_SERIAL = 1,  ///< Device's serial number
+	SE3_FLASH_TYPE_SECTOR = 2,  ///< Sector header, first node of each sector
 	SE3_FLASH_TYPE_CONT = 0xFE,  ///< Continuation of previous node
 	SE3_FLASH_TYPE_EMPTY = 0xFF  ///< Not written yet
 };
@@ -66,18 +95,91 @@ enum {
 	SE3_FLASH_NODE_DATA_MAX = (SE3_FLASH_NODE_MAX - 2)
 };
 
+/** Sector header node fields */
+enum {
+	SE3_FLASH_SECTOR_OFF_GENERATION = 0,  ///< big endian, programmed when the sector becomes the head
+	SE3_FLASH_SECTOR_OFF_ERASE_COUNT = 4,
+	SE3_FLASH_SECTOR_HEADER_SIZE = 8
+};
+
+/** Generation of a sector which is not part of the log yet */
+#define SE3_FLASH_GENERATION_NONE (0xFFFFFFFF)
+
+/** Sector states */
+enum {
+	SE3_FLASH_SECTOR_DIRTY = 0,  ///< must be erased
+	SE3_FLASH_SECTOR_FREE = 1,  ///< erased, not part of the log yet
+	SE3_FLASH_SECTOR_LOG = 2,  ///< part of the log
+	SE3_FLASH_SECTOR_ERASING = 3  ///< erase running in background, see se3_flash_compact_step
+};
+
+/** Garbage collection states */
+enum {
+	SE3_FLASH_GC_IDLE = 0,
+	SE3_FLASH_GC_COPY = 1  ///< moving live nodes out of the victim sector
+};
+
+/** Collect garbage in background when there are fewer free sectors than this, the last one is reserved */
+#define SE3_FLASH_GC_FREE_SECTORS (2)
+
+/** Collect a sector in background only if it holds at least this amount of invalid bytes */
+#define SE3_FLASH_GC_THRESHOLD (16*1024)
+
+/** \brief Garbage collection state
+ *
+ *  Live nodes are moved to the head one at a time while the device is idle,
+ *  so that se3_flash_it_new does not have to copy a whole sector.
+ */
+typedef struct SE3_FLASH_GC_ {
+	uint8_t state;  ///< one of SE3_FLASH_GC_*
+	size_t victim;  ///< sector being collected
+	size_t pos;  ///< next index position to be moved from the victim
+	bool paused;  ///< background collection suspended, see se3_flash_compact_pause
+} SE3_FLASH_GC;
+
 /** \brief Initialize flash
  *  
- *  Selects the active flash sector or initializes one
+ *  Scans all the sectors, selects the head of the log or initializes one
  */
 bool se3_flash_init();
 
+/** \brief Advance the background garbage collection
+ *
+ *  Performs one unit of work: erase a dirty sector, or move one live node of the
+ *  victim sector to the head. When the victim holds no more live nodes it becomes dirty.
+ *  Must be called only while no command is being executed.
+ *  \remark The 128 KB sector erase takes 1-2 s. Sectors 20 to 23 are in flash bank 2: their erase
+ *  is started with an interrupt and this call returns, the next calls complete it once it has
+ *  ended. Meanwhile the code keeps running from bank 1, but a read of another bank 2 sector
+ *  stalls until the erase ends, and a write waits for it. Sectors 10 and 11 are in bank 1,
+ *  which holds the code: their erase is not bounded, execution stalls until it completes and a
+ *  request that arrives meanwhile waits for it.
+ *  \return true if some work has been done, false if there is nothing to do or a flash operation fails
+ */
+bool se3_flash_compact_step();
+
+/** \brief Suspend or resume the background garbage collection
+ *
+ *  While suspended, se3_flash_compact_step does nothing, so that node positions (and the
+ *  epoch) only change when a write needs space. Used to keep a key listing cursor valid.
+ *  \param pause true to suspend, false to resume
+ */
+void se3_flash_compact_pause(bool pause);
+
 /** \brief Initialize flash iterator
  *  
  *  \param it flash iterator structure
  */
 void se3_flash_it_init(se3_flash_it* it);
 
+/** \brief Resume flash iteration
+ *
+ *  The next call to se3_flash_it_next returns the first node at or after the given position
+ *  \param it flash iterator structure
+ *  \param pos index position of the node (se3_flash_it.pos)
+ */
+void se3_flash_it_seek(se3_flash_it* it, size_t pos);
+
 /** \brief Increment flash iterator
  *  
  *  Increment iterator and read information of the next node in flash
@@ -129,11 +231,23 @@ bool se3_flash_pos_delete(size_t pos);
 /** \brief Get unused space
  *
  *  Get unused space in the flash memory, including the space marked as invalid.
- *  If space is available, it does not mean that flash sectors will not be swapped.
+ *  If space is available, it does not mean that the garbage collector will not run.
  *  \return unused space in bytes
  */
 size_t se3_flash_unused();
 
+/** \brief Get the space written in the log
+ *
+ *  \return bytes written to the sectors of the log by valid and invalid nodes, sector headers excluded
+ */
+size_t se3_flash_allocated();
+
+/** \brief Get the space available to nodes
+ *
+ *  \return bytes of the sectors of the log, the one kept free for the garbage collector excluded
+ */
+size_t se3_flash_capacity();
+
 /** \brief Check if enough space for new node
  *
  *  Check if there is enough space
@@ -144,11 +258,12 @@ bool se3_flash_canfit(size_t size);
 
 /** \brief Initialize flash structures
  *
- *  Initializes the structures for flash management, selecting a sector and its base address.
- *  \param sector active sector number
- *  \param base active sector base address
+ *  Initializes the structures for flash management of a sector, which is marked as dirty.
+ *  \param n index of the sector in the log
+ *  \param sector hardware sector number
+ *  \param base sector base address
  */
-void se3_flash_info_setup(uint32_t sector, const uint8_t* base);
+void se3_flash_info_setup(size_t n, uint32_t sector, const uint8_t* base);
 
 /** \brief Initialize flash structures
  *
@@ -14,6 +14,15 @@ enum {
 	SE3_KEY_OFFSET_DATA = 12
 };
 
+/** Fingerprints of the key nodes, for a single salt and flash epoch */
+static struct {
+	bool valid;
+	uint32_t epoch;
+	uint8_t salt[SE3_KEY_SALT_SIZE];
+	uint16_t pos[SE3_KEY_FINGERPRINT_CACHE_SIZE];
+	uint8_t fingerprint[SE3_KEY_FINGERPRINT_CACHE_SIZE][SE3_KEY_FINGERPRINT_SIZE];
+} fingerprint_cache;
+
 bool se3_key_find(uint32_t id, se3_flash_it* it)
 {
     uint32_t key_id = 0;
@@ -137,3 +146,26 @@ void se3_key_fingerprint(se3_flash_key* key, const uint8_t* salt, uint8_t* finge
 {
 	PBKDF2HmacSha256(key->data, key->data_size, salt, SE3_KEY_SALT_SIZE, 1, fingerprint, SE3_KEY_FINGERPRINT_SIZE);
 }
+
+void se3_key_fingerprint_cached(se3_flash_it* it, const uint8_t* salt, uint8_t* fingerprint)
+{
+	size_t i = it->pos % SE3_KEY_FINGERPRINT_CACHE_SIZE;
+	uint16_t data_size;
+
+	if (!fingerprint_cache.valid || fingerprint_cache.epoch != flash.epoch ||
+		memcmp(fingerprint_cache.salt, salt, SE3_KEY_SALT_SIZE))
+	{
+		memset(fingerprint_cache.pos, 0xFF, sizeof(fingerprint_cache.pos));
+		memcpy(fingerprint_cache.salt, salt, SE3_KEY_SALT_SIZE);
+		fingerprint_cache.epoch = flash.epoch;
+		fingerprint_cache.valid = true;
+	}
+	// a position is never reused by another node within the same epoch
+	if (fingerprint_cache.pos[i] != it->pos) {
+		SE3_GET16(it->addr, SE3_KEY_OFFSET_DATALEN, data_size);
+		PBKDF2HmacSha256(it->addr + SE3_KEY_OFFSET_DATA, data_size, salt, SE3_KEY_SALT_SIZE, 1,
+			fingerprint_cache.fingerprint[i], SE3_KEY_FINGERPRINT_SIZE);
+		fingerprint_cache.pos[i] = (uint16_t)it->pos;
+	}
+	memcpy(fingerprint, fingerprint_cache.fingerprint[i], SE3_KEY_FINGERPRINT_SIZE);
+}
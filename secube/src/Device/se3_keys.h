@@ -9,6 +9,7 @@
 #include "se3_flash.h"
 #include "pbkdf2.h"
 #define SE3_TYPE_KEY 100
+#define SE3_KEY_FINGERPRINT_CACHE_SIZE 64
 /** \brief Flash key structure
  *  
  *  Disposition of the fields within the flash node:
@@ -119,7 +120,12 @@ bool se3_key_write(se3_flash_it* it, se3_flash_key* key);
  */
 void se3_key_fingerprint(se3_flash_key* key, const uint8_t* salt, uint8_t* fingerprint);
 
-
-
-
-
+/** \brief Produce salted key fingerprint, using a cache
+ *
+ *  The key data is read directly from flash. Fingerprints are cached by node position
+ *  for the last salt used, until the garbage collector moves a node.
+ *  \param it a flash iterator pointing to the key
+ *  \param salt a 32-byte salt
+ *  \param fingerprint output 32-byte fingerprint of the key data
+ */
+void se3_key_fingerprint_cached(se3_flash_it* it, const uint8_t* salt, uint8_t* fingerprint);
@@ -0,0 +1,202 @@
+/**
+ *  \file se3_log.c
+ *  \brief Binary event log of the device, kept in a RAM ring and written to the SD card when idle
+ *
+ *  \details Writers reserve a slot by advancing head with a compare and swap, fill it and
+ *  publish it by storing its sequence number plus one in stamp; the main loop is the only reader and
+ *  takes the published slots in order from tail.
+ */
+
+#include "se3_log.h"
+
+#ifdef SE3_LOG_SD
+
+#include "se3_bench.h"
+#include "se3_rand.h"
+#include "se3_sdio.h"
+#ifndef CUBESIM
+#include "stm32f4xx.h"
+#endif
+
+enum {
+	SE3_LOG_RING = 256,  ///< events kept in RAM, a power of two
+	SE3_LOG_BATCH = 4  ///< blocks written at once
+};
+
+/** Cycle counter frequency when the core clock is not known */
+#define SE3_LOG_HZ_DEFAULT (168000000)
+
+typedef struct se3_log_slot_ {
+	uint32_t stamp;  ///< sequence number of the event plus one, once written
+	uint32_t time;
+	uint32_t arg0;
+	uint32_t arg1;
+	uint16_t id;
+} se3_log_slot;
+
+static struct {
+	se3_log_slot ring[SE3_LOG_RING];
+	uint32_t head;  ///< events reserved
+	uint32_t tail;  ///< events taken by the main loop
+	uint32_t dropped;  ///< events lost since the last block
+	uint32_t boot;
+	uint32_t seq;  ///< blocks written
+	uint32_t block;  ///< next block, from SE3_LOG_SD_FIRST
+	uint32_t buf[SE3_LOG_BATCH * SE3_LOG_BLOCK_SIZE / sizeof(uint32_t)];  ///< word aligned for the DMA
+} se3_log;
+
+static uint32_t se3_log_hz()
+{
+#ifdef CUBESIM
+	return SE3_LOG_HZ_DEFAULT;
+#else
+	return SystemCoreClock;
+#endif
+}
+
+/** \brief Mask the USB interrupt, which also reads and writes the card, during an SD transfer */
+static void se3_log_sd_lock(bool lock)
+{
+#ifndef CUBESIM
+	if (lock) {
+		NVIC_DisableIRQ(OTG_HS_IRQn);
+	}
+	else {
+		NVIC_EnableIRQ(OTG_HS_IRQn);
+	}
+#endif
+}
+
+/** \brief Boot ID when the RNG fails
+ *
+ *  One more than the ID in the first block of the range, which the previous boot wrote, so that
+ *  the decoder does not merge the two boots; the cycle counter if the block is not a log block.
+ */
+static uint32_t se3_log_boot_fallback()
+{
+	uint8_t* block = (uint8_t*)(se3_log.buf);
+	uint32_t magic = 0, boot = se3_cycles();
+	bool ok;
+
+	se3_log_sd_lock(true);
+	ok = secube_sdio_read(0, block, SE3_LOG_SD_FIRST, 1);
+	se3_log_sd_lock(false);
+	if (ok) {
+		SE3_GET32(block, SE3_LOG_BLOCK_OFF_MAGIC, magic);
+		if (magic == SE3_LOG_MAGIC) {
+			SE3_GET32(block, SE3_LOG_BLOCK_OFF_BOOT, boot);
+			boot++;
+		}
+	}
+	return boot;
+}
+
+void se3_log_init()
+{
+	if (sizeof(uint32_t) != se3_rand(sizeof(uint32_t), (uint8_t*)&(se3_log.boot))) {
+		se3_log.boot = se3_log_boot_fallback();
+	}
+	se3_log.seq = 0;
+	se3_log.block = 0;
+	SE3_LOG(SE3_LOG_BOOT, se3_log_hz(), 0);
+}
+
+void se3_log_event(uint16_t id, uint32_t arg0, uint32_t arg1)
+{
+	uint32_t head = __atomic_load_n(&(se3_log.head), __ATOMIC_RELAXED);
+	se3_log_slot* slot;
+
+	do {
+		if (head - __atomic_load_n(&(se3_log.tail), __ATOMIC_ACQUIRE) >= SE3_LOG_RING) {
+			__atomic_fetch_add(&(se3_log.dropped), 1, __ATOMIC_RELAXED);
+			return;
+		}
+	} while (!__atomic_compare_exchange_n(&(se3_log.head), &head, head + 1, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+
+	slot = se3_log.ring + (head % SE3_LOG_RING);
+	slot->time = se3_cycles();
+	slot->id = id;
+	slot->arg0 = arg0;
+	slot->arg1 = arg1;
+	__atomic_store_n(&(slot->stamp), head + 1, __ATOMIC_RELEASE);
+}
+
+/** \brief Published events from tail, stopping at the first one still being written */
+static uint32_t se3_log_ready()
+{
+	uint32_t head = __atomic_load_n(&(se3_log.head), __ATOMIC_ACQUIRE);
+	uint32_t n = 0;
+
+	while (se3_log.tail + n != head &&
+		__atomic_load_n(&(se3_log.ring[(se3_log.tail + n) % SE3_LOG_RING].stamp), __ATOMIC_ACQUIRE) == se3_log.tail + n + 1)
+	{
+		n++;
+	}
+	return n;
+}
+
+/** \brief Move n events to a block and release their slots */
+static void se3_log_pack(uint8_t* block, uint32_t n)
+{
+	uint32_t magic = SE3_LOG_MAGIC, hz = se3_log_hz();
+	uint32_t dropped = __atomic_exchange_n(&(se3_log.dropped), 0, __ATOMIC_RELAXED);
+	uint16_t count = (uint16_t)n, u16tmp;
+	uint8_t* p = block + SE3_LOG_BLOCK_OFF_RECORDS;
+	uint32_t i;
+
+	memset(block, 0, SE3_LOG_BLOCK_SIZE);
+	SE3_SET32(block, SE3_LOG_BLOCK_OFF_MAGIC, magic);
+	SE3_SET32(block, SE3_LOG_BLOCK_OFF_BOOT, se3_log.boot);
+	SE3_SET32(block, SE3_LOG_BLOCK_OFF_SEQ, se3_log.seq);
+	SE3_SET16(block, SE3_LOG_BLOCK_OFF_COUNT, count);
+	u16tmp = (dropped > 0xFFFF) ? (0xFFFF) : ((uint16_t)dropped);
+	SE3_SET16(block, SE3_LOG_BLOCK_OFF_DROPPED, u16tmp);
+	SE3_SET32(block, SE3_LOG_BLOCK_OFF_HZ, hz);
+
+	for (i = 0; i < n; i++, p += SE3_LOG_RECORD_SIZE) {
+		const se3_log_slot* slot = se3_log.ring + ((se3_log.tail + i) % SE3_LOG_RING);
+		u16tmp = (uint16_t)(se3_log.tail + i);
+		SE3_SET32(p, SE3_LOG_RECORD_OFF_TIME, slot->time);
+		SE3_SET16(p, SE3_LOG_RECORD_OFF_ID, slot->id);
+		SE3_SET16(p, SE3_LOG_RECORD_OFF_SEQ, u16tmp);
+		SE3_SET32(p, SE3_LOG_RECORD_OFF_ARG0, slot->arg0);
+		SE3_SET32(p, SE3_LOG_RECORD_OFF_ARG1, slot->arg1);
+	}
+	__atomic_store_n(&(se3_log.tail), se3_log.tail + n, __ATOMIC_RELEASE);
+	(se3_log.seq)++;
+}
+
+void se3_log_idle()
+{
+	uint32_t ready, n, blocks = 0;
+
+	if (__atomic_load_n(&(se3_log.head), __ATOMIC_RELAXED) == se3_log.tail) {
+		return;
+	}
+	ready = se3_log_ready();
+	if (ready == 0) {
+		return;
+	}
+	// wait for a full batch, unless the oldest event has waited for a second
+	if (ready < SE3_LOG_BATCH * SE3_LOG_BLOCK_RECORDS &&
+		se3_cycles() - se3_log.ring[se3_log.tail % SE3_LOG_RING].time < se3_log_hz())
+	{
+		return;
+	}
+
+	// the batch does not wrap around the end of the range
+	while (ready > 0 && blocks < SE3_LOG_BATCH && se3_log.block + blocks < SE3_LOG_SD_BLOCKS) {
+		n = (ready < SE3_LOG_BLOCK_RECORDS) ? (ready) : (SE3_LOG_BLOCK_RECORDS);
+		se3_log_pack((uint8_t*)(se3_log.buf) + blocks * SE3_LOG_BLOCK_SIZE, n);
+		ready -= n;
+		blocks++;
+	}
+
+	// a failure is logged by secube_sdio_write, the blocks are lost
+	se3_log_sd_lock(true);
+	secube_sdio_write(0, (const uint8_t*)(se3_log.buf), SE3_LOG_SD_FIRST + se3_log.block, (uint16_t)blocks);
+	se3_log_sd_lock(false);
+	se3_log.block = (se3_log.block + blocks) % SE3_LOG_SD_BLOCKS;
+}
+
+#endif
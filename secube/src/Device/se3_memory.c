@@ -41,6 +41,8 @@ void se3_mem_init(se3_mem* mem, size_t index_size, uint8_t** index, size_t buf_s
     nblocks = (uint16_t)(buf_size / SE3_MEM_BLOCK);
     mem->dat_size = nblocks;
     mem->dat = buf;
+    mem->peak = 0;
+    mem->defrags = 0;
 
     se3_mem_reset(mem);
 }
@@ -196,6 +198,8 @@ int32_t se3_mem_alloc(se3_mem* mem, size_t size)
 	if (p >= dat_end) {
         // there enough free memory but it is fragmented
 		p = se3_mem_defrag(mem);
+		(mem->defrags)++;
+		SE3_LOG(SE3_LOG_MEM_DEFRAG, mem->used, 0);
 		SE3_TRACE(("[se3_mem_alloc] defragging session memory\n"));
 
 		if (p < dat_end) {
@@ -220,6 +224,9 @@ int32_t se3_mem_alloc(se3_mem* mem, size_t size)
     // update index
 	mem->ptr[i] = p;
 	(mem->used) += nblocks;
+	if (mem->used > mem->peak) {
+		mem->peak = mem->used;
+	}
 
 	return (int32_t)i;
 }
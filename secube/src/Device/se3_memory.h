@@ -14,6 +14,8 @@ typedef struct se3_mem_ {
 	uint8_t* dat;
 	size_t dat_size;
 	size_t used;
+	size_t peak;  ///< highest used, in blocks
+	uint32_t defrags;  ///< times the buffer has been defragmented
 } se3_mem;
 
 enum {
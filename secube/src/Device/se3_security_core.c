@@ -6,12 +6,18 @@
  */
 
 #include "se3_security_core.h"
+#include "se3_core.h"
 #include "se3_flash.h"
 #include "se3_algo_Aes.h"
 #include "se3_algo_sha256.h"
 #include "se3_algo_HmacSha256.h"
 #include "se3_algo_AesHmacSha256s.h"
 #include "se3_algo_aes256hmacsha256.h"
+#include "se3_algo_AesGcm.h"
+#include "se3_algo_ChaCha20Poly1305.h"
+#include "se3_algo_AesCmac.h"
+#include "se3_algo_AesXts.h"
+#include "se3_algo_AesKw.h"
 
 /* Cryptographic algorithms handlers and display info for the security core ONLY. */
 se3_algo_descriptor algo_table[SE3_ALGO_MAX] = {
@@ -55,9 +61,46 @@ se3_algo_descriptor algo_table[SE3_ALGO_MAX] = {
 		SE3_CRYPTO_TYPE_BLOCKCIPHER_AUTH,
 		B5_AES_BLK_SIZE,
 		B5_AES_256 },
-	{ NULL, NULL, 0, "", 0, 0, 0 },
-	{ NULL, NULL, 0, "", 0, 0, 0 },
-	{ NULL, NULL, 0, "", 0, 0, 0 }
+	{
+		se3_algo_AesGcm_init,
+		se3_algo_AesGcm_update,
+		sizeof(B5_tGcmAesCtx),
+		"AesGcm",
+		SE3_CRYPTO_TYPE_BLOCKCIPHER_AUTH,
+		B5_AES_BLK_SIZE,
+		B5_AES_256 },
+	{
+		se3_algo_ChaCha20Poly1305_init,
+		se3_algo_ChaCha20Poly1305_update,
+		sizeof(B5_tChaCha20Poly1305Ctx),
+		"ChaCha20Poly1305",
+		SE3_CRYPTO_TYPE_BLOCKCIPHER_AUTH,
+		B5_CHACHA20_BLK_SIZE,
+		B5_CHACHA20_KEY_SIZE },
+	{
+		se3_algo_AesCmac_init,
+		se3_algo_AesCmac_update,
+		sizeof(B5_tCmacAesCtx),
+		"AesCmac",
+		SE3_CRYPTO_TYPE_DIGEST,
+		B5_CMAC_AES_BLK_SIZE,
+		B5_AES_256 },
+	{
+		se3_algo_AesXts_init,
+		se3_algo_AesXts_update,
+		sizeof(B5_tXtsAesCtx),
+		"AesXts",
+		SE3_CRYPTO_TYPE_BLOCKCIPHER,
+		SE3_CRYPTO_XTS_SECTOR_SIZE,
+		B5_XTS_AES_256 },
+	{
+		se3_algo_AesKw_init,
+		se3_algo_AesKw_update,
+		sizeof(B5_tKwAesCtx),
+		"AesKw",
+		SE3_CRYPTO_TYPE_OTHER,
+		B5_KW_AES_SEMIBLK_SIZE,
+		B5_AES_256 }
 };
 
 union {
@@ -70,11 +113,33 @@ void se3_security_core_init(){
     memset((void*)&se3_security_info, 0, sizeof(SE3_SECURITY_INFO));
 }
 
-static bool record_find(uint16_t record_type, se3_flash_it* it)
+/** RAM copy of the configuration records, so that reading them does not scan the flash */
+static struct {
+    bool valid[SE3_RECORD_MAX];  ///< record has been written
+    size_t pos[SE3_RECORD_MAX];  ///< position of the record node in the flash index
+    uint32_t epoch[SE3_RECORD_MAX];  ///< flash epoch in which pos is valid
+    uint8_t data[SE3_RECORD_MAX][SE3_RECORD_SIZE];
+} records;
+
+void record_load(const se3_flash_it* it)
+{
+    uint16_t type = 0;
+    SE3_GET16(it->addr, SE3_RECORD_OFFSET_TYPE, type);
+    if (type >= SE3_RECORD_MAX) {
+        return;
+    }
+    // nodes are visited in write order, the last one is the most recent
+    memcpy(records.data[type], it->addr + SE3_RECORD_OFFSET_DATA, SE3_RECORD_SIZE);
+    records.pos[type] = it->pos;
+    records.epoch[type] = flash.epoch;
+    records.valid[type] = true;
+}
+
+static bool record_find(uint16_t record_type, size_t skip_pos, se3_flash_it* it)
 {
     uint16_t it_record_type = 0;
     while (se3_flash_it_next(it)) {
-        if (it->type == SE3_FLASH_TYPE_RECORD) {
+        if (it->type == SE3_FLASH_TYPE_RECORD && it->pos != skip_pos) {
             SE3_GET16(it->addr, SE3_RECORD_OFFSET_TYPE, it_record_type);
             if (it_record_type == record_type) {
                 return true;
@@ -87,34 +152,50 @@ static bool record_find(uint16_t record_type, se3_flash_it* it)
 bool record_set(uint16_t type, const uint8_t* data)
 {
     se3_flash_it it;
-    bool found = false;
-    se3_flash_it it2;
     uint8_t tmp[2];
+    uint32_t epoch;
+    bool found;
+    size_t old_pos;
     if (type >= SE3_RECORD_MAX) {
         return false;
     }
-    se3_flash_it_init(&it);
-    if (record_find(type, &it)) {
-        found = true;
+    if (records.valid[type] && !memcmp(records.data[type], data, SE3_RECORD_SIZE)) {
+        return true;
     }
+    found = records.valid[type];
+    old_pos = records.pos[type];
+    epoch = records.epoch[type];
 
     // allocate new flash block
-    memcpy(&it2, &it, sizeof(se3_flash_it));
-    if (!se3_flash_it_new(&it2, SE3_FLASH_TYPE_RECORD, SE3_RECORD_SIZE_TYPE + SE3_RECORD_SIZE)) {
+    se3_flash_it_init(&it);
+    if (!se3_flash_it_new(&it, SE3_FLASH_TYPE_RECORD, SE3_RECORD_SIZE_TYPE + SE3_RECORD_SIZE)) {
         return false;
     }
-    // write record type and data
-    if (!se3_flash_it_write(&it2, SE3_RECORD_OFFSET_DATA, data, SE3_RECORD_SIZE)) {
+    // write record data, then type: the record is valid only when complete
+    if (!se3_flash_it_write(&it, SE3_RECORD_OFFSET_DATA, data, SE3_RECORD_SIZE)) {
         return false;
     }
     SE3_SET16(tmp, 0, type);
-    if (!se3_flash_it_write(&it2, SE3_RECORD_OFFSET_TYPE, tmp, SE3_RECORD_SIZE_TYPE)) {
+    if (!se3_flash_it_write(&it, SE3_RECORD_OFFSET_TYPE, tmp, SE3_RECORD_SIZE_TYPE)) {
         return false;
     }
 
+    // commit to RAM only when the new record is in flash
+    memcpy(records.data[type], data, SE3_RECORD_SIZE);
+    records.pos[type] = it.pos;
+    records.epoch[type] = flash.epoch;
+    records.valid[type] = true;
+
     if (found) {
-        // delete previously found flash block
-        if (!se3_flash_it_delete(&it)) {
+        // delete previous flash block, which may have been moved by the garbage collector
+        if (epoch != flash.epoch) {
+            se3_flash_it_init(&it);
+            if (!record_find(type, records.pos[type], &it)) {
+                return true;
+            }
+            old_pos = it.pos;
+        }
+        if (!se3_flash_pos_delete(old_pos)) {
             return false;
         }
     }
@@ -124,15 +205,13 @@ bool record_set(uint16_t type, const uint8_t* data)
 
 bool record_get(uint16_t type, uint8_t* data)
 {
-    se3_flash_it it;
     if (type >= SE3_RECORD_MAX) {
         return false;
     }
-    se3_flash_it_init(&it);
-    if (!record_find(type, &it)) {
+    if (!records.valid[type]) {
         return false;
     }
-    memcpy(data, it.addr + SE3_RECORD_OFFSET_DATA, SE3_RECORD_SIZE);
+    memcpy(data, records.data[type], SE3_RECORD_SIZE);
     return true;
 }
 
@@ -339,6 +418,9 @@ uint16_t crypto_update(uint16_t req_size, const uint8_t* req, uint16_t* resp_siz
     if (req_params.flags & SE3_CRYPTO_FLAG_FINIT) {
         se3_mem_free(&(se3_security_info.sessions), (int32_t)req_params.sid);
     }
+    if (algo < SE3_STATS_ALGO_COUNT) {
+        se3_counters.algo_bytes[algo] += (uint32_t)req_params.datain1_len + req_params.datain2_len;
+    }
 
     SE3_SET16(resp, SE3_CMD1_CRYPTO_UPDATE_RESP_OFF_DATAOUT_LEN, resp_params.dataout_len);
     *resp_size = SE3_CMD1_CRYPTO_UPDATE_RESP_OFF_DATA + resp_params.dataout_len;
@@ -418,25 +500,13 @@ uint16_t crypto_list(uint16_t req_size, const uint8_t* req, uint16_t* resp_size,
     return SE3_OK;
 }
 
-void se3_payload_cryptoinit(se3_payload_cryptoctx* ctx, const uint8_t* key)
-{
-	uint8_t keys[2 * B5_AES_256];
-
-	PBKDF2HmacSha256(key, B5_AES_256, NULL, 0, 1, keys, 2 * B5_AES_256);
-    B5_Aes256_Init(&(ctx->aesenc), keys, B5_AES_256, B5_AES256_CBC_ENC);
-    B5_Aes256_Init(&(ctx->aesdec), keys, B5_AES_256, B5_AES256_CBC_DEC);
-	memcpy(ctx->hmac_key, keys + B5_AES_256, B5_AES_256);
-	memset(keys, 0, 2 * B5_AES_256);
-}
-
 bool se3_payload_encrypt(se3_payload_cryptoctx* ctx, uint8_t* auth, uint8_t* iv, uint8_t* data, uint16_t nblocks, uint16_t flags, uint8_t crypto_algo)
 {
 	switch(crypto_algo){
 		case SE3_AES256:
-		    if (flags & SE3_CMDFLAG_ENCRYPT) {
-		        B5_Aes256_SetIV(&(ctx->aesenc), iv);
-		        B5_Aes256_Update(&(ctx->aesenc), data, data, nblocks);
-		    } break;
+			// encryption and MAC in one pass, see se3_payload.c
+			se3_payload_seal(ctx, auth, iv, data, nblocks, flags);
+			break;
 
 		case SE3_CRC16:
 			//to be implemented
@@ -450,37 +520,18 @@ bool se3_payload_encrypt(se3_payload_cryptoctx* ctx, uint8_t* auth, uint8_t* iv,
 		default: return false; break;
 	}
 
-    if (flags & SE3_CMDFLAG_SIGN) {
-        B5_HmacSha256_Init(&(ctx->hmac), ctx->hmac_key, B5_AES_256);
-        B5_HmacSha256_Update(&(ctx->hmac), iv, B5_AES_IV_SIZE);
-        B5_HmacSha256_Update(&(ctx->hmac), data, nblocks*B5_AES_BLK_SIZE);
-        B5_HmacSha256_Finit(&(ctx->hmac), ctx->auth);
-        memcpy(auth, ctx->auth, 16);
-    }
-    else {
-        memset(auth, 0, 16);
-    }
     return true;
 }
 
 bool se3_payload_decrypt(se3_payload_cryptoctx* ctx, const uint8_t* auth, const uint8_t* iv, uint8_t* data, uint16_t nblocks, uint16_t flags, uint8_t crypto_algo)
 {
-    if (flags & SE3_CMDFLAG_SIGN) {
-        B5_HmacSha256_Init(&(ctx->hmac), ctx->hmac_key, B5_AES_256);
-        B5_HmacSha256_Update(&(ctx->hmac), iv, B5_AES_IV_SIZE);
-        B5_HmacSha256_Update(&(ctx->hmac), data, nblocks*B5_AES_BLK_SIZE);
-        B5_HmacSha256_Finit(&(ctx->hmac), ctx->auth);
-        if (memcmp(auth, ctx->auth, 16)) {
-            return false;
-        }
-    }
-
 	switch(crypto_algo){
 		case SE3_AES256:
-		    if (flags & SE3_CMDFLAG_ENCRYPT) {
-		        B5_Aes256_SetIV(&(ctx->aesdec), iv);
-		        B5_Aes256_Update(&(ctx->aesdec), data, data, nblocks);
-		    } break;
+			// the tag is checked while decrypting, see se3_payload.c
+			if (!se3_payload_open(ctx, auth, iv, data, nblocks, flags)) {
+				return false;
+			}
+			break;
 
 		case SE3_CRC16:
 			//to be implemented
@@ -12,6 +12,7 @@
 #include "aes256.h"
 #include "sha256.h"
 #include "pbkdf2.h"
+#include "se3_payload.h"
 
 enum {
 	SE3_SESSIONS_BUF = (32*1024),  ///< session buffer size
@@ -72,14 +73,6 @@ typedef struct se3_algo_descriptor_ {
 	uint16_t display_key_size;  ///< key size for the algorithm list API
 } se3_algo_descriptor;
 
-typedef struct se3_payload_cryptoctx_ {
-	B5_tAesCtx aesenc;
-    B5_tAesCtx aesdec;
-	B5_tHmacSha256Ctx hmac;
-	uint8_t hmac_key[B5_AES_256];
-    uint8_t auth[B5_SHA256_DIGEST_SIZE];
-} se3_payload_cryptoctx;
-
 /** \brief Write record
  *
  *  Set data of a record
@@ -90,6 +83,13 @@ typedef struct se3_payload_cryptoctx_ {
  */
 bool record_set(uint16_t type, const uint8_t* data);
 
+/** \brief Load record from flash
+ *
+ *  Called by se3_flash_init for each record node, to populate the RAM copy of the records
+ *  \param it a flash iterator pointing to the record
+ */
+void record_load(const se3_flash_it* it);
+
 /** \brief Read record
 *
 *  Get data of a record.
@@ -125,18 +125,18 @@ uint16_t crypto_set_time(uint16_t req_size, const uint8_t* req, uint16_t* resp_s
  */
 uint16_t crypto_list(uint16_t req_size, const uint8_t* req, uint16_t* resp_size, uint8_t* resp);
 
-/** \brief Security Core initialization
+/** \brief Whether the request being handled was both encrypted and signed
  *
- *  Inizialitazion of Security Core data structures
+ *  Crypto handlers whose response carries clear keys refuse requests without
+ *  this protection. Implemented by the dispatcher, which holds the request header.
  */
-void se3_security_core_init();
-
+bool se3_request_protected();
 
-/** \brief Crypto algo initializator
+/** \brief Security Core initialization
  *
- *  Initialise the cryptographics algorithms
+ *  Inizialitazion of Security Core data structures
  */
-void se3_payload_cryptoinit(se3_payload_cryptoctx* ctx, const uint8_t* key);
+void se3_security_core_init();
 
 
 /** \brief data buffer encrypt function
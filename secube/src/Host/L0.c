@@ -8,10 +8,20 @@ static uint16_t L0_RX(se3_device* device, uint16_t* resp_status, uint16_t* resp_
 #include "se3_proto.h"
 
 bool se3c_write_sim(uint8_t* buf, se3_file hfile, size_t block, size_t nblocks, uint32_t timeout) {
-    se3_proto_recv(1, buf, (uint32_t)(101 + block), (uint16_t)nblocks); return true;
+    uint64_t start = (se3_capture_active()) ? (se3c_clock_us()) : (0);
+    se3_proto_recv(1, buf, (uint32_t)(101 + block), (uint16_t)nblocks);
+    if (se3_capture_active()) {
+        se3_capture_blocks(SE3_CAPTURE_WRITE, buf, block, nblocks, true, start, se3c_clock_us());
+    }
+    return true;
 }
 bool se3c_read_sim(uint8_t* buf, se3_file hfile, size_t block, size_t nblocks, uint32_t timeout) {
-    se3_proto_send(1, buf, (uint32_t)(101 + block), (uint16_t)nblocks); return true;
+    uint64_t start = (se3_capture_active()) ? (se3c_clock_us()) : (0);
+    se3_proto_send(1, buf, (uint32_t)(101 + block), (uint16_t)nblocks);
+    if (se3_capture_active()) {
+        se3_capture_blocks(SE3_CAPTURE_READ, buf, block, nblocks, true, start, se3c_clock_us());
+    }
+    return true;
 }
 uint16_t L0_open_sim(se3_device* s) {
 	uint8_t* buf = NULL;
@@ -40,6 +50,7 @@ uint16_t L0_open_sim(se3_device* s) {
  */
 uint16_t L0_TXRX(se3_device* device, uint16_t req_cmd, uint16_t req_cmdflags, uint16_t req_len, const uint8_t* req_data, uint16_t* resp_status, uint16_t* resp_len, uint8_t* resp_data) {
 	uint16_t error = 0;   // error value
+	uint64_t start = 0, sent = 0;
 
 	/* Check parameters are valid */
 	if (device == NULL ||
@@ -49,23 +60,38 @@ uint16_t L0_TXRX(se3_device* device, uint16_t req_cmd, uint16_t req_cmdflags, ui
 	}
 	/* */
 
+	if (device->metrics != NULL) {
+		// L1 requests are measured and added by L1, which has already started
+		if (req_cmd != SE3_CMD0_L1) {
+			se3_metrics_sample_reset(&(device->sample));
+		}
+		start = se3c_clock_us();
+	}
+
 	/* Send Request */
 	error = L0_TX(device, req_cmd, req_cmdflags, req_len, req_data);
-    if (error != SE3_OK) {
-        return(error);
-    }
-	/* */
-
-
-	/* Receive Response */
-	error = L0_RX(device, resp_status, resp_len, resp_data);
-    if (error != SE3_OK) {
-        return(error);
-    }
+	if (device->metrics != NULL) {
+		sent = se3c_clock_us();
+		se3_metrics_sample_set(&(device->sample), SE3_METRICS_WRITE_US, sent - start);
+	}
+	if (error == SE3_OK) {
+		/* Receive Response */
+		error = L0_RX(device, resp_status, resp_len, resp_data);
+	}
 	/* */
 
+	if (device->metrics != NULL) {
+		se3_metrics_sample_set(&(device->sample), SE3_METRICS_ROUNDTRIP_US, se3c_clock_us() - start);
+		if (req_cmd != SE3_CMD0_L1) {
+			se3_metrics_sample_set(&(device->sample), SE3_METRICS_REQ_BYTES, req_len);
+			if (error == SE3_OK) {
+				se3_metrics_sample_set(&(device->sample), SE3_METRICS_RESP_BYTES, *resp_len);
+			}
+			se3_metrics_add(device->metrics, 0, req_cmd, &(device->sample), (error != SE3_OK) ? (error) : (*resp_status));
+		}
+	}
 
-	return(SE3_OK);
+	return(error);
 }
 
 
@@ -81,9 +107,11 @@ static uint16_t L0_TX(se3_device* device, uint16_t cmd, uint16_t cmd_flags, uint
 	uint32_t offset_src = 0;   // Offset for source data buffer
 	uint32_t offset_dst = 0;   // Offset for destination blocks buffer
     uint16_t len_data_and_headers = se3_req_len_data_and_headers(len);
+    uint64_t start = (device->timeline != NULL) ? se3c_clock_us() : 0;
     
 
     se3c_rand(sizeof(uint32_t), (uint8_t*)&cmd_token);
+    device->cmd_token = cmd_token;
 
 	/* Set header fields */
 	SE3_SET16(request, SE3_REQ_OFFSET_CMD, cmd);
@@ -124,6 +152,11 @@ static uint16_t L0_TX(se3_device* device, uint16_t cmd, uint16_t cmd_flags, uint
     }
 	/* */
 
+    if (device->timeline != NULL) {
+        se3_timeline_add(device->timeline, start, device->cmd_token, SE3_TIMELINE_HOST_TX_BEGIN, cmd);
+        se3_timeline_add(device->timeline, se3c_clock_us(), device->cmd_token, SE3_TIMELINE_HOST_TX_END, cmd);
+    }
+
 	return(SE3_OK);
 }
 
@@ -138,9 +171,17 @@ static uint16_t L0_RX(se3_device* device, uint16_t* resp_status, uint16_t* resp_
 	uint32_t cmdtok0, u32tmp;
 	uint64_t deadline = se3c_deadline(SE3_TIMEOUT);
     uint16_t offset_src, offset_dst;
+    uint16_t polls = 0;
+    uint64_t begin = 0, ready_time = 0, end = 0;
 #if SE3_CONF_CRC
 	uint16_t crc;
 #endif
+    if (device->timeline != NULL || device->metrics != NULL) {
+        begin = se3c_clock_us();
+    }
+    if (device->timeline != NULL) {
+        se3_timeline_add(device->timeline, begin, device->cmd_token, SE3_TIMELINE_HOST_RX_BEGIN, 0);
+    }
 	while (!ready) {
         se3c_sleep();
 		if (!se3c_read(device->response, device->f, 0, 1, SE3_TIMEOUT)) {
@@ -149,14 +190,25 @@ static uint16_t L0_RX(se3_device* device, uint16_t* resp_status, uint16_t* resp_
 		}
 		SE3_GET16(device->response, 0, u16tmp);
 		ready = (u16tmp == 1);
+        if (polls < UINT16_MAX) polls++;
 		if ((se3c_clock() > deadline) && !ready) {
 			success = false;
 			break;
 		}
 	}
+    if (device->timeline != NULL || device->metrics != NULL) {
+        ready_time = se3c_clock_us();
+    }
+    if (device->metrics != NULL) {
+        se3_metrics_sample_set(&(device->sample), SE3_METRICS_POLLS, polls);
+        se3_metrics_sample_set(&(device->sample), SE3_METRICS_WAIT_US, ready_time - begin);
+    }
     if (!success) {
         return SE3_ERR_COMM;
     }
+    if (device->timeline != NULL) {
+        se3_timeline_add(device->timeline, ready_time, device->cmd_token, SE3_TIMELINE_HOST_RX_READY, polls);
+    }
     
 	SE3_GET16(device->response, SE3_RESP_OFFSET_LEN, len_data_and_headers);
     len = se3_resp_len_data(len_data_and_headers);
@@ -218,6 +270,15 @@ static uint16_t L0_RX(se3_device* device, uint16_t* resp_status, uint16_t* resp_
 	}
 #endif
 
+    if (device->timeline != NULL || device->metrics != NULL) {
+        end = se3c_clock_us();
+    }
+    if (device->timeline != NULL) {
+        se3_timeline_add(device->timeline, end, device->cmd_token, SE3_TIMELINE_HOST_RX_END, 0);
+    }
+    if (device->metrics != NULL) {
+        se3_metrics_sample_set(&(device->sample), SE3_METRICS_READ_US, end - ready_time);
+    }
 	return SE3_OK;
 }
 
@@ -248,6 +309,67 @@ uint16_t L0_factoryinit(se3_device* device, const uint8_t* serialno) {
 
 
 
+uint16_t L0_stats(se3_device* device, bool reset, se3_stats* stats) {
+    uint16_t resp_status = 0, resp_len = 0;
+	uint16_t error = 0;
+	uint16_t flags = reset ? SE3_STATS_FLAG_RESET : 0;
+	uint8_t req[SE3_STATS_REQ_SIZE];
+	uint8_t resp[SE3_STATS_SIZE];
+
+	SE3_SET16(req, SE3_STATS_REQ_OFF_FLAGS, flags);
+	resp_len = SE3_STATS_SIZE;
+	error = L0_TXRX(device, SE3_CMD0_STATS, 0, SE3_STATS_REQ_SIZE, req, &resp_status, &resp_len, resp);
+	if (error != SE3_OK) return(error);
+	if (resp_status != SE3_OK) return(resp_status);
+	if (resp_len < SE3_STATS_SIZE || !se3_stats_decode(stats, resp)) return(SE3_ERR_COMM);
+
+	return(SE3_OK);
+}
+
+void L0_timeline_attach(se3_device* device, se3_timeline* timeline) {
+	device->timeline = timeline;
+}
+
+void L0_metrics_attach(se3_device* device, se3_metrics* metrics) {
+	device->metrics = metrics;
+}
+
+uint16_t L0_timeline_read(se3_device* device, se3_timeline_event* events, uint16_t max, uint16_t* count, uint32_t* dropped) {
+    uint16_t resp_status = 0, resp_len = 0;
+	uint16_t error = 0;
+	uint8_t req[SE3_TIMELINE_REQ_SIZE];
+	uint8_t resp[SE3_TIMELINE_SIZE_MAX];
+	uint32_t now = 0, hz = 0;
+	uint64_t t0, t1, mid;
+	uint16_t i;
+
+	if (max > SE3_TIMELINE_DEVICE_EVENTS) {
+		max = SE3_TIMELINE_DEVICE_EVENTS;
+	}
+	SE3_SET16(req, SE3_TIMELINE_REQ_OFF_MAX, max);
+	resp_len = SE3_TIMELINE_SIZE_MAX;
+	t0 = se3c_clock_us();
+	error = L0_TXRX(device, SE3_CMD0_TIMELINE, 0, SE3_TIMELINE_REQ_SIZE, req, &resp_status, &resp_len, resp);
+	t1 = se3c_clock_us();
+	if (error != SE3_OK) return(error);
+	if (resp_status != SE3_OK) return(resp_status);
+	if (!se3_timeline_decode(resp, resp_len, count, dropped, &now, &hz) || *count > max) return(SE3_ERR_COMM);
+
+	// cycles to host microseconds, relative to the sample of the cycle counter
+	if (hz == 0) {
+		hz = SE3_TIMELINE_HZ_DEFAULT;
+	}
+	mid = t0 + (t1 - t0) / 2;
+	for (i = 0; i < *count; i++) {
+		se3_timeline_decode_event(resp, i, &(events[i]));
+		events[i].time = mid - ((uint64_t)(now - (uint32_t)events[i].time) * 1000000) / hz;
+	}
+
+	return(SE3_OK);
+}
+
+
+
 void L0_discover_init(se3_disco_it* it) {
 	se3c_drive_init(&(it->_drive_it));
 }
@@ -292,7 +414,14 @@ uint16_t L0_open(se3_device* dev, se3_device_info* dev_info, uint32_t timeout)
 {
 	se3_file hfile;
 	se3_discover_info discov_nfo;
+#ifdef SE3_CAPTURE_ENABLE
+	const char* capture_path = getenv(SE3_CAPTURE_ENV);
 
+    // capture without changing the application, in the builds which enable it
+    if (capture_path != NULL && *capture_path != '\0' && !se3_capture_active()) {
+        se3_capture_open(capture_path);
+    }
+#endif
     memset(dev, 0, sizeof(se3_device));
     memcpy(&(dev->info), dev_info, sizeof(se3_device_info));
 
@@ -9,6 +9,10 @@
 #include "se3_common.h"
 #include "se3comm.h"
 #include "crc16.h"
+#include "se3_stats.h"
+#include "se3_timeline.h"
+#include "se3_metrics.h"
+#include "se3_capture.h"
 
 
 #ifdef __cplusplus
@@ -30,6 +34,10 @@ typedef struct se3_device_ {
     uint8_t* response;
 	se3_file f;
     bool opened;
+    se3_timeline* timeline;  ///< host events of the requests, NULL if not recorded
+    uint32_t cmd_token;  ///< command token of the last request
+    se3_metrics* metrics;  ///< histograms of the requests, NULL if not recorded
+    se3_metrics_sample sample;  ///< measures of the request in progress
 } se3_device;
 
 /** \brief Discovery iterator */
@@ -56,6 +64,9 @@ uint16_t L0_open_sim(se3_device* s);
 #define SE3_RES_SIZE_HEADER   (32)
 
 #define SE3_SIZE_PAYLOAD_MAX   ((SE3_COMM_BLOCK * SE3_NBLOCKS) - SE3_REQ_SIZE_HEADER - (SE3_COMM_BLOCK * SE3_REQDATA_SIZE_HEADER))
+
+/** Cycle counter frequency assumed when the device does not report it (simulator) */
+#define SE3_TIMELINE_HZ_DEFAULT   (168000000)
 /* */
 
 /**
@@ -99,6 +110,62 @@ uint16_t L0_echo(se3_device* device, const uint8_t* data_in, uint16_t data_in_le
  */
 uint16_t L0_factoryinit(se3_device* device, const uint8_t* serialno);
 
+/**
+ *  \brief Read the performance counters of the device
+ *  
+ *  \param [in] device pointer to SEcube device structure
+ *  \param [in] reset Clear the counters after reading them
+ *  \param [out] stats Counters, see \ref se3_stats.h
+ *  \return Error code or SE3_OK
+ *  
+ *  \details No login is required. SE3_ERR_CMD is returned by firmwares without the command.
+ */
+uint16_t L0_stats(se3_device* device, bool reset, se3_stats* stats);
+
+/**
+ *  \brief Record the host side of the requests
+ *  
+ *  \param [in] device pointer to SEcube device structure
+ *  \param [in] timeline ring of events timed with \ref se3c_clock_us, NULL to stop recording
+ *  
+ *  \details L0 records the request write and the response polling and read, L1 the encryption
+ *  and decryption of the payload; the events carry the command token of the request, like the
+ *  device events returned by \ref L0_timeline_read. Sessions copy the device at login, so the
+ *  ring must be attached before. L1 events are added when the request completes, hence the
+ *  ring is not strictly in time order.
+ */
+void L0_timeline_attach(se3_device* device, se3_timeline* timeline);
+
+/**
+ *  \brief Remove the oldest events recorded by the device
+ *  
+ *  \param [in] device pointer to SEcube device structure
+ *  \param [out] events at most max events, oldest first
+ *  \param [in] max capacity of events, up to \ref SE3_TIMELINE_DEVICE_EVENTS per call
+ *  \param [out] count events returned
+ *  \param [out] dropped events overwritten by the device before they were read
+ *  \return Error code or SE3_OK
+ *  
+ *  \details No login is required. The times are converted to the clock of \ref se3c_clock_us,
+ *  taking the middle of the request as the time the device sampled its cycle counter; events
+ *  older than 2^32 cycles (about 25 s) are misplaced. SE3_ERR_CMD is returned by firmwares
+ *  without the command.
+ */
+uint16_t L0_timeline_read(se3_device* device, se3_timeline_event* events, uint16_t max, uint16_t* count, uint32_t* dropped);
+
+/**
+ *  \brief Add the requests to the histograms of a registry
+ *  
+ *  \param [in] device pointer to SEcube device structure
+ *  \param [in] metrics registry created by \ref se3_metrics_create, NULL to stop recording
+ *  
+ *  \details L0 measures the request write, the poll loop and the response read; L1 adds the
+ *  payload encryption and decryption and the device cycles, and files L1 requests under their
+ *  L1 command. Sessions copy the device at login, so the registry must be attached before; one
+ *  registry may be attached to any number of devices, used from any thread.
+ */
+void L0_metrics_attach(se3_device* device, se3_metrics* metrics);
+
 /**
  *  \brief Open SEcube device
  *  
@@ -1,12 +1,50 @@
 #include "L1.h"
 #include "sha256.h"
+#include "pbkdf2.h"
 #include "aes256.h"
+#include "se3_capture.h"
 
-static uint16_t key_list(se3_session* s, uint16_t skip, uint16_t max_keys, const uint8_t* salt, se3_key* key_array, uint16_t* count);
+#if defined(_MSC_VER)
+#include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+static uint16_t key_list(se3_session* s, uint16_t skip, uint16_t max_keys, const uint8_t* salt, uint64_t* cursor, se3_key* key_array, uint16_t* count);
 static void se3_session_init(se3_session* s, se3_device* dev);
+static uint16_t read_keyinfo(const uint8_t* keyinfo, se3_key* key);
 static uint16_t L1_TXRX(se3_session* s, uint16_t cmd, uint16_t cmd_flags, uint16_t req_len, uint16_t* resp_len);
+static uint16_t L1_exchange(se3_session* s, uint16_t cmd, uint16_t cmd_flags, uint16_t req_len, uint16_t* resp_len);
+
+/** CPU cycle counter of the host, read around each command */
+static uint32_t L1_cycles()
+{
+#if defined(_MSC_VER) || defined(__x86_64__) || defined(__i386__)
+	return (uint32_t)__rdtsc();
+#else
+	return 0;
+#endif
+}
 
+/** Send a request and receive the response, adding them to the metrics of the device */
 static uint16_t L1_TXRX(se3_session* s, uint16_t cmd, uint16_t cmd_flags, uint16_t req_len, uint16_t* resp_len)
+{
+	uint16_t result;
+
+	if (s->device.metrics == NULL) {
+		return L1_exchange(s, cmd, cmd_flags, req_len, resp_len);
+	}
+	se3_metrics_sample_reset(&(s->device.sample));
+	se3_metrics_sample_set(&(s->device.sample), SE3_METRICS_REQ_BYTES, req_len);
+	result = L1_exchange(s, cmd, cmd_flags, req_len, resp_len);
+	if (result == SE3_OK) {
+		se3_metrics_sample_set(&(s->device.sample), SE3_METRICS_RESP_BYTES, *resp_len);
+	}
+	se3_metrics_add(s->device.metrics, 1, cmd, &(s->device.sample), result);
+	return result;
+}
+
+static uint16_t L1_exchange(se3_session* s, uint16_t cmd, uint16_t cmd_flags, uint16_t req_len, uint16_t* resp_len)
 {
 	uint16_t result;
 	uint16_t u16tmp = 0;
@@ -18,6 +56,15 @@ static uint16_t L1_TXRX(se3_session* s, uint16_t cmd, uint16_t cmd_flags, uint16
 		*req_auth = s->buf + SE3_REQ1_OFFSET_AUTH;
 	uint8_t* resp_iv = s->buf + SE3_RESP1_OFFSET_IV,
 		*resp_auth = s->buf + SE3_RESP1_OFFSET_AUTH;
+	uint32_t start = L1_cycles(), crypto_start, crypto;
+	uint32_t u32tmp = 0;
+	uint64_t seal_begin = 0, seal_end = 0, open_begin = 0, open_end = 0;
+	bool timed = (s->device.timeline != NULL || s->device.metrics != NULL);
+
+	// protected requests use the mode negotiated at login
+	if (cmd_flags & (SE3_CMDFLAG_ENCRYPT | SE3_CMDFLAG_SIGN)) {
+		cmd_flags |= s->cmd_flags;
+	}
 
 	// set headers
 	if (s->logged_in) {
@@ -42,18 +89,35 @@ static uint16_t L1_TXRX(se3_session* s, uint16_t cmd, uint16_t cmd_flags, uint16
 		se3_payload_cryptoinit(&(s->cryptoctx), s->key);
 		s->cryptoctx_initialized = true;
 	}
-	if (cmd_flags & SE3_CMDFLAG_ENCRYPT) {
+	// GMAC needs a fresh nonce even when the payload is not encrypted
+	if (cmd_flags & (SE3_CMDFLAG_ENCRYPT | SE3_CMDFLAG_AEAD)) {
 		se3c_rand(SE3_L1_CRYPTOBLOCK_SIZE, req_iv);
 	}
 	else {
 		memset(req_iv, 0, SE3_L1_CRYPTOBLOCK_SIZE);
 	}
-	se3_payload_encrypt(
+	if (timed) {
+		seal_begin = se3c_clock_us();
+	}
+	crypto_start = L1_cycles();
+	se3_payload_seal(
 		&(s->cryptoctx), req_auth, req_iv,
 		(s->buf + SE3_L1_AUTH_SIZE + SE3_L1_IV_SIZE), (req0_len - SE3_L1_AUTH_SIZE - SE3_L1_IV_SIZE) / SE3_L1_CRYPTOBLOCK_SIZE, cmd_flags);
+	crypto = L1_cycles() - crypto_start;
+	if (timed) {
+		seal_end = se3c_clock_us();
+	}
+	if (s->device.metrics != NULL) {
+		se3_metrics_sample_set(&(s->device.sample), SE3_METRICS_SEAL_US, seal_end - seal_begin);
+	}
 
 	resp0_len = SE3_COMM_N*SE3_COMM_BLOCK;
 	result = L0_TXRX(&(s->device), SE3_CMD0_L1, cmd_flags, req0_len, s->buf, &resp_status, &resp0_len, s->buf);
+	// the command token is chosen by L0, after the encryption
+	if (s->device.timeline != NULL) {
+		se3_timeline_add(s->device.timeline, seal_begin, s->device.cmd_token, SE3_TIMELINE_HOST_SEAL_BEGIN, cmd);
+		se3_timeline_add(s->device.timeline, seal_end, s->device.cmd_token, SE3_TIMELINE_HOST_SEAL_END, cmd);
+	}
 
 	// comm error status
 	if (result != SE3_OK) {
@@ -70,7 +134,14 @@ static uint16_t L1_TXRX(se3_session* s, uint16_t cmd, uint16_t cmd_flags, uint16
 	}
 
 	//decrypt
-	if (!se3_payload_decrypt(
+	if (timed) {
+		open_begin = se3c_clock_us();
+	}
+	if (s->device.timeline != NULL) {
+		se3_timeline_add(s->device.timeline, open_begin, s->device.cmd_token, SE3_TIMELINE_HOST_OPEN_BEGIN, cmd);
+	}
+	crypto_start = L1_cycles();
+	if (!se3_payload_open(
 		&(s->cryptoctx), resp_auth, resp_iv,
 		s->buf + SE3_L1_AUTH_SIZE + SE3_L1_IV_SIZE,
 		(resp0_len - SE3_L1_AUTH_SIZE - SE3_L1_IV_SIZE) / SE3_L1_CRYPTOBLOCK_SIZE, cmd_flags))
@@ -78,6 +149,22 @@ static uint16_t L1_TXRX(se3_session* s, uint16_t cmd, uint16_t cmd_flags, uint16
 		SE3_TRACE(("[L0d_cmd1] AUTH failed\n"));
 		return SE3_ERR_COMM;
 	}
+	crypto += L1_cycles() - crypto_start;
+	if (timed) {
+		open_end = se3c_clock_us();
+	}
+	if (s->device.timeline != NULL) {
+		se3_timeline_add(s->device.timeline, open_end, s->device.cmd_token, SE3_TIMELINE_HOST_OPEN_END, cmd);
+	}
+
+	SE3_GET32(s->buf, SE3_RESP1_OFFSET_CYCLES, u32tmp);
+	if (s->device.metrics != NULL) {
+		se3_metrics_sample_set(&(s->device.sample), SE3_METRICS_OPEN_US, open_end - open_begin);
+		se3_metrics_sample_set(&(s->device.sample), SE3_METRICS_DEVICE_CYCLES, u32tmp);
+	}
+	s->last_cycles.device = u32tmp;
+	s->last_cycles.host_crypto = crypto;
+	s->last_cycles.host_total = L1_cycles() - start;
 	
 	SE3_GET16(s->buf, SE3_RESP1_OFFSET_LEN, u16tmp);
 	*resp_len = u16tmp;
@@ -96,8 +183,14 @@ static void se3_session_init(se3_session* s, se3_device* dev) {
 
 uint16_t L1_login(se3_session* s, se3_device* dev, const uint8_t* pin, uint16_t access) {
 	uint8_t cc1[SE3_L1_CHALLENGE_SIZE], cc2[SE3_L1_CHALLENGE_SIZE], sc[SE3_L1_CHALLENGE_SIZE], sresp_expected[SE3_L1_CHALLENGE_SIZE];
+	uint8_t cresp[SE3_L1_CHALLENGE_SIZE];
+	const uint8_t* pins[2] = { pin, pin };
+	const size_t npins[2] = { SE3_L1_PIN_SIZE, SE3_L1_PIN_SIZE };
+	const uint8_t* challenges[2] = { cc1, sc };
+	uint8_t* responses[2] = { sresp_expected, cresp };
 	uint16_t req_len = 0, resp_len = 0;
 	uint16_t error;
+	uint16_t cmd_flags = SE3_CMDFLAG_AEAD;
 	uint8_t* session_data = s->buf + SE3_RESP1_OFFSET_DATA;
 	// only for login
 	se3_session_init(s, dev);
@@ -107,26 +200,47 @@ uint16_t L1_login(se3_session* s, se3_device* dev, const uint8_t* pin, uint16_t
 	se3c_rand(SE3_L1_CHALLENGE_SIZE, cc1);   // Generates 2 randoms for Challenge
 	se3c_rand(SE3_L1_CHALLENGE_SIZE, cc2);
 
-	memcpy(session_data + SE3_CMD1_CHALLENGE_REQ_OFF_CC1, cc1, SE3_L1_CHALLENGE_SIZE);
-	memcpy(session_data + SE3_CMD1_CHALLENGE_REQ_OFF_CC2, cc2, SE3_L1_CHALLENGE_SIZE);
-	SE3_SET16(session_data, SE3_CMD1_CHALLENGE_REQ_OFF_ACCESS, access);
+	// Ask for AES-GCM payload protection; firmware without the optional field rejects the
+	// longer request, which is then sent again without it
+	req_len = SE3_CMD1_CHALLENGE_REQ_SIZE_CMDFLAGS;
+	do {
+		memcpy(session_data + SE3_CMD1_CHALLENGE_REQ_OFF_CC1, cc1, SE3_L1_CHALLENGE_SIZE);
+		memcpy(session_data + SE3_CMD1_CHALLENGE_REQ_OFF_CC2, cc2, SE3_L1_CHALLENGE_SIZE);
+		SE3_SET16(session_data, SE3_CMD1_CHALLENGE_REQ_OFF_ACCESS, access);
+		if (req_len == SE3_CMD1_CHALLENGE_REQ_SIZE_CMDFLAGS) {
+			SE3_SET16(session_data, SE3_CMD1_CHALLENGE_REQ_OFF_CMDFLAGS, cmd_flags);
+		}
 
-	req_len = SE3_CMD1_CHALLENGE_REQ_OFF_ACCESS + sizeof(uint16_t);
+		// Send Challenge
+		error = L1_TXRX(s, SE3_CMD1_CHALLENGE, 0, req_len, &resp_len);
+		if (error == SE3_ERR_PARAMS && req_len == SE3_CMD1_CHALLENGE_REQ_SIZE_CMDFLAGS) {
+			req_len = SE3_CMD1_CHALLENGE_REQ_SIZE;
+			continue;
+		}
+		if (error != SE3_OK) {
+			return error;
+		}
+		break;
+	} while (true);
+	// the accepted command flags are returned only if they were requested
+	if (resp_len != ((req_len == SE3_CMD1_CHALLENGE_REQ_SIZE_CMDFLAGS) ? (SE3_CMD1_CHALLENGE_RESP_SIZE_CMDFLAGS) : (SE3_CMD1_CHALLENGE_RESP_SIZE))) {
+		return SE3_ERR_COMM;
+	}
 
-	// Send Challenge
-	error = L1_TXRX(s, SE3_CMD1_CHALLENGE, 0, req_len, &resp_len);
-	if (error != SE3_OK) {
-		return error;
+	if (req_len == SE3_CMD1_CHALLENGE_REQ_SIZE_CMDFLAGS) {
+		SE3_GET16(session_data, SE3_CMD1_CHALLENGE_RESP_OFF_CMDFLAGS, cmd_flags);
+		s->cmd_flags = cmd_flags & SE3_CMDFLAG_AEAD;
 	}
-	// TODO check response length
 
 	// Read Server Challenge sc
 	memcpy(sc, session_data + SE3_CMD1_CHALLENGE_RESP_OFF_SC, SE3_L1_CHALLENGE_SIZE);
 
 	// check server response
 	// sresp = PBKDF2(HMACSHA256, pin, cc1, SE3_L1_CHALLENGE_ITERATIONS, SE3_CHALLENGE_SIZE)
-	PBKDF2HmacSha256(pin, SE3_L1_PIN_SIZE, cc1,
-		SE3_L1_CHALLENGE_SIZE, SE3_L1_CHALLENGE_ITERATIONS, sresp_expected, SE3_L1_CHALLENGE_SIZE);
+	// cresp = PBKDF2(HMACSHA256, pin, sc, SE3_L1_CHALLENGE_ITERATIONS, SE3_CHALLENGE_SIZE)
+	// both derivations are independent, compute them together
+	PBKDF2HmacSha256_Multi(pins, npins, challenges,
+		SE3_L1_CHALLENGE_SIZE, SE3_L1_CHALLENGE_ITERATIONS, responses, SE3_L1_CHALLENGE_SIZE, 2);
 
 	if (memcmp(sresp_expected, session_data + SE3_CMD1_CHALLENGE_RESP_OFF_SRESP, SE3_L1_CHALLENGE_SIZE)) {
 		return SE3_ERR_PIN;
@@ -145,10 +259,7 @@ uint16_t L1_login(se3_session* s, se3_device* dev, const uint8_t* pin, uint16_t
 
 	// Prepare Challenge Response
 
-	// cresp = PBKDF2(HMACSHA256, pin, sc, SE3_L1_CHALLENGE_ITERATIONS, SE3_CHALLENGE_SIZE)
-	PBKDF2HmacSha256(pin, SE3_L1_PIN_SIZE, sc,
-		SE3_L1_CHALLENGE_SIZE, SE3_L1_CHALLENGE_ITERATIONS,
-		session_data + SE3_CMD1_LOGIN_REQ_OFF_CRESP, SE3_L1_CHALLENGE_SIZE);
+	memcpy(session_data + SE3_CMD1_LOGIN_REQ_OFF_CRESP, cresp, SE3_L1_CHALLENGE_SIZE);
 
 	req_len = SE3_L1_CHALLENGE_SIZE;
 
@@ -158,10 +269,17 @@ uint16_t L1_login(se3_session* s, se3_device* dev, const uint8_t* pin, uint16_t
 		s->logged_in = false;
 		return error;
 	}
-	// TODO check response length
+	if (resp_len != SE3_CMD1_LOGIN_RESP_SIZE) {
+		s->logged_in = false;
+		return SE3_ERR_COMM;
+	}
 
 	// Read Token
 	memcpy(s->token, session_data + SE3_CMD1_LOGIN_RESP_OFF_TOKEN, SE3_L1_TOKEN_SIZE);
+	// lets a replay of the capture decrypt and run the requests of this session
+	if (se3_capture_active()) {
+		se3_capture_session(s->token, s->key, access, s->cmd_flags);
+	}
 
 	// s->logged_in = true;  // moved up
 
@@ -264,7 +382,18 @@ uint16_t L1_key_edit(se3_session* s, uint16_t op, se3_key* k) {
 	return(SE3_OK);
 }
 
-static uint16_t key_list(se3_session* s, uint16_t skip, uint16_t max_keys, const uint8_t* salt, se3_key* key_array, uint16_t* count) {
+static uint16_t read_keyinfo(const uint8_t* keyinfo, se3_key* key) {
+	SE3_GET32(keyinfo, SE3_CMD1_KEY_LIST_KEYINFO_OFF_ID, key->id);
+	SE3_GET32(keyinfo, SE3_CMD1_KEY_LIST_KEYINFO_OFF_VALIDITY, key->validity);
+	SE3_GET16(keyinfo, SE3_CMD1_KEY_LIST_KEYINFO_OFF_DATA_LEN, key->data_size);
+	SE3_GET16(keyinfo, SE3_CMD1_KEY_LIST_KEYINFO_OFF_NAME_LEN, key->name_size);
+	memcpy(key->fingerprint, keyinfo + SE3_CMD1_KEY_LIST_KEYINFO_OFF_FINGERPRINT, SE3_KEY_FINGERPRINT_SIZE);
+	memcpy(key->name, keyinfo + SE3_CMD1_KEY_LIST_KEYINFO_OFF_NAME, key->name_size);
+	return (uint16_t)(SE3_CMD1_KEY_LIST_KEYINFO_OFF_NAME + key->name_size);
+}
+
+/** One KEY_LIST request; with a cursor, the listing resumes after it and *cursor is updated */
+static uint16_t key_list(se3_session* s, uint16_t skip, uint16_t max_keys, const uint8_t* salt, uint64_t* cursor, se3_key* key_array, uint16_t* count) {
 	uint16_t error = 0;
 	uint16_t resp_len = 0;
 	uint16_t n_keys = 0;
@@ -287,58 +416,192 @@ static uint16_t key_list(se3_session* s, uint16_t skip, uint16_t max_keys, const
 	SE3_SET16(session_data, SE3_CMD1_KEY_LIST_REQ_OFF_SKIP, skip);
 	SE3_SET16(session_data, SE3_CMD1_KEY_LIST_REQ_OFF_NMAX, max_keys);
 	memcpy(session_data + SE3_CMD1_KEY_LIST_REQ_OFF_SALT, salt_, SE3_KEY_SALT_SIZE);
+	SE3_SET64(session_data, SE3_CMD1_KEY_LIST_REQ_OFF_CURSOR, *cursor);
 
 	// Send data
-	error = L1_TXRX(s, SE3_CMD1_KEY_LIST, 0, SE3_CMD1_KEY_LIST_REQ_SIZE, &resp_len);
+	error = L1_TXRX(s, SE3_CMD1_KEY_LIST, 0, SE3_CMD1_KEY_LIST_REQ_SIZE_CURSOR, &resp_len);
 	if (error != SE3_OK) {
 		return error;
 	}
 
 	// Read response
 	SE3_GET16(session_data, SE3_CMD1_KEY_LIST_RESP_OFF_COUNT, n_keys);   // Get number of keys returned
-	//if(n_keys == 0) return(???)
-	offset_key = 2;
+	offset_key = SE3_CMD1_KEY_LIST_RESP_OFF_KEYINFO;
 	for (i = 0; i < n_keys; i++) {   // Fills with key received
-		SE3_GET32(session_data, offset_key + SE3_CMD1_KEY_LIST_KEYINFO_OFF_ID, key_array[i].id);
-		SE3_GET32(session_data, offset_key + SE3_CMD1_KEY_LIST_KEYINFO_OFF_VALIDITY, key_array[i].validity);
-		SE3_GET16(session_data, offset_key + SE3_CMD1_KEY_LIST_KEYINFO_OFF_DATA_LEN, key_array[i].data_size);
-		SE3_GET16(session_data, offset_key + SE3_CMD1_KEY_LIST_KEYINFO_OFF_NAME_LEN, key_array[i].name_size);
-		memcpy(key_array[i].fingerprint, session_data + offset_key + SE3_CMD1_KEY_LIST_KEYINFO_OFF_FINGERPRINT, SE3_KEY_FINGERPRINT_SIZE);
-		memcpy(key_array[i].name, session_data + offset_key + SE3_CMD1_KEY_LIST_KEYINFO_OFF_NAME, key_array[i].name_size);
-		offset_key += SE3_CMD1_KEY_LIST_KEYINFO_OFF_NAME + key_array[i].name_size;
+		offset_key += read_keyinfo(session_data + offset_key, &(key_array[i]));
+	}
+	if (offset_key + SE3_CMD1_KEY_LIST_RESP_CURSOR_SIZE > resp_len) {
+		return(SE3_ERR_COMM);
 	}
+	SE3_GET64(session_data, offset_key, *cursor);   // the cursor follows the last keyinfo
 
 	*count = n_keys;
 
 	return(SE3_OK);
 }
 
+uint16_t L1_key_import(se3_session* s, uint16_t op, FILE* fp, size_t* count) {
+	uint16_t resp_len = 0;
+	uint16_t error = 0;
+	uint16_t n = 0, imported = 0;
+	uint16_t data_len = 0, name_len = 0, key_size = 0;
+	size_t len = SE3_CMD1_KEY_IMPORT_REQ_OFF_KEYS, nread = 0;
+	bool eof = false;
+	uint8_t* session_data = s->buf + SE3_REQ1_OFFSET_DATA;
+	uint8_t key[SE3_CMD1_KEY_IMPORT_KEY_OFF_DATA_AND_NAME + SE3_KEY_DATA_MAX + SE3_KEY_NAME_MAX];
+
+	if (fp == NULL) {
+		return(SE3_ERR_PARAMS);
+	}
+	if (count != NULL) {
+		*count = 0;
+	}
+
+	for (;;) {
+		// read next key from file
+		key_size = 0;
+		nread = fread(key, 1, SE3_CMD1_KEY_IMPORT_KEY_OFF_DATA_AND_NAME, fp);
+		if (nread == 0) {
+			eof = true;
+		}
+		else if (nread != SE3_CMD1_KEY_IMPORT_KEY_OFF_DATA_AND_NAME) {
+			return(SE3_ERR_PARAMS);
+		}
+		else {
+			SE3_GET16(key, SE3_CMD1_KEY_IMPORT_KEY_OFF_DATA_LEN, data_len);
+			SE3_GET16(key, SE3_CMD1_KEY_IMPORT_KEY_OFF_NAME_LEN, name_len);
+			if ((data_len > SE3_KEY_DATA_MAX) || (name_len > SE3_KEY_NAME_MAX)) {
+				return(SE3_ERR_PARAMS);
+			}
+			if (fread(key + SE3_CMD1_KEY_IMPORT_KEY_OFF_DATA_AND_NAME, 1, data_len + name_len, fp) != (size_t)(data_len + name_len)) {
+				return(SE3_ERR_PARAMS);
+			}
+			key_size = SE3_CMD1_KEY_IMPORT_KEY_OFF_DATA_AND_NAME + data_len + name_len;
+		}
+
+		// send the packet when full or at the end of the file
+		if (n > 0 && (eof || n == SE3_CMD1_KEY_IMPORT_MAX || len + key_size > SE3_REQ1_MAX_DATA)) {
+			SE3_SET16(session_data, SE3_CMD1_KEY_IMPORT_REQ_OFF_OP, op);
+			SE3_SET16(session_data, SE3_CMD1_KEY_IMPORT_REQ_OFF_COUNT, n);
+			error = L1_TXRX(s, SE3_CMD1_KEY_IMPORT_BATCH, SE3_CMDFLAG_ENCRYPT | SE3_CMDFLAG_SIGN, (uint16_t)len, &resp_len);
+			if (error != SE3_OK) {
+				return error;
+			}
+			SE3_GET16(session_data, SE3_CMD1_KEY_IMPORT_RESP_OFF_COUNT, imported);
+			if (count != NULL) {
+				*count += imported;
+			}
+			n = 0;
+			len = SE3_CMD1_KEY_IMPORT_REQ_OFF_KEYS;
+		}
+		if (eof) {
+			break;
+		}
+		memcpy(session_data + len, key, key_size);
+		len += key_size;
+		n++;
+	}
+
+	return(SE3_OK);
+}
+
 uint16_t L1_key_list(se3_session* s, uint16_t skip, uint16_t max_keys, const uint8_t* salt, se3_key* key_array, uint16_t* count) {
 	int i = 0;
 	uint16_t return_value = 0, xcount = 0;
-	while (i != max_keys &&
-		(return_value = key_list(s, i + skip, max_keys - i, salt, &(key_array[i]), &xcount)) == 0 &&
-		xcount>0){
+	uint64_t cursor = SE3_KEY_LIST_CURSOR_START;
+	while (i != max_keys) {
+		// the first request skips, the following ones resume from the cursor
+		return_value = key_list(s, (i == 0) ? (skip) : (0), max_keys - i, salt, &cursor, &(key_array[i]), &xcount);
+		if (return_value == SE3_ERR_EXPIRED) {
+			// a write needed space and moved nodes, restart counting the keys already read
+			cursor = SE3_KEY_LIST_CURSOR_START;
+			return_value = key_list(s, skip + i, max_keys - i, salt, &cursor, &(key_array[i]), &xcount);
+		}
+		if (return_value != SE3_OK || xcount == 0) {
+			break;
+		}
 		i += xcount;
 	}
 	*count = i;
 	return return_value;
 }
 
-bool L1_find_key(se3_session* s, uint32_t key_id){
-	enum{
-		FIND_KEY_NUM = 50
-	};
-	se3_key key_array[FIND_KEY_NUM];
-	uint16_t ret = SE3_OK, count = 0;
-	int i = 0, j = 0;
-	while ((ret = L1_key_list(s, i, i + FIND_KEY_NUM, NULL, key_array, &count)) == SE3_OK && count>0){
-		for (j = 0; j<count; j++){
-			if (key_array[j].id == key_id) return true;
+uint16_t L1_key_list_next(se3_session* s, uint64_t* cursor, uint16_t max_keys, const uint8_t* salt, se3_key* key_array, uint16_t* count) {
+	uint16_t i = 0;
+	uint16_t return_value = SE3_OK, xcount = 0;
+	if (cursor == NULL || count == NULL) {
+		return(SE3_ERR_PARAMS);
+	}
+	while (i != max_keys) {
+		return_value = key_list(s, 0, max_keys - i, salt, cursor, &(key_array[i]), &xcount);
+		if (return_value != SE3_OK || xcount == 0) {
+			break;
 		}
-		i += count;
+		i += xcount;
 	}
-	return false;
+	*count = i;
+	return return_value;
+}
+
+uint16_t L1_key_get_info(se3_session* s, uint32_t key_id, const uint8_t* salt, se3_key* key) {
+	uint16_t error = 0;
+	uint16_t resp_len = 0;
+	uint8_t* session_data = s->buf + SE3_RESP1_OFFSET_DATA;
+
+	SE3_SET32(session_data, SE3_CMD1_KEY_GET_INFO_REQ_OFF_ID, key_id);
+	// without a salt the device does not compute the fingerprint
+	if (salt != NULL) {
+		memcpy(session_data + SE3_CMD1_KEY_GET_INFO_REQ_OFF_SALT, salt, SE3_KEY_SALT_SIZE);
+	}
+
+	error = L1_TXRX(s, SE3_CMD1_KEY_GET_INFO, 0, (salt != NULL) ? (SE3_CMD1_KEY_GET_INFO_REQ_SIZE_SALT) : (SE3_CMD1_KEY_GET_INFO_REQ_SIZE), &resp_len);
+	if (error != SE3_OK) {
+		return error;
+	}
+	if (key != NULL) {
+		read_keyinfo(session_data + SE3_CMD1_KEY_GET_INFO_RESP_OFF_KEYINFO, key);
+	}
+
+	return(SE3_OK);
+}
+
+bool L1_key_verify(const se3_key* keys, uint16_t count, const uint8_t* salt, bool* match) {
+	const uint8_t* data[B5_SHA256_MULTI_LANES];
+	size_t data_size[B5_SHA256_MULTI_LANES];
+	const uint8_t* salts[B5_SHA256_MULTI_LANES];
+	uint8_t fingerprint[B5_SHA256_MULTI_LANES][SE3_KEY_FINGERPRINT_SIZE];
+	uint8_t* fingerprints[B5_SHA256_MULTI_LANES];
+	uint8_t salt_[SE3_KEY_SALT_SIZE];
+	uint16_t i, j, n;
+	bool equal, success = true;
+
+	if (salt == NULL) {
+		memset(salt_, 0, SE3_KEY_SALT_SIZE);
+		salt = salt_;
+	}
+	for (i = 0; i < count; i += n) {
+		n = ((count - i) < B5_SHA256_MULTI_LANES) ? (count - i) : (B5_SHA256_MULTI_LANES);
+		for (j = 0; j < n; j++) {
+			data[j] = keys[i + j].data;
+			data_size[j] = keys[i + j].data_size;
+			salts[j] = salt;
+			fingerprints[j] = fingerprint[j];
+		}
+		// same derivation as the device, see se3_key_fingerprint
+		PBKDF2HmacSha256_Multi(data, data_size, salts, SE3_KEY_SALT_SIZE, 1, fingerprints, SE3_KEY_FINGERPRINT_SIZE, (int16_t)n);
+		for (j = 0; j < n; j++) {
+			equal = !memcmp(fingerprint[j], keys[i + j].fingerprint, SE3_KEY_FINGERPRINT_SIZE);
+			if (match != NULL) {
+				match[i + j] = equal;
+			}
+			success = success && equal;
+		}
+	}
+	return success;
+}
+
+bool L1_find_key(se3_session* s, uint32_t key_id){
+	return (SE3_OK == L1_key_get_info(s, key_id, NULL, NULL));
 }
 
 
@@ -370,7 +633,9 @@ uint16_t L1_crypto_init(se3_session* s, uint16_t algorithm, uint16_t mode, uint3
 // L1_crypto_update : (sid:ui32, flags : ui16, datain1 - len : ui16, datain2 - len : ui16, 
 //					pad - to - 16[6], *datain1[datain1 - len], pad - to - 16[...], datain2[datain2 - len])
 // = > (dataout - len, pad - to - 16[14], dataout[dataout - len]
-uint16_t L1_crypto_update(se3_session* s,
+/** L1_crypto_update with the given L1 command flags, SE3_CMDFLAG_ENCRYPT | SE3_CMDFLAG_SIGN for requests or responses carrying keys */
+static uint16_t L1_crypto_update_cmd(se3_session* s,
+	uint16_t cmd_flags,
 	uint32_t sess_id,
 	uint16_t flags,
 	uint16_t data1_len,
@@ -389,8 +654,8 @@ uint16_t L1_crypto_update(se3_session* s,
 	//memset(session_data, 0, SE3_CMD1_CRYPTO_UPDATE_REQ_OFF_DATA);   // Clear buffer
 	SE3_SET32(session_data, SE3_CMD1_CRYPTO_UPDATE_REQ_OFF_SID, sess_id);   // Session ID
 	SE3_SET16(session_data, SE3_CMD1_CRYPTO_UPDATE_REQ_OFF_FLAGS, flags);   // Flags
-	SE3_SET32(session_data, SE3_CMD1_CRYPTO_UPDATE_REQ_OFF_DATAIN1_LEN, data1_len);   // Length of Data1
-	SE3_SET32(session_data, SE3_CMD1_CRYPTO_UPDATE_REQ_OFF_DATAIN2_LEN, data2_len);   // Length of Data2
+	SE3_SET16(session_data, SE3_CMD1_CRYPTO_UPDATE_REQ_OFF_DATAIN1_LEN, data1_len);   // Length of Data1
+	SE3_SET16(session_data, SE3_CMD1_CRYPTO_UPDATE_REQ_OFF_DATAIN2_LEN, data2_len);   // Length of Data2
 	// compute offset for data2
 	if (data1_len % 16 != 0) {
 		data1_len_pad16 = data1_len + (16 - (data1_len % 16));
@@ -404,17 +669,17 @@ uint16_t L1_crypto_update(se3_session* s,
 		return SE3_ERR_PARAMS;
 	}
 	// copy data1
-	if (data1_len > 0) {
+	if (data1 != NULL && data1_len > 0) {
 		memcpy(session_data + SE3_CMD1_CRYPTO_UPDATE_REQ_OFF_DATA, data1, data1_len);
 	}
 	//copy data2
-	if (data2_len > 0) {
+	if (data2 != NULL && data2_len > 0) {
 		memcpy(session_data + SE3_CMD1_CRYPTO_UPDATE_REQ_OFF_DATA + data1_len_pad16, data2, data2_len);
 	}
 
 	// Send data
 
-	error = L1_TXRX(s, SE3_CMD1_CRYPTO_UPDATE, 0, data_len, &resp_len);
+	error = L1_TXRX(s, SE3_CMD1_CRYPTO_UPDATE, cmd_flags, data_len, &resp_len);
 	if (error != SE3_OK) {
 		return error;
 	}
@@ -430,6 +695,18 @@ uint16_t L1_crypto_update(se3_session* s,
 	return(SE3_OK);
 }
 
+uint16_t L1_crypto_update(se3_session* s,
+	uint32_t sess_id,
+	uint16_t flags,
+	uint16_t data1_len,
+	const uint8_t* data1,
+	uint16_t data2_len,
+	const uint8_t* data2,
+	uint16_t* dataout_len,
+	uint8_t* data_out) {
+	return L1_crypto_update_cmd(s, 0, sess_id, flags, data1_len, data1, data2_len, data2, dataout_len, data_out);
+}
+
 
 uint16_t L1_get_algorithms(se3_session* s,
 	uint16_t skip,
@@ -572,3 +849,216 @@ uint16_t L1_digest(se3_session* s, uint16_t algorithm, size_t datain_len, uint8_
 	return(error);
 }
 
+/** Message bytes sent by each AEAD request, leaving room for the tag in the last one */
+#define L1_AEAD_CHUNK (((SE3_CRYPTO_MAX_DATAIN < SE3_CRYPTO_MAX_DATAOUT) ? SE3_CRYPTO_MAX_DATAIN : SE3_CRYPTO_MAX_DATAOUT) - SE3_CRYPTO_AEAD_TAG_SIZE)
+
+static uint16_t L1_aead(se3_session* s, uint16_t algorithm, uint16_t mode, uint32_t key_id, uint16_t nonce_len, const uint8_t* nonce, size_t aad_len, const uint8_t* aad, size_t datain_len, const uint8_t* data_in, size_t* dataout_len, uint8_t* data_out) {
+	const uint8_t* sp = data_in;
+	uint8_t* rp = data_out;
+	bool decrypt = (mode == SE3_DIR_DECRYPT);
+	uint16_t error = SE3_OK;
+	uint16_t curr_len = 0;
+	uint32_t sess_id = 0;
+	size_t msg_len, curr_chunk;
+	bool last;
+
+	if (nonce == NULL || data_out == NULL || (aad_len > 0 && aad == NULL) || (datain_len > 0 && data_in == NULL))
+		return(SE3_ERR_PARAMS);
+	if (decrypt && datain_len < SE3_CRYPTO_AEAD_TAG_SIZE)
+		return(SE3_ERR_PARAMS);
+	msg_len = decrypt ? (datain_len - SE3_CRYPTO_AEAD_TAG_SIZE) : datain_len;
+
+	error = L1_crypto_init(s, algorithm, mode, key_id, &sess_id);
+	if (error != SE3_OK) {
+		return error;
+	}
+
+	if (dataout_len != NULL)
+		*dataout_len = 0;
+
+	error = L1_crypto_update(s, sess_id, SE3_CRYPTO_FLAG_SETNONCE, nonce_len, nonce, 0, NULL, NULL, NULL);
+
+	// the additional data goes in datain1, all of it before the message
+	while (error == SE3_OK && aad_len > 0) {
+		curr_chunk = aad_len < SE3_CRYPTO_MAX_DATAIN ? aad_len : SE3_CRYPTO_MAX_DATAIN;
+		error = L1_crypto_update(s, sess_id, 0, (uint16_t)curr_chunk, aad, 0, NULL, NULL, NULL);
+		aad_len -= curr_chunk;
+		aad += curr_chunk;
+	}
+
+	// the last request carries the tag: appended to the output, or expected at the end of the input
+	last = false;
+	while (error == SE3_OK && !last) {
+		curr_chunk = msg_len < L1_AEAD_CHUNK ? msg_len : L1_AEAD_CHUNK;
+		last = (curr_chunk == msg_len);
+		curr_len = 0;
+		error = L1_crypto_update(s, sess_id, last ? SE3_CRYPTO_FLAG_FINIT : 0, 0, NULL,
+			(uint16_t)(curr_chunk + ((last && decrypt) ? SE3_CRYPTO_AEAD_TAG_SIZE : 0)), sp, &curr_len, rp);
+		msg_len -= curr_chunk;
+		sp += curr_chunk;
+		rp += curr_len;
+		if (dataout_len != NULL)
+			*dataout_len += curr_len;
+	}
+
+	if (error != SE3_OK) {
+		// a new nonce ends the message in progress, so that FINIT releases the session
+		L1_crypto_update(s, sess_id, SE3_CRYPTO_FLAG_SETNONCE | SE3_CRYPTO_FLAG_FINIT, nonce_len, nonce, 0, NULL, NULL, NULL);
+		if (decrypt) {
+			memset(data_out, 0, rp - data_out);
+		}
+		if (dataout_len != NULL)
+			*dataout_len = 0;
+	}
+
+	return(error);
+}
+
+uint16_t L1_aead_encrypt(se3_session* s, uint16_t algorithm, uint32_t key_id, uint16_t nonce_len, const uint8_t* nonce, size_t aad_len, const uint8_t* aad, size_t datain_len, const uint8_t* data_in, size_t* dataout_len, uint8_t* data_out) {
+	return L1_aead(s, algorithm, SE3_DIR_ENCRYPT, key_id, nonce_len, nonce, aad_len, aad, datain_len, data_in, dataout_len, data_out);
+}
+
+uint16_t L1_aead_decrypt(se3_session* s, uint16_t algorithm, uint32_t key_id, uint16_t nonce_len, const uint8_t* nonce, size_t aad_len, const uint8_t* aad, size_t datain_len, const uint8_t* data_in, size_t* dataout_len, uint8_t* data_out) {
+	return L1_aead(s, algorithm, SE3_DIR_DECRYPT, key_id, nonce_len, nonce, aad_len, aad, datain_len, data_in, dataout_len, data_out);
+}
+
+
+uint16_t L1_envelope_init(se3_session* s, uint32_t kek_id, se3_envelope* env) {
+	if (s == NULL || env == NULL)
+		return(SE3_ERR_PARAMS);
+	env->s = s;
+	return L1_crypto_init(s, SE3_ALGO_AES_KW, 0, kek_id, &env->sess_id);
+}
+
+uint16_t L1_envelope_close(se3_envelope* env) {
+	if (env == NULL)
+		return(SE3_ERR_PARAMS);
+	return L1_crypto_update(env->s, env->sess_id, SE3_CRYPTO_FLAG_FINIT, 0, NULL, 0, NULL, NULL, NULL);
+}
+
+/** Run one SE3_ALGO_AES_KW request, encrypted and signed since request or response holds a clear key;
+ *  the response is wiped from the session buffer */
+static uint16_t L1_envelope_cmd(se3_envelope* env, uint16_t flags, uint16_t data1_len, const uint8_t* data1, uint16_t data2_len, const uint8_t* data2, uint16_t expected_len, uint8_t* data_out) {
+	uint16_t error;
+	uint16_t resp_len = 0;
+
+	error = L1_crypto_update_cmd(env->s, SE3_CMDFLAG_ENCRYPT | SE3_CMDFLAG_SIGN, env->sess_id, flags, data1_len, data1, data2_len, data2, &resp_len, data_out);
+	memset(env->s->buf + SE3_RESP1_OFFSET_DATA + SE3_CMD1_CRYPTO_UPDATE_RESP_OFF_DATA, 0, SE3_CRYPTO_MAX_DATAOUT);
+	if (error == SE3_OK && resp_len != expected_len) {
+		memset(data_out, 0, resp_len);
+		error = SE3_ERR_COMM;
+	}
+	return error;
+}
+
+uint16_t L1_envelope_new_key(se3_envelope* env, uint16_t key_size, uint8_t* key, uint8_t* wrapped) {
+	uint8_t size[2];
+	uint8_t buf[2 * SE3_CRYPTO_KW_MAX_KEY + SE3_CRYPTO_KW_OVERHEAD];
+	uint16_t error;
+
+	if (env == NULL || key == NULL || wrapped == NULL || key_size > SE3_CRYPTO_KW_MAX_KEY)
+		return(SE3_ERR_PARAMS);
+
+	SE3_SET16(size, 0, key_size);
+	error = L1_envelope_cmd(env, SE3_CRYPTO_FLAG_GENKEY, sizeof(size), size, 0, NULL, 2 * key_size + SE3_CRYPTO_KW_OVERHEAD, buf);
+	if (error == SE3_OK) {
+		memcpy(key, buf, key_size);
+		memcpy(wrapped, buf + key_size, key_size + SE3_CRYPTO_KW_OVERHEAD);
+	}
+	memset(buf, 0, sizeof(buf));
+	return error;
+}
+
+uint16_t L1_envelope_wrap_key(se3_envelope* env, uint16_t key_size, const uint8_t* key, uint8_t* wrapped) {
+	if (env == NULL || key == NULL || wrapped == NULL || key_size == 0)
+		return(SE3_ERR_PARAMS);
+	return L1_envelope_cmd(env, 0, key_size, key, 0, NULL, key_size + SE3_CRYPTO_KW_OVERHEAD, wrapped);
+}
+
+uint16_t L1_envelope_unwrap_key(se3_envelope* env, uint16_t wrapped_size, const uint8_t* wrapped, uint8_t* key) {
+	if (env == NULL || key == NULL || wrapped == NULL || wrapped_size <= SE3_CRYPTO_KW_OVERHEAD)
+		return(SE3_ERR_PARAMS);
+	return L1_envelope_cmd(env, 0, 0, NULL, wrapped_size, wrapped, wrapped_size - SE3_CRYPTO_KW_OVERHEAD, key);
+}
+
+/** Bytes given to B5_GcmAes256_Update in one call, which takes an int32_t length */
+#define L1_ENVELOPE_GCM_CHUNK ((size_t)1 << 30)
+
+/** AES-256-GCM with the local AES backend; the tag follows the cipher text */
+static uint16_t L1_envelope_gcm(const uint8_t* key, const uint8_t* nonce, bool decrypt, size_t aad_len, const uint8_t* aad, size_t len, const uint8_t* data_in, uint8_t* data_out) {
+	B5_tGcmAesCtx ctx;
+	uint16_t error = SE3_OK;
+	size_t done, n;
+
+	B5_GcmAes256_Init(&ctx, key, B5_GCM_AES_256, decrypt ? B5_GCM_AES256_DEC : B5_GCM_AES256_ENC);
+	B5_GcmAes256_SetIV(&ctx, nonce, SE3_ENVELOPE_NONCE_SIZE);
+	for (done = 0; done < aad_len; done += n) {
+		n = (aad_len - done < L1_ENVELOPE_GCM_CHUNK) ? aad_len - done : L1_ENVELOPE_GCM_CHUNK;
+		B5_GcmAes256_UpdateAad(&ctx, aad + done, (int32_t)n);
+	}
+	for (done = 0; done < len; done += n) {
+		n = (len - done < L1_ENVELOPE_GCM_CHUNK) ? len - done : L1_ENVELOPE_GCM_CHUNK;
+		if (decrypt)
+			B5_GcmAes256_Update(&ctx, (uint8_t*)data_in + done, data_out + done, (int32_t)n);
+		else
+			B5_GcmAes256_Update(&ctx, data_out + done, (uint8_t*)data_in + done, (int32_t)n);
+	}
+	if (decrypt) {
+		if (B5_GCM_AES256_RES_OK != B5_GcmAes256_Verify(&ctx, data_in + len, SE3_CRYPTO_AEAD_TAG_SIZE)) {
+			memset(data_out, 0, len);
+			error = SE3_ERR_AUTH;
+		}
+	}
+	else {
+		B5_GcmAes256_Finit(&ctx, data_out + len);
+	}
+	memset(&ctx, 0, sizeof(ctx));
+	return error;
+}
+
+uint16_t L1_envelope_seal(se3_envelope* env, size_t aad_len, const uint8_t* aad, size_t datain_len, const uint8_t* data_in, size_t* dataout_len, uint8_t* data_out) {
+	uint8_t key[SE3_ENVELOPE_KEY_SIZE];
+	uint8_t* nonce = data_out + SE3_ENVELOPE_WRAPPED_SIZE;
+	uint16_t error;
+
+	if (data_out == NULL || (aad_len > 0 && aad == NULL) || (datain_len > 0 && data_in == NULL))
+		return(SE3_ERR_PARAMS);
+
+	// one command per object: the device generates the data key and wraps it
+	error = L1_envelope_new_key(env, SE3_ENVELOPE_KEY_SIZE, key, data_out);
+	if (error != SE3_OK)
+		return error;
+
+	// every object has its own key, the random nonce only adds margin
+	se3c_rand(SE3_ENVELOPE_NONCE_SIZE, nonce);
+	error = L1_envelope_gcm(key, nonce, false, aad_len, aad, datain_len, data_in, nonce + SE3_ENVELOPE_NONCE_SIZE);
+	memset(key, 0, sizeof(key));
+
+	if (dataout_len != NULL)
+		*dataout_len = (error == SE3_OK) ? datain_len + SE3_ENVELOPE_OVERHEAD : 0;
+	return error;
+}
+
+uint16_t L1_envelope_open(se3_envelope* env, size_t aad_len, const uint8_t* aad, size_t datain_len, const uint8_t* data_in, size_t* dataout_len, uint8_t* data_out) {
+	uint8_t key[SE3_ENVELOPE_KEY_SIZE];
+	const uint8_t* nonce = data_in + SE3_ENVELOPE_WRAPPED_SIZE;
+	size_t len;
+	uint16_t error;
+
+	if (dataout_len != NULL)
+		*dataout_len = 0;
+	if (data_in == NULL || data_out == NULL || (aad_len > 0 && aad == NULL) || datain_len < SE3_ENVELOPE_OVERHEAD)
+		return(SE3_ERR_PARAMS);
+	len = datain_len - SE3_ENVELOPE_OVERHEAD;
+
+	error = L1_envelope_unwrap_key(env, SE3_ENVELOPE_WRAPPED_SIZE, data_in, key);
+	if (error != SE3_OK)
+		return error;
+
+	error = L1_envelope_gcm(key, nonce, true, aad_len, aad, len, nonce + SE3_ENVELOPE_NONCE_SIZE, data_out);
+	memset(key, 0, sizeof(key));
+
+	if (dataout_len != NULL && error == SE3_OK)
+		*dataout_len = len;
+	return error;
+}
@@ -7,6 +7,7 @@
 #pragma once
 #include "L0.h"
 #include "se3c1def.h"
+#include "se3_payload.h"
 
 
 /* defines */
@@ -20,6 +21,13 @@
 #define SE3_RESP_CHALLENGE_SC_OFFSET   (32)
 #define SE3_RESP_LOGIN_TOKEN_OFFSET   (32)
 
+/** data key of the objects sealed by L1_envelope_seal, used with AES-256-GCM on the host */
+#define SE3_ENVELOPE_KEY_SIZE   (32)
+#define SE3_ENVELOPE_WRAPPED_SIZE   (SE3_ENVELOPE_KEY_SIZE + SE3_CRYPTO_KW_OVERHEAD)
+#define SE3_ENVELOPE_NONCE_SIZE   (12)
+/** bytes added by L1_envelope_seal: wrapped key, nonce and tag */
+#define SE3_ENVELOPE_OVERHEAD   (SE3_ENVELOPE_WRAPPED_SIZE + SE3_ENVELOPE_NONCE_SIZE + SE3_CRYPTO_AEAD_TAG_SIZE)
+
 /* END - defines */
 
 
@@ -29,6 +37,13 @@ extern "C" {
 #endif
 
 /* struct */
+/** \brief CPU time spent on the last command, see se3_session::last_cycles */
+typedef struct se3_cmd_cycles_ {
+	uint32_t host_crypto;  ///< host cycles spent protecting the request and checking the response
+	uint32_t host_total;  ///< host cycles for the whole command, transfer included
+	uint32_t device;  ///< device cycles from the request to its response, payload protection of the response excluded
+} se3_cmd_cycles;
+
 /** \brief SEcube Communication session structure */
 typedef struct se3_session_ {
 	se3_device device;
@@ -41,6 +56,8 @@ typedef struct se3_session_ {
 	se3_file hfile;
 	se3_payload_cryptoctx cryptoctx;
 	bool cryptoctx_initialized;
+	uint16_t cmd_flags;  ///< optional command flags negotiated at login (SE3_CMDFLAG_AEAD)
+	se3_cmd_cycles last_cycles;  ///< CPU time of the last command
 	// TODO: Add flag for type of user logged (see set_{admin,user}_PIN) or change type for logged_in
 } se3_session;
 
@@ -63,6 +80,13 @@ typedef struct se3_algo_ {
 	uint16_t key_size;
 } se3_algo;
 
+/** \brief Envelope encryption context: a SE3_ALGO_AES_KW session on a key encryption
+ *  key stored in the device, see \ref L1_envelope_init */
+typedef struct se3_envelope_ {
+	se3_session* s;
+	uint32_t sess_id;
+} se3_envelope;
+
 
 /* END - struct */
 
@@ -134,6 +158,20 @@ uint16_t L1_logout(se3_session* s);
 */
 uint16_t L1_key_list(se3_session* s, uint16_t skip, uint16_t max_keys, const uint8_t* salt, se3_key* key_array, uint16_t* count);
 /**
+*  \brief List the keys that follow a cursor, to read the whole list in batches
+*
+*  \param [in] s Pointer to current se3_session, you must be logged in
+*  \param [in,out] cursor \ref SE3_KEY_LIST_CURSOR_START to start from the first key; on return,
+*  			   the cursor that resumes the listing after the last key returned
+*  \param [in] max_keys How many keys you want to retrieve from the device
+*  \param [in] salt Salt for the key fingerprints (can be NULL)
+*  \param [out] key_array Pointer to the already allocated array where to store the keys
+*  \param [out] count Effective number of retrieved keys, 0 at the end of the list
+*  \return It returns SE3_OK on success, SE3_ERR_EXPIRED if a write moved the keys since the
+*  		 cursor was returned (start again from \ref SE3_KEY_LIST_CURSOR_START), otherwise see \ref se3c1def.h
+*/
+uint16_t L1_key_list_next(se3_session* s, uint64_t* cursor, uint16_t max_keys, const uint8_t* salt, se3_key* key_array, uint16_t* count);
+/**
 *  \brief This function is used to edit the keys data on the device
 *
 *  \param [in] s Pointer to current se3_session, you must be logged in
@@ -144,6 +182,53 @@ uint16_t L1_key_list(se3_session* s, uint16_t skip, uint16_t max_keys, const uin
 */
 uint16_t L1_key_edit(se3_session* s, uint16_t op, se3_key* k);
 
+/**
+*  \brief This function is used to insert or update many keys read from a key file
+*
+*  \param [in] s Pointer to current se3_session, you must be logged in
+*  \param [in] op \ref SE3_KEY_OP_INSERT or \ref SE3_KEY_OP_UPSERT
+*  \param [in] fp Key file, opened in binary mode
+*  \param [out] count Number of keys written to the device (can be NULL)
+*  \return It returns SE3_OK on success, otherwise see \ref se3c1def.h
+*
+*  \details The key file is a sequence of records
+*  		 (id:ui32, validity:ui32, data-len:ui16, name-len:ui16, data[data-len], name[name-len]),
+*  		 with little-endian integers. Records are streamed to the device packing as many
+*  		 keys as possible in each request. Each request is validated as a whole before the
+*  		 flash is written: with \ref SE3_KEY_OP_INSERT it is rejected if one of its keys already
+*  		 exists, and it is rejected if its keys do not fit. Writing is not atomic: as with
+*  		 \ref L1_key_edit, replaced keys are deleted before the new values are written, so a
+*  		 flash failure or a reset during a request can leave some of its keys missing.
+*  		 Keys which are already stored with the same value are not rewritten, and are not counted.
+*/
+uint16_t L1_key_import(se3_session* s, uint16_t op, FILE* fp, size_t* count);
+
+/**
+*  \brief This function is used to get information about a single key
+*
+*  \param [in] s Pointer to current se3_session, you must be logged in
+*  \param [in] key_id ID of the key
+*  \param [in] salt Salt for the key fingerprint (can be NULL: the fingerprint is not computed,
+*  			   and is returned zeroed)
+*  \param [out] key Pointer to the key structure where to store the information (can be NULL);
+*  			  the data field is not modified
+*  \return It returns SE3_OK on success, SE3_ERR_RESOURCE if the key does not exist,
+*  		 otherwise see \ref se3c1def.h
+*/
+uint16_t L1_key_get_info(se3_session* s, uint32_t key_id, const uint8_t* salt, se3_key* key);
+
+/**
+*  \brief Check the fingerprints returned by \ref L1_key_list or \ref L1_key_get_info against known key values
+*
+*  \param [in] keys Keys whose data, data_size and fingerprint fields are set
+*  \param [in] count Number of keys
+*  \param [in] salt Salt used when the fingerprints were read (can be NULL, as for \ref L1_key_list;
+*  			   \ref L1_key_get_info returns no fingerprint without a salt)
+*  \param [out] match Result for each key (can be NULL)
+*  \return true if all the fingerprints match, false otherwise
+*/
+bool L1_key_verify(const se3_key* keys, uint16_t count, const uint8_t* salt, bool* match);
+
 /**
  *  \brief Check if a Key is present or not
  *  
@@ -243,6 +328,45 @@ uint16_t L1_decrypt(se3_session* s, uint16_t algorithm, uint16_t mode, uint32_t
 */
 uint16_t L1_digest(se3_session* s, uint16_t algorithm, size_t datain_len, uint8_t* data_in, size_t* dataout_len, uint8_t* data_out);
 /**
+*  \brief This function is used to encrypt and authenticate a message with one of the
+*  	   authenticated encryption algorithms (SE3_ALGO_AES_GCM, SE3_ALGO_CHACHA20_POLY1305)
+*
+*  \param [in] s Pointer to current se3_session, you must be logged in
+*  \param [in] algorithm Which algorithm to use, see \ref AlgorithmAvail
+*  \param [in] key_id Which key ID to use for encryption
+*  \param [in] nonce_len Length of the nonce; never reuse a nonce with the same key
+*  \param [in] nonce Pointer to the nonce
+*  \param [in] aad_len Length of the additional data, authenticated but not encrypted (can be 0)
+*  \param [in] aad Pointer to the additional data
+*  \param [in] datain_len How long is the buffer you want to encrypt
+*  \param [in] data_in Pointer to the buffer
+*  \param [out] dataout_len datain_len + SE3_CRYPTO_AEAD_TAG_SIZE (can be NULL)
+*  \param [out] data_out Pointer to a pre-allocated buffer where to store the cipher text
+*  			   followed by the tag
+*  \return It returns SE3_OK on success, otherwise see \ref se3c1def.h
+*
+*/
+uint16_t L1_aead_encrypt(se3_session* s, uint16_t algorithm, uint32_t key_id, uint16_t nonce_len, const uint8_t* nonce, size_t aad_len, const uint8_t* aad, size_t datain_len, const uint8_t* data_in, size_t* dataout_len, uint8_t* data_out);
+/**
+*  \brief This function is used to verify and decrypt a message produced by \ref L1_aead_encrypt
+*
+*  \param [in] s Pointer to current se3_session, you must be logged in
+*  \param [in] algorithm Which algorithm to use, see \ref AlgorithmAvail
+*  \param [in] key_id Which key ID to use for decryption
+*  \param [in] nonce_len Length of the nonce
+*  \param [in] nonce Pointer to the nonce used for encryption
+*  \param [in] aad_len Length of the additional data (can be 0)
+*  \param [in] aad Pointer to the additional data
+*  \param [in] datain_len How long is the cipher text, tag included
+*  \param [in] data_in Pointer to the cipher text followed by the tag
+*  \param [out] dataout_len datain_len - SE3_CRYPTO_AEAD_TAG_SIZE (can be NULL)
+*  \param [out] data_out Pointer to a pre-allocated buffer where to store the clear text
+*  \return It returns SE3_OK on success, SE3_ERR_AUTH if the message or the additional
+*  		 data have been modified, in which case data_out is cleared
+*
+*/
+uint16_t L1_aead_decrypt(se3_session* s, uint16_t algorithm, uint32_t key_id, uint16_t nonce_len, const uint8_t* nonce, size_t aad_len, const uint8_t* aad, size_t datain_len, const uint8_t* data_in, size_t* dataout_len, uint8_t* data_out);
+/**
 *  \brief This function is used to retrieve a list from the device of available algorithms
 *
 *  \param [in] s Pointer to current se3_session, you must be logged in
@@ -257,6 +381,95 @@ uint16_t L1_digest(se3_session* s, uint16_t algorithm, size_t datain_len, uint8_
 */
 uint16_t L1_get_algorithms(se3_session* s, uint16_t skip, uint16_t max_algorithms, se3_algo* algorithms_array, uint16_t* count);
 
+/**
+*  \brief This function opens an envelope encryption context on a key encryption key (KEK)
+*  	   stored in the device. The device generates, wraps and unwraps the data keys of
+*  	   the objects with a single command each, while the bulk encryption runs on the host
+*  	   (see \ref L1_envelope_seal). The KEK never leaves the device.
+*
+*  \param [in] s Pointer to current se3_session, you must be logged in
+*  \param [in] kek_id ID of the KEK, an AES key (128, 192 or 256 bits)
+*  \param [out] env Pointer to the context to initialize
+*  \return It returns SE3_OK on success, otherwise see \ref se3c1def.h
+*
+*/
+uint16_t L1_envelope_init(se3_session* s, uint32_t kek_id, se3_envelope* env);
+/**
+*  \brief This function releases the device session of an envelope encryption context
+*
+*  \param [in] env Pointer to the context opened by \ref L1_envelope_init
+*  \return It returns SE3_OK on success, otherwise see \ref se3c1def.h
+*
+*/
+uint16_t L1_envelope_close(se3_envelope* env);
+/**
+*  \brief This function asks the device for a new random data key, returned both in clear
+*  	   and wrapped under the KEK
+*
+*  \param [in] env Pointer to the context opened by \ref L1_envelope_init
+*  \param [in] key_size Size of the data key, from SE3_CRYPTO_KW_MIN_KEY to SE3_CRYPTO_KW_MAX_KEY
+*  			     in multiples of SE3_CRYPTO_KW_ALIGN
+*  \param [out] key Pointer to a buffer of key_size bytes
+*  \param [out] wrapped Pointer to a buffer of key_size + SE3_CRYPTO_KW_OVERHEAD bytes
+*  \return It returns SE3_OK on success, otherwise see \ref se3c1def.h
+*
+*/
+uint16_t L1_envelope_new_key(se3_envelope* env, uint16_t key_size, uint8_t* key, uint8_t* wrapped);
+/**
+*  \brief This function wraps a data key under the KEK
+*
+*  \param [in] env Pointer to the context opened by \ref L1_envelope_init
+*  \param [in] key_size Size of the data key, see \ref L1_envelope_new_key
+*  \param [in] key Pointer to the data key
+*  \param [out] wrapped Pointer to a buffer of key_size + SE3_CRYPTO_KW_OVERHEAD bytes
+*  \return It returns SE3_OK on success, otherwise see \ref se3c1def.h
+*
+*/
+uint16_t L1_envelope_wrap_key(se3_envelope* env, uint16_t key_size, const uint8_t* key, uint8_t* wrapped);
+/**
+*  \brief This function unwraps a data key wrapped under the KEK
+*
+*  \param [in] env Pointer to the context opened by \ref L1_envelope_init
+*  \param [in] wrapped_size Size of the wrapped key
+*  \param [in] wrapped Pointer to the wrapped key
+*  \param [out] key Pointer to a buffer of wrapped_size - SE3_CRYPTO_KW_OVERHEAD bytes
+*  \return It returns SE3_OK on success, SE3_ERR_AUTH if the key was not wrapped under
+*  		 this KEK or has been modified
+*
+*/
+uint16_t L1_envelope_unwrap_key(se3_envelope* env, uint16_t wrapped_size, const uint8_t* wrapped, uint8_t* key);
+/**
+*  \brief This function encrypts and authenticates an object under a new data key: one
+*  	   command to the device, then AES-256-GCM on the host.
+*
+*  \param [in] env Pointer to the context opened by \ref L1_envelope_init
+*  \param [in] aad_len Length of the additional data, authenticated but not encrypted (can be 0)
+*  \param [in] aad Pointer to the additional data
+*  \param [in] datain_len How long is the object
+*  \param [in] data_in Pointer to the object
+*  \param [out] dataout_len datain_len + SE3_ENVELOPE_OVERHEAD (can be NULL)
+*  \param [out] data_out Pointer to a pre-allocated buffer where to store the wrapped key, the
+*  			   nonce, the cipher text and the tag
+*  \return It returns SE3_OK on success, otherwise see \ref se3c1def.h
+*
+*/
+uint16_t L1_envelope_seal(se3_envelope* env, size_t aad_len, const uint8_t* aad, size_t datain_len, const uint8_t* data_in, size_t* dataout_len, uint8_t* data_out);
+/**
+*  \brief This function verifies and decrypts an object produced by \ref L1_envelope_seal
+*
+*  \param [in] env Pointer to the context opened by \ref L1_envelope_init, on the same KEK
+*  \param [in] aad_len Length of the additional data (can be 0)
+*  \param [in] aad Pointer to the additional data
+*  \param [in] datain_len How long is the sealed object
+*  \param [in] data_in Pointer to the sealed object
+*  \param [out] dataout_len datain_len - SE3_ENVELOPE_OVERHEAD (can be NULL)
+*  \param [out] data_out Pointer to a pre-allocated buffer where to store the object
+*  \return It returns SE3_OK on success, SE3_ERR_AUTH if the object, its key or the
+*  		 additional data have been modified, in which case data_out is cleared
+*
+*/
+uint16_t L1_envelope_open(se3_envelope* env, size_t aad_len, const uint8_t* aad, size_t datain_len, const uint8_t* data_in, size_t* dataout_len, uint8_t* data_out);
+
 
 #ifdef __cplusplus
 }
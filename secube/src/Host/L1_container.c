@@ -0,0 +1,514 @@
+#include "L1_container.h"
+
+/* threads: one for each device but the first, which runs in the caller */
+#ifdef _WIN32
+typedef HANDLE L1_container_thread;
+#define L1_CONTAINER_THREAD_FN DWORD WINAPI
+#define L1_CONTAINER_THREAD_RET 0
+static bool thread_start(L1_container_thread* t, LPTHREAD_START_ROUTINE fn, void* arg)
+{
+	*t = CreateThread(NULL, 0, fn, arg, 0, NULL);
+	return (*t != NULL);
+}
+static void thread_join(L1_container_thread t)
+{
+	WaitForSingleObject(t, INFINITE);
+	CloseHandle(t);
+}
+#else
+typedef pthread_t L1_container_thread;
+#define L1_CONTAINER_THREAD_FN void*
+#define L1_CONTAINER_THREAD_RET NULL
+static bool thread_start(L1_container_thread* t, void* (*fn)(void*), void* arg)
+{
+	return (0 == pthread_create(t, NULL, fn, arg));
+}
+static void thread_join(L1_container_thread t)
+{
+	pthread_join(t, NULL);
+}
+#endif
+
+#define L1_CONTAINER_MAGIC "SE3C"
+#define L1_CONTAINER_INDEX_MAGIC "SE3I"
+#define L1_CONTAINER_TAG SE3_CRYPTO_AEAD_TAG_SIZE
+
+/** Header and footer fields */
+enum {
+	L1_CONTAINER_HEADER_OFF_MAGIC = 0,
+	L1_CONTAINER_HEADER_OFF_VERSION = 4,
+	L1_CONTAINER_HEADER_OFF_ALGORITHM = 6,
+	L1_CONTAINER_HEADER_OFF_KEY_ID = 8,
+	L1_CONTAINER_HEADER_OFF_CHUNK_SIZE = 12,
+	L1_CONTAINER_HEADER_OFF_PREFIX = 16,
+	L1_CONTAINER_FOOTER_OFF_SIZE = 0,
+	L1_CONTAINER_FOOTER_OFF_CHUNKS = 8,
+	L1_CONTAINER_FOOTER_OFF_MAGIC = 12
+};
+
+/** nonces hold the chunk number in 32 bits */
+#define L1_CONTAINER_MAX_CHUNKS ((uint64_t)1 << 32)
+
+/** Chunks of the batch given to one device */
+typedef struct container_job_ {
+	L1_container* c;
+	uint16_t dev;
+	bool decrypt;
+	uint64_t first;  ///< number of the first chunk of the batch
+	uint16_t count;  ///< chunks in the batch
+	uint64_t last;  ///< number of the last chunk of the container
+	uint16_t error;
+} container_job;
+
+static bool container_algorithm_valid(uint16_t algorithm)
+{
+	return (algorithm == SE3_ALGO_AES_GCM) || (algorithm == SE3_ALGO_CHACHA20_POLY1305);
+}
+
+/** Keep one session for each device, the first one found */
+static uint16_t container_set_devices(L1_container* c, se3_session* const* sessions, uint16_t n_sessions)
+{
+	uint16_t i, j;
+
+	if (sessions == NULL || n_sessions == 0)
+		return(SE3_ERR_PARAMS);
+	c->n_dev = 0;
+	for (i = 0; i < n_sessions && c->n_dev < L1_CONTAINER_MAX_DEVICES; i++) {
+		if (sessions[i] == NULL || !sessions[i]->logged_in)
+			return(SE3_ERR_PARAMS);
+		for (j = 0; j < c->n_dev; j++) {
+			if (!memcmp(c->dev[j]->device.info.serialno, sessions[i]->device.info.serialno, SE3_SN_SIZE))
+				break;
+		}
+		if (j == c->n_dev)
+			c->dev[c->n_dev++] = sessions[i];
+	}
+	return(SE3_OK);
+}
+
+static uint16_t container_alloc(L1_container* c)
+{
+	c->batch = c->n_dev * L1_CONTAINER_DEVICE_CHUNKS;
+	c->clear = (uint8_t*)malloc((size_t)c->batch * c->chunk_size);
+	c->cipher = (uint8_t*)malloc((size_t)c->batch * (c->chunk_size + L1_CONTAINER_TAG));
+	c->lens = (size_t*)calloc(c->batch, sizeof(size_t));
+	if (c->clear == NULL || c->cipher == NULL || c->lens == NULL)
+		return(SE3_ERR_MEMORY);
+	return(SE3_OK);
+}
+
+static uint8_t* container_clear(L1_container* c, uint16_t i)
+{
+	return c->clear + (size_t)i * c->chunk_size;
+}
+
+static uint8_t* container_cipher(L1_container* c, uint16_t i)
+{
+	return c->cipher + (size_t)i * (c->chunk_size + L1_CONTAINER_TAG);
+}
+
+/** prefix || chunk number (big endian) || last chunk flag */
+static void container_nonce(const L1_container* c, uint64_t chunk, bool last, uint8_t* nonce)
+{
+	memcpy(nonce, c->header + L1_CONTAINER_HEADER_OFF_PREFIX, L1_CONTAINER_PREFIX_SIZE);
+	nonce[7] = (uint8_t)(chunk >> 24);
+	nonce[8] = (uint8_t)(chunk >> 16);
+	nonce[9] = (uint8_t)(chunk >> 8);
+	nonce[10] = (uint8_t)chunk;
+	nonce[11] = last ? 1 : 0;
+}
+
+static L1_CONTAINER_THREAD_FN container_worker(void* arg)
+{
+	container_job* job = (container_job*)arg;
+	L1_container* c = job->c;
+	se3_session* s = c->dev[job->dev];
+	uint8_t nonce[L1_CONTAINER_NONCE_SIZE];
+	uint16_t i;
+
+	job->error = SE3_OK;
+	for (i = job->dev; i < job->count && job->error == SE3_OK; i += c->n_dev) {
+		container_nonce(c, job->first + i, (job->first + i == job->last), nonce);
+		if (job->decrypt) {
+			job->error = L1_aead_decrypt(s, c->algorithm, c->key_id, L1_CONTAINER_NONCE_SIZE, nonce, 0, NULL,
+				c->lens[i] + L1_CONTAINER_TAG, container_cipher(c, i), NULL, container_clear(c, i));
+		}
+		else {
+			job->error = L1_aead_encrypt(s, c->algorithm, c->key_id, L1_CONTAINER_NONCE_SIZE, nonce, 0, NULL,
+				c->lens[i], container_clear(c, i), NULL, container_cipher(c, i));
+		}
+	}
+	return L1_CONTAINER_THREAD_RET;
+}
+
+/** Encrypt or decrypt the first count chunks of the batch, chunk i on device i % n_dev */
+static uint16_t container_run(L1_container* c, bool decrypt, uint64_t first, uint16_t count, uint64_t last)
+{
+	container_job jobs[L1_CONTAINER_MAX_DEVICES];
+	L1_container_thread threads[L1_CONTAINER_MAX_DEVICES];
+	bool started[L1_CONTAINER_MAX_DEVICES];
+	uint16_t n = (count < c->n_dev) ? count : c->n_dev;
+	uint16_t i, error = SE3_OK;
+
+	for (i = 0; i < n; i++) {
+		jobs[i].c = c;
+		jobs[i].dev = i;
+		jobs[i].decrypt = decrypt;
+		jobs[i].first = first;
+		jobs[i].count = count;
+		jobs[i].last = last;
+		started[i] = (i > 0) && thread_start(&threads[i], container_worker, &jobs[i]);
+	}
+	for (i = 0; i < n; i++) {
+		if (!started[i])
+			container_worker(&jobs[i]);
+	}
+	for (i = 0; i < n; i++) {
+		if (started[i])
+			thread_join(threads[i]);
+		if (error == SE3_OK)
+			error = jobs[i].error;
+	}
+	return(error);
+}
+
+/** Encrypt and write the first count chunks of the batch */
+static uint16_t container_emit(L1_container* c, uint16_t count, bool last)
+{
+	uint64_t* index;
+	uint16_t error;
+	uint16_t i;
+
+	if (c->chunks + count > L1_CONTAINER_MAX_CHUNKS)
+		return(SE3_ERR_MEMORY);
+	if (c->chunks + count > c->index_cap) {
+		c->index_cap = (c->index_cap == 0) ? 256 : 2 * c->index_cap;
+		if (c->chunks + count > c->index_cap)
+			c->index_cap = c->chunks + count;
+		index = (uint64_t*)realloc(c->index, (size_t)c->index_cap * sizeof(uint64_t));
+		if (index == NULL)
+			return(SE3_ERR_MEMORY);
+		c->index = index;
+	}
+
+	error = container_run(c, false, c->chunks, count, last ? (c->chunks + count - 1) : UINT64_MAX);
+	if (error != SE3_OK)
+		return(error);
+
+	for (i = 0; i < count; i++) {
+		if (!c->write(c->io_ctx, container_cipher(c, i), c->lens[i] + L1_CONTAINER_TAG))
+			return(SE3_ERR_RESOURCE);
+		c->index[c->chunks++] = c->end;
+		c->end += c->lens[i] + L1_CONTAINER_TAG;
+	}
+	return(SE3_OK);
+}
+
+/** Clear text offset of a chunk */
+static uint64_t container_chunk_offset(const L1_container* c, uint64_t chunk)
+{
+	return c->index[chunk] - L1_CONTAINER_HEADER_SIZE - chunk * L1_CONTAINER_TAG;
+}
+
+static uint64_t container_chunk_end(const L1_container* c, uint64_t chunk)
+{
+	return (chunk + 1 < c->chunks) ? c->index[chunk + 1] : c->end;
+}
+
+/** Read and decrypt count chunks into the batch */
+static uint16_t container_load(L1_container* c, uint64_t first, uint16_t count)
+{
+	uint64_t off;
+	uint16_t i;
+
+	for (i = 0; i < count; i++) {
+		off = c->index[first + i];
+		c->lens[i] = (size_t)(container_chunk_end(c, first + i) - off - L1_CONTAINER_TAG);
+		if (!c->read(c->io_ctx, off, container_cipher(c, i), c->lens[i] + L1_CONTAINER_TAG))
+			return(SE3_ERR_RESOURCE);
+	}
+	return container_run(c, true, first, count, c->chunks - 1);
+}
+
+uint16_t L1_container_create(L1_container* c, se3_session* const* sessions, uint16_t n_sessions, uint16_t algorithm,
+	uint32_t key_id, uint32_t chunk_size, L1_container_write_cb write, void* write_ctx)
+{
+	uint16_t version = L1_CONTAINER_VERSION;
+	uint16_t error;
+
+	if (c == NULL)
+		return(SE3_ERR_PARAMS);
+	memset(c, 0, sizeof(L1_container));
+	if (write == NULL || !container_algorithm_valid(algorithm) || chunk_size == 0 || chunk_size > L1_CONTAINER_MAX_CHUNK)
+		return(SE3_ERR_PARAMS);
+	error = container_set_devices(c, sessions, n_sessions);
+	if (error != SE3_OK)
+		return(error);
+
+	c->writing = true;
+	c->algorithm = algorithm;
+	c->key_id = key_id;
+	c->chunk_size = chunk_size;
+	c->write = write;
+	c->io_ctx = write_ctx;
+	c->end = L1_CONTAINER_HEADER_SIZE;
+	error = container_alloc(c);
+
+	if (error == SE3_OK) {
+		memcpy(c->header + L1_CONTAINER_HEADER_OFF_MAGIC, L1_CONTAINER_MAGIC, 4);
+		SE3_SET16(c->header, L1_CONTAINER_HEADER_OFF_VERSION, version);
+		SE3_SET16(c->header, L1_CONTAINER_HEADER_OFF_ALGORITHM, algorithm);
+		SE3_SET32(c->header, L1_CONTAINER_HEADER_OFF_KEY_ID, key_id);
+		SE3_SET32(c->header, L1_CONTAINER_HEADER_OFF_CHUNK_SIZE, chunk_size);
+		se3c_rand(L1_CONTAINER_PREFIX_SIZE, c->header + L1_CONTAINER_HEADER_OFF_PREFIX);
+		if (!write(write_ctx, c->header, L1_CONTAINER_HEADER_SIZE))
+			error = SE3_ERR_RESOURCE;
+	}
+	if (error != SE3_OK) {
+		c->writing = false;
+		L1_container_close(c);
+	}
+	return(error);
+}
+
+uint16_t L1_container_write(L1_container* c, size_t data_len, const uint8_t* data)
+{
+	size_t curr_len;
+
+	if (c == NULL || !c->writing || (data_len > 0 && data == NULL))
+		return(SE3_ERR_PARAMS);
+
+	while (c->error == SE3_OK && data_len > 0) {
+		// a complete batch is written only when more data follows, as its last chunk could be the last one
+		if (c->pending == c->batch) {
+			c->error = container_emit(c, c->pending, false);
+			c->pending = 0;
+			c->lens[0] = 0;
+			if (c->error != SE3_OK)
+				break;
+		}
+		curr_len = c->chunk_size - c->lens[c->pending];
+		if (curr_len > data_len)
+			curr_len = data_len;
+		memcpy(container_clear(c, c->pending) + c->lens[c->pending], data, curr_len);
+		c->lens[c->pending] += curr_len;
+		c->size += curr_len;
+		data += curr_len;
+		data_len -= curr_len;
+		if (c->lens[c->pending] == c->chunk_size)
+			L1_container_flush(c);
+	}
+	return(c->error);
+}
+
+uint16_t L1_container_flush(L1_container* c)
+{
+	if (c == NULL || !c->writing)
+		return(SE3_ERR_PARAMS);
+	if (c->pending < c->batch && c->lens[c->pending] > 0) {
+		c->pending++;
+		if (c->pending < c->batch)
+			c->lens[c->pending] = 0;
+	}
+	return(c->error);
+}
+
+uint16_t L1_container_open(L1_container* c, se3_session* const* sessions, uint16_t n_sessions,
+	L1_container_read_cb read, void* read_ctx, uint64_t container_size)
+{
+	uint8_t footer[L1_CONTAINER_FOOTER_SIZE];
+	uint16_t version = 0;
+	uint32_t count = 0;
+	uint64_t index_size, len, size = 0;
+	uint64_t i;
+	size_t off;
+	uint16_t error;
+
+	if (c == NULL)
+		return(SE3_ERR_PARAMS);
+	memset(c, 0, sizeof(L1_container));
+	if (read == NULL)
+		return(SE3_ERR_PARAMS);
+	error = container_set_devices(c, sessions, n_sessions);
+	if (error != SE3_OK)
+		return(error);
+	c->read = read;
+	c->io_ctx = read_ctx;
+
+	if (container_size < L1_CONTAINER_HEADER_SIZE + L1_CONTAINER_FOOTER_SIZE)
+		return(SE3_ERR_PARAMS);
+	if (!read(read_ctx, 0, c->header, L1_CONTAINER_HEADER_SIZE) ||
+		!read(read_ctx, container_size - L1_CONTAINER_FOOTER_SIZE, footer, L1_CONTAINER_FOOTER_SIZE))
+		return(SE3_ERR_RESOURCE);
+	SE3_GET16(c->header, L1_CONTAINER_HEADER_OFF_VERSION, version);
+	SE3_GET16(c->header, L1_CONTAINER_HEADER_OFF_ALGORITHM, c->algorithm);
+	SE3_GET32(c->header, L1_CONTAINER_HEADER_OFF_KEY_ID, c->key_id);
+	SE3_GET32(c->header, L1_CONTAINER_HEADER_OFF_CHUNK_SIZE, c->chunk_size);
+	SE3_GET64(footer, L1_CONTAINER_FOOTER_OFF_SIZE, c->size);
+	SE3_GET32(footer, L1_CONTAINER_FOOTER_OFF_CHUNKS, count);
+	if (memcmp(c->header + L1_CONTAINER_HEADER_OFF_MAGIC, L1_CONTAINER_MAGIC, 4) || version != L1_CONTAINER_VERSION ||
+		memcmp(footer + L1_CONTAINER_FOOTER_OFF_MAGIC, L1_CONTAINER_INDEX_MAGIC, 4) ||
+		!container_algorithm_valid(c->algorithm) || c->chunk_size == 0 || c->chunk_size > L1_CONTAINER_MAX_CHUNK || count == 0)
+		return(SE3_ERR_PARAMS);
+
+	// the index and at least a tag for each chunk must fit
+	index_size = (uint64_t)count * sizeof(uint64_t);
+	if (container_size - L1_CONTAINER_HEADER_SIZE - L1_CONTAINER_FOOTER_SIZE < index_size + (uint64_t)count * L1_CONTAINER_TAG ||
+		index_size > SIZE_MAX)
+		return(SE3_ERR_PARAMS);
+	c->chunks = count;
+	c->end = container_size - L1_CONTAINER_FOOTER_SIZE - index_size;
+	c->index = (uint64_t*)malloc((size_t)index_size);
+	if (c->index == NULL)
+		return(SE3_ERR_MEMORY);
+	error = container_alloc(c);
+	if (error == SE3_OK && !read(read_ctx, c->end, (uint8_t*)c->index, (size_t)index_size))
+		error = SE3_ERR_RESOURCE;
+	for (i = 0; i < c->chunks && error == SE3_OK; i++) {
+		off = (size_t)i * sizeof(uint64_t);
+		SE3_GET64(c->index, off, c->index[i]);
+	}
+
+	// the chunks follow each other from the header to the index
+	if (error == SE3_OK && c->index[0] != L1_CONTAINER_HEADER_SIZE)
+		error = SE3_ERR_PARAMS;
+	for (i = 0; i < c->chunks && error == SE3_OK; i++) {
+		if (container_chunk_end(c, i) <= c->index[i]) {
+			error = SE3_ERR_PARAMS;
+			break;
+		}
+		len = container_chunk_end(c, i) - c->index[i];
+		if (len < L1_CONTAINER_TAG || len > (uint64_t)c->chunk_size + L1_CONTAINER_TAG)
+			error = SE3_ERR_PARAMS;
+		size += len - L1_CONTAINER_TAG;
+	}
+	if (error == SE3_OK && size != c->size)
+		error = SE3_ERR_PARAMS;
+
+	// the last chunk tells whether the container has been truncated
+	if (error == SE3_OK)
+		error = container_load(c, c->chunks - 1, 1);
+
+	if (error != SE3_OK)
+		L1_container_close(c);
+	return(error);
+}
+
+uint16_t L1_container_read(L1_container* c, uint64_t offset, size_t data_len, uint8_t* data, size_t* read_len)
+{
+	uint64_t lo, hi, mid, chunk, chunk_off;
+	size_t done = 0, curr_len, skip;
+	uint16_t count, i;
+	uint16_t error = SE3_OK;
+
+	if (read_len != NULL)
+		*read_len = 0;
+	if (c == NULL || c->read == NULL || (data_len > 0 && data == NULL))
+		return(SE3_ERR_PARAMS);
+	if (offset >= c->size)
+		return(SE3_OK);
+	if (data_len > c->size - offset)
+		data_len = (size_t)(c->size - offset);
+
+	// last chunk starting at or before the offset
+	lo = 0;
+	hi = c->chunks - 1;
+	while (lo < hi) {
+		mid = lo + (hi - lo + 1) / 2;
+		if (container_chunk_offset(c, mid) <= offset)
+			lo = mid;
+		else
+			hi = mid - 1;
+	}
+	chunk = lo;
+
+	while (done < data_len && error == SE3_OK) {
+		// the chunks covering the rest of the range, up to a batch
+		for (count = 0; count < c->batch && chunk + count < c->chunks; count++) {
+			if (container_chunk_offset(c, chunk + count) >= offset + data_len)
+				break;
+		}
+		error = container_load(c, chunk, count);
+		for (i = 0; i < count && error == SE3_OK; i++) {
+			chunk_off = container_chunk_offset(c, chunk + i);
+			skip = (size_t)(offset + done - chunk_off);
+			curr_len = c->lens[i] - skip;
+			if (curr_len > data_len - done)
+				curr_len = data_len - done;
+			memcpy(data + done, container_clear(c, i) + skip, curr_len);
+			done += curr_len;
+		}
+		chunk += count;
+	}
+
+	if (error != SE3_OK) {
+		memset(data, 0, data_len);
+		return(error);
+	}
+	if (read_len != NULL)
+		*read_len = done;
+	return(SE3_OK);
+}
+
+uint64_t L1_container_size(const L1_container* c)
+{
+	return (c == NULL) ? 0 : c->size;
+}
+
+/** Write the index, each offset serialized as the other fields of the container */
+static uint16_t container_write_index(L1_container* c)
+{
+	enum { BATCH = 64 };
+	uint8_t buf[BATCH * sizeof(uint64_t)];
+	uint64_t i;
+	size_t n, off;
+
+	for (i = 0; i < c->chunks; i += n) {
+		n = (c->chunks - i < BATCH) ? (size_t)(c->chunks - i) : BATCH;
+		for (off = 0; off < n * sizeof(uint64_t); off += sizeof(uint64_t))
+			SE3_SET64(buf, off, c->index[i + off / sizeof(uint64_t)]);
+		if (!c->write(c->io_ctx, buf, n * sizeof(uint64_t)))
+			return(SE3_ERR_RESOURCE);
+	}
+	return(SE3_OK);
+}
+
+uint16_t L1_container_close(L1_container* c)
+{
+	uint8_t footer[L1_CONTAINER_FOOTER_SIZE];
+	uint32_t count;
+	uint16_t n;
+	uint16_t error = SE3_OK;
+
+	if (c == NULL)
+		return(SE3_ERR_PARAMS);
+
+	if (c->writing) {
+		error = c->error;
+		if (error == SE3_OK) {
+			// the open chunk, even if empty when it is the only one
+			n = c->pending;
+			if (n < c->batch && (c->lens[n] > 0 || n == 0))
+				n++;
+			error = container_emit(c, n, true);
+		}
+		if (error == SE3_OK) {
+			count = (uint32_t)c->chunks;
+			memcpy(footer + L1_CONTAINER_FOOTER_OFF_MAGIC, L1_CONTAINER_INDEX_MAGIC, 4);
+			SE3_SET64(footer, L1_CONTAINER_FOOTER_OFF_SIZE, c->size);
+			SE3_SET32(footer, L1_CONTAINER_FOOTER_OFF_CHUNKS, count);
+			error = container_write_index(c);
+			if (error == SE3_OK && !c->write(c->io_ctx, footer, L1_CONTAINER_FOOTER_SIZE))
+				error = SE3_ERR_RESOURCE;
+		}
+	}
+
+	if (c->clear != NULL)
+		memset(c->clear, 0, (size_t)c->batch * c->chunk_size);
+	free(c->clear);
+	free(c->cipher);
+	free(c->lens);
+	free(c->index);
+	memset(c, 0, sizeof(L1_container));
+	return(error);
+}
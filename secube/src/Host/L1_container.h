@@ -0,0 +1,183 @@
+/**
+ *  \file L1_container.h
+ *  \brief Chunked, seekable encrypted container
+ *
+ *  \details The clear text is split in chunks of a fixed size, each one encrypted and
+ *  authenticated on its own by the device with SE3_ALGO_AES_GCM or SE3_ALGO_CHACHA20_POLY1305,
+ *  so that any byte range can be decrypted without the rest of the container, and so that
+ *  the chunks can be processed by several devices at the same time.
+ *
+ *  Layout, integers in the byte order of the host like the rest of the protocol:
+ *
+ *  | field   | bytes                             | content                                          |
+ *  |---------|-----------------------------------|--------------------------------------------------|
+ *  | header  | L1_CONTAINER_HEADER_SIZE          | "SE3C", version, algorithm, key id, chunk size, nonce prefix |
+ *  | chunk i | up to chunk size + tag            | cipher text followed by the tag                  |
+ *  | index   | 8 per chunk                       | file offset of each chunk                        |
+ *  | footer  | L1_CONTAINER_FOOTER_SIZE          | clear text size, chunk count, "SE3I"             |
+ *
+ *  The nonce of chunk i is the random prefix of the container, i as a 32-bit big endian
+ *  integer and one byte set to 1 for the last chunk only (the STREAM construction): chunks
+ *  cannot be reordered, moved to another container or dropped from the end without failing
+ *  the authentication. A chunk is shorter than the chunk size only when it is the last one
+ *  or when the writer called \ref L1_container_flush, the index locates them. The header is
+ *  not authenticated on its own: a modified key id, algorithm or nonce prefix makes every
+ *  chunk fail.
+ */
+
+#pragma once
+#include "L1.h"
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Container format */
+enum {
+	L1_CONTAINER_VERSION = 1,
+	L1_CONTAINER_HEADER_SIZE = 32,
+	L1_CONTAINER_FOOTER_SIZE = 16,
+	L1_CONTAINER_PREFIX_SIZE = 7,  ///< random part of the chunk nonces
+	L1_CONTAINER_NONCE_SIZE = 12,
+	L1_CONTAINER_DEFAULT_CHUNK = 65536,
+	L1_CONTAINER_MAX_CHUNK = (1 << 20),
+	L1_CONTAINER_MAX_DEVICES = 16,  ///< devices working on the same container
+	L1_CONTAINER_DEVICE_CHUNKS = 4  ///< chunks given to each device at a time
+};
+
+/** \brief Read callback of a container
+ *  \param [in] ctx Context given to L1_container_open
+ *  \param [in] offset Position in the container
+ *  \param [out] buf Where to store the data
+ *  \param [in] len Bytes to read, all of them
+ *  \return true on success
+ */
+typedef bool (*L1_container_read_cb)(void* ctx, uint64_t offset, uint8_t* buf, size_t len);
+
+/** \brief Write callback of a container, called with consecutive blocks of the container
+ *  \param [in] ctx Context given to L1_container_create
+ *  \param [in] buf Data to append
+ *  \param [in] len Bytes to write, all of them
+ *  \return true on success
+ */
+typedef bool (*L1_container_write_cb)(void* ctx, const uint8_t* buf, size_t len);
+
+/** \brief Container being written or read, the fields are private */
+typedef struct L1_container_ {
+	se3_session* dev[L1_CONTAINER_MAX_DEVICES];  ///< one session for each device
+	uint16_t n_dev;
+	uint16_t algorithm;
+	uint32_t key_id;
+	uint32_t chunk_size;
+	uint8_t header[L1_CONTAINER_HEADER_SIZE];
+	bool writing;
+	L1_container_read_cb read;
+	L1_container_write_cb write;
+	void* io_ctx;
+	uint64_t* index;  ///< offset of each chunk
+	uint64_t chunks;  ///< chunks in the index
+	uint64_t index_cap;
+	uint64_t size;  ///< clear text bytes
+	uint64_t end;  ///< end of the chunks
+	uint8_t* clear;  ///< batch of chunks, L1_CONTAINER_DEVICE_CHUNKS per device
+	uint8_t* cipher;
+	size_t* lens;  ///< clear text bytes in each chunk of the batch
+	uint16_t batch;  ///< chunks in the batch
+	uint16_t pending;  ///< writer: complete chunks in the batch, the next one is being filled
+	uint16_t error;  ///< writer: first failure, returned by the following calls
+} L1_container;
+
+/**
+*  \brief This function starts a new container and writes its header
+*
+*  \param [out] c Container
+*  \param [in] sessions Sessions to use, you must be logged in; requests to sessions of the
+*  			   same device are serialized, since a device runs one request at a time
+*  \param [in] n_sessions Number of sessions
+*  \param [in] algorithm SE3_ALGO_AES_GCM or SE3_ALGO_CHACHA20_POLY1305
+*  \param [in] key_id Which key ID to use, it must be present in all the devices
+*  \param [in] chunk_size Clear text bytes in each chunk, up to L1_CONTAINER_MAX_CHUNK
+*  \param [in] write Write callback
+*  \param [in] write_ctx Context of the write callback
+*  \return It returns SE3_OK on success, SE3_ERR_RESOURCE if the callback failed, otherwise
+*  		 see \ref se3c1def.h
+*/
+uint16_t L1_container_create(L1_container* c, se3_session* const* sessions, uint16_t n_sessions, uint16_t algorithm,
+	uint32_t key_id, uint32_t chunk_size, L1_container_write_cb write, void* write_ctx);
+
+/**
+*  \brief This function appends clear text to a container being written
+*
+*  \param [in] c Container
+*  \param [in] data_len How long is the buffer
+*  \param [in] data Pointer to the buffer
+*  \return It returns SE3_OK on success, SE3_ERR_RESOURCE if the callback failed, otherwise
+*  		 see \ref se3c1def.h
+*
+*  \details The chunks are encrypted when a batch of them is complete, all the devices
+*  		 working at the same time.
+*/
+uint16_t L1_container_write(L1_container* c, size_t data_len, const uint8_t* data);
+
+/**
+*  \brief This function ends the current chunk, even if it is not full, so that the data
+*  		  written so far can be read back as soon as the batch is encrypted
+*
+*  \param [in] c Container
+*  \return It returns SE3_OK on success, otherwise see \ref se3c1def.h
+*/
+uint16_t L1_container_flush(L1_container* c);
+
+/**
+*  \brief This function opens an existing container and checks its last chunk
+*
+*  \param [out] c Container
+*  \param [in] sessions Sessions to use, see \ref L1_container_create
+*  \param [in] n_sessions Number of sessions
+*  \param [in] read Read callback
+*  \param [in] read_ctx Context of the read callback
+*  \param [in] container_size Size of the whole container
+*  \return It returns SE3_OK on success, SE3_ERR_PARAMS if the container is malformed,
+*  		 SE3_ERR_AUTH if it has been truncated or modified, SE3_ERR_RESOURCE if the callback
+*  		 failed, otherwise see \ref se3c1def.h
+*/
+uint16_t L1_container_open(L1_container* c, se3_session* const* sessions, uint16_t n_sessions,
+	L1_container_read_cb read, void* read_ctx, uint64_t container_size);
+
+/**
+*  \brief This function decrypts a range of an open container
+*
+*  \param [in] c Container
+*  \param [in] offset Position of the first clear text byte
+*  \param [in] data_len Bytes to read
+*  \param [out] data Pointer to a pre-allocated buffer of data_len bytes
+*  \param [out] read_len Bytes read, less than data_len at the end of the container (can be NULL)
+*  \return It returns SE3_OK on success, SE3_ERR_AUTH if a chunk has been modified, in
+*  		 which case data is cleared, otherwise see \ref L1_container_open
+*
+*  \details Only the chunks covering the range are read and decrypted, all the devices
+*  		 working at the same time.
+*/
+uint16_t L1_container_read(L1_container* c, uint64_t offset, size_t data_len, uint8_t* data, size_t* read_len);
+
+/**
+*  \brief This function returns the clear text size of a container
+*
+*  \param [in] c Container
+*  \return Bytes written so far, or size of an open container
+*/
+uint64_t L1_container_size(const L1_container* c);
+
+/**
+*  \brief This function ends a container: a container being written gets its last chunks,
+*  		  its index and its footer; the buffers are released in any case
+*
+*  \param [in] c Container
+*  \return It returns SE3_OK on success, otherwise see \ref L1_container_write
+*/
+uint16_t L1_container_close(L1_container* c);
+
+#ifdef __cplusplus
+}
+#endif
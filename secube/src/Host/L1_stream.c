@@ -0,0 +1,375 @@
+#include "L1_stream.h"
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <limits.h>
+#endif
+
+/* threads: the device loop runs in the caller, the reader and the writer in their own thread */
+#ifdef _WIN32
+typedef HANDLE L1_stream_thread;
+typedef CRITICAL_SECTION L1_stream_mutex;
+typedef CONDITION_VARIABLE L1_stream_cond;
+#define L1_STREAM_THREAD_FN DWORD WINAPI
+#define L1_STREAM_THREAD_RET 0
+#define mutex_init(m) InitializeCriticalSection(m)
+#define mutex_destroy(m) DeleteCriticalSection(m)
+#define mutex_lock(m) EnterCriticalSection(m)
+#define mutex_unlock(m) LeaveCriticalSection(m)
+#define cond_init(c) InitializeConditionVariable(c)
+#define cond_destroy(c)
+#define cond_wait(c, m) SleepConditionVariableCS(c, m, INFINITE)
+#define cond_broadcast(c) WakeAllConditionVariable(c)
+static bool thread_start(L1_stream_thread* t, LPTHREAD_START_ROUTINE fn, void* arg)
+{
+	*t = CreateThread(NULL, 0, fn, arg, 0, NULL);
+	return (*t != NULL);
+}
+static void thread_join(L1_stream_thread t)
+{
+	WaitForSingleObject(t, INFINITE);
+	CloseHandle(t);
+}
+#else
+typedef pthread_t L1_stream_thread;
+typedef pthread_mutex_t L1_stream_mutex;
+typedef pthread_cond_t L1_stream_cond;
+#define L1_STREAM_THREAD_FN void*
+#define L1_STREAM_THREAD_RET NULL
+#define mutex_init(m) pthread_mutex_init(m, NULL)
+#define mutex_destroy(m) pthread_mutex_destroy(m)
+#define mutex_lock(m) pthread_mutex_lock(m)
+#define mutex_unlock(m) pthread_mutex_unlock(m)
+#define cond_init(c) pthread_cond_init(c, NULL)
+#define cond_destroy(c) pthread_cond_destroy(c)
+#define cond_wait(c, m) pthread_cond_wait(c, m)
+#define cond_broadcast(c) pthread_cond_broadcast(c)
+static bool thread_start(L1_stream_thread* t, void* (*fn)(void*), void* arg)
+{
+	return (0 == pthread_create(t, NULL, fn, arg));
+}
+static void thread_join(L1_stream_thread t)
+{
+	pthread_join(t, NULL);
+}
+#endif
+
+enum {
+	L1_STREAM_SLOT_SIZE = L1_STREAM_CHUNK * L1_STREAM_SLOT_CHUNKS
+};
+
+/** owner of a ring slot */
+enum {
+	SLOT_FREE = 0,  ///< reader
+	SLOT_READY = 1,  ///< device loop
+	SLOT_DONE = 2  ///< writer
+};
+
+typedef struct L1_stream_slot_ {
+	uint8_t* in;
+	uint8_t* out;
+	size_t len;  ///< bytes in in, then in out
+	bool eof;  ///< last slot of the stream, possibly empty
+	int state;
+} L1_stream_slot;
+
+typedef struct L1_stream_ctx_ {
+	L1_stream_slot slots[L1_STREAM_SLOTS];
+	L1_stream_mutex lock;
+	L1_stream_cond cond;
+	bool abort;
+	bool read_failed;
+	bool write_failed;
+	L1_stream_read_cb read;
+	void* read_ctx;
+	L1_stream_write_cb write;
+	void* write_ctx;
+	uint64_t bytes_in;
+	uint64_t bytes_out;
+} L1_stream_ctx;
+
+/** Wait until the slot reaches the state or the stream is aborted; called with the lock held */
+static bool slot_wait(L1_stream_ctx* ctx, L1_stream_slot* slot, int state)
+{
+	while (slot->state != state && !ctx->abort) {
+		cond_wait(&ctx->cond, &ctx->lock);
+	}
+	return !ctx->abort;
+}
+
+static void slot_set(L1_stream_ctx* ctx, L1_stream_slot* slot, int state)
+{
+	mutex_lock(&ctx->lock);
+	slot->state = state;
+	cond_broadcast(&ctx->cond);
+	mutex_unlock(&ctx->lock);
+}
+
+static void stream_abort(L1_stream_ctx* ctx)
+{
+	mutex_lock(&ctx->lock);
+	ctx->abort = true;
+	cond_broadcast(&ctx->cond);
+	mutex_unlock(&ctx->lock);
+}
+
+static L1_STREAM_THREAD_FN stream_reader(void* arg)
+{
+	L1_stream_ctx* ctx = (L1_stream_ctx*)arg;
+	L1_stream_slot* slot;
+	size_t i = 0;
+	long long n;
+	bool eof = false;
+
+	while (!eof) {
+		slot = &ctx->slots[i++ % L1_STREAM_SLOTS];
+		mutex_lock(&ctx->lock);
+		if (!slot_wait(ctx, slot, SLOT_FREE)) {
+			mutex_unlock(&ctx->lock);
+			break;
+		}
+		mutex_unlock(&ctx->lock);
+
+		// fill the whole slot, so that a short slot marks the end of the stream
+		slot->len = 0;
+		while (slot->len < L1_STREAM_SLOT_SIZE) {
+			n = ctx->read(ctx->read_ctx, slot->in + slot->len, L1_STREAM_SLOT_SIZE - slot->len);
+			if (n < 0) {
+				ctx->read_failed = true;
+				stream_abort(ctx);
+				return L1_STREAM_THREAD_RET;
+			}
+			if (n == 0) {
+				eof = true;
+				break;
+			}
+			slot->len += (size_t)n;
+		}
+		ctx->bytes_in += slot->len;
+		slot->eof = eof;
+		slot_set(ctx, slot, SLOT_READY);
+	}
+	return L1_STREAM_THREAD_RET;
+}
+
+static L1_STREAM_THREAD_FN stream_writer(void* arg)
+{
+	L1_stream_ctx* ctx = (L1_stream_ctx*)arg;
+	L1_stream_slot* slot;
+	size_t i = 0;
+	bool eof = false;
+
+	while (!eof) {
+		slot = &ctx->slots[i++ % L1_STREAM_SLOTS];
+		mutex_lock(&ctx->lock);
+		if (!slot_wait(ctx, slot, SLOT_DONE)) {
+			mutex_unlock(&ctx->lock);
+			break;
+		}
+		mutex_unlock(&ctx->lock);
+
+		if (slot->len > 0 && !ctx->write(ctx->write_ctx, slot->out, slot->len)) {
+			ctx->write_failed = true;
+			stream_abort(ctx);
+			break;
+		}
+		ctx->bytes_out += slot->len;
+		eof = slot->eof;
+		slot_set(ctx, slot, SLOT_FREE);
+	}
+	return L1_STREAM_THREAD_RET;
+}
+
+/** Wait for the next slot of the device loop; counts the waits */
+static L1_stream_slot* stream_next(L1_stream_ctx* ctx, size_t i, L1_stream_stats* stats)
+{
+	L1_stream_slot* slot = &ctx->slots[i % L1_STREAM_SLOTS];
+	bool ok;
+
+	mutex_lock(&ctx->lock);
+	if (slot->state != SLOT_READY && !ctx->abort) {
+		stats->input_stalls++;
+	}
+	ok = slot_wait(ctx, slot, SLOT_READY);
+	mutex_unlock(&ctx->lock);
+	return ok ? slot : NULL;
+}
+
+uint16_t L1_stream_crypt(se3_session* s, uint16_t algorithm, uint16_t mode, uint32_t key_id, const uint8_t* iv,
+	L1_stream_read_cb read, void* read_ctx, L1_stream_write_cb write, void* write_ctx, L1_stream_stats* stats)
+{
+	L1_stream_ctx* ctx;
+	L1_stream_stats local_stats;
+	L1_stream_slot* slot, *next = NULL;
+	L1_stream_thread reader, writer;
+	bool reader_started = false, writer_started = false;
+	bool session_open = false, finit_sent = false, first = true, tail, last;
+	uint16_t feedback = mode & 0x07;
+	bool pad_tail = (feedback == SE3_FEEDBACK_CTR) || (feedback == SE3_FEEDBACK_OFB) || (feedback == SE3_FEEDBACK_CFB);
+	uint16_t error = SE3_OK;
+	uint16_t flags, chunk, padded, out_len;
+	uint32_t sess_id = 0;
+	size_t i, off;
+
+	if (s == NULL || read == NULL || write == NULL)
+		return(SE3_ERR_PARAMS);
+	if (stats == NULL)
+		stats = &local_stats;
+	memset(stats, 0, sizeof(L1_stream_stats));
+
+	ctx = (L1_stream_ctx*)calloc(1, sizeof(L1_stream_ctx));
+	if (ctx == NULL)
+		return(SE3_ERR_MEMORY);
+	ctx->read = read;
+	ctx->read_ctx = read_ctx;
+	ctx->write = write;
+	ctx->write_ctx = write_ctx;
+	for (i = 0; i < L1_STREAM_SLOTS; i++) {
+		// room for the padding of a partial last block
+		ctx->slots[i].in = (uint8_t*)malloc(L1_STREAM_SLOT_SIZE + 16);
+		ctx->slots[i].out = (uint8_t*)malloc(L1_STREAM_SLOT_SIZE + 16);
+		if (ctx->slots[i].in == NULL || ctx->slots[i].out == NULL)
+			error = SE3_ERR_MEMORY;
+	}
+	mutex_init(&ctx->lock);
+	cond_init(&ctx->cond);
+
+	if (error == SE3_OK) {
+		error = L1_crypto_init(s, algorithm, mode, key_id, &sess_id);
+		session_open = (error == SE3_OK);
+	}
+	if (error == SE3_OK) {
+		reader_started = thread_start(&reader, stream_reader, ctx);
+		writer_started = reader_started && thread_start(&writer, stream_writer, ctx);
+		if (!writer_started)
+			error = SE3_ERR_MEMORY;
+	}
+
+	slot = (error == SE3_OK) ? stream_next(ctx, 0, stats) : NULL;
+	for (i = 0; slot != NULL && error == SE3_OK; i++) {
+		last = false;
+		for (off = 0; error == SE3_OK; off += chunk) {
+			chunk = (uint16_t)((slot->len - off < L1_STREAM_CHUNK) ? slot->len - off : L1_STREAM_CHUNK);
+			tail = (off + chunk == slot->len);
+			if (tail) {
+				// a slot is short only at the end of the stream; after a full one, the stream
+				// ends if the next slot is empty
+				if (slot->eof) {
+					last = true;
+				}
+				else {
+					next = stream_next(ctx, i + 1, stats);
+					if (next == NULL)
+						break;
+					last = next->eof && (next->len == 0);
+				}
+			}
+			if (chunk == 0 && !last)
+				break;
+
+			padded = chunk;
+			if (chunk % 16) {
+				if (!last || !pad_tail) {
+					error = SE3_ERR_PARAMS;
+					break;
+				}
+				padded = chunk + (16 - chunk % 16);
+				memset(slot->in + off + chunk, 0, padded - chunk);
+			}
+
+			flags = last ? SE3_CRYPTO_FLAG_FINIT : 0;
+			if (first && iv != NULL)
+				flags |= SE3_CRYPTO_FLAG_SETIV;
+			out_len = 0;
+			error = L1_crypto_update(s, sess_id, flags, (first && iv != NULL) ? 16 : 0, iv, padded, slot->in + off, &out_len, slot->out + off);
+			stats->requests++;
+			first = false;
+			if (error == SE3_OK && out_len != padded)
+				error = SE3_ERR_COMM;
+			finit_sent = last && (error == SE3_OK);
+			if (tail)
+				break;
+		}
+		if (error != SE3_OK || ctx->abort)
+			break;
+
+		slot_set(ctx, slot, SLOT_DONE);
+		if (last) {
+			if (!slot->eof) {
+				// the empty slot that ends the stream still goes to the writer
+				slot_set(ctx, next, SLOT_DONE);
+			}
+			break;
+		}
+		slot = next;
+	}
+
+	if (!finit_sent) {
+		stream_abort(ctx);
+		if (session_open) {
+			// release the device session
+			L1_crypto_update(s, sess_id, SE3_CRYPTO_FLAG_FINIT, 0, NULL, 0, NULL, NULL, NULL);
+		}
+	}
+	if (reader_started)
+		thread_join(reader);
+	if (writer_started)
+		thread_join(writer);
+
+	if (error == SE3_OK && (ctx->read_failed || ctx->write_failed))
+		error = SE3_ERR_RESOURCE;
+	stats->bytes_in = ctx->bytes_in;
+	stats->bytes_out = ctx->bytes_out;
+
+	cond_destroy(&ctx->cond);
+	mutex_destroy(&ctx->lock);
+	for (i = 0; i < L1_STREAM_SLOTS; i++) {
+		free(ctx->slots[i].in);
+		free(ctx->slots[i].out);
+	}
+	free(ctx);
+	return error;
+}
+
+static long long stream_fd_read(void* ctx, uint8_t* buf, size_t len)
+{
+	int fd = *(int*)ctx;
+	if (len > INT_MAX)
+		len = INT_MAX;
+	for (;;) {
+#ifdef _WIN32
+		int n = _read(fd, buf, (unsigned int)len);
+#else
+		ssize_t n = read(fd, buf, len);
+		if (n < 0 && errno == EINTR)
+			continue;
+#endif
+		return (long long)n;
+	}
+}
+
+static bool stream_fd_write(void* ctx, const uint8_t* buf, size_t len)
+{
+	int fd = *(int*)ctx;
+	while (len > 0) {
+#ifdef _WIN32
+		int n = _write(fd, buf, (unsigned int)((len > INT_MAX) ? INT_MAX : len));
+#else
+		ssize_t n = write(fd, buf, len);
+		if (n < 0 && errno == EINTR)
+			continue;
+#endif
+		if (n <= 0)
+			return false;
+		buf += n;
+		len -= (size_t)n;
+	}
+	return true;
+}
+
+uint16_t L1_stream_crypt_fd(se3_session* s, uint16_t algorithm, uint16_t mode, uint32_t key_id, const uint8_t* iv,
+	int fd_in, int fd_out, L1_stream_stats* stats)
+{
+	return L1_stream_crypt(s, algorithm, mode, key_id, iv, stream_fd_read, &fd_in, stream_fd_write, &fd_out, stats);
+}
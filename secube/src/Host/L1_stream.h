@@ -0,0 +1,88 @@
+/**
+ *  \file L1_stream.h
+ *  \brief Streaming encryption of files and pipes through the device
+ *
+ *  \details L1_encrypt needs the whole input and output in memory, and waits for each
+ *  request before copying the next chunk. The functions in this file read the input ahead
+ *  and write the output from two helper threads, so that the device is kept busy while the
+ *  host does the I/O.
+ */
+
+#pragma once
+#include "L1.h"
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Streaming buffers */
+enum {
+	L1_STREAM_CHUNK = (SE3_CRYPTO_MAX_DATAIN - 16),  ///< data bytes per crypto_update, the IV takes one 16-byte row of the first one
+	L1_STREAM_SLOT_CHUNKS = 64,  ///< chunks read or written by one call of the callbacks
+	L1_STREAM_SLOTS = 4  ///< buffers in the ring shared by the reader, the device loop and the writer
+};
+
+/** \brief Read callback
+ *  \param [in] ctx Context given to L1_stream_crypt
+ *  \param [out] buf Where to store the data
+ *  \param [in] len Maximum bytes to read
+ *  \return Bytes read, 0 at the end of the input, a negative value on error
+ */
+typedef long long (*L1_stream_read_cb)(void* ctx, uint8_t* buf, size_t len);
+
+/** \brief Write callback
+ *  \param [in] ctx Context given to L1_stream_crypt
+ *  \param [in] buf Data to write
+ *  \param [in] len Bytes to write, all of them
+ *  \return true on success
+ */
+typedef bool (*L1_stream_write_cb)(void* ctx, const uint8_t* buf, size_t len);
+
+/** \brief Counters of a streaming operation */
+typedef struct L1_stream_stats_ {
+	uint64_t bytes_in;  ///< bytes read from the input
+	uint64_t bytes_out;  ///< bytes written to the output
+	uint32_t requests;  ///< crypto_update requests sent to the device
+	uint32_t input_stalls;  ///< times the device loop had to wait for the reader
+} L1_stream_stats;
+
+/**
+*  \brief This function encrypts or decrypts a stream of any length with SE3_ALGO_AES
+*
+*  \param [in] s Pointer to current se3_session, you must be logged in
+*  \param [in] algorithm Which algorithm to use, see \ref AlgorithmAvail; the output of each
+*  			  request must be as long as its input
+*  \param [in] mode This parameter strictly depends on the which algorithm is chosen
+*  \param [in] key_id Which key ID to use
+*  \param [in] iv Initialization vector sent with the first request (SE3_CRYPTO_FLAG_SETIV),
+*  			   16 bytes, or NULL to keep the default one
+*  \param [in] read Read callback
+*  \param [in] read_ctx Context of the read callback
+*  \param [in] write Write callback
+*  \param [in] write_ctx Context of the write callback
+*  \param [out] stats Counters of the operation (can be NULL)
+*  \return It returns SE3_OK on success, SE3_ERR_RESOURCE if a callback failed, otherwise
+*  		 see \ref se3c1def.h
+*
+*  \details The input is split in L1_STREAM_CHUNK byte requests, the last one with
+*  		 SE3_CRYPTO_FLAG_FINIT. A last block shorter than 16 bytes is zero padded and the
+*  		 output truncated in the CTR, OFB and CFB modes; the other modes need whole blocks
+*  		 and fail with SE3_ERR_PARAMS.
+*/
+uint16_t L1_stream_crypt(se3_session* s, uint16_t algorithm, uint16_t mode, uint32_t key_id, const uint8_t* iv,
+	L1_stream_read_cb read, void* read_ctx, L1_stream_write_cb write, void* write_ctx, L1_stream_stats* stats);
+
+/**
+*  \brief This function is \ref L1_stream_crypt on file descriptors (files, pipes, stdin/stdout)
+*
+*  \param [in] fd_in Descriptor to read until its end
+*  \param [in] fd_out Descriptor to write the output to
+*  \return See \ref L1_stream_crypt
+*/
+uint16_t L1_stream_crypt_fd(se3_session* s, uint16_t algorithm, uint16_t mode, uint32_t key_id, const uint8_t* iv,
+	int fd_in, int fd_out, L1_stream_stats* stats);
+
+#ifdef __cplusplus
+}
+#endif
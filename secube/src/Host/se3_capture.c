@@ -0,0 +1,194 @@
+#include "se3_capture.h"
+#include "se3comm.h"
+
+#ifdef SE3_CAPTURE_ENABLE
+
+#ifdef _WIN32
+#include <sddl.h>
+#include <io.h>
+#include <fcntl.h>
+#pragma comment(lib, "Advapi32.lib")
+typedef SRWLOCK se3_capture_mutex;
+#define SE3_CAPTURE_MUTEX_INIT SRWLOCK_INIT
+#define mutex_lock(m) AcquireSRWLockExclusive(m)
+#define mutex_unlock(m) ReleaseSRWLockExclusive(m)
+#else
+typedef pthread_mutex_t se3_capture_mutex;
+#define SE3_CAPTURE_MUTEX_INIT PTHREAD_MUTEX_INITIALIZER
+#define mutex_lock(m) pthread_mutex_lock(m)
+#define mutex_unlock(m) pthread_mutex_unlock(m)
+#endif
+
+/* One capture per process, shared by all the devices */
+static struct {
+	se3_capture_mutex lock;
+	FILE* fp;
+	uint64_t start;
+	volatile bool active;
+} capture = { SE3_CAPTURE_MUTEX_INIT, NULL, 0, false };
+
+/** \brief Append a record; called with the lock held */
+static void capture_record(uint64_t time, uint32_t duration, uint32_t block, uint16_t nblocks, uint8_t type, bool ok, const uint8_t* data, uint32_t len)
+{
+	uint8_t rec[SE3_CAPTURE_REC_SIZE];
+
+	SE3_SET64(rec, SE3_CAPTURE_REC_OFF_TIME, time);
+	SE3_SET32(rec, SE3_CAPTURE_REC_OFF_DURATION, duration);
+	SE3_SET32(rec, SE3_CAPTURE_REC_OFF_BLOCK, block);
+	SE3_SET16(rec, SE3_CAPTURE_REC_OFF_NBLOCKS, nblocks);
+	rec[SE3_CAPTURE_REC_OFF_TYPE] = type;
+	rec[SE3_CAPTURE_REC_OFF_OK] = (ok) ? (1) : (0);
+	SE3_SET32(rec, SE3_CAPTURE_REC_OFF_LEN, len);
+	if (fwrite(rec, 1, sizeof(rec), capture.fp) != sizeof(rec) ||
+		(len > 0 && fwrite(data, 1, len, capture.fp) != len))
+	{
+		// stop rather than leave a truncated record in the middle of the file
+		fclose(capture.fp);
+		capture.fp = NULL;
+		capture.active = false;
+	}
+}
+
+/** \brief Create a new file that only its owner can read and write: it holds session keys */
+static FILE* capture_create(const char* path)
+{
+	FILE* fp = NULL;
+	int fd;
+#ifdef _WIN32
+	SECURITY_ATTRIBUTES sa;
+	PSECURITY_DESCRIPTOR sd = NULL;
+	HANDLE h;
+
+	// protected DACL, full access for the owner only
+	if (!ConvertStringSecurityDescriptorToSecurityDescriptorA("D:P(A;;FA;;;OW)", SDDL_REVISION_1, &sd, NULL)) {
+		return NULL;
+	}
+	sa.nLength = sizeof(sa);
+	sa.lpSecurityDescriptor = sd;
+	sa.bInheritHandle = FALSE;
+	DeleteFileA(path);
+	h = CreateFileA(path, GENERIC_WRITE, 0, &sa, CREATE_NEW, FILE_ATTRIBUTE_NORMAL, NULL);
+	LocalFree(sd);
+	if (h == INVALID_HANDLE_VALUE) {
+		return NULL;
+	}
+	fd = _open_osfhandle((intptr_t)h, _O_BINARY);
+	if (fd < 0) {
+		CloseHandle(h);
+		return NULL;
+	}
+	fp = _fdopen(fd, "wb");
+	if (fp == NULL) {
+		_close(fd);
+	}
+#else
+	// an existing file would keep its mode and owner, and could be a link
+	if (unlink(path) != 0 && errno != ENOENT) {
+		return NULL;
+	}
+	fd = open(path, O_WRONLY | O_CREAT | O_EXCL, S_IRUSR | S_IWUSR);
+	if (fd < 0) {
+		return NULL;
+	}
+	fp = fdopen(fd, "wb");
+	if (fp == NULL) {
+		close(fd);
+	}
+#endif
+	return fp;
+}
+
+bool se3_capture_open(const char* path)
+{
+	uint8_t hdr[SE3_CAPTURE_HEADER_SIZE];
+	uint32_t magic = SE3_CAPTURE_MAGIC;
+	uint16_t version = SE3_CAPTURE_VERSION, block_size = SE3_COMM_BLOCK;
+	uint64_t start = se3c_clock_us();
+	FILE* fp = capture_create(path);
+
+	if (fp == NULL) {
+		return false;
+	}
+	SE3_SET32(hdr, SE3_CAPTURE_OFF_MAGIC, magic);
+	SE3_SET16(hdr, SE3_CAPTURE_OFF_VERSION, version);
+	SE3_SET16(hdr, SE3_CAPTURE_OFF_BLOCK_SIZE, block_size);
+	SE3_SET64(hdr, SE3_CAPTURE_OFF_START, start);
+	if (fwrite(hdr, 1, sizeof(hdr), fp) != sizeof(hdr)) {
+		fclose(fp);
+		return false;
+	}
+
+	se3_capture_close();
+	mutex_lock(&(capture.lock));
+	capture.fp = fp;
+	capture.start = start;
+	capture.active = true;
+	mutex_unlock(&(capture.lock));
+	return true;
+}
+
+void se3_capture_close()
+{
+	mutex_lock(&(capture.lock));
+	capture.active = false;
+	if (capture.fp != NULL) {
+		fclose(capture.fp);
+		capture.fp = NULL;
+	}
+	mutex_unlock(&(capture.lock));
+}
+
+bool se3_capture_active()
+{
+	return capture.active;
+}
+
+void se3_capture_blocks(uint8_t type, const uint8_t* buf, size_t block, size_t nblocks, bool ok, uint64_t start, uint64_t end)
+{
+	uint32_t len = (type == SE3_CAPTURE_WRITE || ok) ? ((uint32_t)(nblocks * SE3_COMM_BLOCK)) : (0);
+
+	mutex_lock(&(capture.lock));
+	if (capture.fp != NULL) {
+		capture_record(start - capture.start, (uint32_t)(end - start), (uint32_t)block, (uint16_t)nblocks, type, ok, buf, len);
+	}
+	mutex_unlock(&(capture.lock));
+}
+
+void se3_capture_session(const uint8_t* token, const uint8_t* key, uint16_t access, uint16_t cmd_flags)
+{
+	uint8_t data[SE3_CAPTURE_SESSION_SIZE];
+	uint64_t now = se3c_clock_us();
+
+	memcpy(data + SE3_CAPTURE_SESSION_OFF_TOKEN, token, SE3_TOKEN_SIZE);
+	memcpy(data + SE3_CAPTURE_SESSION_OFF_KEY, key, SE3_KEY_SIZE);
+	SE3_SET16(data, SE3_CAPTURE_SESSION_OFF_ACCESS, access);
+	SE3_SET16(data, SE3_CAPTURE_SESSION_OFF_CMDFLAGS, cmd_flags);
+
+	mutex_lock(&(capture.lock));
+	if (capture.fp != NULL) {
+		capture_record(now - capture.start, 0, 0, 0, SE3_CAPTURE_SESSION, true, data, sizeof(data));
+	}
+	mutex_unlock(&(capture.lock));
+	memset(data, 0, sizeof(data));
+}
+
+#else
+
+bool se3_capture_open(const char* path)
+{
+	return false;
+}
+
+void se3_capture_close()
+{
+}
+
+void se3_capture_blocks(uint8_t type, const uint8_t* buf, size_t block, size_t nblocks, bool ok, uint64_t start, uint64_t end)
+{
+}
+
+void se3_capture_session(const uint8_t* token, const uint8_t* key, uint16_t access, uint16_t cmd_flags)
+{
+}
+
+#endif
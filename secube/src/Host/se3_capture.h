@@ -0,0 +1,108 @@
+/**
+ *  \file se3_capture.h
+ *  \brief Recording of the block traffic between the host and the SEcube, for offline replay
+ *
+ *  \details While a capture is open, every \ref se3c_write and \ref se3c_read of the process is
+ *  appended to the capture file with its time, duration, block range, result and data. L1 logins
+ *  add a session record with the token and the session key, so that the replay can decrypt the
+ *  command codes and the simulated device can accept the requests of the session.
+ *
+ *  SECURITY: the session key decrypts every request and response of the session, so the file
+ *  exposes all the L1 traffic in clear: the keys written by key_edit and KEY_IMPORT_BATCH, the
+ *  PINs set by the config commands, the data and the results of the crypto commands. The login
+ *  PIN is not recorded, but the captured challenge and response allow to guess it offline. The
+ *  keys stored in the device are exposed only if they travel in the captured requests. The file
+ *  is created readable and writable by its owner only, and must be kept like the keys.
+ *
+ *  Capture is compiled only if SE3_CAPTURE_ENABLE is defined, below or by the project; in the
+ *  other builds \ref se3_capture_open fails and the transfers are not even checked. A capture
+ *  is started by \ref se3_capture_open, or by the first L0_open of the process if the environment
+ *  variable SE3_CAPTURE names the file, with no change to the application.
+ *
+ *  The replay driver of the simulator (secube-on-pc replay) feeds the captured requests to
+ *  se3_proto_recv and se3_proto_send and compares the time of each command with a baseline.
+ *
+ *  File format, little endian: a header, then records, each followed by len bytes of data.
+ *  header : (magic:ui32, version:ui16, block_size:ui16, start:ui64)
+ *  record : (time:ui64, duration:ui32, block:ui32, nblocks:ui16, type:ui8, ok:ui8, len:ui32, data[len])
+ *  time is in microseconds from start, which is \ref se3c_clock_us when the capture was opened.
+ *  Writes carry the blocks written, successful reads the blocks read, sessions
+ *  (token[16], key[32], access:ui16, cmd_flags:ui16).
+ */
+
+#pragma once
+
+#include "se3c1def.h"
+
+
+//#define SE3_CAPTURE_ENABLE
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+enum {
+	SE3_CAPTURE_MAGIC = 0x52334553,  ///< "SE3R"
+	SE3_CAPTURE_VERSION = 1,
+
+	SE3_CAPTURE_OFF_MAGIC = 0,
+	SE3_CAPTURE_OFF_VERSION = 4,
+	SE3_CAPTURE_OFF_BLOCK_SIZE = 6,
+	SE3_CAPTURE_OFF_START = 8,
+	SE3_CAPTURE_HEADER_SIZE = 16,
+
+	SE3_CAPTURE_REC_OFF_TIME = 0,
+	SE3_CAPTURE_REC_OFF_DURATION = 8,
+	SE3_CAPTURE_REC_OFF_BLOCK = 12,
+	SE3_CAPTURE_REC_OFF_NBLOCKS = 16,
+	SE3_CAPTURE_REC_OFF_TYPE = 18,
+	SE3_CAPTURE_REC_OFF_OK = 19,
+	SE3_CAPTURE_REC_OFF_LEN = 20,
+	SE3_CAPTURE_REC_SIZE = 24,
+
+	SE3_CAPTURE_SESSION_OFF_TOKEN = 0,
+	SE3_CAPTURE_SESSION_OFF_KEY = 16,
+	SE3_CAPTURE_SESSION_OFF_ACCESS = 48,
+	SE3_CAPTURE_SESSION_OFF_CMDFLAGS = 50,
+	SE3_CAPTURE_SESSION_SIZE = 52
+};
+
+/** Environment variable read by L0_open */
+#define SE3_CAPTURE_ENV "SE3_CAPTURE"
+
+/** Record types */
+enum {
+	SE3_CAPTURE_WRITE = 1,
+	SE3_CAPTURE_READ = 2,
+	SE3_CAPTURE_SESSION = 3
+};
+
+/** \brief Start recording to a new file, replacing the capture in progress if any
+ *
+ *  An existing file is replaced, not reused, so that the new one is private to the owner.
+ *  \return false if the file cannot be created, or if capture is not compiled
+ */
+bool se3_capture_open(const char* path);
+
+/** \brief Stop recording and close the file */
+void se3_capture_close();
+
+#ifdef SE3_CAPTURE_ENABLE
+/** \brief True while a capture is open; cheap enough to test around each block transfer */
+bool se3_capture_active();
+#else
+#define se3_capture_active() (false)
+#endif
+
+/** \brief Record a block transfer, called by se3c_write and se3c_read
+ *  \param [in] start \ref se3c_clock_us before the transfer
+ *  \param [in] end \ref se3c_clock_us after the transfer
+ */
+void se3_capture_blocks(uint8_t type, const uint8_t* buf, size_t block, size_t nblocks, bool ok, uint64_t start, uint64_t end);
+
+/** \brief Record the session established by an L1 login */
+void se3_capture_session(const uint8_t* token, const uint8_t* key, uint16_t access, uint16_t cmd_flags);
+
+#ifdef __cplusplus
+}
+#endif
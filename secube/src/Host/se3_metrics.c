@@ -0,0 +1,284 @@
+#include "se3_metrics.h"
+#include "se3comm.h"
+#include <stdarg.h>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+#ifdef _WIN32
+typedef CRITICAL_SECTION se3_metrics_mutex;
+#define mutex_init(m) InitializeCriticalSection(m)
+#define mutex_destroy(m) DeleteCriticalSection(m)
+#define mutex_lock(m) EnterCriticalSection(m)
+#define mutex_unlock(m) LeaveCriticalSection(m)
+#else
+typedef pthread_mutex_t se3_metrics_mutex;
+#define mutex_init(m) pthread_mutex_init(m, NULL)
+#define mutex_destroy(m) pthread_mutex_destroy(m)
+#define mutex_lock(m) pthread_mutex_lock(m)
+#define mutex_unlock(m) pthread_mutex_unlock(m)
+#endif
+
+struct se3_metrics_ {
+	se3_metrics_mutex lock;
+	se3_metrics_data data;
+};
+
+static const struct {
+	const char* name;
+	const char* help;
+} histograms[SE3_METRICS_HISTOGRAMS] = {
+	{ "se3_request_bytes", "Payload of the requests" },
+	{ "se3_response_bytes", "Payload of the responses" },
+	{ "se3_roundtrip_microseconds", "Request written and response read" },
+	{ "se3_write_microseconds", "Request write" },
+	{ "se3_wait_microseconds", "Wait for the response" },
+	{ "se3_read_microseconds", "Response read" },
+	{ "se3_polls", "Reads of the first response block" },
+	{ "se3_seal_microseconds", "L1 payload encryption on the host" },
+	{ "se3_open_microseconds", "L1 payload decryption on the host" },
+	{ "se3_device_cycles", "L1 command execution on the device" }
+};
+
+static const char* cmd0_names[SE3_METRICS_CMD0_COUNT] = {
+	NULL, "factory_init", "echo", "l1", "boot_mode_reset", "stats", "timeline", NULL
+};
+
+static const char* cmd1_names[SE3_METRICS_CMD1_COUNT] = {
+	NULL, "challenge", "login", "logout", "config", "key_edit", "key_list", "crypto_init",
+	"crypto_update", "crypto_list", "crypto_set_time", "key_import_batch", "key_get_info", NULL, NULL, NULL
+};
+
+/** \brief Index of the smallest bucket bound 2^i not below v */
+static unsigned se3_metrics_bucket(uint32_t v)
+{
+#if defined(_MSC_VER)
+	unsigned long i;
+#endif
+	if (v <= 1) {
+		return 0;
+	}
+#if defined(__GNUC__)
+	return 32 - (unsigned)__builtin_clz(v - 1);
+#elif defined(_MSC_VER)
+	_BitScanReverse(&i, v - 1);
+	return (unsigned)i + 1;
+#else
+	{
+		unsigned i = 0;
+		for (v--; v != 0; v >>= 1) {
+			i++;
+		}
+		return i;
+	}
+#endif
+}
+
+se3_metrics* se3_metrics_create()
+{
+	se3_metrics* m = (se3_metrics*)calloc(1, sizeof(se3_metrics));
+	if (m != NULL) {
+		mutex_init(&(m->lock));
+	}
+	return m;
+}
+
+void se3_metrics_destroy(se3_metrics* m)
+{
+	if (m != NULL) {
+		mutex_destroy(&(m->lock));
+		free(m);
+	}
+}
+
+void se3_metrics_reset(se3_metrics* m)
+{
+	mutex_lock(&(m->lock));
+	memset(&(m->data), 0, sizeof(se3_metrics_data));
+	mutex_unlock(&(m->lock));
+}
+
+void se3_metrics_snapshot(se3_metrics* m, se3_metrics_data* data)
+{
+	mutex_lock(&(m->lock));
+	memcpy(data, &(m->data), sizeof(se3_metrics_data));
+	mutex_unlock(&(m->lock));
+}
+
+void se3_metrics_sample_reset(se3_metrics_sample* sample)
+{
+	sample->mask = 0;
+}
+
+void se3_metrics_sample_set(se3_metrics_sample* sample, unsigned which, uint64_t value)
+{
+	sample->values[which] = (value > UINT32_MAX) ? (UINT32_MAX) : ((uint32_t)value);
+	sample->mask |= (uint16_t)(1 << which);
+}
+
+void se3_metrics_add(se3_metrics* m, unsigned level, uint16_t cmd, const se3_metrics_sample* sample, uint16_t status)
+{
+	se3_metrics_cmd* c;
+	se3_histogram* h;
+	unsigned buckets[SE3_METRICS_HISTOGRAMS];
+	unsigned i;
+
+	if (level == 0 && cmd < SE3_METRICS_CMD0_COUNT) {
+		c = m->data.cmd0 + cmd;
+	}
+	else if (level == 1 && cmd < SE3_METRICS_CMD1_COUNT) {
+		c = m->data.cmd1 + cmd;
+	}
+	else {
+		return;
+	}
+	for (i = 0; i < SE3_METRICS_HISTOGRAMS; i++) {
+		buckets[i] = se3_metrics_bucket(sample->values[i]);
+	}
+
+	mutex_lock(&(m->lock));
+	for (i = 0, h = c->h; i < SE3_METRICS_HISTOGRAMS; i++, h++) {
+		if (sample->mask & (1 << i)) {
+			(h->count)++;
+			h->sum += sample->values[i];
+			(h->buckets[buckets[i]])++;
+		}
+	}
+	if (status != SE3_OK) {
+		for (i = 0; i < SE3_METRICS_CODES; i++) {
+			if (c->errors[i] == 0 || c->codes[i] == status) {
+				c->codes[i] = status;
+				(c->errors[i])++;
+				break;
+			}
+		}
+		if (i == SE3_METRICS_CODES) {
+			(c->errors_other)++;
+		}
+	}
+	mutex_unlock(&(m->lock));
+}
+
+/** \brief Output of \ref se3_metrics_prometheus; counts the whole length even past the end */
+typedef struct {
+	char* buf;
+	size_t size;
+	size_t len;
+} se3_metrics_text;
+
+static void text_printf(se3_metrics_text* t, const char* fmt, ...)
+{
+	va_list args;
+	int n;
+	size_t left = (t->len < t->size) ? (t->size - t->len) : (0);
+	char* p = (left > 0) ? (t->buf + t->len) : (NULL);
+
+	va_start(args, fmt);
+	n = vsnprintf(p, left, fmt, args);
+	va_end(args);
+	if (n > 0) {
+		t->len += (size_t)n;
+	}
+}
+
+static bool cmd_used(const se3_metrics_cmd* c)
+{
+	return (c->h[SE3_METRICS_ROUNDTRIP_US].count > 0 || c->h[SE3_METRICS_REQ_BYTES].count > 0 ||
+		c->errors[0] > 0 || c->errors_other > 0);
+}
+
+static void text_labels(se3_metrics_text* t, unsigned level, unsigned cmd)
+{
+	const char* name = (level == 0) ? (cmd0_names[cmd]) : (cmd1_names[cmd]);
+
+	if (name != NULL) {
+		text_printf(t, "level=\"l%u\",cmd=\"%s\"", level, name);
+	}
+	else {
+		text_printf(t, "level=\"l%u\",cmd=\"%u\"", level, cmd);
+	}
+}
+
+static void text_histograms(se3_metrics_text* t, unsigned which, unsigned level, const se3_metrics_cmd* cmds, unsigned count)
+{
+	const se3_histogram* h;
+	uint64_t cumulative;
+	unsigned cmd, i;
+
+	for (cmd = 0; cmd < count; cmd++) {
+		h = cmds[cmd].h + which;
+		if (h->count == 0) {
+			continue;
+		}
+		for (i = 0, cumulative = 0; i < SE3_METRICS_BUCKETS; i++) {
+			cumulative += h->buckets[i];
+			text_printf(t, "%s_bucket{", histograms[which].name);
+			text_labels(t, level, cmd);
+			if (i < SE3_METRICS_BUCKETS - 1) {
+				text_printf(t, ",le=\"%lu\"} %llu\n", 1UL << i, (unsigned long long)cumulative);
+			}
+			else {
+				text_printf(t, ",le=\"+Inf\"} %llu\n", (unsigned long long)cumulative);
+			}
+		}
+		text_printf(t, "%s_sum{", histograms[which].name);
+		text_labels(t, level, cmd);
+		text_printf(t, "} %llu\n", (unsigned long long)h->sum);
+		text_printf(t, "%s_count{", histograms[which].name);
+		text_labels(t, level, cmd);
+		text_printf(t, "} %llu\n", (unsigned long long)h->count);
+	}
+}
+
+static void text_errors(se3_metrics_text* t, unsigned level, const se3_metrics_cmd* cmds, unsigned count)
+{
+	unsigned cmd, i;
+
+	for (cmd = 0; cmd < count; cmd++) {
+		if (!cmd_used(cmds + cmd)) {
+			continue;
+		}
+		for (i = 0; i < SE3_METRICS_CODES && cmds[cmd].errors[i] > 0; i++) {
+			text_printf(t, "se3_errors_total{");
+			text_labels(t, level, cmd);
+			text_printf(t, ",code=\"0x%04x\"} %llu\n", (unsigned)cmds[cmd].codes[i], (unsigned long long)cmds[cmd].errors[i]);
+		}
+		if (cmds[cmd].errors_other > 0) {
+			text_printf(t, "se3_errors_total{");
+			text_labels(t, level, cmd);
+			text_printf(t, ",code=\"other\"} %llu\n", (unsigned long long)cmds[cmd].errors_other);
+		}
+	}
+}
+
+size_t se3_metrics_prometheus(se3_metrics* m, char* buf, size_t size)
+{
+	se3_metrics_data* data = (se3_metrics_data*)malloc(sizeof(se3_metrics_data));
+	se3_metrics_text t;
+	unsigned which;
+
+	t.buf = buf;
+	t.size = size;
+	t.len = 0;
+	if (size > 0) {
+		buf[0] = '\0';
+	}
+	if (data == NULL) {
+		return 0;
+	}
+	// format a copy, without holding the lock
+	se3_metrics_snapshot(m, data);
+
+	for (which = 0; which < SE3_METRICS_HISTOGRAMS; which++) {
+		text_printf(&t, "# HELP %s %s\n# TYPE %s histogram\n", histograms[which].name, histograms[which].help, histograms[which].name);
+		text_histograms(&t, which, 0, data->cmd0, SE3_METRICS_CMD0_COUNT);
+		text_histograms(&t, which, 1, data->cmd1, SE3_METRICS_CMD1_COUNT);
+	}
+	text_printf(&t, "# HELP se3_errors_total Requests failed, by error code\n# TYPE se3_errors_total counter\n");
+	text_errors(&t, 0, data->cmd0, SE3_METRICS_CMD0_COUNT);
+	text_errors(&t, 1, data->cmd1, SE3_METRICS_CMD1_COUNT);
+
+	free(data);
+	return t.len;
+}
@@ -0,0 +1,113 @@
+/**
+ *  \file se3_metrics.h
+ *  \brief Histograms of the requests sent by the host library, by L0 and L1 command
+ *
+ *  \details When a registry is attached to a device, L0 times the request write, the wait for
+ *  the response (the poll loop) and the response read, and counts the polls; L1 adds the
+ *  payload encryption and decryption and the cycles reported by the device. Each request is
+ *  added to the histograms of its command together with its sizes and status: L1 requests
+ *  under their L1 command, the others under their L0 command. The registry is shared by any
+ *  number of devices and sessions, in any thread, and can be dumped in the Prometheus text
+ *  format at any time.
+ */
+
+#pragma once
+
+#include "se3c0def.h"
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Histograms kept for each command */
+enum {
+	SE3_METRICS_REQ_BYTES = 0,  ///< request payload: L0 data, or L1 data before encryption
+	SE3_METRICS_RESP_BYTES = 1,  ///< response payload, same as the request
+	SE3_METRICS_ROUNDTRIP_US = 2,  ///< L0 request written and response read
+	SE3_METRICS_WRITE_US = 3,  ///< request write
+	SE3_METRICS_WAIT_US = 4,  ///< poll loop, up to the first read that found the response
+	SE3_METRICS_READ_US = 5,  ///< rest of the response read and checked
+	SE3_METRICS_POLLS = 6,  ///< iterations of the poll loop
+	SE3_METRICS_SEAL_US = 7,  ///< L1 payload encryption
+	SE3_METRICS_OPEN_US = 8,  ///< L1 payload decryption
+	SE3_METRICS_DEVICE_CYCLES = 9,  ///< L1 command execution reported by the device
+	SE3_METRICS_HISTOGRAMS = 10
+};
+
+enum {
+	SE3_METRICS_CMD0_COUNT = 8,  ///< SE3_CMD0_* codes
+	SE3_METRICS_CMD1_COUNT = 16,  ///< SE3_CMD1_* codes
+	SE3_METRICS_BUCKETS = 33,  ///< upper bounds 2^0 .. 2^31, then +Inf
+	SE3_METRICS_CODES = 8  ///< distinct error codes counted for each command
+};
+
+/** \brief Histogram with power of two buckets; buckets are not cumulative */
+typedef struct se3_histogram_ {
+	uint64_t count;
+	uint64_t sum;
+	uint64_t buckets[SE3_METRICS_BUCKETS];  ///< values up to 2^i, above 2^(i-1)
+} se3_histogram;
+
+/** \brief Metrics of one command */
+typedef struct se3_metrics_cmd_ {
+	se3_histogram h[SE3_METRICS_HISTOGRAMS];
+	uint16_t codes[SE3_METRICS_CODES];  ///< error codes, in order of appearance
+	uint64_t errors[SE3_METRICS_CODES];  ///< requests failed with codes[i]
+	uint64_t errors_other;  ///< requests failed with codes beyond the first SE3_METRICS_CODES
+} se3_metrics_cmd;
+
+/** \brief Counters of a registry */
+typedef struct se3_metrics_data_ {
+	se3_metrics_cmd cmd0[SE3_METRICS_CMD0_COUNT];  ///< L0 commands, by SE3_CMD0_* code, L1 excluded
+	se3_metrics_cmd cmd1[SE3_METRICS_CMD1_COUNT];  ///< L1 commands, by SE3_CMD1_* code
+} se3_metrics_data;
+
+/** \brief Measures of the request in progress, kept by its device */
+typedef struct se3_metrics_sample_ {
+	uint32_t values[SE3_METRICS_HISTOGRAMS];
+	uint16_t mask;  ///< bit i set if values[i] was measured
+} se3_metrics_sample;
+
+/** \brief Registry, opaque */
+typedef struct se3_metrics_ se3_metrics;
+
+/** \brief Allocate an empty registry
+ *  \return NULL if out of memory
+ */
+se3_metrics* se3_metrics_create();
+
+/** \brief Free a registry; it must not be attached to any device */
+void se3_metrics_destroy(se3_metrics* m);
+
+/** \brief Clear all the counters */
+void se3_metrics_reset(se3_metrics* m);
+
+/** \brief Copy the counters, consistently with respect to the requests in progress */
+void se3_metrics_snapshot(se3_metrics* m, se3_metrics_data* data);
+
+/** \brief Write the counters in the Prometheus text exposition format
+ *  \param [out] buf output, always NUL terminated if size > 0; may be NULL if size is 0
+ *  \param [in] size capacity of buf
+ *  \return length of the whole text, without the NUL; the text was truncated if it is >= size
+ *
+ *  \details Only the commands sent at least once are written. Labels are level ("l0" or "l1")
+ *  and cmd, the lower case name of the command; error counters add code, in hexadecimal.
+ */
+size_t se3_metrics_prometheus(se3_metrics* m, char* buf, size_t size);
+
+/** \brief Forget the measures of a sample */
+void se3_metrics_sample_reset(se3_metrics_sample* sample);
+
+/** \brief Store a measure in a sample */
+void se3_metrics_sample_set(se3_metrics_sample* sample, unsigned which, uint64_t value);
+
+/** \brief Add the measured values of a sample to the histograms of a command
+ *  \param [in] level 0 for L0 commands, 1 for L1 commands
+ *  \param [in] status SE3_OK, or the error of the request, counted by code
+ */
+void se3_metrics_add(se3_metrics* m, unsigned level, uint16_t cmd, const se3_metrics_sample* sample, uint16_t status);
+
+#ifdef __cplusplus
+}
+#endif
@@ -1,5 +1,6 @@
 #include "se3comm.h"
 #include "se3_common.h"
+#include "se3_capture.h"
 
 #define _GNU_SOURCE
 #ifndef O_DIRECT
@@ -43,29 +44,52 @@ enum {
 #define FSCTL_IS_VOLUME_MOUNTED (0x90028)
 #endif
 
-void se3c_rand(size_t len, uint8_t* buf) {
+/* Random bytes are drawn from the OS SE3C_RAND_BUF_SIZE at a time into a per-thread buffer, so that
+   the command token and the IV of a request cost a copy instead of one or more system calls. Bytes
+   are erased as they are handed out; the buffer is dropped in a child process after fork. */
+enum {
+	SE3C_RAND_BUF_SIZE = 512
+};
+
+#ifdef _MSC_VER
+#define SE3C_THREAD_LOCAL __declspec(thread)
+#else
+#define SE3C_THREAD_LOCAL __thread
+#endif
+
+typedef struct {
+	uint8_t buf[SE3C_RAND_BUF_SIZE];
+	size_t pos;  // bytes already used
+	unsigned fork_gen;
+} se3c_rand_state;
+
+static SE3C_THREAD_LOCAL se3c_rand_state se3c_rand_tls = { { 0 }, SE3C_RAND_BUF_SIZE, 0 };
+
+/* The bytes become tokens, IVs and keys: without an OS source there is no safe way to go on */
+static void se3c_rand_fail(void)
+{
+	fprintf(stderr, "se3c_rand: no random source available\n");
+	abort();
+}
+
 #ifdef _WIN32
+static INIT_ONCE se3c_rand_once = INIT_ONCE_STATIC_INIT;
+static tADVAPI32_CryptGenRandom ADVAPI32_CryptGenRandom = NULL;
+static ULONG_PTR hProvider = 0;
+
+static BOOL CALLBACK se3c_rand_os_init(PINIT_ONCE once, PVOID param, PVOID* ctx)
+{
 	HMODULE hAdvapi32 = NULL;
 	tADVAPI32_CryptAcquireContextW ADVAPI32_CryptAcquireContextW = NULL;
-	tADVAPI32_CryptGenRandom ADVAPI32_CryptGenRandom = NULL;
-	tADVAPI32_CryptReleaseContext ADVAPI32_CryptReleaseContext = NULL;
-	bool wincrypt_available = false;
-	ULONG_PTR hProvider = 0;
-
-	if (!hAdvapi32) {
-		hAdvapi32 = LoadLibraryW(L"Advapi32.dll");
-		if (hAdvapi32 != NULL) {
-			ADVAPI32_CryptAcquireContextW = (tADVAPI32_CryptAcquireContextW)GetProcAddress(hAdvapi32, "CryptAcquireContextW");
-			ADVAPI32_CryptGenRandom = (tADVAPI32_CryptGenRandom)GetProcAddress(hAdvapi32, "CryptGenRandom");
-			ADVAPI32_CryptReleaseContext = (tADVAPI32_CryptReleaseContext)GetProcAddress(hAdvapi32, "CryptReleaseContext");
-			if (ADVAPI32_CryptAcquireContextW != NULL &&  ADVAPI32_CryptGenRandom != NULL && ADVAPI32_CryptReleaseContext != NULL) {
-				wincrypt_available = true;
-			}
-		}
-	}
 
-	if (wincrypt_available) {
+	hAdvapi32 = LoadLibraryW(L"Advapi32.dll");
+	if (hAdvapi32 != NULL) {
+		ADVAPI32_CryptAcquireContextW = (tADVAPI32_CryptAcquireContextW)GetProcAddress(hAdvapi32, "CryptAcquireContextW");
+		ADVAPI32_CryptGenRandom = (tADVAPI32_CryptGenRandom)GetProcAddress(hAdvapi32, "CryptGenRandom");
+	}
+	if (ADVAPI32_CryptAcquireContextW != NULL && ADVAPI32_CryptGenRandom != NULL) {
 		if (FALSE == ADVAPI32_CryptAcquireContextW(&hProvider, NULL, NULL, ADVAPI32_PROV_RSA_FULL, 0)) {
+			hProvider = 0;
 			if (ADVAPI32_NTE_BAD_KEYSET == GetLastError()) {
 				if (FALSE == ADVAPI32_CryptAcquireContextW(&hProvider, NULL, NULL, ADVAPI32_PROV_RSA_FULL, ADVAPI32_CRYPT_NEWKEYSET)) {
 					hProvider = 0;
@@ -73,22 +97,103 @@ void se3c_rand(size_t len, uint8_t* buf) {
 			}
 		}
 	}
+	// the provider is kept for the lifetime of the process
+	return TRUE;
+}
 
-	if (hProvider != 0) {
-		ADVAPI32_CryptGenRandom(hProvider, (DWORD)len, buf);
-		ADVAPI32_CryptReleaseContext(hProvider, 0U);
-	}
-	else {
-		for (size_t i = 0; i < len; i++) {
-			buf[i] = (uint8_t)rand();
-		}
+static void se3c_rand_os(size_t len, uint8_t* buf)
+{
+	InitOnceExecuteOnce(&se3c_rand_once, se3c_rand_os_init, NULL, NULL);
+	if (hProvider == 0 || FALSE == ADVAPI32_CryptGenRandom(hProvider, (DWORD)len, buf)) {
+		se3c_rand_fail();
 	}
+}
 
+static unsigned se3c_rand_fork_gen(void)
+{
+	return 0;
+}
 #else
-	int frnd = open("/dev/urandom", O_RDONLY);
-	read(frnd, buf, len);
-	close(frnd);
+static pthread_once_t se3c_rand_once = PTHREAD_ONCE_INIT;
+static volatile unsigned se3c_rand_forks = 0;
+
+static void se3c_rand_atfork_child(void)
+{
+	se3c_rand_forks++;
+}
+
+static void se3c_rand_atfork_init(void)
+{
+	pthread_atfork(NULL, NULL, se3c_rand_atfork_child);
+}
+
+static unsigned se3c_rand_fork_gen(void)
+{
+	pthread_once(&se3c_rand_once, se3c_rand_atfork_init);
+	return se3c_rand_forks;
+}
+
+static void se3c_rand_os(size_t len, uint8_t* buf)
+{
+	ssize_t r = -1;
+	int frnd;
+
+	while (len > 0) {
+#ifdef SYS_getrandom
+		r = syscall(SYS_getrandom, buf, len, 0);
+		if (r < 0 && errno == EINTR) {
+			continue;
+		}
 #endif
+		if (r <= 0) {
+			// kernel older than 3.17
+			frnd = open("/dev/urandom", O_RDONLY);
+			r = (frnd < 0) ? -1 : read(frnd, buf, len);
+			if (frnd >= 0) {
+				close(frnd);
+			}
+			if (r <= 0) {
+				se3c_rand_fail();
+			}
+		}
+		buf += r;
+		len -= (size_t)r;
+	}
+}
+#endif
+
+void se3c_rand(size_t len, uint8_t* buf) {
+	se3c_rand_state* st = &se3c_rand_tls;
+	unsigned fork_gen = se3c_rand_fork_gen();
+	size_t n;
+
+	if (st->fork_gen != fork_gen) {
+		// the parent process may use the same bytes
+		memset(st->buf, 0, sizeof(st->buf));
+		st->pos = SE3C_RAND_BUF_SIZE;
+		st->fork_gen = fork_gen;
+	}
+
+	if (len >= SE3C_RAND_BUF_SIZE / 2) {
+		se3c_rand_os(len, buf);
+		return;
+	}
+
+	while (len > 0) {
+		if (st->pos == SE3C_RAND_BUF_SIZE) {
+			se3c_rand_os(SE3C_RAND_BUF_SIZE, st->buf);
+			st->pos = 0;
+		}
+		n = SE3C_RAND_BUF_SIZE - st->pos;
+		if (n > len) {
+			n = len;
+		}
+		memcpy(buf, st->buf + st->pos, n);
+		memset(st->buf + st->pos, 0, n);
+		st->pos += n;
+		buf += n;
+		len -= n;
+	}
 }
 
 #ifdef _WIN32
@@ -171,7 +276,7 @@ bool se3c_drive_next(se3_drive_it* it)
 
 
 
-bool se3c_write(uint8_t* buf, se3_file hfile, size_t block, size_t nblocks, uint32_t timeout)
+static bool se3c_write_os(uint8_t* buf, se3_file hfile, size_t block, size_t nblocks, uint32_t timeout)
 {
     bool success = false;
     DWORD bytes_written = 0;
@@ -206,7 +311,7 @@ bool se3c_write(uint8_t* buf, se3_file hfile, size_t block, size_t nblocks, uint
     return success;
 }
 
-bool se3c_read(uint8_t* buf, se3_file hfile, size_t block, size_t nblocks, uint32_t timeout)
+static bool se3c_read_os(uint8_t* buf, se3_file hfile, size_t block, size_t nblocks, uint32_t timeout)
 {
     bool success = false;
     DWORD bytes_read = 0;
@@ -297,7 +402,7 @@ bool se3c_drive_next(se3_drive_it* it)
     return false;
 }
 
-bool se3c_write(uint8_t* buf, se3_file hfile, size_t block, size_t nblocks, uint32_t timeout)
+static bool se3c_write_os(uint8_t* buf, se3_file hfile, size_t block, size_t nblocks, uint32_t timeout)
 {
     memcpy(hfile.buf, buf, nblocks*SE3_COMM_BLOCK);
     if (nblocks*SE3_COMM_BLOCK != pwrite(hfile.fd, hfile.buf, nblocks*SE3_COMM_BLOCK, block*SE3_COMM_BLOCK)) {
@@ -306,7 +411,7 @@ bool se3c_write(uint8_t* buf, se3_file hfile, size_t block, size_t nblocks, uint
     return true;
 }
 
-bool se3c_read(uint8_t* buf, se3_file hfile, size_t block, size_t nblocks, uint32_t timeout)
+static bool se3c_read_os(uint8_t* buf, se3_file hfile, size_t block, size_t nblocks, uint32_t timeout)
 {
     if (nblocks*SE3_COMM_BLOCK != pread(hfile.fd, hfile.buf, nblocks*SE3_COMM_BLOCK, block*SE3_COMM_BLOCK)) {
         return false;
@@ -328,6 +433,34 @@ void se3c_close(se3_file hfile) {
 
 #endif
 
+bool se3c_write(uint8_t* buf, se3_file hfile, size_t block, size_t nblocks, uint32_t timeout)
+{
+    uint64_t start;
+    bool ok;
+
+    if (!se3_capture_active()) {
+        return se3c_write_os(buf, hfile, block, nblocks, timeout);
+    }
+    start = se3c_clock_us();
+    ok = se3c_write_os(buf, hfile, block, nblocks, timeout);
+    se3_capture_blocks(SE3_CAPTURE_WRITE, buf, block, nblocks, ok, start, se3c_clock_us());
+    return ok;
+}
+
+bool se3c_read(uint8_t* buf, se3_file hfile, size_t block, size_t nblocks, uint32_t timeout)
+{
+    uint64_t start;
+    bool ok;
+
+    if (!se3_capture_active()) {
+        return se3c_read_os(buf, hfile, block, nblocks, timeout);
+    }
+    start = se3c_clock_us();
+    ok = se3c_read_os(buf, hfile, block, nblocks, timeout);
+    se3_capture_blocks(SE3_CAPTURE_READ, buf, block, nblocks, ok, start, se3c_clock_us());
+    return ok;
+}
+
 static void se3c_make_path(se3_char* dest, se3_char* src)
 {
     size_t len = 0;
@@ -693,6 +826,14 @@ uint64_t se3c_clock()
     ms = (ms * 1000) / CLOCKS_PER_SEC;
     return ms;
 }
+
+uint64_t se3c_clock_us()
+{
+    LARGE_INTEGER f, t;
+    QueryPerformanceFrequency(&f);
+    QueryPerformanceCounter(&t);
+    return (uint64_t)(t.QuadPart / f.QuadPart) * 1000000 + (uint64_t)((t.QuadPart % f.QuadPart) * 1000000 / f.QuadPart);
+}
 #else
 void se3c_pathcopy(se3_char* dest, se3_char* src)
 {
@@ -710,6 +851,17 @@ uint64_t se3c_clock()
     return ms;
 }
 
+uint64_t se3c_clock_us()
+{
+    uint64_t us;
+    struct timespec spec;
+    clock_gettime(CLOCK_MONOTONIC, &spec);
+    us = spec.tv_sec;
+    us *= 1000000;
+    us += (uint64_t)spec.tv_nsec / ((uint64_t)1000);
+    return us;
+}
+
 
 #endif
 
@@ -9,6 +9,8 @@
 #include <sys/stat.h>
 #include <malloc.h>
 #include <fcntl.h>
+#include <pthread.h>
+#include <sys/syscall.h>
 #endif
 
 #ifdef __cplusplus
@@ -76,6 +78,10 @@ extern "C" {
 #endif
     } se3_drive_it;
 
+    /** \brief Fill buf with random bytes from the OS; thread and fork safe
+     *
+     *  The process is aborted if the OS source fails, rather than return predictable bytes
+     */
     void se3c_rand(size_t len, uint8_t* buf);
 
     void se3c_drive_init(se3_drive_it* it);
@@ -91,6 +97,8 @@ extern "C" {
     uint64_t se3c_deadline(uint32_t timeout);
     void se3c_pathcopy(se3_char* dest, se3_char* src);
     uint64_t se3c_clock();
+    /** \brief Monotonic clock in microseconds, for timing requests */
+    uint64_t se3c_clock_us();
 
 #ifdef _WIN32
 #define se3c_sleep() Sleep(0)
@@ -0,0 +1,238 @@
+#include "secube.hpp"
+
+#include <cstring>
+
+namespace secube {
+
+static const char* error_string(uint16_t code)
+{
+	switch (code) {
+	case SE3_ERR_HW: return "hardware failure";
+	case SE3_ERR_COMM: return "communication error";
+	case SE3_ERR_BUSY: return "device locked by another process";
+	case SE3_ERR_STATE: return "invalid state for this operation";
+	case SE3_ERR_CMD: return "command does not exist";
+	case SE3_ERR_PARAMS: return "parameters are not valid";
+	case SE3_ERR_ACCESS: return "insufficient privileges";
+	case SE3_ERR_PIN: return "pin rejected";
+	case SE3_ERR_RESOURCE: return "resource not found";
+	case SE3_ERR_EXPIRED: return "resource expired";
+	case SE3_ERR_MEMORY: return "no more space to allocate resource";
+	case SE3_ERR_AUTH: return "authentication failed";
+	default: return "unknown error";
+	}
+}
+
+Error::Error(uint16_t code)
+	: std::runtime_error(std::string("SEcube error ") + std::to_string(code) + " (" + error_string(code) + ")"), code_(code)
+{
+}
+
+/* Device */
+
+std::vector<se3_device_info> Device::discover()
+{
+	std::vector<se3_device_info> devices;
+	se3_disco_it it;
+	L0_discover_init(&it);
+	while (L0_discover_next(&it)) {
+		devices.push_back(it.device_info);
+	}
+	return devices;
+}
+
+Device::Device(const se3_device_info* info, uint32_t timeout)
+	: dev_(new se3_device())
+{
+	se3_device_info first;
+	if (info == nullptr) {
+		std::vector<se3_device_info> devices = discover();
+		if (devices.empty())
+			throw Error(SE3_ERR_RESOURCE);
+		first = devices[0];
+		info = &first;
+	}
+	check(L0_open(dev_.get(), const_cast<se3_device_info*>(info), timeout));
+}
+
+Device& Device::operator=(Device&& other) noexcept
+{
+	if (this != &other) {
+		if (dev_)
+			L0_close(dev_.get());
+		dev_ = std::move(other.dev_);
+	}
+	return *this;
+}
+
+Device::~Device()
+{
+	if (dev_)
+		L0_close(dev_.get());
+}
+
+void Device::echo(bytes_in in, bytes_out out)
+{
+	if (out.size() < in.size() || in.size() > SE3_REQ_MAX_DATA)
+		throw Error(SE3_ERR_PARAMS);
+	check(L0_echo(dev_.get(), in.data(), (uint16_t)in.size(), out.data()));
+}
+
+/* Session */
+
+Session::Session(Device& dev, bytes_in pin, uint16_t access)
+	: state_(std::make_shared<State>())
+{
+	uint8_t padded[SE3_L1_PIN_SIZE] = { 0 };
+	if (pin.size() > SE3_L1_PIN_SIZE)
+		throw Error(SE3_ERR_PARAMS);
+	std::memcpy(padded, pin.data(), pin.size());
+	uint16_t r = L1_login(&state_->s, dev.get(), padded, access);
+	std::memset(padded, 0, sizeof(padded));
+	check(r);
+}
+
+Session::Session(Device& dev, std::string_view pin, uint16_t access)
+	: Session(dev, bytes_in(reinterpret_cast<const uint8_t*>(pin.data()), pin.size()), access)
+{
+}
+
+Session& Session::operator=(Session&& other) noexcept
+{
+	if (this != &other) {
+		logout();
+		state_ = std::move(other.state_);
+	}
+	return *this;
+}
+
+Session::~Session()
+{
+	logout();
+}
+
+void Session::logout() noexcept
+{
+	if (state_) {
+		std::lock_guard<std::mutex> lock(state_->lock);
+		if (state_->s.logged_in)
+			L1_logout(&state_->s);
+	}
+}
+
+std::vector<uint8_t> Session::encrypt(uint16_t algorithm, uint16_t mode, uint32_t key_id, bytes_in in)
+{
+	std::vector<uint8_t> out(in.size());
+	out.resize(encrypt(algorithm, mode, key_id, in, out));
+	return out;
+}
+
+std::vector<uint8_t> Session::decrypt(uint16_t algorithm, uint16_t mode, uint32_t key_id, bytes_in in)
+{
+	std::vector<uint8_t> out(in.size());
+	out.resize(decrypt(algorithm, mode, key_id, in, out));
+	return out;
+}
+
+size_t Session::aead_encrypt(uint16_t algorithm, uint32_t key_id, bytes_in nonce, bytes_in aad, bytes_in in, bytes_out out)
+{
+	size_t len = 0;
+	if (out.size() < in.size() + SE3_CRYPTO_AEAD_TAG_SIZE || nonce.size() > SE3_CRYPTO_MAX_DATAIN)
+		throw Error(SE3_ERR_PARAMS);
+	std::lock_guard<std::mutex> lock(state_->lock);
+	check(L1_aead_encrypt(&state_->s, algorithm, key_id, (uint16_t)nonce.size(), nonce.data(), aad.size(), aad.data(),
+		in.size(), in.data(), &len, out.data()));
+	return len;
+}
+
+size_t Session::aead_decrypt(uint16_t algorithm, uint32_t key_id, bytes_in nonce, bytes_in aad, bytes_in in, bytes_out out)
+{
+	size_t len = 0;
+	if (in.size() < SE3_CRYPTO_AEAD_TAG_SIZE || out.size() < in.size() - SE3_CRYPTO_AEAD_TAG_SIZE ||
+		nonce.size() > SE3_CRYPTO_MAX_DATAIN)
+		throw Error(SE3_ERR_PARAMS);
+	std::lock_guard<std::mutex> lock(state_->lock);
+	check(L1_aead_decrypt(&state_->s, algorithm, key_id, (uint16_t)nonce.size(), nonce.data(), aad.size(), aad.data(),
+		in.size(), in.data(), &len, out.data()));
+	return len;
+}
+
+bool Session::key_get_info(uint32_t key_id, se3_key& key, const uint8_t* salt)
+{
+	std::lock_guard<std::mutex> lock(state_->lock);
+	uint16_t r = L1_key_get_info(&state_->s, key_id, salt, &key);
+	if (r == SE3_ERR_RESOURCE)
+		return false;
+	check(r);
+	return true;
+}
+
+std::vector<se3_key> Session::key_list(const uint8_t* salt)
+{
+	enum { batch = 64 };
+	std::vector<se3_key> keys;
+	uint64_t cursor = SE3_KEY_LIST_CURSOR_START;
+	uint16_t count = 0;
+	std::lock_guard<std::mutex> lock(state_->lock);
+	do {
+		size_t n = keys.size();
+		keys.resize(n + batch);
+		check(L1_key_list_next(&state_->s, &cursor, batch, salt, keys.data() + n, &count));
+		keys.resize(n + count);
+	} while (count > 0);
+	return keys;
+}
+
+std::future<size_t> Session::encrypt_async(uint16_t algorithm, uint16_t mode, uint32_t key_id, bytes_in in, bytes_out out)
+{
+	return std::async(std::launch::async, [st = state_, algorithm, mode, key_id, in, out]() {
+		return do_crypt(st.get(), false, algorithm, mode, key_id, in, out);
+	});
+}
+
+std::future<size_t> Session::decrypt_async(uint16_t algorithm, uint16_t mode, uint32_t key_id, bytes_in in, bytes_out out)
+{
+	return std::async(std::launch::async, [st = state_, algorithm, mode, key_id, in, out]() {
+		return do_crypt(st.get(), true, algorithm, mode, key_id, in, out);
+	});
+}
+
+std::future<Digest> Session::digest_async(uint16_t algorithm, bytes_in in)
+{
+	return std::async(std::launch::async, [st = state_, algorithm, in]() {
+		return do_digest(st.get(), algorithm, in);
+	});
+}
+
+std::future<void> Session::key_edit_async(uint16_t op, se3_key& key)
+{
+	return std::async(std::launch::async, [st = state_, op, &key]() {
+		do_key_edit(st.get(), op, key);
+	});
+}
+
+/* CryptoSession */
+
+CryptoSession& CryptoSession::operator=(CryptoSession&& other) noexcept
+{
+	if (this != &other) {
+		release();
+		session_ = std::move(other.session_);
+		id_ = other.id_;
+		open_ = other.open_;
+		other.open_ = false;
+	}
+	return *this;
+}
+
+void CryptoSession::release() noexcept
+{
+	if (open_) {
+		std::lock_guard<std::mutex> lock(session_->lock);
+		if (session_->s.logged_in)
+			L1_crypto_update(&session_->s, id_, SE3_CRYPTO_FLAG_FINIT, 0, NULL, 0, NULL, NULL, NULL);
+		open_ = false;
+	}
+}
+
+}  // namespace secube
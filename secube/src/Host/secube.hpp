@@ -0,0 +1,307 @@
+/**
+ *  \file secube.hpp
+ *  \brief C++17 interface to the host library
+ *
+ *  \details Thin layer over L0/L1: the C structures are owned by move-only handles that
+ *  release them (L0_close, L1_logout, SE3_CRYPTO_FLAG_FINIT) when they go out of scope,
+ *  buffers are passed as spans and written in place, and errors are thrown as
+ *  secube::Error. The functions are inline where they only forward to the C API, so
+ *  that they cost no more than the call they wrap.
+ */
+
+#pragma once
+#include "L1.h"
+
+#include <array>
+#include <cstddef>
+#include <cstring>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+#if __cplusplus >= 202002L && __has_include(<span>)
+#include <span>
+#endif
+
+namespace secube {
+
+#if defined(__cpp_lib_span)
+template <typename T>
+using span = std::span<T>;
+#else
+/** \brief Minimal std::span for C++17: a pointer and a size */
+template <typename T>
+class span {
+public:
+	constexpr span() noexcept : data_(nullptr), size_(0) {}
+	constexpr span(T* data, size_t size) noexcept : data_(data), size_(size) {}
+	template <size_t N>
+	constexpr span(T (&a)[N]) noexcept : data_(a), size_(N) {}
+	template <typename C, typename = std::enable_if_t<
+		std::is_convertible_v<decltype(std::declval<C&>().data()), T*>>>
+	constexpr span(C& c) noexcept : data_(c.data()), size_(c.size()) {}
+	template <typename C, typename = std::enable_if_t<
+		std::is_convertible_v<decltype(std::declval<const C&>().data()), T*>>>
+	constexpr span(const C& c) noexcept : data_(c.data()), size_(c.size()) {}
+
+	constexpr T* data() const noexcept { return data_; }
+	constexpr size_t size() const noexcept { return size_; }
+	constexpr bool empty() const noexcept { return size_ == 0; }
+	constexpr T* begin() const noexcept { return data_; }
+	constexpr T* end() const noexcept { return data_ + size_; }
+	constexpr T& operator[](size_t i) const noexcept { return data_[i]; }
+	constexpr span first(size_t n) const noexcept { return span(data_, n); }
+	constexpr span subspan(size_t off, size_t n) const noexcept { return span(data_ + off, n); }
+	constexpr span subspan(size_t off) const noexcept { return span(data_ + off, size_ - off); }
+private:
+	T* data_;
+	size_t size_;
+};
+#endif
+
+using bytes_in = span<const uint8_t>;
+using bytes_out = span<uint8_t>;
+
+/** \brief Status other than SE3_OK returned by the C API */
+class Error : public std::runtime_error {
+public:
+	explicit Error(uint16_t code);
+	uint16_t code() const noexcept { return code_; }
+private:
+	uint16_t code_;
+};
+
+/** \brief Throw the status as an Error, unless it is SE3_OK */
+inline void check(uint16_t r)
+{
+	if (r != SE3_OK)
+		throw Error(r);
+}
+
+/** \brief Size of the SE3_ALGO_SHA256 and SE3_ALGO_HMACSHA256 outputs */
+constexpr size_t digest_size = B5_SHA256_DIGEST_SIZE;
+using Digest = std::array<uint8_t, digest_size>;
+
+/** \brief Open device, closed by the destructor; it must outlive its sessions */
+class Device {
+public:
+	/** \brief Devices connected to the host */
+	static std::vector<se3_device_info> discover();
+
+	/** \brief Open the device; the first one found if info is NULL */
+	explicit Device(const se3_device_info* info = nullptr, uint32_t timeout = 1000);
+	Device(Device&&) noexcept = default;
+	Device& operator=(Device&& other) noexcept;
+	~Device();
+
+	const se3_device_info& info() const noexcept { return dev_->info; }
+	se3_device* get() noexcept { return dev_.get(); }
+
+	/** \brief Send data and get it back, see \ref L0_echo; out must be as long as in */
+	void echo(bytes_in in, bytes_out out);
+
+	/** \brief Performance counters of the device, see \ref L0_stats */
+	se3_stats stats(bool reset = false)
+	{
+		se3_stats st;
+		check(L0_stats(dev_.get(), reset, &st));
+		return st;
+	}
+
+private:
+	std::unique_ptr<se3_device> dev_;
+};
+
+class CryptoSession;
+
+/** \brief Logged in session, logged out by the destructor
+ *
+ *  \details The 8 KB se3_session lives on the heap, so moving a Session moves a pointer.
+ *  Calls on the same Session, including the asynchronous ones, are serialized; use one
+ *  Session per device to run requests in parallel. The Device must outlive the Session;
+ *  crypto sessions and pending futures keep the session state alive, but fail once the
+ *  Session has logged out.
+ */
+class Session {
+public:
+	Session(Device& dev, bytes_in pin, uint16_t access = SE3_ACCESS_USER);
+	Session(Device& dev, std::string_view pin, uint16_t access = SE3_ACCESS_USER);
+	Session(Session&&) noexcept = default;
+	Session& operator=(Session&& other) noexcept;
+	~Session();
+
+	se3_session* get() noexcept { return &state_->s; }
+
+	/** \brief Set the device time, used for the key validity, see \ref L1_crypto_set_time */
+	void set_time(uint32_t devtime)
+	{
+		std::lock_guard<std::mutex> lock(state_->lock);
+		check(L1_crypto_set_time(&state_->s, devtime));
+	}
+
+	/** \brief Start a crypto session on the device, see \ref L1_crypto_init */
+	CryptoSession crypto(uint16_t algorithm, uint16_t mode, uint32_t key_id);
+
+	/** \brief Encrypt a whole message with \ref L1_encrypt
+	 *  \param [out] out At least as long as in
+	 *  \return Bytes written to out
+	 */
+	size_t encrypt(uint16_t algorithm, uint16_t mode, uint32_t key_id, bytes_in in, bytes_out out)
+	{
+		return do_crypt(state_.get(), false, algorithm, mode, key_id, in, out);
+	}
+	/** \brief Decrypt a whole message with \ref L1_decrypt */
+	size_t decrypt(uint16_t algorithm, uint16_t mode, uint32_t key_id, bytes_in in, bytes_out out)
+	{
+		return do_crypt(state_.get(), true, algorithm, mode, key_id, in, out);
+	}
+	/** \brief Encrypt into a vector allocated once with the size of the output */
+	std::vector<uint8_t> encrypt(uint16_t algorithm, uint16_t mode, uint32_t key_id, bytes_in in);
+	std::vector<uint8_t> decrypt(uint16_t algorithm, uint16_t mode, uint32_t key_id, bytes_in in);
+
+	/** \brief Digest of a whole message with \ref L1_digest */
+	Digest digest(uint16_t algorithm, bytes_in in)
+	{
+		return do_digest(state_.get(), algorithm, in);
+	}
+
+	/** \brief Authenticated encryption, see \ref L1_aead_encrypt
+	 *  \param [out] out At least in.size() + SE3_CRYPTO_AEAD_TAG_SIZE bytes
+	 *  \return Bytes written to out
+	 */
+	size_t aead_encrypt(uint16_t algorithm, uint32_t key_id, bytes_in nonce, bytes_in aad, bytes_in in, bytes_out out);
+	/** \brief Authenticated decryption, see \ref L1_aead_decrypt; throws SE3_ERR_AUTH if the
+	 *  message has been modified */
+	size_t aead_decrypt(uint16_t algorithm, uint32_t key_id, bytes_in nonce, bytes_in aad, bytes_in in, bytes_out out);
+
+	/** \brief Insert, update or delete a key, see \ref L1_key_edit */
+	void key_edit(uint16_t op, se3_key& key)
+	{
+		do_key_edit(state_.get(), op, key);
+	}
+	/** \brief Key information without its data, false if the key does not exist */
+	bool key_get_info(uint32_t key_id, se3_key& key, const uint8_t* salt = nullptr);
+	/** \brief All the keys stored in the device, without their data */
+	std::vector<se3_key> key_list(const uint8_t* salt = nullptr);
+
+	/** \name Asynchronous versions
+	 *  The buffers must stay valid until the future is ready. The future of a call that
+	 *  failed rethrows the Error from get().
+	 *  @{ */
+	std::future<size_t> encrypt_async(uint16_t algorithm, uint16_t mode, uint32_t key_id, bytes_in in, bytes_out out);
+	std::future<size_t> decrypt_async(uint16_t algorithm, uint16_t mode, uint32_t key_id, bytes_in in, bytes_out out);
+	std::future<Digest> digest_async(uint16_t algorithm, bytes_in in);
+	std::future<void> key_edit_async(uint16_t op, se3_key& key);
+	/** @} */
+
+private:
+	friend class CryptoSession;
+	struct State {
+		se3_session s;
+		std::mutex lock;  ///< one request at a time
+	};
+
+	void logout() noexcept;
+
+	// shared with the asynchronous calls, which hold a reference to the state
+	static size_t do_crypt(State* st, bool decrypt, uint16_t algorithm, uint16_t mode, uint32_t key_id, bytes_in in, bytes_out out)
+	{
+		size_t len = 0;
+		if (out.size() < in.size())
+			throw Error(SE3_ERR_PARAMS);
+		std::lock_guard<std::mutex> lock(st->lock);
+		// L1_encrypt and L1_decrypt do not write to the input
+		uint8_t* p = const_cast<uint8_t*>(in.data());
+		check(decrypt ? L1_decrypt(&st->s, algorithm, mode, key_id, in.size(), p, &len, out.data())
+			: L1_encrypt(&st->s, algorithm, mode, key_id, in.size(), p, &len, out.data()));
+		return len;
+	}
+	static Digest do_digest(State* st, uint16_t algorithm, bytes_in in)
+	{
+		Digest d;
+		size_t len = 0;
+		std::lock_guard<std::mutex> lock(st->lock);
+		check(L1_digest(&st->s, algorithm, in.size(), const_cast<uint8_t*>(in.data()), &len, d.data()));
+		return d;
+	}
+	static void do_key_edit(State* st, uint16_t op, se3_key& key)
+	{
+		std::lock_guard<std::mutex> lock(st->lock);
+		check(L1_key_edit(&st->s, op, &key));
+	}
+
+	std::shared_ptr<State> state_;
+};
+
+/** \brief Crypto session on the device, released by the destructor if not finished
+ *
+ *  \details Each update is one request, see \ref L1_crypto_update; a successful update
+ *  with SE3_CRYPTO_FLAG_FINIT ends the session.
+ */
+class CryptoSession {
+public:
+	CryptoSession(CryptoSession&& other) noexcept
+		: session_(std::move(other.session_)), id_(other.id_), open_(other.open_)
+	{
+		other.open_ = false;
+	}
+	CryptoSession& operator=(CryptoSession&& other) noexcept;
+	~CryptoSession() { release(); }
+
+	uint32_t id() const noexcept { return id_; }
+	bool is_open() const noexcept { return open_; }
+
+	/** \brief One request
+	 *  \param [out] out Response, up to SE3_CRYPTO_MAX_DATAOUT bytes; a shorter buffer is
+	 *  filled through a copy, and Error(SE3_ERR_PARAMS) is thrown if the response does not fit
+	 *  \return Bytes written to out
+	 */
+	size_t update(uint16_t flags, bytes_in in1, bytes_in in2, bytes_out out)
+	{
+		uint16_t len = 0;
+		if (!open_ || in1.size() > SE3_CRYPTO_MAX_DATAIN || in2.size() > SE3_CRYPTO_MAX_DATAIN)
+			throw Error(SE3_ERR_PARAMS);
+		std::lock_guard<std::mutex> lock(session_->lock);
+		// L1_crypto_update writes the whole response, only a buffer for the largest one is passed
+		bool direct = out.size() >= SE3_CRYPTO_MAX_DATAOUT;
+		check(L1_crypto_update(&session_->s, id_, flags, (uint16_t)in1.size(), in1.data(), (uint16_t)in2.size(), in2.data(),
+			&len, direct ? out.data() : nullptr));
+		if (flags & SE3_CRYPTO_FLAG_FINIT)
+			open_ = false;
+		if (!direct) {
+			if (len > out.size())
+				throw Error(SE3_ERR_PARAMS);
+			std::memcpy(out.data(), session_->s.buf + SE3_RESP1_OFFSET_DATA + SE3_CMD1_CRYPTO_UPDATE_RESP_OFF_DATA, len);
+		}
+		return len;
+	}
+
+	/** \brief Last request, with SE3_CRYPTO_FLAG_FINIT */
+	size_t finish(bytes_in in1, bytes_in in2, bytes_out out, uint16_t flags = 0)
+	{
+		return update(flags | SE3_CRYPTO_FLAG_FINIT, in1, in2, out);
+	}
+
+private:
+	friend class Session;
+	CryptoSession(std::shared_ptr<Session::State> session, uint32_t id) noexcept
+		: session_(std::move(session)), id_(id), open_(true) {}
+	void release() noexcept;
+
+	std::shared_ptr<Session::State> session_;
+	uint32_t id_;
+	bool open_;
+};
+
+inline CryptoSession Session::crypto(uint16_t algorithm, uint16_t mode, uint32_t key_id)
+{
+	uint32_t id = 0;
+	std::lock_guard<std::mutex> lock(state_->lock);
+	check(L1_crypto_init(&state_->s, algorithm, mode, key_id, &id));
+	return CryptoSession(state_, id);
+}
+
+}  // namespace secube
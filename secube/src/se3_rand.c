@@ -1,42 +1,240 @@
+/**
+ *  \file se3_rand.c
+ *  \brief Random numbers: hardware RNG entropy pool feeding an AES-256 CTR_DRBG
+ */
+
 #include "se3_rand.h"
 #include "rng.h"
 #include "stm32f4xx_hal_rng.h"
+#include "ctr_drbg.h"
+#include "se3c0def.h"
+#include <string.h>
+
+static struct {
+	volatile uint32_t pool[SE3_RAND_POOL_WORDS];
+	volatile uint32_t head;  ///< words written by the interrupt
+	volatile uint32_t tail;  ///< words read
+	volatile bool filling;  ///< RNG interrupt armed
+	volatile bool last_valid;
+	volatile uint32_t last;  ///< last RNG word, for the repetition test
+	volatile uint16_t rep_count;  ///< consecutive repeated words
+	B5_tCtrDrbgCtx drbg;
+	uint8_t buf[SE3_RAND_BUF_SIZE];
+	uint16_t buf_pos;  ///< bytes of buf already used
+	volatile se3_rand_stats stats;
+} rng;
+
+/* NIST CAVP CTR_DRBG AES-256 no df, no reseed, COUNT = 0: instantiate, generate twice */
+static const uint8_t kat_entropy[B5_CTR_DRBG_SEED_SIZE] = {
+	0xdf, 0x5d, 0x73, 0xfa, 0xa4, 0x68, 0x64, 0x9e, 0xdd, 0xa3, 0x3b, 0x5c, 0xca, 0x79, 0xb0, 0xb0,
+	0x56, 0x00, 0x41, 0x9c, 0xcb, 0x7a, 0x87, 0x9d, 0xdf, 0xec, 0x9d, 0xb3, 0x2e, 0xe4, 0x94, 0xe5,
+	0x53, 0x1b, 0x51, 0xde, 0x16, 0xa3, 0x0f, 0x76, 0x92, 0x62, 0x47, 0x4c, 0x73, 0xbe, 0xc0, 0x10
+};
+static const uint8_t kat_output[64] = {
+	0xd1, 0xc0, 0x7c, 0xd9, 0x5a, 0xf8, 0xa7, 0xf1, 0x10, 0x12, 0xc8, 0x4c, 0xe4, 0x8b, 0xb8, 0xcb,
+	0x87, 0x18, 0x9e, 0x99, 0xd4, 0x0f, 0xcc, 0xb1, 0x77, 0x1c, 0x61, 0x9b, 0xdf, 0x82, 0xab, 0x22,
+	0x80, 0xb1, 0xdc, 0x2f, 0x25, 0x81, 0xf3, 0x91, 0x64, 0xf7, 0xac, 0x0c, 0x51, 0x04, 0x94, 0xb3,
+	0xa4, 0x3c, 0x41, 0xb7, 0xdb, 0x17, 0x51, 0x4c, 0x87, 0xb1, 0x07, 0xae, 0x79, 0x3e, 0x01, 0xc5
+};
+
+static bool rand_kat(void)
+{
+	uint8_t out[sizeof(kat_output)];
+	bool ok;
+
+	ok = (B5_CTR_DRBG_RES_OK == B5_CtrDrbg_Instantiate(&rng.drbg, kat_entropy, NULL, 0)) &&
+		(B5_CTR_DRBG_RES_OK == B5_CtrDrbg_Generate(&rng.drbg, out, sizeof(out), NULL, 0)) &&
+		(B5_CTR_DRBG_RES_OK == B5_CtrDrbg_Generate(&rng.drbg, out, sizeof(out), NULL, 0)) &&
+		(memcmp(out, kat_output, sizeof(out)) == 0);
+	B5_CtrDrbg_Uninstantiate(&rng.drbg);
+	return ok;
+}
+
+static uint32_t rand_pool_count(void)
+{
+	return rng.head - rng.tail;
+}
 
+/* Arm the RNG interrupt, unless it is armed already or the pool is full */
+static void rand_pool_fill(void)
+{
+	if (rng.filling || !rng.stats.ok || rand_pool_count() >= SE3_RAND_POOL_WORDS) {
+		return;
+	}
+	rng.filling = true;
+	if (HAL_OK != HAL_RNG_GenerateRandomNumber_IT(&hrng)) {
+		rng.filling = false;
+	}
+}
 
-bool se3_rand32(uint32_t *val){
-	size_t i;
-	HAL_StatusTypeDef ret;
-	for(i=0; i<20; i++){
-		ret=HAL_RNG_GenerateRandomNumber(&hrng, val);
-		if(ret==HAL_OK){
-			return true;
+void HAL_RNG_ReadyDataCallback(RNG_HandleTypeDef* h, uint32_t word)
+{
+	if (!rng.last_valid) {
+		// the first word after a (re)start is only used for comparison
+		rng.last_valid = true;
+	}
+	else if (word == rng.last) {
+		rng.stats.rep_failures++;
+		if (++rng.rep_count >= SE3_RAND_REP_MAX) {
+			rng.stats.ok = false;
+			rng.filling = false;
+			return;
 		}
-		else if(ret==HAL_ERROR){
-			return false;
+	}
+	else {
+		rng.rep_count = 0;
+		rng.pool[rng.head % SE3_RAND_POOL_WORDS] = word;
+		rng.head++;
+	}
+	rng.last = word;
+
+	if (rand_pool_count() < SE3_RAND_POOL_WORDS) {
+		if (HAL_OK != HAL_RNG_GenerateRandomNumber_IT(h)) {
+			rng.filling = false;
 		}
 	}
-	return false;
+	else {
+		rng.filling = false;
+	}
 }
 
-uint16_t se3_rand(uint16_t size, uint8_t* data){
-	uint32_t tmp;
-	size_t i,n;
+void HAL_RNG_ErrorCallback(RNG_HandleTypeDef* h)
+{
+	rng.stats.hw_errors++;
+	// seed or clock error: restart the generator and discard the word in progress
+	__HAL_RNG_DISABLE(h);
+	__HAL_RNG_ENABLE(h);
+	h->State = HAL_RNG_STATE_READY;
+	rng.last_valid = false;
+	if (HAL_OK != HAL_RNG_GenerateRandomNumber_IT(h)) {
+		rng.filling = false;
+	}
+}
 
-	n=size/4;
-	for(i=0;i<n;i++){
-		if(!se3_rand32((uint32_t*)data)){
-			return 0;
+uint16_t se3_rand_entropy(uint16_t size, uint8_t* data)
+{
+	uint32_t start = HAL_GetTick();
+	uint32_t word;
+	uint16_t i, n;
+
+	for (i = 0; i < size; i += n) {
+		rand_pool_fill();
+		if (rand_pool_count() == 0) {
+			if (!rng.stats.ok || (HAL_GetTick() - start) > SE3_RAND_TIMEOUT) {
+				return 0;
+			}
+			n = 0;
+			continue;
 		}
-		data+=4;
+		word = rng.pool[rng.tail % SE3_RAND_POOL_WORDS];
+		rng.pool[rng.tail % SE3_RAND_POOL_WORDS] = 0;
+		rng.tail++;
+
+		n = ((size - i) < 4) ? (size - i) : 4;
+		memcpy(data + i, &word, n);
 	}
-	n=size%4;
-	if(n!=0){
-		if(!se3_rand32(&tmp)){
-			return 0;
-		}
-		for(i=0;i<n;i++){
-			data[i]=((uint8_t*)&tmp)[i];
+	word = 0;
+	return size;
+}
+
+static bool rand_reseed(void)
+{
+	uint8_t seed[B5_CTR_DRBG_SEED_SIZE];
+	bool ok;
+
+	ok = (sizeof(seed) == se3_rand_entropy(sizeof(seed), seed)) &&
+		(B5_CTR_DRBG_RES_OK == B5_CtrDrbg_Reseed(&rng.drbg, seed, NULL, 0));
+	memset(seed, 0, sizeof(seed));
+	if (ok) {
+		rng.stats.reseeds++;
+	}
+	else {
+		SE3_TRACE(("[se3_rand] reseed failed\n"));
+	}
+	return ok;
+}
+
+static bool rand_generate(uint8_t* out, uint16_t len)
+{
+	// the reseed may wait on the RNG: se3_rand_idle normally reseeds long before this limit
+	if (rng.drbg.reseedCounter > SE3_RAND_RESEED_MAX && !rand_reseed()) {
+		return false;
+	}
+	return (B5_CTR_DRBG_RES_OK == B5_CtrDrbg_Generate(&rng.drbg, out, len, NULL, 0));
+}
+
+bool se3_rand_init(const uint8_t* pers, uint16_t pers_len)
+{
+	uint8_t seed[B5_CTR_DRBG_SEED_SIZE];
+	bool ok;
+
+	memset((void*)&rng, 0, sizeof(rng));
+	rng.buf_pos = SE3_RAND_BUF_SIZE;
+
+	if (!rand_kat()) {
+		SE3_TRACE(("[se3_rand_init] CTR_DRBG self test failed\n"));
+		return false;
+	}
+	rng.stats.ok = true;
+
+	ok = (sizeof(seed) == se3_rand_entropy(sizeof(seed), seed)) &&
+		(B5_CTR_DRBG_RES_OK == B5_CtrDrbg_Instantiate(&rng.drbg, seed, pers, (int16_t)pers_len));
+	memset(seed, 0, sizeof(seed));
+	if (!ok) {
+		SE3_TRACE(("[se3_rand_init] cannot seed the DRBG\n"));
+		rng.stats.ok = false;
+		return false;
+	}
+
+	se3_rand_idle();
+	return true;
+}
+
+uint16_t se3_rand(uint16_t size, uint8_t* data)
+{
+	uint16_t n;
+
+	if (!rng.stats.ok) {
+		return 0;
+	}
+
+	n = SE3_RAND_BUF_SIZE - rng.buf_pos;
+	if (n > size) {
+		n = size;
+	}
+	memcpy(data, rng.buf + rng.buf_pos, n);
+	memset(rng.buf + rng.buf_pos, 0, n);
+	rng.buf_pos += n;
+
+	if (n == size) {
+		rng.stats.buffer_hits++;
+		return size;
+	}
+	return rand_generate(data + n, size - n) ? size : 0;
+}
+
+void se3_rand_idle(void)
+{
+	if (!rng.stats.ok) {
+		return;
+	}
+	rand_pool_fill();
+
+	// only when the pool holds a full seed, so that the idle loop never waits on the RNG
+	if (rng.drbg.reseedCounter > SE3_RAND_RESEED_IDLE &&
+		rand_pool_count() * 4 >= B5_CTR_DRBG_SEED_SIZE)
+	{
+		rand_reseed();
+	}
+
+	if (rng.buf_pos >= SE3_RAND_BUF_SIZE / 2) {
+		if (rand_generate(rng.buf, SE3_RAND_BUF_SIZE)) {
+			rng.buf_pos = 0;
 		}
 	}
-	return size;
+}
+
+void se3_rand_get_stats(se3_rand_stats* stats)
+{
+	memcpy(stats, (const void*)&rng.stats, sizeof(se3_rand_stats));
 }
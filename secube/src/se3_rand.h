@@ -1,6 +1,63 @@
+/**
+ *  \file se3_rand.h
+ *  \brief Random numbers: hardware RNG entropy pool feeding an AES-256 CTR_DRBG
+ *  
+ *  The RNG interrupt fills the entropy pool in the background; each word passes a repetition
+ *  test before use. The DRBG is seeded from the pool and keeps a buffer of output, refilled
+ *  and reseeded by \ref se3_rand_idle, so that short requests are served by a copy.
+ */
+
 #pragma once
 #include <stdint.h>
 #include <stdbool.h>
 #include <stddef.h>
 
+/** Sizes and reseed policy */
+enum {
+	SE3_RAND_POOL_WORDS = 64,  ///< 32-bit words in the entropy pool, power of two
+	SE3_RAND_BUF_SIZE = 256,  ///< DRBG output buffer
+	SE3_RAND_RESEED_IDLE = 16,  ///< DRBG requests after which se3_rand_idle reseeds
+	SE3_RAND_RESEED_MAX = 1024,  ///< DRBG requests after which se3_rand must reseed before answering
+	SE3_RAND_REP_MAX = 4,  ///< consecutive repeated RNG words after which the RNG is declared failed
+	SE3_RAND_TIMEOUT = 10  ///< ms to wait for the RNG when the pool is empty
+};
+
+/** \brief Health and reseed counters */
+typedef struct se3_rand_stats_ {
+	uint32_t reseeds;  ///< DRBG reseeds
+	uint32_t buffer_hits;  ///< se3_rand requests served from the output buffer alone
+	uint32_t rep_failures;  ///< RNG words discarded by the repetition test
+	uint32_t hw_errors;  ///< RNG seed or clock errors
+	bool ok;  ///< false after a failed self test or a stuck RNG; se3_rand then fails
+} se3_rand_stats;
+
+/** \brief Self test and instantiate the DRBG
+ *  
+ *  Runs the CTR_DRBG known answer test, starts the RNG interrupt and seeds the DRBG from the pool.
+ *  \param pers personalization string, such as the serial number
+ *  \param pers_len length of pers, up to 48 bytes
+ *  \return false if the self test fails or the RNG produces no entropy
+ */
+bool se3_rand_init(const uint8_t* pers, uint16_t pers_len);
+
+/** \brief Fill a buffer with random bytes from the DRBG
+ *  \return size, or 0 on failure
+ */
 uint16_t se3_rand(uint16_t size, uint8_t* data);
+
+/** \brief Fill a buffer with raw RNG output from the entropy pool
+ *  
+ *  Waits for the RNG, up to SE3_RAND_TIMEOUT, when the pool runs out.
+ *  \return size, or 0 on failure
+ */
+uint16_t se3_rand_entropy(uint16_t size, uint8_t* data);
+
+/** \brief Background work, to be called when no command is pending
+ *  
+ *  Restarts the RNG interrupt if the pool is not full, reseeds the DRBG when it is due and the
+ *  pool holds a full seed, and refills the output buffer when half of it has been used.
+ */
+void se3_rand_idle(void);
+
+/** \brief Read the health and reseed counters */
+void se3_rand_get_stats(se3_rand_stats* stats);
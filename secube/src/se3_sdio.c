@@ -1,23 +1,46 @@
 #include "se3_sdio.h"
 #include "usbd_storage_if.h"
 #include "sdio.h"
+#include "se3_core.h"
+#include "se3_bench.h"
+#include "se3_log.h"
 
 
 bool secube_sdio_write(uint8_t lun, const uint8_t* buf, uint32_t blk_addr, uint16_t blk_len)
 {
+	uint32_t start = se3_cycles();
+	bool ok = false;
+
 	if (HAL_SD_WriteBlocks_DMA(&hsd, (uint32_t *)buf, blk_addr * STORAGE_BLK_SIZ, STORAGE_BLK_SIZ, blk_len) == SD_OK)
 		if (HAL_SD_CheckWriteOperation(&hsd, (uint32_t)SD_DATATIMEOUT) == SD_OK)
-			return true;
+			ok = true;
 
-	return false;
+	se3_counters.sd_write_cycles += se3_cycles() - start;
+	if (ok)
+		se3_counters.sd_write_blocks += blk_len;
+	else {
+		se3_counters.sd_errors++;
+		SE3_LOG(SE3_LOG_SD_ERROR, blk_addr, blk_len | 0x80000000);
+	}
+	return ok;
 }
 bool secube_sdio_read(uint8_t lun, uint8_t* buf, uint32_t blk_addr, uint16_t blk_len)
 {
+	uint32_t start = se3_cycles();
+	bool ok = false;
+
 	if (HAL_SD_ReadBlocks_DMA(&hsd, (uint32_t *)buf, blk_addr * STORAGE_BLK_SIZ, STORAGE_BLK_SIZ, blk_len) == SD_OK)
 		if (HAL_SD_CheckReadOperation(&hsd, (uint32_t)SD_DATATIMEOUT) == SD_OK)
-			return true;
+			ok = true;
 
-	return false;
+	se3_counters.sd_read_cycles += se3_cycles() - start;
+	if (ok)
+		se3_counters.sd_read_blocks += blk_len;
+	else {
+		se3_counters.sd_errors++;
+		SE3_LOG(SE3_LOG_SD_ERROR, blk_addr, blk_len);
+	}
+	return ok;
 }
 
 bool secube_sdio_capacity(uint32_t *block_num, uint16_t *block_size)
@@ -46,10 +46,12 @@
 /* Exported functions ------------------------------------------------------- */
 
 void SysTick_Handler(void);
+void FLASH_IRQHandler(void);
 void SDIO_IRQHandler(void);
 void DMA2_Stream3_IRQHandler(void);
 void DMA2_Stream6_IRQHandler(void);
 void OTG_HS_IRQHandler(void);
+void HASH_RNG_IRQHandler(void);
 
 #ifdef __cplusplus
 }